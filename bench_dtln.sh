@@ -0,0 +1,105 @@
+#!/bin/bash
+# dtln benchmarks, run on a host with tflite (thirdpart/lib) and the dtln models:
+#   1. ms/frame per interpreter thread count, builtin kernels and xnnpack
+#   2. snr and ms/frame of the int8 / float16 model pairs against float32
+#   3. ms/frame of the copying code before the zero-copy tensor binding
+#      and of the binding itself, each built from its own commit
+# usage: ./bench_dtln.sh model_dir [in.wav [before_rev after_rev]]
+# model_dir holds model_1.tflite and model_2.tflite, and optionally
+# model_1_int8.tflite / model_2_int8.tflite and model_1_f16.tflite / model_2_f16.tflite.
+# after_rev defaults to the commit whose subject starts with [user-001] and
+# before_rev to its parent; pass both when the history was rewritten. Both
+# need the two-argument dios_ssp_dtln_init_api of that commit
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "usage: $0 model_dir [in.wav [before_rev after_rev]]"
+	exit 1
+fi
+MODEL=$(cd "$1" && pwd)
+WAV=$(realpath "${2:-data/airconditioner.wav}")
+ROOT=$(pwd)
+AFTER=${4:-$(git log --reverse --format=%H --grep='^\[user-001\]' | head -1)}
+BEFORE=${3:-$AFTER^}
+if [ -z "$AFTER" ] || ! git rev-parse -q --verify "$BEFORE^{commit}" > /dev/null ||
+		! git rev-parse -q --verify "$AFTER^{commit}" > /dev/null; then
+	echo "zero-copy revisions not found in the history, pass before_rev and after_rev"
+	exit 1
+fi
+
+./compile_lib.sh
+./compile_exm.sh
+
+echo "== threads and delegate (test pair = float32 pair)"
+for delegate in 0 1
+do
+	for threads in 1 2 4
+	do
+		bin/dtln_compare "$WAV" "$MODEL/model_1.tflite" "$MODEL/model_2.tflite" \
+			"$MODEL/model_1.tflite" "$MODEL/model_2.tflite" $threads $delegate
+	done
+done
+
+for quant in int8 f16
+do
+	if [ -f "$MODEL/model_1_$quant.tflite" ]; then
+		echo "== $quant against float32"
+		bin/dtln_compare "$WAV" "$MODEL/model_1.tflite" "$MODEL/model_2.tflite" \
+			"$MODEL/model_1_$quant.tflite" "$MODEL/model_2_$quant.tflite"
+	fi
+done
+
+# the copy path no longer exists, so the commit before the zero-copy binding
+# and the binding commit itself are built in temporary worktrees and timed
+# with the same driver, whose api is the one of those two commits
+echo "== copying tensors ($BEFORE) against zero-copy binding ($AFTER)"
+cat > /tmp/dtln_bench_driver.c <<'EOF'
+#include "dios_ssp_dtln/dios_ssp_dtln_api.h"
+#include "sndfile.h"
+#include <time.h>
+
+int main(int argc, char **argv) {
+	const char *modelpath[2] = { argv[2], argv[3] };
+	SF_INFO info;
+	memset(&info, 0, sizeof(info));
+	SNDFILE *inwav = sf_open(argv[1], SFM_READ, &info);
+	int framelen = 128;
+	int frames = (int)(info.frames / framelen);
+	short *pcm = (short *)calloc(frames * framelen, sizeof(short));
+	float buf[128];
+	frames = (int)(sf_readf_short(inwav, pcm, frames * framelen) / framelen);
+	sf_close(inwav);
+
+	void *hdtln = dios_ssp_dtln_init_api(modelpath, framelen);
+	dios_ssp_dtln_reset_api(hdtln);
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (int i = 0; i < frames; i++) {
+		for (int j = 0; j < framelen; j++) {
+			buf[j] = pcm[i * framelen + j];
+		}
+		dios_ssp_dtln_process(hdtln, buf);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double ms = (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1000000.0;
+	printf("%d frames, %.4f ms/frame\n", frames, ms / frames);
+	dios_ssp_dtln_uninit_api(hdtln);
+	free(pcm);
+	return 0;
+}
+EOF
+for rev in "$BEFORE" "$AFTER"
+do
+	WT=/tmp/dtln_bench_$(git rev-parse --short "$rev")
+	rm -rf "$WT"
+	git worktree add -f --detach "$WT" $rev > /dev/null
+	ln -s "$ROOT/thirdpart/lib" "$WT/thirdpart/lib"
+	(cd "$WT" && ./compile_lib.sh && gcc /tmp/dtln_bench_driver.c -Iinc -Ithirdpart/include \
+		-Llib -Lthirdpart/lib -lathena -lsndfile -lpthread -ldl -lm -Wl,-rpath,./lib -o bench)
+	echo -n "$rev: "
+	for run in 1 2 3
+	do
+		(cd "$WT" && ./bench "$WAV" "$MODEL/model_1.tflite" "$MODEL/model_2.tflite")
+	done
+	git worktree remove --force "$WT"
+done
@@ -13,3 +13,49 @@ g++ \
 	-lm \
 	-Wl,-rpath,./lib \
 	-o bin/dtln
+
+for name in dtln_compare doa_compare fft_compare aec_compare tde_compare complex_compare mask_compare
+do
+	g++ \
+		examples/$name.c \
+		-Iinc \
+		-Ithirdpart/include \
+		-Llib \
+		-Lthirdpart/lib \
+		-lathena \
+		-lsndfile \
+		-lpthread \
+		-ldl \
+		-lm \
+		-Wl,-rpath,./lib \
+		-o bin/$name
+done
+
+# built from the dtln sources with its own stub tflite c api, runs without tflite
+gcc \
+	examples/dtln_batch_compare.c \
+	src/dios_ssp_dtln/*.c \
+	src/dios_ssp_share/*.c \
+	-Iinc \
+	-Iinc/dios_ssp_dtln \
+	-Iinc/dios_ssp_share \
+	-Isrc \
+	-Ithirdpart/include \
+	-O2 \
+	-lpthread \
+	-lm \
+	-o bin/dtln_batch_compare
+
+# built from the mvdr sources, runs without tflite
+gcc \
+	examples/mvdr_compare.c \
+	src/dios_ssp_mvdr/*.c \
+	src/dios_ssp_share/*.c \
+	-Iinc \
+	-Iinc/dios_ssp_mvdr \
+	-Iinc/dios_ssp_share \
+	-Isrc \
+	-O2 \
+	-lpthread \
+	-lm \
+	-o bin/mvdr_compare
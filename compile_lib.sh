@@ -6,7 +6,6 @@ src/dios_ssp_aec/dios_ssp_aec_tde/*.c \
 	src/dios_ssp_aec/*.c \
 	src/dios_ssp_agc/dios_ssp_agc_api.c \
 	src/dios_ssp_doa/dios_ssp_doa_api.c \
-	src/dios_ssp_doa/dios_ssp_doa_win.c \
 	src/dios_ssp_gsc/*.c \
 	src/dios_ssp_hpf/dios_ssp_hpf_api.c \
 	src/dios_ssp_mvdr/*.c \
@@ -34,4 +33,5 @@ src/dios_ssp_aec/dios_ssp_aec_tde/*.c \
  	-shared \
 	-O3 \
 	-ltensorflow-lite \
+	-lpthread \
 	-o lib/libathena.so
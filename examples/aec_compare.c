@@ -0,0 +1,145 @@
+#include "dios_ssp_api.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "compare_common.h"
+
+// compare the subband and pbfdaf aec engines on synthetic rooms whose echo
+// decays by 60 db over 64, 128 and 256 ms: erle of the aec output (linear
+// filter plus residual echo suppression) over the second half of a far end
+// single talk recording, and processing time per frame. then the time per
+// frame of 2 to 8 mics processed on 1 to 8 threads, and whether the output
+// matches the single thread one bit for bit
+#define AEC_FRAME_LEN   128
+#define AEC_FRAME_NUM   2500
+#define AEC_RATE        16000
+#define AEC_MIC_MAX     8
+#define AEC_SCALE_FRAMES  1000
+
+// room impulse response: 2 ms of direct path delay, then noise decaying by 60 db over tail_ms
+static int room(float *h, int tail_ms)
+{
+    unsigned int seed = (unsigned int)tail_ms;
+    int delay = 2 * AEC_RATE / 1000;
+    int len = tail_ms * AEC_RATE / 1000;
+    memset(h, 0, sizeof(float) * len);
+    for (int i = delay; i < len; i++) {
+        h[i] = (float)(0.5 * noise(&seed) * exp(-6.9 * (i - delay) / (len - delay)));
+    }
+    return len;
+}
+
+// run one engine over one room, returns the erle in db of the second half
+static double run_aec(int engine, int tail_ms, const float *mic, const float *ref, double *cost_ms)
+{
+    void *haec = dios_ssp_aec_init_api(1, 1, AEC_FRAME_LEN);
+    if (0 != dios_ssp_aec_engine_config_api(haec, engine, tail_ms)) {
+        dios_ssp_aec_uninit_api(haec);
+        return 0.0;
+    }
+    dios_ssp_aec_reset_api(haec);
+
+    float io[AEC_FRAME_LEN];
+    float ref_frame[AEC_FRAME_LEN];
+    double in_power = 0.0, out_power = 0.0;
+    int dt_st = 0;
+    for (int i = 0; i < AEC_FRAME_NUM; i++) {
+        memcpy(io, mic + i * AEC_FRAME_LEN, sizeof(io));
+        memcpy(ref_frame, ref + i * AEC_FRAME_LEN, sizeof(ref_frame));
+        double start = now_ms();
+        dios_ssp_aec_process_api(haec, io, ref_frame, &dt_st);
+        *cost_ms += now_ms() - start;
+        if (i >= AEC_FRAME_NUM / 2) {
+            for (int k = 0; k < AEC_FRAME_LEN; k++) {
+                in_power += mic[i * AEC_FRAME_LEN + k] * mic[i * AEC_FRAME_LEN + k];
+                out_power += io[k] * io[k];
+            }
+        }
+    }
+    dios_ssp_aec_uninit_api(haec);
+    return 10.0 * log10(in_power / (out_power + 1e-9));
+}
+
+// run mic_num mics on thread_num threads, the output of every frame goes to out
+static double run_mics(int mic_num, int thread_num, const float *mic, const float *ref, float *out)
+{
+    void *haec = dios_ssp_aec_init_api(mic_num, 1, AEC_FRAME_LEN);
+    dios_ssp_aec_thread_config_api(haec, thread_num);
+
+    float ref_frame[AEC_FRAME_LEN];
+    int dt_st = 0;
+    double cost_ms = 0.0;
+    for (int i = 0; i < AEC_SCALE_FRAMES; i++) {
+        float *io = out + i * mic_num * AEC_FRAME_LEN;
+        // mic m hears the room m samples later
+        for (int m = 0; m < mic_num; m++) {
+            for (int k = 0; k < AEC_FRAME_LEN; k++) {
+                int t = i * AEC_FRAME_LEN + k - m;
+                io[m * AEC_FRAME_LEN + k] = t >= 0 ? mic[t] : 0.0f;
+            }
+        }
+        memcpy(ref_frame, ref + i * AEC_FRAME_LEN, sizeof(ref_frame));
+        double start = now_ms();
+        dios_ssp_aec_process_api(haec, io, ref_frame, &dt_st);
+        cost_ms += now_ms() - start;
+    }
+    dios_ssp_aec_uninit_api(haec);
+    return cost_ms / AEC_SCALE_FRAMES;
+}
+
+int main(void) {
+    const int rooms[] = { 64, 128, 256 };
+    const int tails[] = { 64, 128, 256 };
+    int len = AEC_FRAME_NUM * AEC_FRAME_LEN;
+    float *ref = (float *)calloc(len, sizeof(float));
+    float *mic = (float *)calloc(len, sizeof(float));
+    float *h = (float *)calloc(256 * AEC_RATE / 1000, sizeof(float));
+    talker(ref, len, AEC_RATE, 30, 0.3, 11);
+
+    printf("%-9s %-8s %-8s %10s %12s\n", "room(ms)", "engine", "tail(ms)", "erle(db)", "ms/frame");
+    for (int r = 0; r < (int)(sizeof(rooms) / sizeof(rooms[0])); r++) {
+        int h_len = room(h, rooms[r]);
+        unsigned int seed = 3;
+        for (int i = 0; i < len; i++) {
+            double v = 0.0;
+            for (int j = 0; j < h_len && j <= i; j++) {
+                v += h[j] * ref[i - j];
+            }
+            mic[i] = (float)(v + 5.0 * noise(&seed));
+        }
+
+        double cost_ms = 0.0;
+        double erle = run_aec(AEC_ENGINE_SUBBAND, 0, mic, ref, &cost_ms);
+        printf("%-9d %-8s %-8d %10.2f %12.4f\n", rooms[r], "subband", NTAPS_LOW_BAND * AEC_FRAME_LEN * 1000 / AEC_RATE,
+               erle, cost_ms / AEC_FRAME_NUM);
+        for (int t = 0; t < (int)(sizeof(tails) / sizeof(tails[0])); t++) {
+            cost_ms = 0.0;
+            erle = run_aec(AEC_ENGINE_PBFDAF, tails[t], mic, ref, &cost_ms);
+            printf("%-9d %-8s %-8d %10.2f %12.4f\n", rooms[r], "pbfdaf", tails[t], erle, cost_ms / AEC_FRAME_NUM);
+        }
+    }
+
+    // the last room is reused for the mic scaling
+    int out_len = AEC_SCALE_FRAMES * AEC_MIC_MAX * AEC_FRAME_LEN;
+    float *out_serial = (float *)calloc(out_len, sizeof(float));
+    float *out = (float *)calloc(out_len, sizeof(float));
+    const int threads[] = { 2, 4, 8 };
+    printf("\n%-6s %-8s %12s %10s %10s\n", "mics", "threads", "ms/frame", "speedup", "identical");
+    for (int mic_num = 2; mic_num <= AEC_MIC_MAX; mic_num += 2) {
+        double serial_ms = run_mics(mic_num, 1, mic, ref, out_serial);
+        printf("%-6d %-8d %12.4f %10s %10s\n", mic_num, 1, serial_ms, "-", "-");
+        for (int t = 0; t < (int)(sizeof(threads) / sizeof(threads[0])) && threads[t] <= mic_num; t++) {
+            double cost_ms = run_mics(mic_num, threads[t], mic, ref, out);
+            int same = 0 == memcmp(out, out_serial, sizeof(float) * AEC_SCALE_FRAMES * mic_num * AEC_FRAME_LEN);
+            printf("%-6d %-8d %12.4f %9.2fx %10s\n", mic_num, threads[t], cost_ms, serial_ms / cost_ms, same ? "yes" : "no");
+        }
+    }
+
+    free(out_serial);
+    free(out);
+    free(ref);
+    free(mic);
+    free(h);
+    return 0;
+}
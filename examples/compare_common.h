@@ -0,0 +1,60 @@
+#ifndef _COMPARE_COMMON_H_
+#define _COMPARE_COMMON_H_
+
+#include <time.h>
+#include <math.h>
+
+// helpers shared by the examples/*_compare.c tools: a monotonic clock, the
+// linear congruential generator behind their synthetic signals, so every tool
+// sees the same sequence for the same seed, and a synthetic talker
+
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// next 16-bit value of the generator, 0 .. 65535
+static inline unsigned int lcg_u16(unsigned int *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 8) & 0xffff;
+}
+
+// uniform noise in [-1, 1)
+static inline double noise(unsigned int *seed)
+{
+    return lcg_u16(seed) / 32768.0 - 1.0;
+}
+
+// sum of uniforms, roughly gaussian with unit variance
+static inline double noise_gauss(unsigned int *seed)
+{
+    double sum = 0.0;
+    for (int i = 0; i < 12; i++) {
+        sum += lcg_u16(seed) / 65536.0;
+    }
+    return sum - 6.0;
+}
+
+// voiced talker with a gliding pitch and syllable rate modulation, plus
+// noise: harmonics partials, partial h starting at phase h * harmonic_phase
+static inline void talker(float *out, int len, int rate, int harmonics, double harmonic_phase,
+                          unsigned int seed)
+{
+    double phase = 0.0;
+    for (int i = 0; i < len; i++) {
+        double t = (double)i / rate;
+        double f0 = 140.0 + 40.0 * sin(2.0 * M_PI * 0.3 * t);
+        double v = 0.0;
+        phase += 2.0 * M_PI * f0 / rate;
+        for (int h = 1; h <= harmonics; h++) {
+            v += sin(h * phase + harmonic_phase * h) / h;
+        }
+        double env = 0.5 + 0.5 * sin(2.0 * M_PI * 4.0 * t);
+        out[i] = (float)(4000.0 * env * v + 300.0 * noise(&seed));
+    }
+}
+
+#endif  /* _COMPARE_COMMON_H_ */
@@ -0,0 +1,111 @@
+#include "dios_ssp_api.h"
+#include "dios_ssp_share/dios_ssp_share_simd.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "compare_common.h"
+
+// compare the xcomplex vector kernels of dios_ssp_share_simd against the per
+// element loops of complex_defs they replace in the gsc and aec modules: the
+// largest difference of the outputs and the time per call for the bin counts
+// of the modules
+#define CPLX_LOOPS  200000
+
+static void fill(xcomplex *x, int len, unsigned int seed)
+{
+    for (int i = 0; i < len; i++) {
+        x[i].r = (float)noise(&seed);
+        x[i].i = (float)noise(&seed);
+    }
+}
+
+static float max_diff(const float *a, const float *b, int len)
+{
+    float d = 0.0f;
+    for (int i = 0; i < len; i++) {
+        d = xmax(d, xabs(a[i] - b[i]));
+    }
+    return d;
+}
+
+// one flms block as done by the adaptive filters: filter output, update, leakage
+static void block_loop(const xcomplex *x, const xcomplex *e, const xcomplex *mu, const xcomplex *nu,
+                       xcomplex *h, xcomplex *y, float *p, int len)
+{
+    for (int i = 0; i < len; i++) {
+        p[i] = complex_abs2(x[i]);
+        y[i] = complex_mul(h[i], x[i]);
+        h[i] = complex_add(h[i], complex_mul(complex_mul(complex_conjg(x[i]), e[i]), mu[i]));
+        h[i] = complex_sub(h[i], complex_mul(h[i], nu[i]));
+    }
+}
+
+static void block_simd(const xcomplex *x, const xcomplex *e, const xcomplex *mu, const xcomplex *nu,
+                       xcomplex *h, xcomplex *y, float *p, int len)
+{
+    dios_ssp_share_xcvec_abs2(x, 0, p, len);
+    dios_ssp_share_xcvec_mul(h, x, 0, y, len);
+    dios_ssp_share_xcvec_flms_update(x, e, mu, h, len);
+    dios_ssp_share_xcvec_mul_sub(nu, h, len);
+}
+
+int main(void) {
+    const int bins[] = { 65, 129, 257, 513 };
+    printf("simd level %d\n", dios_ssp_share_simd_level());
+    printf("%-6s %12s %12s %12s %8s\n", "bins", "max diff", "loop us", "simd us", "speedup");
+    for (int b = 0; b < (int)(sizeof(bins) / sizeof(bins[0])); b++) {
+        int len = bins[b];
+        xcomplex *x = (xcomplex *)calloc(len, sizeof(xcomplex));
+        xcomplex *e = (xcomplex *)calloc(len, sizeof(xcomplex));
+        xcomplex *mu = (xcomplex *)calloc(len, sizeof(xcomplex));
+        xcomplex *nu = (xcomplex *)calloc(len, sizeof(xcomplex));
+        xcomplex *h0 = (xcomplex *)calloc(len, sizeof(xcomplex));
+        xcomplex *h1 = (xcomplex *)calloc(len, sizeof(xcomplex));
+        xcomplex *y0 = (xcomplex *)calloc(len, sizeof(xcomplex));
+        xcomplex *y1 = (xcomplex *)calloc(len, sizeof(xcomplex));
+        float *p0 = (float *)calloc(len, sizeof(float));
+        float *p1 = (float *)calloc(len, sizeof(float));
+        fill(x, len, 1);
+        fill(e, len, 2);
+        fill(mu, len, 3);
+        fill(nu, len, 4);
+        fill(h0, len, 5);
+        for (int i = 0; i < len; i++) {
+            mu[i].r *= 0.01f;
+            mu[i].i = 0.0f;
+            nu[i].r *= 0.001f;
+            nu[i].i = 0.0f;
+        }
+        memcpy(h1, h0, len * sizeof(xcomplex));
+
+        double start = now_ms();
+        for (int n = 0; n < CPLX_LOOPS; n++) {
+            block_loop(x, e, mu, nu, h0, y0, p0, len);
+        }
+        double loop_ms = now_ms() - start;
+        start = now_ms();
+        for (int n = 0; n < CPLX_LOOPS; n++) {
+            block_simd(x, e, mu, nu, h1, y1, p1, len);
+        }
+        double simd_ms = now_ms() - start;
+
+        float diff = max_diff((const float *)h0, (const float *)h1, 2 * len);
+        diff = xmax(diff, max_diff((const float *)y0, (const float *)y1, 2 * len));
+        diff = xmax(diff, max_diff(p0, p1, len));
+        printf("%-6d %12g %12.4f %12.4f %7.2fx\n", len, diff, loop_ms * 1000.0 / CPLX_LOOPS,
+               simd_ms * 1000.0 / CPLX_LOOPS, loop_ms / simd_ms);
+
+        free(x);
+        free(e);
+        free(mu);
+        free(nu);
+        free(h0);
+        free(h1);
+        free(y0);
+        free(y1);
+        free(p0);
+        free(p1);
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "dios_ssp_api.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "compare_common.h"
+
+// compare the capon and srp-phat doa engines on synthetic plane waves:
+// angle error and processing time per frame for several arrays and snrs,
+// the error includes up to 2.5 degrees from the DEFAULT_DOA_DELTA_ANGLE grid
+#define DOA_FRAME_LEN   128
+#define DOA_FRAME_NUM   250
+#define DOA_SAMPLE_RATE 16000
+
+// voiced source with a 150 hz pitch and a slow amplitude modulation, delayed by tau
+static double source(double t)
+{
+    double v = 0.0;
+    for (int h = 1; h <= 40; h++) {
+        v += sin(2.0 * M_PI * 150.0 * h * t + 0.7 * h) / sqrt((double)h);
+    }
+    return v * (1.0 + 0.5 * sin(2.0 * M_PI * 3.0 * t));
+}
+
+// unvoiced interferer, random sinusoids between 300 and 4000 hz
+static double interferer(double t)
+{
+    double v = 0.0;
+    unsigned int seed = 7;
+    for (int h = 0; h < 30; h++) {
+        double frq = 300.0 + 3700.0 * lcg_u16(&seed) / 65536.0;
+        v += sin(2.0 * M_PI * frq * t + h);
+    }
+    return v / sqrt(15.0);
+}
+
+// source at angle, an interferer 6 db weaker 140 degrees away and white noise at snr_db
+static void synth(const PlaneCoord *mic, int mic_num, float angle, float snr_db, float *pcm)
+{
+    double th = angle * M_PI / 180.0;
+    double th_int = (angle + 140.0) * M_PI / 180.0;
+    double sig_power = 0.0;
+    int len = DOA_FRAME_NUM * DOA_FRAME_LEN;
+    for (int m = 0; m < mic_num; m++) {
+        double tau = (mic[m].x * cos(th) + mic[m].y * sin(th)) / 340.0;
+        double tau_int = (mic[m].x * cos(th_int) + mic[m].y * sin(th_int)) / 340.0;
+        for (int i = 0; i < len; i++) {
+            double s = 1000.0 * source((double)i / DOA_SAMPLE_RATE + tau);
+            sig_power += s * s;
+            pcm[m * len + i] = (float)(s + 500.0 * interferer((double)i / DOA_SAMPLE_RATE + tau_int));
+        }
+    }
+    double gain = sqrt(sig_power / (mic_num * len) / pow(10.0, snr_db / 10.0));
+    unsigned int seed = (unsigned int)(angle * 7 + snr_db * 13 + mic_num);
+    for (int i = 0; i < mic_num * len; i++) {
+        pcm[i] += (float)(gain * noise_gauss(&seed));
+    }
+}
+
+static float angle_error(float a, float b)
+{
+    float d = fabsf(a - b);
+    while (d >= 360.0f) {
+        d -= 360.0f;
+    }
+    return d > 180.0f ? 360.0f - d : d;
+}
+
+// run one engine over one recording, returns the mean error of the second half
+static float run_doa(int engine, PlaneCoord *mic, int mic_num, const float *pcm, float angle,
+                     float *hit, double *cost_ms)
+{
+    void *hdoa = dios_ssp_doa_init_api(mic_num, mic);
+    dios_ssp_doa_engine_config_api(hdoa, engine);
+    dios_ssp_doa_reset_api(hdoa);
+
+    float *in = (float *)calloc(mic_num * DOA_FRAME_LEN, sizeof(float));
+    float err = 0.0f;
+    int count = 0;
+    *hit = 0.0f;
+    for (int i = 0; i < DOA_FRAME_NUM; i++) {
+        for (int m = 0; m < mic_num; m++) {
+            memcpy(in + m * DOA_FRAME_LEN, pcm + m * DOA_FRAME_NUM * DOA_FRAME_LEN + i * DOA_FRAME_LEN, sizeof(float) * DOA_FRAME_LEN);
+        }
+        double start = now_ms();
+        float est = dios_ssp_doa_process_api(hdoa, in, 1, 0);
+        *cost_ms += now_ms() - start;
+        if (i >= DOA_FRAME_NUM / 2) {
+            float e = angle_error(est, angle);
+            err += e;
+            *hit += e <= 10.0f ? 1.0f : 0.0f;
+            count++;
+        }
+    }
+    *hit /= count;
+
+    free(in);
+    dios_ssp_doa_uninit_api(hdoa);
+    return err / count;
+}
+
+int main(void) {
+    const int mic_nums[] = { 4, 6, 8 };
+    const float snrs[] = { 20.0f, 10.0f, 0.0f };
+    const char *names[] = { "capon", "srp-phat" };
+
+    printf("%-4s %-6s %-9s %10s %10s %12s\n", "mics", "snr", "engine", "err(deg)", "hit<=10", "ms/frame");
+    for (int a = 0; a < (int)(sizeof(mic_nums) / sizeof(mic_nums[0])); a++) {
+        int mic_num = mic_nums[a];
+        PlaneCoord mic[8];
+        for (int m = 0; m < mic_num; m++) {
+            mic[m].x = 0.035f * cosf(2.0f * (float)M_PI * m / mic_num);
+            mic[m].y = 0.035f * sinf(2.0f * (float)M_PI * m / mic_num);
+            mic[m].z = 0.0f;
+        }
+        float *pcm = (float *)calloc(mic_num * DOA_FRAME_NUM * DOA_FRAME_LEN, sizeof(float));
+
+        for (int s = 0; s < (int)(sizeof(snrs) / sizeof(snrs[0])); s++) {
+            for (int engine = DOA_ENGINE_CAPON; engine <= DOA_ENGINE_SRP_PHAT; engine++) {
+                float err = 0.0f;
+                float hit = 0.0f;
+                double cost_ms = 0.0;
+                int runs = 0;
+                for (float angle = 7.0f; angle < 360.0f; angle += 23.0f) {
+                    float h = 0.0f;
+                    synth(mic, mic_num, angle, snrs[s], pcm);
+                    err += run_doa(engine, mic, mic_num, pcm, angle, &h, &cost_ms);
+                    hit += h;
+                    runs++;
+                }
+                printf("%-4d %-6.0f %-9s %10.2f %9.1f%% %12.4f\n", mic_num, snrs[s], names[engine],
+                       err / runs, 100.0f * hit / runs, cost_ms / (runs * DOA_FRAME_NUM));
+            }
+        }
+        free(pcm);
+    }
+
+    return 0;
+}
@@ -0,0 +1,532 @@
+#include "dios_ssp_dtln/dios_ssp_dtln_api.h"
+#include "dios_ssp_dtln/dios_ssp_dtln_batch.h"
+#include "tflite/c_api.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include "compare_common.h"
+
+// check the batched dtln engine against single-stream instances and against
+// failed invokes, and the pipelined mode against the sequential one. It is linked against the dtln sources and the stub tflite c
+// api below instead of libathena, so it runs without tflite and without real
+// models. Exits with 1 when a check fails
+#define STUB_STREAMS    4
+#define STUB_FRAME_LEN  128
+#define STUB_FRAMES     24
+#define STUB_STATE_LEN  DTLN_FRAME_SIZE
+#define PIPE_FRAMES     48
+
+// stub c api. model_1 returns a mask and model_2 scales its frame, both by a
+// gain taken from the first lstm state, and every output state is the input
+// state plus one, so any state that is scattered or kept wrongly changes the
+// output and shows up in the state fed to the next invoke
+struct TfLiteModel {
+    int index;
+};
+
+struct TfLiteInterpreterOptions {
+    int num_threads;
+};
+
+struct TfLiteTensor {
+    TfLiteType type;
+    int num_dims;
+    int dims[4];
+    float *data;
+};
+
+struct TfLiteInterpreter {
+    int index;
+    TfLiteTensor in[2];
+    TfLiteTensor out[2];
+};
+
+static int g_allocs;
+static int g_alloc_fail;
+// the pipelined mode invokes model_2 on its worker thread
+static pthread_mutex_t g_stub_lock = PTHREAD_MUTEX_INITIALIZER;
+static int g_invokes[DTLN_MODEL_NUM];
+static int g_fail_at[DTLN_MODEL_NUM] = { -1, -1 };
+static float g_state_seen[DTLN_MODEL_NUM][STUB_STREAMS][STUB_STATE_LEN];
+
+TfLiteModel* TfLiteModelCreate(const void *model_data, size_t model_size)
+{
+    if (model_size < 1 || ('1' != *(const char *)model_data && '2' != *(const char *)model_data)) {
+        return NULL;
+    }
+    TfLiteModel *model = (TfLiteModel *)calloc(1, sizeof(TfLiteModel));
+    model->index = *(const char *)model_data - '1';
+    return model;
+}
+
+void TfLiteModelDelete(TfLiteModel *model)
+{
+    free(model);
+}
+
+TfLiteInterpreterOptions* TfLiteInterpreterOptionsCreate(void)
+{
+    return (TfLiteInterpreterOptions *)calloc(1, sizeof(TfLiteInterpreterOptions));
+}
+
+void TfLiteInterpreterOptionsDelete(TfLiteInterpreterOptions *options)
+{
+    free(options);
+}
+
+void TfLiteInterpreterOptionsSetNumThreads(TfLiteInterpreterOptions *options, int32_t num_threads)
+{
+    options->num_threads = num_threads;
+}
+
+void TfLiteInterpreterOptionsAddDelegate(TfLiteInterpreterOptions *options, TfLiteDelegate *delegate)
+{
+    (void)options;
+    (void)delegate;
+}
+
+static void stub_set_dims(TfLiteTensor *t, int d0, int d1, int d2, int d3, int num_dims)
+{
+    t->type = kTfLiteFloat32;
+    t->num_dims = num_dims;
+    t->dims[0] = d0;
+    t->dims[1] = d1;
+    t->dims[2] = d2;
+    t->dims[3] = d3;
+}
+
+static int stub_count(const TfLiteTensor *t)
+{
+    int n = 1;
+    for (int i = 0; i < t->num_dims; i++) {
+        n *= t->dims[i];
+    }
+    return n;
+}
+
+TfLiteInterpreter* TfLiteInterpreterCreate(const TfLiteModel *model, const TfLiteInterpreterOptions *options)
+{
+    (void)options;
+    TfLiteInterpreter *interpreter = (TfLiteInterpreter *)calloc(1, sizeof(TfLiteInterpreter));
+    interpreter->index = model->index;
+    // [1,1,257] or [1,1,512] frames and [1,2,128,2] lstm states, as in the dtln models
+    stub_set_dims(&interpreter->in[0], 1, 1, 0 == model->index ? DTLN_FFTOUT_SIZE : DTLN_FRAME_SIZE, 0, 3);
+    stub_set_dims(&interpreter->in[1], 1, 2, STUB_STATE_LEN / 4, 2, 4);
+    return interpreter;
+}
+
+void TfLiteInterpreterDelete(TfLiteInterpreter *interpreter)
+{
+    for (int i = 0; i < 2; i++) {
+        free(interpreter->in[i].data);
+        free(interpreter->out[i].data);
+    }
+    free(interpreter);
+}
+
+TfLiteTensor* TfLiteInterpreterGetInputTensor(const TfLiteInterpreter *interpreter, int32_t input_index)
+{
+    return (TfLiteTensor *)&interpreter->in[input_index];
+}
+
+const TfLiteTensor* TfLiteInterpreterGetOutputTensor(const TfLiteInterpreter *interpreter, int32_t output_index)
+{
+    return &interpreter->out[output_index];
+}
+
+TfLiteStatus TfLiteInterpreterResizeInputTensor(TfLiteInterpreter *interpreter, int32_t input_index,
+                                                const int *input_dims, int32_t input_dims_size)
+{
+    TfLiteTensor *t = &interpreter->in[input_index];
+    if (input_dims_size != t->num_dims) {
+        return kTfLiteError;
+    }
+    memcpy(t->dims, input_dims, input_dims_size * sizeof(int));
+    free(t->data);
+    t->data = NULL;
+    return kTfLiteOk;
+}
+
+TfLiteStatus TfLiteInterpreterAllocateTensors(TfLiteInterpreter *interpreter)
+{
+    g_allocs++;
+    if (g_alloc_fail) {
+        return kTfLiteError;
+    }
+    for (int i = 0; i < 2; i++) {
+        free(interpreter->in[i].data);
+        free(interpreter->out[i].data);
+        interpreter->out[i] = interpreter->in[i];
+        // arenas are not cleared by tflite either
+        interpreter->in[i].data = (float *)malloc(stub_count(&interpreter->in[i]) * sizeof(float));
+        interpreter->out[i].data = (float *)malloc(stub_count(&interpreter->out[i]) * sizeof(float));
+        for (int j = 0; j < stub_count(&interpreter->in[i]); j++) {
+            interpreter->in[i].data[j] = NAN;
+            interpreter->out[i].data[j] = NAN;
+        }
+    }
+    return kTfLiteOk;
+}
+
+TfLiteStatus TfLiteInterpreterInvoke(TfLiteInterpreter *interpreter)
+{
+    int m = interpreter->index;
+    int rows = interpreter->in[0].dims[0];
+    int len = stub_count(&interpreter->in[0]) / rows;
+
+    pthread_mutex_lock(&g_stub_lock);
+    for (int r = 0; r < rows; r++) {
+        const float *state_in = interpreter->in[1].data + r * STUB_STATE_LEN;
+        if (r < STUB_STREAMS) {
+            memcpy(g_state_seen[m][r], state_in, sizeof(g_state_seen[m][r]));
+        }
+    }
+    int failed = g_invokes[m]++ == g_fail_at[m];
+    pthread_mutex_unlock(&g_stub_lock);
+    if (failed) {
+        return kTfLiteError;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        const float *state_in = interpreter->in[1].data + r * STUB_STATE_LEN;
+        const float *x = interpreter->in[0].data + r * len;
+        float *state_out = interpreter->out[1].data + r * STUB_STATE_LEN;
+        float *y = interpreter->out[0].data + r * len;
+        float gain = 1.0f / (1.0f + 0.01f * fabsf(state_in[0]));
+        for (int j = 0; j < len; j++) {
+            y[j] = 0 == m ? gain : x[j] * gain;
+        }
+        for (int j = 0; j < STUB_STATE_LEN; j++) {
+            state_out[j] = state_in[j] + 1.0f;
+        }
+    }
+    return kTfLiteOk;
+}
+
+TfLiteType TfLiteTensorType(const TfLiteTensor *tensor)
+{
+    return tensor->type;
+}
+
+int32_t TfLiteTensorNumDims(const TfLiteTensor *tensor)
+{
+    return tensor->num_dims;
+}
+
+int32_t TfLiteTensorDim(const TfLiteTensor *tensor, int32_t dim_index)
+{
+    return tensor->dims[dim_index];
+}
+
+size_t TfLiteTensorByteSize(const TfLiteTensor *tensor)
+{
+    return stub_count(tensor) * sizeof(float);
+}
+
+void* TfLiteTensorData(const TfLiteTensor *tensor)
+{
+    return tensor->data;
+}
+
+TfLiteQuantizationParams TfLiteTensorQuantizationParams(const TfLiteTensor *tensor)
+{
+    (void)tensor;
+    TfLiteQuantizationParams quant = { 0.0f, 0 };
+    return quant;
+}
+
+TfLiteStatus TfLiteTensorCopyFromBuffer(TfLiteTensor *tensor, const void *input_data, size_t input_data_size)
+{
+    memcpy(tensor->data, input_data, input_data_size);
+    return kTfLiteOk;
+}
+
+TfLiteStatus TfLiteTensorCopyToBuffer(const TfLiteTensor *tensor, void *output_data, size_t output_data_size)
+{
+    memcpy(output_data, tensor->data, output_data_size);
+    return kTfLiteOk;
+}
+
+static int write_stub_model(const char *path, char index)
+{
+    FILE *fp = fopen(path, "wb");
+    if (NULL == fp) {
+        return -1;
+    }
+    fputc(index, fp);
+    fclose(fp);
+    return 0;
+}
+
+static void fill_frames(float *frame[], unsigned int *seed)
+{
+    for (int s = 0; s < STUB_STREAMS; s++) {
+        for (int j = 0; j < STUB_FRAME_LEN; j++) {
+            frame[s][j] = (float)(8000.0 * noise(seed));
+        }
+    }
+}
+
+// fail the next invoke of one model and check that the lstm states of the
+// models invoked in that round are fed unchanged to the round after it
+static int check_failure(void *batch, int model, unsigned int *seed, float *frame[])
+{
+    float seen[DTLN_MODEL_NUM][STUB_STREAMS][STUB_STATE_LEN];
+    int fail = 0;
+
+    g_fail_at[model] = g_invokes[model];
+    fill_frames(frame, seed);
+    int ret_fail = dios_ssp_dtln_batch_process(batch, frame, STUB_STREAMS);
+    g_fail_at[model] = -1;
+    memcpy(seen, g_state_seen, sizeof(seen));
+
+    fill_frames(frame, seed);
+    int ret_next = dios_ssp_dtln_batch_process(batch, frame, STUB_STREAMS);
+    // model_2 is not invoked in a round whose model_1 failed
+    for (int m = 0; m <= model; m++) {
+        if (0 != memcmp(seen[m], g_state_seen[m], sizeof(seen[m]))) {
+            printf("model_%d failed: states of model_%d changed by the failed round\n", model + 1, m + 1);
+            fail = 1;
+        }
+    }
+    if (-1 != ret_fail || 0 != ret_next) {
+        printf("model_%d failed: returned %d then %d, expected -1 then 0\n", model + 1, ret_fail, ret_next);
+        fail = 1;
+    }
+    for (int s = 0; s < STUB_STREAMS; s++) {
+        for (int j = 0; j < STUB_FRAME_LEN; j++) {
+            if (!isfinite(frame[s][j])) {
+                printf("model_%d failed: output of stream %d not finite\n", model + 1, s);
+                fail = 1;
+                break;
+            }
+        }
+    }
+    printf("%-24s %s\n", 0 == model ? "model_1 invoke failure" : "model_2 invoke failure", fail ? "FAIL" : "ok");
+    return fail;
+}
+
+// let a fresh engine fail to grow its batch for a while and check that the
+// hops of those rounds are still consumed: the calls return -1, but no input
+// frame is dropped or left behind, so once the batch can grow every call runs
+// exactly one round, as frame_len is one hop
+static int check_grow_failure(const char *modelpath[], unsigned int *seed, float *frame[])
+{
+    void *batch = dios_ssp_dtln_batch_init_api(modelpath, STUB_FRAME_LEN, STUB_STREAMS);
+    int failed = 0;
+    int fail = 0;
+
+    g_alloc_fail = 1;
+    for (int n = 0; n < 2 * DTLN_FRAME_SIZE / STUB_FRAME_LEN; n++) {
+        fill_frames(frame, seed);
+        failed += 0 != dios_ssp_dtln_batch_process(batch, frame, STUB_STREAMS);
+    }
+    g_alloc_fail = 0;
+    if (0 == failed) {
+        printf("batch growth failure: never returned -1\n");
+        fail = 1;
+    }
+    for (int n = 0; n < 2 * DTLN_FRAME_SIZE / STUB_FRAME_LEN; n++) {
+        fill_frames(frame, seed);
+        int invokes = g_invokes[0];
+        if (0 != dios_ssp_dtln_batch_process(batch, frame, STUB_STREAMS)) {
+            printf("batch growth failure: frame %d after the failures returned -1\n", n);
+            fail = 1;
+        }
+        if (1 != g_invokes[0] - invokes) {
+            printf("batch growth failure: frame %d after the failures ran %d rounds\n", n, g_invokes[0] - invokes);
+            fail = 1;
+        }
+        for (int s = 0; s < STUB_STREAMS; s++) {
+            for (int j = 0; j < STUB_FRAME_LEN; j++) {
+                if (!isfinite(frame[s][j])) {
+                    printf("batch growth failure: output of stream %d not finite\n", s);
+                    fail = 1;
+                    break;
+                }
+            }
+        }
+    }
+    dios_ssp_dtln_batch_uninit_api(batch);
+    printf("%-24s %s\n", "batch growth failure", fail ? "FAIL" : "ok");
+    return fail;
+}
+
+// run frames [from, to) of x through one single-stream instance
+static int run_stream(void *hdtln, const float *x, float *y, int from, int to)
+{
+    int failed = 0;
+    for (int n = from; n < to; n++) {
+        memcpy(y + n * STUB_FRAME_LEN, x + n * STUB_FRAME_LEN, STUB_FRAME_LEN * sizeof(float));
+        failed += 0 != dios_ssp_dtln_process(hdtln, y + n * STUB_FRAME_LEN);
+    }
+    return failed;
+}
+
+// largest difference of y[t + delay] against ref[t] over len samples
+static double delayed_diff(const float *y, const float *ref, int delay, int len)
+{
+    double diff = 0.0;
+    for (int t = 0; t + delay < len; t++) {
+        diff = fmax(diff, fabs((double)y[t + delay] - ref[t]));
+    }
+    return diff;
+}
+
+// the pipelined mode has to give the sequential output delayed by the one hop
+// it reports in dios_ssp_dtln_latency_get, also when it is switched on and off
+// mid-stream (each switch resets the stream), and has to report a failed
+// model_2 invoke of its worker in one of the following calls
+static int check_pipeline(const char *modelpath[], unsigned int *seed)
+{
+    int len = PIPE_FRAMES * STUB_FRAME_LEN;
+    int on = PIPE_FRAMES / 4;
+    int off = PIPE_FRAMES / 2;
+    float *x = (float *)calloc(len, sizeof(float));
+    float *y_seq = (float *)calloc(len, sizeof(float));
+    float *y_pipe = (float *)calloc(len, sizeof(float));
+    float *y_ref = (float *)calloc(len, sizeof(float));
+    void *h_seq = dios_ssp_dtln_init_api(modelpath, STUB_FRAME_LEN, 1, DTLN_DELEGATE_NONE);
+    void *h_pipe = dios_ssp_dtln_init_api(modelpath, STUB_FRAME_LEN, 1, DTLN_DELEGATE_NONE);
+    int fail = 0;
+
+    for (int t = 0; t < len; t++) {
+        x[t] = (float)(8000.0 * noise(seed));
+    }
+
+    // whole stream
+    dios_ssp_dtln_reset_api(h_seq);
+    dios_ssp_dtln_config_api(h_pipe, 1);
+    int delay = dios_ssp_dtln_latency_get(h_pipe) - dios_ssp_dtln_latency_get(h_seq);
+    run_stream(h_seq, x, y_seq, 0, PIPE_FRAMES);
+    run_stream(h_pipe, x, y_pipe, 0, PIPE_FRAMES);
+    double diff = delayed_diff(y_pipe, y_seq, DTLN_FRAME_SHIFT, len);
+    int bad = DTLN_FRAME_SHIFT != delay || diff > 0.0;
+    printf("%-24s %s (delay %d, max diff %g)\n", "pipelined vs sequential", bad ? "FAIL" : "ok", delay, diff);
+    fail |= bad;
+
+    // switched on at frame on and off at frame off, against a sequential
+    // stream reset at the same frame
+    dios_ssp_dtln_config_api(h_pipe, 0);
+    run_stream(h_pipe, x, y_pipe, 0, on);
+    dios_ssp_dtln_config_api(h_pipe, 1);
+    run_stream(h_pipe, x, y_pipe, on, off);
+    dios_ssp_dtln_config_api(h_pipe, 0);
+    run_stream(h_pipe, x, y_pipe, off, PIPE_FRAMES);
+    dios_ssp_dtln_reset_api(h_seq);
+    run_stream(h_seq, x, y_ref, on, off);
+    diff = delayed_diff(y_pipe + on * STUB_FRAME_LEN, y_ref + on * STUB_FRAME_LEN,
+                        DTLN_FRAME_SHIFT, (off - on) * STUB_FRAME_LEN);
+    dios_ssp_dtln_reset_api(h_seq);
+    run_stream(h_seq, x, y_ref, off, PIPE_FRAMES);
+    diff = fmax(diff, delayed_diff(y_pipe + off * STUB_FRAME_LEN, y_ref + off * STUB_FRAME_LEN,
+                                   0, (PIPE_FRAMES - off) * STUB_FRAME_LEN));
+    printf("%-24s %s (max diff %g)\n", "pipeline switched on/off", diff > 0.0 ? "FAIL" : "ok", diff);
+    fail |= diff > 0.0;
+
+    // a failed model_2 invoke on the worker, then a working stream again
+    dios_ssp_dtln_config_api(h_pipe, 1);
+    run_stream(h_pipe, x, y_pipe, 0, on);
+    pthread_mutex_lock(&g_stub_lock);
+    g_fail_at[1] = g_invokes[1];
+    pthread_mutex_unlock(&g_stub_lock);
+    int failed = run_stream(h_pipe, x, y_pipe, on, on + 3);
+    pthread_mutex_lock(&g_stub_lock);
+    g_fail_at[1] = -1;
+    pthread_mutex_unlock(&g_stub_lock);
+    int failed_after = run_stream(h_pipe, x, y_pipe, on + 3, PIPE_FRAMES);
+    bad = 1 != failed || 0 != failed_after;
+    for (int t = 0; t < len; t++) {
+        bad |= !isfinite(y_pipe[t]);
+    }
+    printf("%-24s %s (%d then %d failed calls)\n", "pipeline model_2 failure", bad ? "FAIL" : "ok",
+           failed, failed_after);
+    fail |= bad;
+
+    dios_ssp_dtln_uninit_api(h_seq);
+    dios_ssp_dtln_uninit_api(h_pipe);
+    free(x);
+    free(y_seq);
+    free(y_pipe);
+    free(y_ref);
+    return fail;
+}
+
+int main(void) {
+    const char *modelpath[DTLN_MODEL_NUM] = { "dtln_stub_model_1.tflite", "dtln_stub_model_2.tflite" };
+    if (0 != write_stub_model(modelpath[0], '1') || 0 != write_stub_model(modelpath[1], '2')) {
+        fprintf(stderr, "write stub models failed\n");
+        return -1;
+    }
+
+    void *batch = dios_ssp_dtln_batch_init_api(modelpath, STUB_FRAME_LEN, STUB_STREAMS);
+    void *single[STUB_STREAMS];
+    float *frame[STUB_STREAMS];
+    float *ref[STUB_STREAMS];
+    unsigned int seed = 1;
+    int fail = 0;
+
+    if (NULL == batch) {
+        fprintf(stderr, "init batch engine failed\n");
+        return -1;
+    }
+    for (int s = 0; s < STUB_STREAMS; s++) {
+        single[s] = dios_ssp_dtln_init_api(modelpath, STUB_FRAME_LEN, 1, DTLN_DELEGATE_NONE);
+        if (NULL == single[s]) {
+            fprintf(stderr, "init stream %d failed\n", s);
+            return -1;
+        }
+        dios_ssp_dtln_reset_api(single[s]);
+        frame[s] = (float *)calloc(STUB_FRAME_LEN, sizeof(float));
+        ref[s] = (float *)calloc(STUB_FRAME_LEN, sizeof(float));
+    }
+
+    // without failures every stream of the batch matches its own instance.
+    // stream s joins at frame 2*s and skips every fifth frame after that, so
+    // the batch grows and some rounds leave rows idle
+    double max_diff = 0.0;
+    float *in_data[STUB_STREAMS];
+    int allocs = g_allocs;
+    for (int n = 0; n < STUB_FRAMES; n++) {
+        fill_frames(frame, &seed);
+        for (int s = 0; s < STUB_STREAMS; s++) {
+            in_data[s] = (n >= 2 * s && (n + s) % 5 != 0) ? frame[s] : NULL;
+            if (NULL != in_data[s]) {
+                memcpy(ref[s], frame[s], STUB_FRAME_LEN * sizeof(float));
+                dios_ssp_dtln_process(single[s], ref[s]);
+            }
+        }
+        dios_ssp_dtln_batch_process(batch, in_data, STUB_STREAMS);
+        for (int s = 0; s < STUB_STREAMS; s++) {
+            for (int j = 0; NULL != in_data[s] && j < STUB_FRAME_LEN; j++) {
+                max_diff = fmax(max_diff, fabs((double)frame[s][j] - ref[s][j]));
+            }
+        }
+    }
+    printf("%-24s %s (max diff %g)\n", "batch vs single stream", max_diff > 0.0 ? "FAIL" : "ok", max_diff);
+    fail |= max_diff > 0.0;
+
+    // growing 1 -> 2 -> 4 rows reallocates both interpreters twice
+    allocs = g_allocs - allocs;
+    printf("%-24s %s (%d)\n", "batch reallocations", allocs > 2 * DTLN_MODEL_NUM ? "FAIL" : "ok", allocs);
+    fail |= allocs > 2 * DTLN_MODEL_NUM;
+
+    fail |= check_failure(batch, 0, &seed, frame);
+    fail |= check_failure(batch, 1, &seed, frame);
+    fail |= check_grow_failure(modelpath, &seed, frame);
+    fail |= check_pipeline(modelpath, &seed);
+    printf("%s\n", fail ? "FAIL" : "PASS");
+
+    dios_ssp_dtln_batch_uninit_api(batch);
+    for (int s = 0; s < STUB_STREAMS; s++) {
+        dios_ssp_dtln_uninit_api(single[s]);
+        free(frame[s]);
+        free(ref[s]);
+    }
+    remove(modelpath[0]);
+    remove(modelpath[1]);
+
+    return fail;
+}
@@ -0,0 +1,95 @@
+#include "dios_ssp_api.h"
+#include "sndfile.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "compare_common.h"
+
+// compare a quantized (int8/float16) dtln model pair against the float32
+// reference on one file: processing time per frame and snr of the output.
+// the test pair runs with the given interpreter threads and delegate, so
+// passing the reference pair twice measures a threading/delegate setting
+// against one thread on the builtin kernels
+static float *run_dtln(const char *modelpath[], const short *pcm, int frames, int framelen,
+                       int num_threads, int delegate, double *cost_ms)
+{
+    void *hdtln = dios_ssp_dtln_init_api(modelpath, framelen, num_threads, delegate);
+    if (NULL == hdtln) {
+        fprintf(stderr, "load %s / %s failed\n", modelpath[0], modelpath[1]);
+        return NULL;
+    }
+    dios_ssp_dtln_reset_api(hdtln);
+
+    float *out = (float *)calloc(frames * framelen, sizeof(float));
+    double start = now_ms();
+    for (int i = 0; i < frames; i++) {
+        float *buf = out + i * framelen;
+        for (int j = 0; j < framelen; j++) {
+            buf[j] = pcm[i * framelen + j];
+        }
+        dios_ssp_dtln_process(hdtln, buf);
+    }
+    *cost_ms = now_ms() - start;
+
+    dios_ssp_dtln_uninit_api(hdtln);
+    return out;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 6 || argc > 8) {
+        printf("usage: dtln_compare in.wav ref_model_1 ref_model_2 test_model_1 test_model_2 "
+               "[test_threads [test_delegate]]\n");
+        printf("       test_delegate: %d none, %d xnnpack\n", DTLN_DELEGATE_NONE, DTLN_DELEGATE_XNNPACK);
+        return 0;
+    }
+    int test_threads = argc > 6 ? atoi(argv[6]) : 1;
+    int test_delegate = argc > 7 ? atoi(argv[7]) : DTLN_DELEGATE_NONE;
+
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    SNDFILE *inwav = sf_open(argv[1], SFM_READ, &info);
+    if (NULL == inwav) {
+        fprintf(stderr, "open %s failed\n", argv[1]);
+        return -1;
+    }
+
+    int framelen = 128;
+    int frames = (int)(info.frames / framelen);
+    short *pcm = (short *)calloc(frames * framelen, sizeof(short));
+    frames = (int)(sf_readf_short(inwav, pcm, frames * framelen) / framelen);
+    sf_close(inwav);
+
+    const char *ref_path[DTLN_MODEL_NUM] = { argv[2], argv[3] };
+    const char *test_path[DTLN_MODEL_NUM] = { argv[4], argv[5] };
+    double ref_ms = 0.0;
+    double test_ms = 0.0;
+    float *ref = run_dtln(ref_path, pcm, frames, framelen, 1, DTLN_DELEGATE_NONE, &ref_ms);
+    float *test = run_dtln(test_path, pcm, frames, framelen, test_threads, test_delegate, &test_ms);
+    if (NULL == ref || NULL == test) {
+        free(ref);
+        free(test);
+        free(pcm);
+        return -2;
+    }
+
+    double sig = 0.0;
+    double err = 0.0;
+    for (int i = 0; i < frames * framelen; i++) {
+        sig += (double)ref[i] * ref[i];
+        err += (double)(ref[i] - test[i]) * (ref[i] - test[i]);
+    }
+
+    double audio_ms = 1000.0 * frames * framelen / info.samplerate;
+    printf("frames: %d (%.1f s)\n", frames, audio_ms / 1000.0);
+    printf("ref : %8.2f ms, %.4f ms/frame, rtf %.4f\n", ref_ms, ref_ms / frames, ref_ms / audio_ms);
+    printf("test: %d thread(s), delegate %d\n", test_threads, test_delegate);
+    printf("test: %8.2f ms, %.4f ms/frame, rtf %.4f\n", test_ms, test_ms / frames, test_ms / audio_ms);
+    printf("snr of test against ref: %.2f dB\n", err > 0.0 ? 10.0 * log10(sig / err) : INFINITY);
+
+    free(ref);
+    free(test);
+    free(pcm);
+
+    return 0;
+}
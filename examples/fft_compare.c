@@ -0,0 +1,256 @@
+#include "dios_ssp_api.h"
+#include "dios_ssp_share/dios_ssp_share_rfft.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "compare_common.h"
+
+// compare dios_ssp_share_rfft against the former radix-2 transform for the
+// fft sizes of the modules: error of both against a double precision dft and
+// time per forward + inverse transform; then the batched transform of several
+// channels against one rfft + unpack per channel
+#define FFT_LOOPS   20000
+#define BATCH_MAX   8
+
+// the former transform: radix-2, bit reversal and twiddle index computed per call
+typedef struct {
+    int fft_len;
+    int mq_max;
+    float *wr;
+    float *wi;
+} LegacyFft;
+
+static void legacy_init(LegacyFft *fft, int fft_len)
+{
+    int i, j;
+    fft->fft_len = fft_len;
+    fft->mq_max = 0;
+    for (i = 1; (j = i << 1) <= fft_len; i = j) {
+        fft->mq_max = i >> 1;
+    }
+    fft->wr = (float *)calloc(fft->mq_max, sizeof(float));
+    fft->wi = (float *)calloc(fft->mq_max, sizeof(float));
+    for (i = 1; i < fft->mq_max; i++) {
+        fft->wr[i - 1] = (float)cos(-2.0 * M_PI / fft_len * i);
+        fft->wi[i - 1] = (float)sin(-2.0 * M_PI / fft_len * i);
+    }
+}
+
+static void legacy_bitrev(float *a, int n)
+{
+    int i = 0, j, k;
+    for (j = 1; j < n - 1; j++) {
+        for (k = n >> 1; k > (i ^= k); k >>= 1) {
+        }
+        if (j < i) {
+            float t = a[j];
+            a[j] = a[i];
+            a[i] = t;
+        }
+    }
+}
+
+static void legacy_rfft(const LegacyFft *fft, const float *in, float *a)
+{
+    int n = fft->fft_len, m, mh, mq, i, j;
+    memcpy(a, in, sizeof(float) * n);
+    legacy_bitrev(a, n);
+    for (mh = 1; (m = mh << 1) <= n; mh = m) {
+        mq = mh >> 1;
+        for (j = 0; j < n; j += m) {
+            float xr = a[j + mh];
+            a[j + mh] = a[j] - xr;
+            a[j] += xr;
+        }
+        for (i = 1; i < mq; i++) {
+            float wr = fft->wr[fft->mq_max / mq * i - 1];
+            float wi = fft->wi[fft->mq_max / mq * i - 1];
+            for (j = 0; j < n; j += m) {
+                int jr = j + i, ji = j + mh - i, kr = j + mh + i, ki = j + m - i;
+                float xr = wr * a[kr] + wi * a[ki];
+                float xi = wr * a[ki] - wi * a[kr];
+                a[kr] = -a[ji] + xi;
+                a[ki] = a[ji] + xi;
+                a[ji] = a[jr] - xr;
+                a[jr] = a[jr] + xr;
+            }
+        }
+    }
+}
+
+static void legacy_irfft(const LegacyFft *fft, const float *in, float *a)
+{
+    int n = fft->fft_len, m, mh, mq, i, j;
+    memcpy(a, in, sizeof(float) * n);
+    a[0] *= 0.5f;
+    a[n / 2] *= 0.5f;
+    for (m = n; (mh = m >> 1) >= 1; m = mh) {
+        mq = mh >> 1;
+        for (j = 0; j < n; j += m) {
+            float xr = a[j] - a[j + mh];
+            a[j] += a[j + mh];
+            a[j + mh] = xr;
+        }
+        for (i = 1; i < mq; i++) {
+            float wr = fft->wr[fft->mq_max / mq * i - 1];
+            float wi = fft->wi[fft->mq_max / mq * i - 1];
+            for (j = 0; j < n; j += m) {
+                int jr = j + i, ji = j + mh - i, kr = j + mh + i, ki = j + m - i;
+                float xr = a[jr] - a[ji];
+                float xi = a[ki] + a[kr];
+                a[jr] = a[jr] + a[ji];
+                a[ji] = a[ki] - a[kr];
+                a[kr] = wr * xr - wi * xi;
+                a[ki] = wr * xi + wi * xr;
+            }
+        }
+    }
+    legacy_bitrev(a, n);
+    for (j = 0; j < n; j++) {
+        a[j] *= 2.0f;
+    }
+}
+
+// packed spectrum of the module: re[k] at k, -im[k] at n - k
+static void dft_reference(const float *x, int n, double *out)
+{
+    for (int k = 0; k <= n / 2; k++) {
+        double re = 0.0, im = 0.0;
+        for (int t = 0; t < n; t++) {
+            re += x[t] * cos(2.0 * M_PI * k * t / n);
+            im -= x[t] * sin(2.0 * M_PI * k * t / n);
+        }
+        out[k] = re;
+        if (k > 0 && k < n / 2) {
+            out[n - k] = -im;
+        }
+    }
+}
+
+// rms error relative to the rms of the reference
+static double rel_error(const float *a, const double *ref, int n, double scale)
+{
+    double err = 0.0, power = 0.0;
+    for (int i = 0; i < n; i++) {
+        err += (a[i] - scale * ref[i]) * (a[i] - scale * ref[i]);
+        power += scale * ref[i] * scale * ref[i];
+    }
+    return sqrt(err / power);
+}
+
+int main(void) {
+    printf("%-6s %-8s %12s %12s %12s\n", "size", "fft", "fwd err", "inv err", "us/fwd+inv");
+    for (int n = 128; n <= 1024; n *= 2) {
+        float *x = (float *)calloc(n, sizeof(float));
+        float *spec = (float *)calloc(n, sizeof(float));
+        float *back = (float *)calloc(n, sizeof(float));
+        double *ref = (double *)calloc(n, sizeof(double));
+        double *xref = (double *)calloc(n, sizeof(double));
+        unsigned int seed = n;
+        for (int i = 0; i < n; i++) {
+            x[i] = (float)((int)lcg_u16(&seed) - 32768);
+            xref[i] = x[i];
+        }
+        dft_reference(x, n, ref);
+
+        // irfft(rfft(x)) = n * x for both transforms
+        LegacyFft legacy;
+        legacy_init(&legacy, n);
+        legacy_rfft(&legacy, x, spec);
+        double fwd_err = rel_error(spec, ref, n, 1.0);
+        legacy_irfft(&legacy, spec, back);
+        double inv_err = rel_error(back, xref, n, n);
+        double start = now_ms();
+        for (int l = 0; l < FFT_LOOPS; l++) {
+            legacy_rfft(&legacy, x, spec);
+            legacy_irfft(&legacy, spec, back);
+        }
+        double legacy_us = (now_ms() - start) * 1000.0 / FFT_LOOPS;
+        printf("%-6d %-8s %12.3g %12.3g %12.3f\n", n, "radix-2", fwd_err, inv_err, legacy_us);
+
+        void *rfft = dios_ssp_share_rfft_init(n);
+        dios_ssp_share_rfft_process(rfft, x, spec);
+        fwd_err = rel_error(spec, ref, n, 1.0);
+        dios_ssp_share_irfft_process(rfft, spec, back);
+        inv_err = rel_error(back, xref, n, n);
+        start = now_ms();
+        for (int l = 0; l < FFT_LOOPS; l++) {
+            dios_ssp_share_rfft_process(rfft, x, spec);
+            dios_ssp_share_irfft_process(rfft, spec, back);
+        }
+        double rfft_us = (now_ms() - start) * 1000.0 / FFT_LOOPS;
+        printf("%-6d %-8s %12.3g %12.3g %12.3f  x%.2f\n", n, "radix-4", fwd_err, inv_err, rfft_us, legacy_us / rfft_us);
+
+        dios_ssp_share_rfft_uninit(rfft);
+        free(legacy.wr);
+        free(legacy.wi);
+        free(x);
+        free(spec);
+        free(back);
+        free(ref);
+        free(xref);
+    }
+
+    printf("\n%-6s %-8s %12s %12s %12s\n", "size", "channels", "max diff", "us/channel", "us/batch");
+    for (int n = 256; n <= 512; n *= 2) {
+        void *rfft = dios_ssp_share_rfft_batch_init(n);
+        float *spec = (float *)calloc(n, sizeof(float));
+        float *x[BATCH_MAX], *re[BATCH_MAX], *im[BATCH_MAX];
+        unsigned int seed = n;
+        for (int c = 0; c < BATCH_MAX; c++) {
+            x[c] = (float *)calloc(n, sizeof(float));
+            re[c] = (float *)calloc(n / 2 + 1, sizeof(float));
+            im[c] = (float *)calloc(n / 2 + 1, sizeof(float));
+            for (int i = 0; i < n; i++) {
+                x[c][i] = (float)((int)lcg_u16(&seed) - 32768);
+            }
+        }
+        for (int channels = 2; channels <= BATCH_MAX; channels += 2) {
+            // per channel path, the way the modules unpacked the spectrum
+            double start = now_ms();
+            for (int l = 0; l < FFT_LOOPS; l++) {
+                for (int c = 0; c < channels; c++) {
+                    dios_ssp_share_rfft_process(rfft, x[c], spec);
+                    for (int k = 0; k <= n / 2; k++) {
+                        re[c][k] = spec[k];
+                    }
+                    im[c][0] = im[c][n / 2] = 0.0f;
+                    for (int k = 1; k < n / 2; k++) {
+                        im[c][k] = -spec[n - k];
+                    }
+                }
+            }
+            double channel_us = (now_ms() - start) * 1000.0 / FFT_LOOPS;
+
+            start = now_ms();
+            for (int l = 0; l < FFT_LOOPS; l++) {
+                dios_ssp_share_rfft_batch_process(rfft, x, channels, re, im, 1);
+            }
+            double batch_us = (now_ms() - start) * 1000.0 / FFT_LOOPS;
+
+            float diff = 0.0f;
+            for (int c = 0; c < channels; c++) {
+                dios_ssp_share_rfft_process(rfft, x[c], spec);
+                for (int k = 0; k <= n / 2; k++) {
+                    float d = fabsf(re[c][k] - spec[k]);
+                    diff = d > diff ? d : diff;
+                    if (k > 0 && k < n / 2) {
+                        d = fabsf(im[c][k] + spec[n - k]);
+                        diff = d > diff ? d : diff;
+                    }
+                }
+            }
+            printf("%-6d %-8d %12.3g %12.3f %12.3f  x%.2f\n", n, channels, diff, channel_us, batch_us, channel_us / batch_us);
+        }
+        for (int c = 0; c < BATCH_MAX; c++) {
+            free(x[c]);
+            free(re[c]);
+            free(im[c]);
+        }
+        free(spec);
+        dios_ssp_share_rfft_uninit(rfft);
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "dios_ssp_api.h"
+#include "dios_ssp_share/dios_ssp_share_simd.h"
+#include "dios_ssp_share/dios_ssp_share_rfft.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "dios_ssp_dtln/dios_ssp_dtln_header.h"
+#ifdef __cplusplus
+}  // extern C
+#endif
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "compare_common.h"
+
+// check the dtln spectral front end against the former polar one. The
+// product side is dtln_analysis and dtln_synthesis of a dtln stream with
+// float buffers bound in place of the model tensors; the reference is the
+// former stft with sqrtf, atan2f and |X|*mask*e^(j*phase). Compared are the
+// model_1 input magnitude, relative to the magnitude, and the model_2 input
+// frame in 16-bit sample units. Exits with 1 when either difference exceeds
+// its tolerance
+#define MASK_FRAME_LEN  DTLN_FRAME_SHIFT    // frame_len of the shipped chain
+#define MASK_FRAMES     2000
+#define MAG_TOL         (1e-6)      // relative to the magnitude
+#define OUT_TOL         (5e-2)      // 16-bit samples, well below the half lsb of rounding
+
+// the former stft, dtln_calc_mag, dtln_calc_phase and masking of dtln_process
+static void polar_mask(objDTLN *st, void *rfft, const float *frame, const float *mask, float *win,
+                       float *spec, float *mag, float *re, float *im)
+{
+    int bins = DTLN_FFTOUT_SIZE;
+    for (int i = 0; i < DTLN_FRAME_SIZE; i++) {
+        win[i] = frame[i] * st->m_ana_win[i];
+    }
+    dios_ssp_share_rfft_process(rfft, win, spec);
+    for (int i = 0; i < bins - 1; i++) {
+        re[i] = spec[i];
+    }
+    im[0] = im[bins - 1] = 0.0f;
+    for (int i = 1; i < bins - 1; i++) {
+        im[i] = -spec[DTLN_FRAME_SIZE - i];
+    }
+    for (int i = 0; i < bins; i++) {
+        mag[i] = sqrtf(re[i]*re[i] + im[i]*im[i]);
+    }
+    for (int i = 0; i < bins; i++) {
+        float phase = atan2f(im[i], re[i]);
+        re[i] = mag[i] * mask[i] * cosf(phase);
+        im[i] = mag[i] * mask[i] * sinf(phase);
+    }
+}
+
+// the former istft of dtln_process. Like dtln_synthesis it only fills the
+// bins below frame_len, so with frame_len 128 bins 129..255 of the masked
+// spectrum never reach model_2, in the product code as well as here
+static void polar_rebuild(void *rfft, int frame_len, const float *re, const float *im, float *buf, float *out)
+{
+    memset(buf, 0, DTLN_FRAME_SIZE * sizeof(float));
+    buf[0] = re[0];
+    buf[frame_len] = re[frame_len];
+    for (int i = 1; i < frame_len; i++) {
+        buf[i] = re[i];
+        buf[DTLN_FRAME_SIZE - i] = -im[i];
+    }
+    dios_ssp_share_irfft_process(rfft, buf, out);
+    for (int i = 0; i < DTLN_FRAME_SIZE; i++) {
+        out[i] = out[i] / DTLN_FRAME_SIZE;
+    }
+}
+
+int main(void) {
+    int bins = DTLN_FFTOUT_SIZE;
+    objDTLN *st = dtln_create(MASK_FRAME_LEN);
+    void *rfft = dios_ssp_share_rfft_init(DTLN_FRAME_SIZE);
+    if (NULL == st || NULL == rfft) {
+        fprintf(stderr, "init failed\n");
+        return -1;
+    }
+    dios_ssp_dtln_reset_api(st);
+
+    float *frame = (float *)calloc(DTLN_FRAME_SIZE, sizeof(float));
+    float *win = (float *)calloc(DTLN_FRAME_SIZE, sizeof(float));
+    float *spec = (float *)calloc(DTLN_FRAME_SIZE, sizeof(float));
+    float *buf = (float *)calloc(DTLN_FRAME_SIZE, sizeof(float));
+    float *out0 = (float *)calloc(DTLN_FRAME_SIZE, sizeof(float));
+    float *out1 = (float *)calloc(DTLN_FRAME_SIZE, sizeof(float));
+    float *mask = (float *)calloc(bins, sizeof(float));
+    float *mag0 = (float *)calloc(bins, sizeof(float));
+    float *mag1 = (float *)calloc(bins, sizeof(float));
+    float *re0 = (float *)calloc(bins, sizeof(float));
+    float *im0 = (float *)calloc(bins, sizeof(float));
+    objDTLNTensor mag_row;
+    objDTLNTensor mask_row;
+    objDTLNTensor time_row;
+    unsigned int seed = 1;
+    double mag_err = 0.0;
+    double out_err = 0.0;
+    double polar_ms = 0.0;
+    double complex_ms = 0.0;
+
+    // stub tensors, float32 model inputs and outputs bound to plain buffers
+    dtln_bind_float(&mag_row, mag1);
+    dtln_bind_float(&mask_row, mask);
+    dtln_bind_float(&time_row, out1);
+
+    for (int n = 0; n < MASK_FRAMES; n++) {
+        // frames from silence to full scale, some bins masked out completely
+        double level = pow(10.0, -4.5 * (n % 10) / 9.0);
+        for (int i = 0; i < DTLN_FRAME_SIZE; i++) {
+            frame[i] = (float)(32767.0 * level * noise(&seed));
+        }
+        if (n % 10 == 9) {
+            memset(frame, 0, DTLN_FRAME_SIZE * sizeof(float));
+        }
+        for (int i = 0; i < bins; i++) {
+            double m = lcg_u16(&seed) / 65535.0;
+            mask[i] = (float)(m < 0.1 ? 0.0 : m);
+        }
+
+        double start = now_ms();
+        polar_mask(st, rfft, frame, mask, win, spec, mag0, re0, im0);
+        polar_rebuild(rfft, st->frame_len, re0, im0, buf, out0);
+        polar_ms += now_ms() - start;
+
+        // one hop of the stream, the window starts at the oldest sample
+        dios_ssp_share_ringbuf_reset(st->m_wav_ring, 0);
+        dios_ssp_share_ringbuf_write(st->m_wav_ring, frame, DTLN_FRAME_SIZE);
+        start = now_ms();
+        dtln_analysis(st, 0, &mag_row);
+        dtln_synthesis(st, &mask_row, &time_row);
+        complex_ms += now_ms() - start;
+
+        for (int i = 0; i < bins; i++) {
+            double d = fabs((double)mag0[i] - mag1[i]);
+            if (d > 0.0) {
+                mag_err = fmax(mag_err, d / fmax(mag0[i], 1e-30));
+            }
+        }
+        for (int i = 0; i < DTLN_FRAME_SIZE; i++) {
+            out_err = fmax(out_err, fabs((double)out0[i] - out1[i]));
+        }
+    }
+
+    int fail = (mag_err > MAG_TOL) || (out_err > OUT_TOL);
+    printf("simd level %d\n", dios_ssp_share_simd_level());
+    printf("%-8s %12s %12s\n", "", "max diff", "tolerance");
+    printf("%-8s %12g %12g\n", "mag", mag_err, MAG_TOL);
+    printf("%-8s %12g %12g\n", "frame", out_err, OUT_TOL);
+    printf("us/frame polar %.4f complex %.4f  x%.2f (stft and istft included)\n",
+           polar_ms * 1000.0 / MASK_FRAMES, complex_ms * 1000.0 / MASK_FRAMES, polar_ms / complex_ms);
+    printf("%s\n", fail ? "FAIL" : "PASS");
+
+    dtln_delete(st);
+    dios_ssp_share_rfft_uninit(rfft);
+    free(frame);
+    free(win);
+    free(spec);
+    free(buf);
+    free(out0);
+    free(out1);
+    free(mask);
+    free(mag0);
+    free(mag1);
+    free(re0);
+    free(im0);
+    return fail;
+}
@@ -0,0 +1,434 @@
+#include "dios_ssp_mvdr/dios_ssp_mvdr_api.h"
+#include "dios_ssp_share/dios_ssp_share_hsolve.h"
+#include "dios_ssp_share/dios_ssp_share_simd.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "compare_common.h"
+
+// check the mvdr matrix paths against references: the batched hermitian
+// solver against a double precision gauss-jordan elimination on random
+// positive definite matrices, the recursive Rnn^-1 tracking with and without
+// its periodic exact inversion and the round-robin weight update against the
+// direct mode on a simulated array, and the trig-free mcra noise spectrum
+// against the former atan2/cos/sin rebuild. It is linked against the mvdr and
+// share sources instead of libathena, so it runs without tflite. Exits with 1
+// when a check fails
+#define HS_BATCH        256
+#define HS_TOL          (1e-4)      // relative to the reference solution
+#define MVDR_FRAME_LEN  DEFAULT_MVDR_SHIFT_SIZE
+#define MVDR_FRAMES     400
+#define MVDR_RATE       DEFAULT_MVDR_SAMPLING_FRQ
+#define MVDR_GROUPS     4
+#define MCRA_FRAMES     400
+#define MCRA_TOL        (1e-5)      // relative to the noise magnitude
+
+// R = A*A^H + 0.1*dim*I, hermitian positive definite and not too well conditioned
+static void random_hpd(int dim, unsigned int *seed, double *r_re, double *r_im)
+{
+    double *a_re = (double *)calloc(dim * dim, sizeof(double));
+    double *a_im = (double *)calloc(dim * dim, sizeof(double));
+    for (int i = 0; i < dim * dim; i++) {
+        a_re[i] = noise_gauss(seed);
+        a_im[i] = noise_gauss(seed);
+    }
+    for (int i = 0; i < dim; i++) {
+        for (int j = 0; j < dim; j++) {
+            double re = (i == j) ? 0.1 * dim : 0.0;
+            double im = 0.0;
+            for (int k = 0; k < dim; k++) {
+                re += a_re[i * dim + k] * a_re[j * dim + k] + a_im[i * dim + k] * a_im[j * dim + k];
+                im += a_im[i * dim + k] * a_re[j * dim + k] - a_re[i * dim + k] * a_im[j * dim + k];
+            }
+            r_re[i * dim + j] = re;
+            r_im[i * dim + j] = im;
+        }
+    }
+    free(a_re);
+    free(a_im);
+}
+
+// reference inverse, gauss-jordan with partial pivoting in double
+static void ref_inverse(int dim, const double *r_re, const double *r_im, double *inv_re, double *inv_im)
+{
+    double *a_re = (double *)calloc(dim * dim, sizeof(double));
+    double *a_im = (double *)calloc(dim * dim, sizeof(double));
+    memcpy(a_re, r_re, dim * dim * sizeof(double));
+    memcpy(a_im, r_im, dim * dim * sizeof(double));
+    for (int i = 0; i < dim * dim; i++) {
+        inv_re[i] = (i % (dim + 1) == 0) ? 1.0 : 0.0;
+        inv_im[i] = 0.0;
+    }
+    for (int c = 0; c < dim; c++) {
+        int p = c;
+        for (int i = c + 1; i < dim; i++) {
+            if (hypot(a_re[i * dim + c], a_im[i * dim + c]) > hypot(a_re[p * dim + c], a_im[p * dim + c])) {
+                p = i;
+            }
+        }
+        for (int j = 0; j < dim; j++) {
+            double t;
+            t = a_re[c * dim + j]; a_re[c * dim + j] = a_re[p * dim + j]; a_re[p * dim + j] = t;
+            t = a_im[c * dim + j]; a_im[c * dim + j] = a_im[p * dim + j]; a_im[p * dim + j] = t;
+            t = inv_re[c * dim + j]; inv_re[c * dim + j] = inv_re[p * dim + j]; inv_re[p * dim + j] = t;
+            t = inv_im[c * dim + j]; inv_im[c * dim + j] = inv_im[p * dim + j]; inv_im[p * dim + j] = t;
+        }
+        // scale the pivot row by 1 / pivot
+        double d = a_re[c * dim + c] * a_re[c * dim + c] + a_im[c * dim + c] * a_im[c * dim + c];
+        double s_re = a_re[c * dim + c] / d;
+        double s_im = -a_im[c * dim + c] / d;
+        for (int j = 0; j < dim; j++) {
+            double re = a_re[c * dim + j] * s_re - a_im[c * dim + j] * s_im;
+            a_im[c * dim + j] = a_re[c * dim + j] * s_im + a_im[c * dim + j] * s_re;
+            a_re[c * dim + j] = re;
+            re = inv_re[c * dim + j] * s_re - inv_im[c * dim + j] * s_im;
+            inv_im[c * dim + j] = inv_re[c * dim + j] * s_im + inv_im[c * dim + j] * s_re;
+            inv_re[c * dim + j] = re;
+        }
+        for (int i = 0; i < dim; i++) {
+            if (i == c) {
+                continue;
+            }
+            double f_re = a_re[i * dim + c];
+            double f_im = a_im[i * dim + c];
+            for (int j = 0; j < dim; j++) {
+                a_re[i * dim + j] -= f_re * a_re[c * dim + j] - f_im * a_im[c * dim + j];
+                a_im[i * dim + j] -= f_re * a_im[c * dim + j] + f_im * a_re[c * dim + j];
+                inv_re[i * dim + j] -= f_re * inv_re[c * dim + j] - f_im * inv_im[c * dim + j];
+                inv_im[i * dim + j] -= f_re * inv_im[c * dim + j] + f_im * inv_re[c * dim + j];
+            }
+        }
+    }
+    free(a_re);
+    free(a_im);
+}
+
+// solve and inverse of dios_ssp_share_hsolve against the reference for one
+// dimension, returns 1 when either relative error exceeds HS_TOL
+static int check_hsolve(int dim)
+{
+    int size = dim * dim;
+    unsigned int seed = (unsigned int)dim;
+    double *r_re = (double *)calloc(HS_BATCH * size, sizeof(double));
+    double *r_im = (double *)calloc(HS_BATCH * size, sizeof(double));
+    double *ref_re = (double *)calloc(HS_BATCH * size, sizeof(double));
+    double *ref_im = (double *)calloc(HS_BATCH * size, sizeof(double));
+    double *b_re = (double *)calloc(HS_BATCH * dim, sizeof(double));
+    double *b_im = (double *)calloc(HS_BATCH * dim, sizeof(double));
+    float *rf_re = (float *)calloc(HS_BATCH * size, sizeof(float));
+    float *rf_im = (float *)calloc(HS_BATCH * size, sizeof(float));
+    float *inv_re = (float *)calloc(HS_BATCH * size, sizeof(float));
+    float *inv_im = (float *)calloc(HS_BATCH * size, sizeof(float));
+    float *bf_re = (float *)calloc(HS_BATCH * dim, sizeof(float));
+    float *bf_im = (float *)calloc(HS_BATCH * dim, sizeof(float));
+    float *x_re = (float *)calloc(HS_BATCH * dim, sizeof(float));
+    float *x_im = (float *)calloc(HS_BATCH * dim, sizeof(float));
+    objHermSolve *hs = dios_ssp_share_hsolve_init(dim, HS_BATCH);
+
+    for (int b = 0; b < HS_BATCH; b++) {
+        random_hpd(dim, &seed, r_re + b * size, r_im + b * size);
+        for (int i = 0; i < dim; i++) {
+            b_re[b * dim + i] = noise_gauss(&seed);
+            b_im[b * dim + i] = noise_gauss(&seed);
+        }
+    }
+    for (int i = 0; i < HS_BATCH * size; i++) {
+        rf_re[i] = (float)r_re[i];
+        rf_im[i] = (float)r_im[i];
+    }
+    for (int i = 0; i < HS_BATCH * dim; i++) {
+        bf_re[i] = (float)b_re[i];
+        bf_im[i] = (float)b_im[i];
+    }
+
+    double start = now_ms();
+    for (int b = 0; b < HS_BATCH; b++) {
+        ref_inverse(dim, r_re + b * size, r_im + b * size, ref_re + b * size, ref_im + b * size);
+    }
+    double ref_ms = now_ms() - start;
+
+    start = now_ms();
+    int clamped = dios_ssp_share_hsolve_factor(hs, rf_re, rf_im, size, HS_BATCH, 0.0f);
+    dios_ssp_share_hsolve_solve(hs, bf_re, bf_im, x_re, x_im, dim);
+    double solve_ms = now_ms() - start;
+    start = now_ms();
+    dios_ssp_share_hsolve_inverse(hs, inv_re, inv_im, size);
+    double inverse_ms = now_ms() - start;
+
+    // largest relative error over the batch, 2-norm for x and frobenius for the inverse
+    double solve_err = 0.0;
+    double inverse_err = 0.0;
+    for (int b = 0; b < HS_BATCH; b++) {
+        const double *p_re = ref_re + b * size;
+        const double *p_im = ref_im + b * size;
+        double num = 0.0, den = 0.0;
+        for (int i = 0; i < dim; i++) {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < dim; j++) {
+                re += p_re[i * dim + j] * b_re[b * dim + j] - p_im[i * dim + j] * b_im[b * dim + j];
+                im += p_re[i * dim + j] * b_im[b * dim + j] + p_im[i * dim + j] * b_re[b * dim + j];
+            }
+            num += pow(x_re[b * dim + i] - re, 2) + pow(x_im[b * dim + i] - im, 2);
+            den += re * re + im * im;
+        }
+        solve_err = fmax(solve_err, sqrt(num / den));
+        num = den = 0.0;
+        for (int i = 0; i < size; i++) {
+            num += pow(inv_re[b * size + i] - p_re[i], 2) + pow(inv_im[b * size + i] - p_im[i], 2);
+            den += p_re[i] * p_re[i] + p_im[i] * p_im[i];
+        }
+        inverse_err = fmax(inverse_err, sqrt(num / den));
+    }
+
+    int fail = (clamped != 0) || (solve_err > HS_TOL) || (inverse_err > HS_TOL);
+    printf("%-4d %12g %12g %12.4f %12.4f %12.4f %s\n", dim, solve_err, inverse_err,
+           ref_ms * 1000.0 / HS_BATCH, solve_ms * 1000.0 / HS_BATCH, inverse_ms * 1000.0 / HS_BATCH,
+           fail ? "FAIL" : "ok");
+
+    dios_ssp_share_hsolve_uninit(hs);
+    free(r_re);
+    free(r_im);
+    free(ref_re);
+    free(ref_im);
+    free(b_re);
+    free(b_im);
+    free(rf_re);
+    free(rf_im);
+    free(inv_re);
+    free(inv_im);
+    free(bf_re);
+    free(bf_im);
+    free(x_re);
+    free(x_im);
+    return fail;
+}
+
+// sum of count sinusoids between 200 and 3800 hz drawn from seed
+static double tones(double t, unsigned int seed, int count)
+{
+    double v = 0.0;
+    for (int h = 0; h < count; h++) {
+        double frq = 200.0 + 3600.0 * lcg_u16(&seed) / 65536.0;
+        v += sin(2.0 * M_PI * frq * t + h);
+    }
+    return v / sqrt(count * 0.5);
+}
+
+// target plane wave from 90 degrees, an interferer 6 db weaker from 210
+// degrees and white noise 20 db below the target, mic m at pcm[m * len]
+static void synth(const PlaneCoord *mic, int mic_num, float *pcm)
+{
+    double th = 90.0 * M_PI / 180.0;
+    double th_int = 210.0 * M_PI / 180.0;
+    int len = MVDR_FRAMES * MVDR_FRAME_LEN;
+    unsigned int seed = (unsigned int)mic_num;
+    for (int m = 0; m < mic_num; m++) {
+        double tau = (mic[m].x * cos(th) + mic[m].y * sin(th)) / VELOCITY;
+        double tau_int = (mic[m].x * cos(th_int) + mic[m].y * sin(th_int)) / VELOCITY;
+        for (int i = 0; i < len; i++) {
+            double t = (double)i / MVDR_RATE;
+            pcm[m * len + i] = (float)(1000.0 * tones(t + tau, 3, 40) + 500.0 * tones(t + tau_int, 5, 30)
+                                       + 100.0 * noise_gauss(&seed));
+        }
+    }
+}
+
+// one mvdr configuration over the recording, refresh 0 keeps DEFAULT_MVDR_INV_REFRESH
+static void run_mvdr(const PlaneCoord *mic, int mic_num, const float *pcm, int inv_mode, int refresh,
+                     int groups, float *out, double *cost_ms, double *bins)
+{
+    void *hmvdr = dios_ssp_mvdr_init_api(mic_num, (void *)mic);
+    dios_ssp_mvdr_config_api(hmvdr, inv_mode);
+    dios_ssp_mvdr_update_config_api(hmvdr, groups);
+    if (refresh > 0) {
+        ((objMVDR *)hmvdr)->m_inv_refresh = refresh;
+    }
+    dios_ssp_mvdr_reset_api(hmvdr);
+
+    int len = MVDR_FRAMES * MVDR_FRAME_LEN;
+    float *in = (float *)calloc(mic_num * MVDR_FRAME_LEN, sizeof(float));
+    *cost_ms = 0.0;
+    *bins = 0.0;
+    for (int n = 0; n < MVDR_FRAMES; n++) {
+        for (int m = 0; m < mic_num; m++) {
+            memcpy(in + m * MVDR_FRAME_LEN, pcm + m * len + n * MVDR_FRAME_LEN, sizeof(float) * MVDR_FRAME_LEN);
+        }
+        double start = now_ms();
+        dios_ssp_mvdr_process_api(hmvdr, in, out + n * MVDR_FRAME_LEN, 90.0f);
+        *cost_ms += now_ms() - start;
+        *bins += dios_ssp_mvdr_update_bins_get(hmvdr);
+    }
+    *bins /= MVDR_FRAMES;
+
+    free(in);
+    dios_ssp_mvdr_uninit_api(hmvdr);
+}
+
+// snr of out against ref in db, 999 when they match bit for bit
+static double snr_db(const float *ref, const float *out, int len)
+{
+    double sig = 0.0, err = 0.0;
+    for (int i = 0; i < len; i++) {
+        sig += (double)ref[i] * ref[i];
+        err += ((double)ref[i] - out[i]) * ((double)ref[i] - out[i]);
+    }
+    return err > 0.0 ? 10.0 * log10(sig / err) : 999.0;
+}
+
+// the direct mode with every bin recalculated each frame is the reference of
+// the recursive inverse, with and without the exact inversion every
+// DEFAULT_MVDR_INV_REFRESH frames, and of the round-robin update, whose
+// reused weights are stale by design and get a lower limit. Returns 1 when a
+// configuration falls below its snr limit
+static int check_mvdr(int mic_num)
+{
+    struct {
+        const char *name;
+        int inv_mode;
+        int refresh;
+        int groups;
+        double min_snr;     // db against the direct mode, 0 only reported
+    } cfg[] = {
+        { "direct", MVDR_RNN_INV_DIRECT, 0, 1, 0.0 },
+        { "recursive", MVDR_RNN_INV_RECURSIVE, 0, 1, 40.0 },
+        { "recursive/norefresh", MVDR_RNN_INV_RECURSIVE, MVDR_FRAMES + 1, 1, 0.0 },   // only inverted on the first frame
+        { "direct/groups", MVDR_RNN_INV_DIRECT, 0, MVDR_GROUPS, 12.0 },
+        { "recursive/groups", MVDR_RNN_INV_RECURSIVE, 0, MVDR_GROUPS, 12.0 },
+    };
+    int cfg_num = (int)(sizeof(cfg) / sizeof(cfg[0]));
+    int len = MVDR_FRAMES * MVDR_FRAME_LEN;
+    PlaneCoord mic[16];
+    for (int m = 0; m < mic_num; m++) {
+        mic[m].x = (float)(0.05 * cos(2.0 * M_PI * m / mic_num));
+        mic[m].y = (float)(0.05 * sin(2.0 * M_PI * m / mic_num));
+        mic[m].z = 0.0f;
+    }
+    float *pcm = (float *)calloc(mic_num * len, sizeof(float));
+    float *ref = (float *)calloc(len, sizeof(float));
+    float *out = (float *)calloc(len, sizeof(float));
+    synth(mic, mic_num, pcm);
+
+    int fail = 0;
+    for (int c = 0; c < cfg_num; c++) {
+        double cost_ms, bins;
+        run_mvdr(mic, mic_num, pcm, cfg[c].inv_mode, cfg[c].refresh, cfg[c].groups,
+                 c == 0 ? ref : out, &cost_ms, &bins);
+        double snr = c == 0 ? 999.0 : snr_db(ref, out, len);
+        int bad = snr < cfg[c].min_snr;
+        fail |= bad;
+        printf("%-4d %-20s %10.1f %10.1f %12.4f %s\n", mic_num, cfg[c].name, snr, bins,
+               cost_ms / MVDR_FRAMES, bad ? "FAIL" : "ok");
+    }
+
+    free(pcm);
+    free(ref);
+    free(out);
+    return fail;
+}
+
+// noise spectrum of dios_ssp_mvdr_mcra against the former rebuild from the
+// phase of the input, sqrt(noise) * e^(j*atan2(im, re)), on random spectra
+// with silent frames and zero bins; the noise power of the mcra is shared, so
+// only the rebuild is compared. Returns 1 when the difference exceeds MCRA_TOL
+static int check_mcra(int mic_num)
+{
+    PlaneCoord mic[16];
+    for (int m = 0; m < mic_num; m++) {
+        mic[m].x = (float)(0.05 * m);
+        mic[m].y = mic[m].z = 0.0f;
+    }
+    objMVDR *st = (objMVDR *)dios_ssp_mvdr_init_api(mic_num, mic);
+    int fft_size = st->m_fft_size;
+    int bins = st->m_sp_size;
+    float *re = (float *)calloc(mic_num * fft_size, sizeof(float));
+    float *im = (float *)calloc(mic_num * fft_size, sizeof(float));
+    float *xn_re = (float *)calloc(bins, sizeof(float));
+    float *xn_im = (float *)calloc(bins, sizeof(float));
+    unsigned int seed = 3;
+    double err = 0.0;
+    double polar_ms = 0.0;
+    double scale_ms = 0.0;
+
+    dios_ssp_mvdr_reset_api(st);
+    for (int n = 0; n < MCRA_FRAMES; n++) {
+        // levels from full scale down to -90 db, every tenth frame silent
+        double level = 32767.0 * pow(10.0, -4.5 * (n % 10) / 9.0);
+        for (int i = 0; i < mic_num * fft_size; i++) {
+            re[i] = (float)(level * noise(&seed));
+            im[i] = (float)(level * noise(&seed));
+            if (n % 10 == 9 || lcg_u16(&seed) < 3000) {
+                re[i] = im[i] = 0.0f;
+            }
+        }
+        st->m_re = re;
+        st->m_im = im;
+        st->m_frame_sum++;
+        dios_ssp_mvdr_mcra(st);
+
+        for (int i = 0; i < mic_num; i++) {
+            const float *x_re = re + i * fft_size;
+            const float *x_im = im + i * fft_size;
+            const float *ps = st->m_ns_ps + i * fft_size;
+            double start = now_ms();
+            for (int k = 0; k < bins; k++) {
+                float theta = atan2f(x_im[k], x_re[k]);
+                float amp = sqrtf(ps[k]);
+                xn_re[k] = amp * cosf(theta);
+                xn_im[k] = amp * sinf(theta);
+            }
+            polar_ms += now_ms() - start;
+            for (int k = 0; k < bins; k++) {
+                double d = hypot((double)xn_re[k] - st->m_xn_re[i * fft_size + k],
+                                 (double)xn_im[k] - st->m_xn_im[i * fft_size + k]);
+                if (d > 0.0) {
+                    err = fmax(err, d / fmax(sqrt(ps[k]), 1e-30));
+                }
+            }
+
+            // the trig-free rebuild alone, on the same spectrum and noise power
+            start = now_ms();
+            dios_ssp_share_vec_scale_power(x_re, x_im, st->m_ns_ps_cur_mic, ps, xn_re, xn_im, bins);
+            scale_ms += now_ms() - start;
+        }
+    }
+
+    int fail = err > MCRA_TOL;
+    printf("%-4d %12g %12g %12.4f %12.4f %s\n", mic_num, err, MCRA_TOL,
+           polar_ms * 1000.0 / MCRA_FRAMES, scale_ms * 1000.0 / MCRA_FRAMES, fail ? "FAIL" : "ok");
+
+    dios_ssp_mvdr_uninit_api(st);
+    free(re);
+    free(im);
+    free(xn_re);
+    free(xn_im);
+    return fail;
+}
+
+int main(void) {
+    const int dims[] = { 2, 4, 8, 16 };
+    const int mics[] = { 4, 8, 16 };
+    int fail = 0;
+
+    printf("simd level %d\n", dios_ssp_share_simd_level());
+    printf("== hermitian solver against gauss-jordan, %d matrices, tolerance %g\n", HS_BATCH, HS_TOL);
+    printf("%-4s %12s %12s %12s %12s %12s\n", "dim", "solve err", "inverse err", "ref us", "solve us", "inverse us");
+    for (int d = 0; d < (int)(sizeof(dims) / sizeof(dims[0])); d++) {
+        fail |= check_hsolve(dims[d]);
+    }
+
+    printf("== mvdr modes against the direct mode, %d frames, groups %d\n", MVDR_FRAMES, MVDR_GROUPS);
+    printf("%-4s %-20s %10s %10s %12s\n", "mics", "mode", "snr(db)", "bins", "ms/frame");
+    for (int m = 0; m < (int)(sizeof(mics) / sizeof(mics[0])); m++) {
+        fail |= check_mvdr(mics[m]);
+    }
+
+    printf("== trig-free mcra noise spectrum against atan2/cos/sin, %d frames\n", MCRA_FRAMES);
+    printf("%-4s %12s %12s %12s %12s\n", "mics", "max diff", "tolerance", "polar us", "scale us");
+    for (int m = 0; m < (int)(sizeof(mics) / sizeof(mics[0])); m++) {
+        fail |= check_mcra(mics[m]);
+    }
+
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
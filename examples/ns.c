@@ -44,6 +44,7 @@ int main(int argc, char **argv) {
     }
 
     objSSP_Param param;
+    memset(&param, 0, sizeof(param));
     param.AEC_KEY = 0;
     param.DTLN_KEY = 1;
     param.NS_KEY  = 1;
@@ -56,7 +57,19 @@ int main(int argc, char **argv) {
     param.loc_phi = 90.0f;
     param.modelpath[0] = "/voc/DTLN_tflite_Cpp/model/DNS/model_1.tflite";
     param.modelpath[1] = "/voc/DTLN_tflite_Cpp/model/DNS/model_2.tflite";
-    memset(param.mic_coord, 0, sizeof(param.mic_coord));
+    param.dtln_num_threads = 1;
+    param.dtln_delegate = DTLN_DELEGATE_NONE;
+    param.dtln_pipeline = 0;
+    param.mvdr_inv_mode = MVDR_RNN_INV_DIRECT;
+    param.mvdr_update_groups = 1;
+    param.doa_delta_angle = DEFAULT_DOA_DELTA_ANGLE;
+    param.doa_coarse_angle = 0;
+    param.doa_engine = DOA_ENGINE_CAPON;
+    param.doa_search_interval = 1;
+    param.aec_engine = AEC_ENGINE_SUBBAND;
+    param.aec_tail_ms = AEC_PBFDAF_DEFAULT_TAIL_MS;
+    param.aec_threads = 1;
+    param.aec_max_delay_ms = AEC_TDE_DEFAULT_DELAY_MS;
 
     void *hssp = dios_ssp_init_api(&param);
     if (NULL == hssp) {
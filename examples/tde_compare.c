@@ -0,0 +1,91 @@
+#include "dios_ssp_api.h"
+#include "dios_ssp_aec/dios_ssp_aec_tde/dios_ssp_aec_tde.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "compare_common.h"
+
+// time delay estimation of the aec for several search ranges: the delay found
+// on a synthetic echo, time per frame of the tde alone and of the whole one mic
+// aec frame with the share of the tde, and the memory of one tde instance
+#define TDE_FRAME_LEN   128
+#define TDE_FRAME_NUM   3000
+#define TDE_RATE        16000
+
+// echo delayed by delay samples, plus noise
+static void echo(const float *ref, float *mic, int len, int delay)
+{
+    unsigned int seed = 5;
+    for (int i = 0; i < len; i++) {
+        mic[i] = (float)((i >= delay ? 0.5 * ref[i - delay] : 0.0) + 30.0 * noise(&seed));
+    }
+}
+
+// tde alone, returns ms per frame, the last delay in samples and the memory in bytes
+static double run_tde(int max_delay_ms, const float *mic, const float *ref, int *delay, int *bytes)
+{
+    objTDE *tde = dios_ssp_aec_tde_init(1, 1, TDE_FRAME_LEN, max_delay_ms);
+    float mic_frame[TDE_FRAME_LEN];
+    float ref_frame[TDE_FRAME_LEN];
+    double cost_ms = 0.0;
+    for (int i = 0; i < TDE_FRAME_NUM; i++) {
+        memcpy(mic_frame, mic + i * TDE_FRAME_LEN, sizeof(mic_frame));
+        memcpy(ref_frame, ref + i * TDE_FRAME_LEN, sizeof(ref_frame));
+        double start = now_ms();
+        dios_ssp_aec_tde_process(tde, ref_frame, mic_frame);
+        cost_ms += now_ms() - start;
+    }
+    *delay = tde->tde_long_shift_smpl + tde->tde_short_shift_smpl;
+    *bytes = dios_ssp_aec_tde_memory_get(tde);
+    dios_ssp_aec_tde_uninit(tde);
+    return cost_ms / TDE_FRAME_NUM;
+}
+
+// one mic aec with the same search range, returns ms per frame
+static double run_aec(int max_delay_ms, const float *mic, const float *ref)
+{
+    void *haec = dios_ssp_aec_init_api(1, 1, TDE_FRAME_LEN);
+    dios_ssp_aec_delay_config_api(haec, max_delay_ms);
+    dios_ssp_aec_reset_api(haec);
+
+    float io[TDE_FRAME_LEN];
+    float ref_frame[TDE_FRAME_LEN];
+    int dt_st = 0;
+    double cost_ms = 0.0;
+    for (int i = 0; i < TDE_FRAME_NUM; i++) {
+        memcpy(io, mic + i * TDE_FRAME_LEN, sizeof(io));
+        memcpy(ref_frame, ref + i * TDE_FRAME_LEN, sizeof(ref_frame));
+        double start = now_ms();
+        dios_ssp_aec_process_api(haec, io, ref_frame, &dt_st);
+        cost_ms += now_ms() - start;
+    }
+    dios_ssp_aec_uninit_api(haec);
+    return cost_ms / TDE_FRAME_NUM;
+}
+
+int main(void) {
+    const int ranges[] = { 500, 1000, 3000, 10000 };
+    const int delays[] = { 100, 800, 2500 };
+    int len = TDE_FRAME_NUM * TDE_FRAME_LEN;
+    float *ref = (float *)calloc(len, sizeof(float));
+    float *mic = (float *)calloc(len, sizeof(float));
+    talker(ref, len, TDE_RATE, 20, 0.0, 7);
+
+    printf("%-10s %-10s %10s %12s %12s %8s %10s\n", "delay(ms)", "range(ms)", "found(ms)",
+           "tde ms/frm", "aec ms/frm", "tde %", "tde kb");
+    for (int d = 0; d < (int)(sizeof(delays) / sizeof(delays[0])); d++) {
+        echo(ref, mic, len, delays[d] * TDE_RATE / 1000);
+        for (int r = 0; r < (int)(sizeof(ranges) / sizeof(ranges[0])); r++) {
+            int delay = 0, bytes = 0;
+            double tde_ms = run_tde(ranges[r], mic, ref, &delay, &bytes);
+            double aec_ms = run_aec(ranges[r], mic, ref);
+            printf("%-10d %-10d %10.1f %12.4f %12.4f %7.1f%% %10.1f\n", delays[d], ranges[r],
+                   delay * 1000.0 / TDE_RATE, tde_ms, aec_ms, 100.0 * tde_ms / aec_ms, bytes / 1024.0);
+        }
+    }
+
+    free(ref);
+    free(mic);
+    return 0;
+}
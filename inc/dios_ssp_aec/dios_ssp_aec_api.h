@@ -25,9 +25,12 @@ limitations under the License.
 #include "dios_ssp_aec_doubletalk.h"
 #include "dios_ssp_aec_erl_est.h"
 #include "dios_ssp_aec_res.h"
+#include "dios_ssp_aec_pbfdaf.h"
 #include "./dios_ssp_aec_tde/dios_ssp_aec_tde.h"
 #include "../dios_ssp_share/dios_ssp_share_subband.h"
 #include "../dios_ssp_share/dios_ssp_share_complex_defs.h"
+#include "../dios_ssp_share/dios_ssp_share_ringbuf.h"
+#include "../dios_ssp_share/dios_ssp_share_workpool.h"
 
 /**********************************************************************************
 Function:      // dios_ssp_aec_init_api
@@ -51,6 +54,49 @@ Return:        // success: return 0, failure: return ERR_AEC
 **********************************************************************************/
 int dios_ssp_aec_config_api(void* ptr, int mode);
 
+/**********************************************************************************
+Function:      // dios_ssp_aec_engine_config_api
+Description:   // select the linear echo cancellation engine, call after init. tde,
+                  erl estimation, residual echo suppression and double talk detection
+                  are shared by both engines
+Input:         // ptr: dios speech signal process aec pointer
+	              engine: AEC_ENGINE_SUBBAND (default), ipnlms over NTAPS_LOW_BAND taps
+	                      per subband, about 80 ms; or AEC_ENGINE_PBFDAF, a partitioned
+	                      block frequency domain filter whose cost grows with tail_ms
+	              tail_ms: echo tail of AEC_ENGINE_PBFDAF in ms, up to AEC_PBFDAF_MAX_TAIL_MS,
+	                       0 for AEC_PBFDAF_DEFAULT_TAIL_MS
+Output:        // none
+Return:        // success: return 0, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_engine_config_api(void* ptr, int engine, int tail_ms);
+
+/**********************************************************************************
+Function:      // dios_ssp_aec_thread_config_api
+Description:   // process the microphones on a persistent pool of threads, call after
+                  init. tde and the reference analysis stay on the calling thread, the
+                  output is identical to the single thread one
+Input:         // ptr: dios speech signal process aec pointer
+	              thread_num: threads including the calling one, at most mic_num are
+	                          used; 0 or 1 processes every microphone on the caller
+Output:        // none
+Return:        // success: return 0, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_thread_config_api(void* ptr, int thread_num);
+
+/**********************************************************************************
+Function:      // dios_ssp_aec_delay_config_api
+Description:   // set the largest echo delay the time delay estimation searches, call
+                  after init. the delay estimator history and the delay compensation
+                  buffers of every mic and ref are sized from it, a shorter range
+                  takes less memory and less time per frame
+Input:         // ptr: dios speech signal process aec pointer
+	              max_delay_ms: AEC_TDE_MIN_DELAY_MS to AEC_TDE_MAX_DELAY_MS,
+	                            0 for AEC_TDE_DEFAULT_DELAY_MS
+Output:        // none
+Return:        // success: return 0, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_delay_config_api(void* ptr, int max_delay_ms);
+
 /**********************************************************************************
 Function:      // dios_ssp_aec_reset_api
 Description:   // reset dios speech signal process aec module
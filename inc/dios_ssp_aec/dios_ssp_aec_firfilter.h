@@ -23,6 +23,7 @@ limitations under the License.
 #include "dios_ssp_aec_macros.h"
 #include "../dios_ssp_share/dios_ssp_share_complex_defs.h"
 #include "../dios_ssp_share/dios_ssp_share_noiselevel.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
 
 /* fir filter struct define */
 typedef struct {
@@ -36,9 +37,15 @@ typedef struct {
     int* num_main_subband_adf;
     float* lambda;
     float* weight;
-    xcomplex*** fir_coef;
-    xcomplex*** adf_coef;
-    xcomplex*** stack_sigIn_adf;
+    // filters and reference history as split real/imag arrays [ref][subband][tap],
+    // AEC_TAP_STRIDE floats per subband, all six in one aligned block
+    float* coef_block;
+    float* fir_coef_re;
+    float* fir_coef_im;
+    float* adf_coef_re;
+    float* adf_coef_im;
+    float* stack_sigIn_re; // newest sample first
+    float* stack_sigIn_im;
     xcomplex* err_adf;
     xcomplex* err_fir;
     xcomplex** est_ref_adf;
@@ -102,6 +109,20 @@ Return:        // success: return 0, failure: return ERR_AEC
 **********************************************************************************/
 int dios_ssp_aec_firfilter_process(objFirFilter* ptr, xcomplex* output_buf, xcomplex* est_echo);
 
+/**********************************************************************************
+Function:      // dios_ssp_aec_firfilter_external_process
+Description:   // take the subband echo estimates of another linear engine in place of
+                  the subband filters, so that erl estimation, residual echo suppression
+                  and double talk detection run on them unchanged
+Input:         // ptr: dios speech signal process aec firfilter pointer
+                  est_ref: echo estimate of each reference in subband domain
+Output:        // output_buf: error signal output
+	              est_echo: estimated echo signal output
+Return:        // success: return 0, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_firfilter_external_process(objFirFilter* ptr, xcomplex** est_ref, xcomplex* output_buf,
+                                            xcomplex* est_echo);
+
 /**********************************************************************************
 Function:      // dios_ssp_aec_firfilter_uninit
 Description:   // free dios speech signal process aec firfilter module
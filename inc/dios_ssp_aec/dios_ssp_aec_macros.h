@@ -35,12 +35,27 @@ limitations under the License.
 #define AEC_REF_FIX_DELAY                         (0)
 
 /* TDE submodule */
-#define DELAY_BUFFER_SIZE                         (51200) /* delay compensation */
+#define AEC_TDE_DEFAULT_DELAY_MS                  (3000) /* delay range of the long-term estimator */
+#define AEC_TDE_MIN_DELAY_MS                      (400)  /* range of the short-term estimator */
+#define AEC_TDE_MAX_DELAY_MS                      (10000)
 
 /* linear echo cancellation module */
 #define NTAPS_LOW_BAND                            (10)          /* low band filter tap number */
 #define NTAPS_HIGH_BAND                           (8)           /* hign band filter tap number */
 #define NUM_MAX_BAND                              (NTAPS_LOW_BAND + 10)    /* max filter tap number */
+#define AEC_TAP_STRIDE                            ((NUM_MAX_BAND + 1 + 7) & ~7) /* floats per subband filter, 32-byte rows */
+
+/* linear echo cancellation engine */
+#define AEC_ENGINE_SUBBAND                        (0) /* subband ipnlms, NTAPS_LOW_BAND taps per subband */
+#define AEC_ENGINE_PBFDAF                         (1) /* partitioned block frequency domain filter */
+#define AEC_PBFDAF_DEFAULT_TAIL_MS                (128)
+#define AEC_PBFDAF_MAX_TAIL_MS                    (1024)
+#define AEC_PBFDAF_MYU                            (0.5f)  /* step size */
+#define AEC_PBFDAF_MYU_DT                         (0.15f) /* step size in double talk */
+#define AEC_PBFDAF_DELTA                          (1e4f)  /* power floor per bin and fft point */
+#define AEC_PBFDAF_ERR_BOUND                      (0.15f) /* max error per bin over reference magnitude */
+#define AEC_PBFDAF_POWER_ALPHA                    (0.97f) /* smoothing of the reference power per bin */
+#define AEC_PBFDAF_PROP_SHARE                     (0.5f)  /* share of the step following partition magnitude */
 
 /* smooth factor */
 #define AEC_PEAK_ALPHA                            (0.9048f)
@@ -0,0 +1,103 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef _DIOS_SSP_AEC_PBFDAF_H_
+#define _DIOS_SSP_AEC_PBFDAF_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dios_ssp_aec_macros.h"
+#include "../dios_ssp_share/dios_ssp_share_rfft.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
+
+/* partitioned block frequency domain adaptive filter struct define */
+typedef struct {
+    int ref_num;
+    int frm_len;        // block length N, one frame
+    int fft_len;        // 2N, overlap-save
+    int bin_num;        // N + 1 bins of the unpacked spectrum
+    int bin_stride;     // floats per spectrum, 32-byte rows
+    int part_num;       // partitions per reference, tail / N
+    int part_pos;       // ring slot of the newest reference spectrum
+    int constrain_pos;  // partition whose gradient constraint runs this frame
+    void *rfft_param;
+    // spectra as split real/imag rows, all in one aligned block
+    float *block;
+    float *ref_re;      // [ref][part][bin] ring of reference spectra
+    float *ref_im;
+    float *coef_re;     // [ref][part][bin] filter partitions
+    float *coef_im;
+    float *echo_re;     // [ref][bin] echo spectrum of each reference
+    float *echo_im;
+    float *err_re;      // [bin] error spectrum, then the normalized step
+    float *err_im;
+    float *ref_power;   // [bin] smoothed power of the newest reference spectra
+    float *ref_time;    // [ref][2N] previous and current reference frame
+    float *fft_buf;     // [2N]
+    float *time_buf;    // [2N]
+    float *part_gain;   // [part] proportionate step gain of each partition
+    float **batch_in;
+    float **batch_re;
+    float **batch_im;
+} objPbfdaf;
+
+/**********************************************************************************
+Function:      // dios_ssp_aec_pbfdaf_init
+Description:   // allocate memory of the partitioned block frequency domain adaptive filter
+Input:         // ref_num: reference number
+                  frm_len: frame length, also the partition length
+                  tail_ms: echo tail length covered by the filter in ms
+Output:        // none
+Return:        // success: return dios speech signal process aec pbfdaf pointer
+	              failure: return NULL
+**********************************************************************************/
+objPbfdaf* dios_ssp_aec_pbfdaf_init(int ref_num, int frm_len, int tail_ms);
+
+/**********************************************************************************
+Function:      // dios_ssp_aec_pbfdaf_reset
+Description:   // reset dios speech signal process aec pbfdaf module
+Input:         // ptr: dios speech signal process aec pbfdaf pointer
+Output:        // none
+Return:        // success: return 0, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_pbfdaf_reset(objPbfdaf* ptr);
+
+/**********************************************************************************
+Function:      // dios_ssp_aec_pbfdaf_process
+Description:   // run dios speech signal process aec pbfdaf module by frames: filter the
+                  references, subtract the echo from the mic and update the filter
+Input:         // ptr: dios speech signal process aec pbfdaf pointer
+                  mic: frm_len mic samples
+                  ref: ref_num pointers to frm_len reference samples
+                  myu: step size, 0 freezes the filter
+Output:        // echo: ref_num pointers to the frm_len echo estimate of each reference
+                  err: frm_len mic samples minus the sum of the echo estimates
+Return:        // success: return 0, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_pbfdaf_process(objPbfdaf* ptr, const float* mic, float** ref, float myu,
+                                float** echo, float* err);
+
+/**********************************************************************************
+Function:      // dios_ssp_aec_pbfdaf_uninit
+Description:   // free dios speech signal process aec pbfdaf module
+Input:         // ptr: dios speech signal process aec pbfdaf pointer
+Output:        // none
+Return:        // success: return 0, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_pbfdaf_uninit(objPbfdaf* ptr);
+
+#endif /* _DIOS_SSP_AEC_PBFDAF_H_ */
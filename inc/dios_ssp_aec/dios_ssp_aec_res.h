@@ -20,6 +20,7 @@ limitations under the License.
 #include <stdlib.h>
 #include "dios_ssp_aec_macros.h"
 #include "../dios_ssp_share/dios_ssp_share_complex_defs.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
 
 typedef struct {
     xcomplex *Xf_res_echo;
@@ -38,6 +38,8 @@ typedef struct {
     int mic_num;
     int ref_num;
     int frm_len;
+    int max_delay_long;     // long-term history in blocks of PART_LEN
+    int buf_len;            // samples of each delay compensation buffer
 
     /* buffer, loop number and data length definition */
     float *tdeBuf_ref;
@@ -63,11 +65,14 @@ Description:   // load configure file and allocate memory
 Input:         // mic_num: microphone number
 				  ref_num: reference number
 				  frm_len: frame length
+				  max_delay_ms: largest delay the long-term estimator searches, in ms,
+				  AEC_TDE_MIN_DELAY_MS to AEC_TDE_MAX_DELAY_MS. the estimator history
+				  and the delay compensation buffers are sized from it
 Output:        // none
 Return:        // success: return dios speech signal process aec time delay estimation(tde) pointer
 	              failure: return NULL
 **********************************************************************************/
-objTDE* dios_ssp_aec_tde_init(int mic_num, int ref_num, int frm_len);
+objTDE* dios_ssp_aec_tde_init(int mic_num, int ref_num, int frm_len, int max_delay_ms);
 
 /**********************************************************************************
 Function:      // dios_ssp_aec_tde_reset
@@ -89,6 +94,15 @@ Return:        // success: return 0, failure: return ERR_AEC
 **********************************************************************************/
 int dios_ssp_aec_tde_process(objTDE* srv, float* refbuf, float* micbuf);
 
+/**********************************************************************************
+Function:      // dios_ssp_aec_tde_memory_get
+Description:   // memory held by dios speech signal process aec tde module
+Input:         // srv: dios speech signal process aec tde pointer
+Output:        // none
+Return:        // success: return memory in bytes, failure: return ERR_AEC
+**********************************************************************************/
+int dios_ssp_aec_tde_memory_get(objTDE* srv);
+
 /**********************************************************************************
 Function:      // dios_ssp_aec_tde_uninit
 Description:   // free dios speech signal process aec tde module
@@ -21,14 +21,18 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include "../../dios_ssp_share/dios_ssp_share_simd.h"
 
 static const int kMaxBitCountsQ9 = (32 << 9);
 
 typedef struct {
-    // Pointer to bit counts.
-    int* far_bit_counts;
-    // Binary history variables.
+    // Mean update shift of each far-end spectrum, 0 for an empty one.
+    int* far_shifts;
+    // Binary history variables. Both histories are mirrored rings of
+    // 2 * |history_size| entries, delay i of the newest spectrum is at
+    // [history_pos + i] for every i < |history_size|.
     unsigned int* binary_far_history;
+    int history_pos;
     int history_size;
 } BinaryDelayEstimatorFarend;
 
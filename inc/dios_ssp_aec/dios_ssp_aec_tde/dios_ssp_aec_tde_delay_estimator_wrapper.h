@@ -49,7 +49,6 @@ limitations under the License.
 #define FAR_BUF_LEN     PART_LEN4       /* Length of buffers. */
 #define DELAY_WIN_SLIDE_TDE   500 // sliding win 
 #define DELAY_WIN_SLIDE       100 // sliding win 
-#define MAX_DELAY_LONG       750// 750 // 750 frames, 750 * 64 
 #define MAX_DELAY_SHORT   100 // 100 frames, 100 * 64 
 
 /* Counter parameters */
@@ -89,9 +88,6 @@ typedef struct {
     void* delay_estimator;
     unsigned short currentDelay;
 
-    float far_history[PART_LEN1 * MAX_DELAY_LONG];
-    int far_q_domains[MAX_DELAY_LONG];
-    int far_history_pos;
     int max_delay_history_size;
 
     short fixedDelay;
@@ -127,7 +123,8 @@ typedef struct {
     short vadUpdateCount;
 
     int            *delayHistVect; //
-    int            *delayN;
+    int            *delayN;         // ring of the last win_slide delays
+    int            delayN_pos;      // oldest entry of delayN
     int            delay_nframe;
     int            delay_nsample;
     int            max_delay_size;  // short-term delay
@@ -300,6 +297,16 @@ Return:        // 0 - Ok
 **********************************************************************************/
 int dios_ssp_aec_tde_initcore(AecmCore_t * const srv);
 
+/**********************************************************************************
+Function:      // dios_ssp_aec_tde_corememory
+Description:   // Heap and struct memory of an instance created by
+                  dios_ssp_aec_tde_creatcore(), the shared fft tables excluded.
+Input:         // srv: Pointer to the instance.
+Output:        // none
+Return:        // Memory in bytes, -1 on error.
+**********************************************************************************/
+int dios_ssp_aec_tde_corememory(AecmCore_t *srv);
+
 /**********************************************************************************
 Function:      // dios_ssp_aec_tde_freecore
 Description:   // this function releases the memory allocated by
@@ -317,14 +324,16 @@ Function:      // dios_ssp_aec_tde_ProcessBlock
 Description:   // This function is called for every block within one frame
 Input:         // srv: Pointer to the AECM instance
                   farend: In buffer containing one block of echo signal
-                  nearendNoisy: In buffer containing one frame of nearend+echo
-                                signal without NS
-                  nearendClean: In buffer containing one frame of nearend+echo signal
-                                with NS
-Output:        // out: Out buffer, one block of nearend signal
-Return:        // none
+                  nearendNoisy: In buffer containing one block of nearend+echo
+                                signal without NS, NULL to reuse near_abs
+                  near_abs: near end magnitude spectrum of PART_LEN1 bins, written
+                            from nearendNoisy, or read as given when nearendNoisy
+                            is NULL so that two estimators fed the same near end
+                            blocks transform them once
+Output:        // near_abs: see above
+Return:        // 1 - a new delay was found, 0 - no new delay, -1 - Error
 **********************************************************************************/
-int dios_ssp_aec_tde_ProcessBlock(AecmCore_t * srv, float * farend, float * nearendNoisy);
+int dios_ssp_aec_tde_ProcessBlock(AecmCore_t * srv, float * farend, float * nearendNoisy, float * near_abs);
 
 int get_tde_final(AecmCore_t * srv);
 
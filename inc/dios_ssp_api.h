@@ -33,7 +33,10 @@ extern "C" {
 #include "./dios_ssp_doa/dios_ssp_doa_api.h"
 #include "./dios_ssp_gsc/dios_ssp_gsc_api.h"
 #include "./dios_ssp_dtln/dios_ssp_dtln_api.h"
+#include "./dios_ssp_dtln/dios_ssp_dtln_batch.h"
 
+/* zero the whole struct before filling it: every field from dtln_num_threads on
+   selects the default when 0, so callers that predate a field keep the old behaviour */
 typedef struct {
     short AEC_KEY;
     short NS_KEY;
@@ -48,15 +51,29 @@ typedef struct {
     PlaneCoord mic_coord[16];
     float loc_phi;
     const char *modelpath[DTLN_MODEL_NUM];
+    int dtln_num_threads;  // tflite threads per dtln model, 1 for dense multi-stream hosts
+    int dtln_delegate;     // DTLN_DELEGATE_NONE / DTLN_DELEGATE_XNNPACK
+    int dtln_pipeline;     // 1: run the two dtln models on two cores, +128 samples latency
+    int mvdr_inv_mode;     // MVDR_RNN_INV_DIRECT / MVDR_RNN_INV_RECURSIVE
+    int mvdr_update_groups;  // >1: recalculate 1/N of the mvdr weights per frame, 0 or 1: all
+    int doa_delta_angle;   // doa resolution in degrees, 0: DEFAULT_DOA_DELTA_ANGLE
+    int doa_coarse_angle;  // >0: scan the doa at this step first, then refine around the peak
+    int doa_engine;        // DOA_ENGINE_CAPON / DOA_ENGINE_SRP_PHAT
+    int doa_search_interval;  // >1: search the doa at most once per N frames, 0 or 1: every frame
+    int aec_engine;        // AEC_ENGINE_SUBBAND / AEC_ENGINE_PBFDAF
+    int aec_tail_ms;       // echo tail of AEC_ENGINE_PBFDAF in ms, 0: AEC_PBFDAF_DEFAULT_TAIL_MS
+    int aec_threads;       // >1: run the aec of the mics on N threads, 0 or 1: calling thread only
+    int aec_max_delay_ms;  // largest echo delay the aec searches in ms, 0: AEC_TDE_DEFAULT_DELAY_MS
 } objSSP_Param;
 
 /**********************************************************************************
 Function:      // dios_ssp_init_api
 Description:   // init with SSP_PARAM and allocate memory
-Input:         // SSP_PARAM: object of SSP with necessary parameters
+Input:         // SSP_PARAM: object of SSP with necessary parameters, zeroed before
+                             the fields are set
 Output:        // none
 Return:        // success: return dios speech signal process pointer
-                  failure: return NULL
+                  failure: return NULL, also when a module rejects its configuration
 **********************************************************************************/
 void* dios_ssp_init_api(objSSP_Param *SSP_PARAM);
 
@@ -20,10 +20,10 @@ limitations under the License.
 #include <stdio.h>
 #include "dios_ssp_return_defs.h"
 #include "dios_ssp_doa_macros.h"
-#include "dios_ssp_doa_win.h"
 #include "dios_ssp_share/dios_ssp_share_typedefs.h"
-#include "dios_ssp_share/dios_ssp_share_rfft.h"
-#include "dios_ssp_share/dios_ssp_share_cinv.h"
+#include "dios_ssp_share/dios_ssp_share_stft.h"
+#include "dios_ssp_share/dios_ssp_share_hsolve.h"
+#include "dios_ssp_share/dios_ssp_share_simd.h"
 
 typedef struct {
     int		m_fs;
@@ -40,35 +40,43 @@ typedef struct {
     float	m_low_frq;
     float	m_high_frq;
     int		m_frq_sp;
-    float	*m_capon_spectrum;
+    int		m_engine;  // DOA_ENGINE_CAPON / DOA_ENGINE_SRP_PHAT
+    float	*m_capon_spectrum;  // capon spectrum, or steered response power of srp-phat
     int     *m_doa_fid;
     int		m_low_fid;
-    float	*m_irxx_re;
+    float	*m_irxx_re;  // inverse of each analysis band, m_frq_bin_num * m_rxx_size
     float	*m_irxx_im;
-    float	*m_vec_re;
-    float	*m_vec_im;
-    float	*m_gstv_re;
-    float	*m_gstv_im;
+    // capon scan, a^H Rxx^-1 a = trace + sum_c m_gpair[c][angle] * m_irxx_pair[c] per band
+    int		m_pair_num;  // channel pairs i < j, m_channels*(m_channels-1)/2
+    int		m_pair_dim;  // 2 * m_pair_num columns, real parts then imaginary parts
+    float	*m_gpair;  // conj(a_i)*a_j of every band, m_frq_bin_num * m_pair_dim * m_angle_num
+    float	*m_gpair_coarse;  // the same at the coarse angles, m_frq_bin_num * m_pair_dim * m_coarse_num
+    float	*m_irxx_pair;  // 2*Re and -2*Im of the upper triangle of Rxx^-1 (phat weighted Rxx for srp-phat), m_pair_dim
+    float	*m_capon_q;  // a^H Rxx^-1 a of one band, m_angle_num
+    float	*m_capon_coarse;  // capon spectrum at the coarse angles, m_coarse_num
+    int		m_coarse_angle;  // 0: scan every angle, >0: scan this step first, then refine
+    int		m_coarse_ratio;
+    int		m_coarse_num;
+    // search scheduling
+    int		m_search_interval;  // min frames between two searches
+    int		m_search_wait;  // frames since the last search
+    int		m_search_count;  // searches run since reset
     int		m_frq_bin_width;
     // rxx
     int		m_rxx_size;
-    float	*m_rxx_in;
-    float	*m_irxx_out;
+    float	*m_rxx_band_re;  // band averaged rxx, m_frq_bin_num * m_rxx_size
+    float	*m_rxx_band_im;
     float	*m_rxx_re;
     float	*m_rxx_im;
-    float	*m_re;
-    float	*m_im;
-    float	*m_win_data;
-    float	*fft_out;
+    const float	*m_re;  // spectrum of the current frame
+    const float	*m_im;
     short	m_first_frame_flag;
     float	m_beta_rxx;
     float	m_alpha_rxx;
-    int		m_gstv_dim;
     PlaneCoord *cood;
-    void *doainv;
-    objDOACwin *doawin;
-    void *doa_fft;
-    float	**m_mch_buffer;
+    objHermSolve *hsolve;
+    objMchStft *stft;
+    int		m_stft_shared;  // stft belongs to the caller, see dios_ssp_doa_init_stft_api
 } objDOA;
 
 /**********************************************************************************
@@ -82,6 +90,21 @@ Return:        // success: return doa object pointer (void*)ptr_doa
 **********************************************************************************/
 void* dios_ssp_doa_init_api(int mic_num, PlaneCoord* mic_coord);
 
+/**********************************************************************************
+Function:      // dios_ssp_doa_init_stft_api
+Description:   // doa init reading the microphone spectrum of a stft owned by the
+                  caller, no stft of its own is allocated; the caller processes and
+                  resets the stft and runs the doa with dios_ssp_doa_process_stft_api
+Input:         // sensor_num: microphone number
+				  cood: micphone coordinate
+				  stft: DEFAULT_DOA_WIN_SIZE fft, DEFAULT_DOA_SHIFT_SIZE hop and
+				        sensor_num channels, NULL: same as dios_ssp_doa_init_api
+Output:        // none
+Return:        // success: return doa object pointer (void*)ptr_doa
+				  failure: return NULL
+**********************************************************************************/
+void* dios_ssp_doa_init_stft_api(int mic_num, PlaneCoord* mic_coord, objMchStft *stft);
+
 /**********************************************************************************
 Function:      // dios_ssp_doa_reset_api
 Description:   // doa reset
@@ -93,7 +116,7 @@ int dios_ssp_doa_reset_api(void *ptr);
 
 /**********************************************************************************
 Function:      // dios_ssp_doa_process_api
-Description:   // doa process
+Description:   // doa process, not for a doa created with a stft of the caller
 Input:         // ptr
 			   // in: microphone data
 			   // vad_result: vad result
@@ -103,6 +126,70 @@ Return:        // success: return doa result
 **********************************************************************************/
 float dios_ssp_doa_process_api(void* ptr, float* in, int vad_result, int dt_st);
 
+/**********************************************************************************
+Function:      // dios_ssp_doa_process_stft_api
+Description:   // doa process on a spectrum computed by the caller, lets doa and
+                  mvdr share one stft of the microphones
+Input:         // ptr
+			   // stft: microphone spectrum of this frame, DEFAULT_DOA_WIN_SIZE
+			   //       fft and DEFAULT_DOA_SHIFT_SIZE hop
+			   // vad_result: vad result
+			   // dt_st: double talk result
+Output:        // none
+Return:        // success: return doa result
+**********************************************************************************/
+float dios_ssp_doa_process_stft_api(void* ptr, const objMchStft *stft, int vad_result, int dt_st);
+
+/**********************************************************************************
+Function:      // dios_ssp_doa_config_api
+Description:   // set the angular resolution of the doa scan, call after init
+Input:         // ptr
+			   // delta_angle: scan step in degrees, must divide 360
+			   // coarse_angle: 0 scans every angle; otherwise a multiple of
+			   //       delta_angle dividing 360, the spectrum is first scanned
+			   //       at this step and then at delta_angle around the peak
+Output:        // none
+Return:        // success: return 0
+				  failure: return ERROR_DOA
+**********************************************************************************/
+int dios_ssp_doa_config_api(void *ptr, int delta_angle, int coarse_angle);
+
+/**********************************************************************************
+Function:      // dios_ssp_doa_engine_config_api
+Description:   // select the doa estimator, call after init
+Input:         // ptr
+			   // engine: DOA_ENGINE_CAPON (default), or DOA_ENGINE_SRP_PHAT which
+			   //       sums the phat weighted cross spectra of all microphone pairs
+			   //       and inverts no matrix
+Output:        // none
+Return:        // success: return 0
+				  failure: return ERROR_DOA
+**********************************************************************************/
+int dios_ssp_doa_engine_config_api(void *ptr, int engine);
+
+/**********************************************************************************
+Function:      // dios_ssp_doa_update_config_api
+Description:   // set how often the doa search runs, call after init. the covariance
+                  is updated every frame; the search runs only on frames whose result
+                  is kept (vad_result == 1 or dt_st != 1) and at most once per interval
+Input:         // ptr
+			   // interval: min frames between two searches, 1 (default) allows every frame
+Output:        // none
+Return:        // success: return 0
+				  failure: return ERROR_DOA
+**********************************************************************************/
+int dios_ssp_doa_update_config_api(void *ptr, int interval);
+
+/**********************************************************************************
+Function:      // dios_ssp_doa_search_count_get
+Description:   // number of frames that ran the doa search since the last reset
+Input:         // ptr
+Output:        // none
+Return:        // success: return the search count
+				  failure: return ERROR_DOA
+**********************************************************************************/
+int dios_ssp_doa_search_count_get(void *ptr);
+
 /**********************************************************************************
 Function:      // dios_ssp_doa_uninit_api
 Description:   // doa free
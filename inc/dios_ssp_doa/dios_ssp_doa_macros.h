@@ -28,6 +28,12 @@ limitations under the License.
 #define	DEFAULT_DOA_FRQ_SP			200
 #define	DEFAULT_DOA_EPS				1073
 #define	DEFAULT_DOA_ALPHA_RXX		(0.9f)
+#define	DEFAULT_DOA_DIAG_LOADING	(0.000001f)
+#define	DEFAULT_DOA_SEARCH_INTERVAL	1
+
+// doa estimator
+#define DOA_ENGINE_CAPON			0
+#define DOA_ENGINE_SRP_PHAT			1
 
 #endif /* _DIOS_SSP_DOA_MACROS_H_ */
 
@@ -29,11 +29,37 @@ Function:      // dios_ssp_dtln_init_api
 Description:   // init dtln module
 Input:         // modelpath: path of dtln model
                   frame_len: frame length
+                  num_threads: tflite interpreter threads, <= 0 means 1
+                  delegate: DTLN_DELEGATE_NONE or DTLN_DELEGATE_XNNPACK, falls
+                            back to the builtin kernels if it cannot be applied
 Output:        // none
 Return:        // success: return dtln module pointer
                   failure: return NULL
 **********************************************************************************/
-void* dios_ssp_dtln_init_api(const char *modelpath[], int frame_len);
+void* dios_ssp_dtln_init_api(const char *modelpath[], int frame_len, int num_threads, int delegate);
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_config_api
+Description:   // config dtln module
+Input:         // ptr: dtln module pointer
+                  pipeline: 1: run model_2 on a worker thread while model_1
+                               processes the next hop, adds one hop
+                               (DTLN_FRAME_SHIFT samples) of latency and
+                               resets the module when switched off
+                            0: run both models back to back (default)
+Output:        // none
+Return:        // success: return 0, failure: return ERROR_DTLN
+**********************************************************************************/
+int dios_ssp_dtln_config_api(void* ptr, int pipeline);
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_latency_get
+Description:   // get the algorithmic latency of the dtln module
+Input:         // ptr: dtln module pointer
+Output:        // none
+Return:        // success: return latency in samples, failure: return -1
+**********************************************************************************/
+int dios_ssp_dtln_latency_get(void* ptr);
 
 /**********************************************************************************
 Function:      // dios_ssp_dtln_reset_api
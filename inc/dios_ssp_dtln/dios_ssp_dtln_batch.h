@@ -0,0 +1,72 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef _DIOS_SSP_DTLN_BATCH_H_
+#define _DIOS_SSP_DTLN_BATCH_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "dios_ssp_dtln_macros.h"
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_batch_init_api
+Description:   // init a batched dtln engine serving up to max_streams independent
+                  streams with one pair of interpreters, float32 models only
+Input:         // modelpath: path of dtln model
+                  frame_len: frame length of every stream
+                  max_streams: maximum number of streams
+Output:        // none
+Return:        // success: return dtln batch engine pointer
+                  failure: return NULL
+**********************************************************************************/
+void* dios_ssp_dtln_batch_init_api(const char *modelpath[], int frame_len, int max_streams);
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_batch_reset_api
+Description:   // reset one stream of the batch engine, e.g. when a new call
+                  takes over the slot
+Input:         // ptr: dtln batch engine pointer
+                  stream: stream index, 0 ~ max_streams-1
+Output:        // none
+Return:        // success: return 0, failure: return ERROR_DTLN
+**********************************************************************************/
+int dios_ssp_dtln_batch_reset_api(void *ptr, int stream);
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_batch_process
+Description:   // ns process one frame of several streams, the pending hops of all
+                  streams are run through each model with a single invoke
+Input:         // ptr: dtln batch engine pointer
+                  in_data: in_data[i] is the input and output frame of stream i,
+                           NULL if stream i has no data in this round
+                  stream_num: number of entries in in_data, <= max_streams
+Output:        //
+Return:        // success: return 0, failure: return ERROR_DTLN
+**********************************************************************************/
+int dios_ssp_dtln_batch_process(void *ptr, float *in_data[], int stream_num);
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_batch_uninit_api
+Description:   // free dtln batch engine and all of its streams
+Input:         // ptr: dtln batch engine pointer
+Output:        // none
+Return:        // success: return 0, failure: return ERROR_DTLN
+**********************************************************************************/
+int dios_ssp_dtln_batch_uninit_api(void *ptr);
+
+#endif  /* _DIOS_SSP_DTLN_BATCH_H_ */
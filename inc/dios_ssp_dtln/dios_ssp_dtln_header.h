@@ -0,0 +1,270 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef _DIOS_SSP_DTLN_HEADER_H_
+#define _DIOS_SSP_DTLN_HEADER_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include "../dios_ssp_share/dios_ssp_share_rfft.h"
+#include "../dios_ssp_share/dios_ssp_share_ringbuf.h"
+#include "dios_ssp_dtln_macros.h"
+#include "dios_ssp_dtln_model.h"
+#ifdef DTLN_USE_XNNPACK
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#endif
+
+// a model input/output bound in place, scale and zero_point are only used
+// by int8 tensors: real_value = scale * (quantized_value - zero_point)
+typedef struct {
+    void *data;
+    TfLiteType type;
+    float scale;
+    float inv_scale;
+    int zero_point;
+} objDTLNTensor;
+
+typedef struct {
+    int frame_len;
+    int m_shift_size;
+    int m_fft_size;
+    int m_frame_sum;
+    int m_sp_size;
+    objRingBuf *m_wav_ring;    // input samples not yet consumed by a hop
+    objOlaBuf *m_out_ola;      // overlap-added output
+    float *m_win_wav;
+    float* m_re;
+    float* m_im;
+
+    //anaylsis window & synthesis window
+    float *m_ana_win;
+    float *m_syn_win;
+    float *m_norm_win;
+
+    //stft_process & istft_process
+    float *fftin_buffer;
+    float *fft_out;
+    void *rfft_param;
+
+    float *m_dtln_out_data;
+
+    // dtln
+    float states[DTLN_MODEL_NUM][DTLN_FRAME_SIZE];
+
+    TfLiteTensor *inDetails[DTLN_MODEL_NUM][2];
+    const TfLiteTensor *outDetails[DTLN_MODEL_NUM][2];
+
+    TfLiteInterpreter *interpreter[DTLN_MODEL_NUM];
+    const TfLiteModel *model[DTLN_MODEL_NUM];  // shared, see dios_ssp_dtln_model
+
+    TfLiteDelegate *delegate[DTLN_MODEL_NUM];
+
+    // zero-copy binding: tensor arena buffers used directly by the hot loop
+    objDTLNTensor m_in[DTLN_MODEL_NUM][2];
+    objDTLNTensor m_out[DTLN_MODEL_NUM][2];
+
+    float *m_mag;
+
+    // pipelined mode: model_2 runs on a worker thread one hop behind model_1
+    int m_pipeline;
+    int m_ola_delay;           // extra output delay in samples, one hop when pipelined
+    pthread_t m_pipe_thread;
+    pthread_mutex_t m_pipe_lock;
+    pthread_cond_t m_pipe_cond;
+    int m_pipe_busy;           // worker owns m_pipe_in/out[m_pipe_slot]
+    int m_pipe_quit;
+    int m_pipe_pending;        // finished hop waiting for overlap-add
+    int m_pipe_slot;
+    int m_pipe_pos;            // overlap-add position of the pending hop
+    int m_pipe_error;          // model_2 failed on the worker since the last check
+    float *m_pipe_in[2];
+    float *m_pipe_out[2];
+} objDTLN;
+
+/**********************************************************************************
+Function:      // dtln_create
+Description:   // allocate the stft buffers of one dtln stream, no model is loaded
+Input:         // frame_len: frame length
+Output:        // none
+Return:        // success: return dtln object pointer
+                  failure: return NULL
+**********************************************************************************/
+objDTLN* dtln_create(int frame_len);
+
+/**********************************************************************************
+Function:      // dtln_check_tensor
+Description:   // check that a tensor is float32 with len elements per batch row
+Input:         // tensor: tflite tensor
+                  len: number of floats per batch row
+                  batch: batch size
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dtln_check_tensor(const TfLiteTensor *tensor, int len, int batch);
+
+/**********************************************************************************
+Function:      // dtln_store_tensor
+Description:   // write floats to a bound tensor, quantizing to its type
+Input:         // t: bound tensor
+                  x: len float values
+Output:        // none
+Return:        // none
+**********************************************************************************/
+void dtln_store_tensor(const objDTLNTensor *t, const float *x, int len);
+
+/**********************************************************************************
+Function:      // dtln_load_tensor
+Description:   // read a bound tensor as floats, dequantizing from its type
+Input:         // t: bound tensor
+Output:        // x: len float values
+Return:        // none
+**********************************************************************************/
+void dtln_load_tensor(const objDTLNTensor *t, float *x, int len);
+
+/**********************************************************************************
+Function:      // dtln_copy_tensor
+Description:   // copy len values between bound tensors, converting the type if needed
+Input:         // src: bound tensor
+                  tmp: len floats of scratch
+Output:        // dst: bound tensor
+Return:        // none
+**********************************************************************************/
+void dtln_copy_tensor(const objDTLNTensor *dst, const objDTLNTensor *src, int len, float *tmp);
+
+/**********************************************************************************
+Function:      // dtln_bind_float
+Description:   // describe a plain float buffer as a bound tensor
+Input:         // data: float buffer
+Output:        // dst: bound tensor
+Return:        // none
+**********************************************************************************/
+void dtln_bind_float(objDTLNTensor *dst, float *data);
+
+/**********************************************************************************
+Function:      // dtln_push_input
+Description:   // append one frame of input to the analysis buffer
+Input:         // srv: dtln object pointer
+                  in_data: frame_len input samples
+Output:        // none
+Return:        // success: return 0, failure (buffer full, frame dropped): return -1
+**********************************************************************************/
+int dtln_push_input(objDTLN* srv, const float *in_data);
+
+/**********************************************************************************
+Function:      // dtln_analysis
+Description:   // window and fft the hop at sta, keep the spectrum in m_re/m_im
+                  and compute its magnitude
+Input:         // srv: dtln object pointer
+                  sta: hop start in m_wav_ring
+Output:        // mag: m_sp_size magnitudes in the tensor type, input of model_1
+Return:        // none
+**********************************************************************************/
+void dtln_analysis(objDTLN* srv, int sta, const objDTLNTensor *mag);
+
+/**********************************************************************************
+Function:      // dtln_synthesis
+Description:   // apply the model_1 mask to the spectrum of dtln_analysis and ifft
+                  back to the time domain
+Input:         // srv: dtln object pointer
+                  mask: model_1 output
+Output:        // time_in: m_fft_size samples in the tensor type, input of model_2
+Return:        // none
+**********************************************************************************/
+void dtln_synthesis(objDTLN* srv, const objDTLNTensor *mask, const objDTLNTensor *time_in);
+
+/**********************************************************************************
+Function:      // dtln_overlap_add
+Description:   // add synthesis window and overlap-add the model_2 output
+Input:         // srv: dtln object pointer
+                  sta: hop start in m_out_ola
+                  time_out: model_2 output
+Output:        // none
+Return:        // none
+**********************************************************************************/
+void dtln_overlap_add(objDTLN* srv, int sta, const objDTLNTensor *time_out);
+
+/**********************************************************************************
+Function:      // dtln_pop_output
+Description:   // emit the finished samples and drop the consumed history
+Input:         // srv: dtln object pointer
+                  sta: number of consumed samples
+Output:        // out_data: sta output samples
+Return:        // none
+**********************************************************************************/
+void dtln_pop_output(objDTLN* srv, int sta, float *out_data);
+
+/**********************************************************************************
+Function:      // dtln_invoke
+Description:   // run model i on its bound input and carry the lstm states over
+Input:         // srv: dtln object pointer
+                  i: model index
+Output:        // none
+Return:        // success: return 0, failure: return -1 when a tensor copy or the
+                  invoke fails
+**********************************************************************************/
+int dtln_invoke(objDTLN* srv, int i);
+
+/**********************************************************************************
+Function:      // dtln_pipeline_start
+Description:   // start the model_2 worker thread and switch to pipelined mode
+Input:         // srv: dtln object pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dtln_pipeline_start(objDTLN* srv);
+
+/**********************************************************************************
+Function:      // dtln_pipeline_process
+Description:   // pipelined dtln_process, model_1 of hop t+1 overlaps model_2 of hop t
+Input:         // srv: dtln object pointer
+                  in_data: frame_len input samples
+Output:        // out_data: frame_len output samples, one hop later than unpipelined
+Return:        // success: return 0, failure: return -1 when a model failed on a hop
+**********************************************************************************/
+int dtln_pipeline_process(objDTLN* srv, float *in_data, float *out_data);
+
+/**********************************************************************************
+Function:      // dtln_pipeline_reset
+Description:   // wait for the worker and drop the hop in flight
+Input:         // srv: dtln object pointer
+Output:        // none
+Return:        // none
+**********************************************************************************/
+void dtln_pipeline_reset(objDTLN* srv);
+
+/**********************************************************************************
+Function:      // dtln_pipeline_stop
+Description:   // stop and join the worker thread, free the pipeline buffers
+Input:         // srv: dtln object pointer
+Output:        // none
+Return:        // none
+**********************************************************************************/
+void dtln_pipeline_stop(objDTLN* srv);
+
+/**********************************************************************************
+Function:      // dtln_delete
+Description:   // free dtln object, release its interpreters and models
+Input:         // srv: dtln object pointer
+Output:        // none
+Return:        // none
+**********************************************************************************/
+void dtln_delete(objDTLN* srv);
+
+#endif  /* _DIOS_SSP_DTLN_HEADER_H_ */
@@ -23,5 +23,10 @@ limitations under the License.
 #define DTLN_FFTOUT_SIZE (DTLN_FRAME_SIZE/2 + 1)
 #define DTLN_MODEL_NUM   (2)
 
+// tflite delegate, XNNPACK needs the library built with -DDTLN_USE_XNNPACK,
+// otherwise or when the graph cannot be delegated the builtin kernels are used
+#define DTLN_DELEGATE_NONE    (0)
+#define DTLN_DELEGATE_XNNPACK (1)
+
 #endif /* _DIOS_SSP_NS_MACROS_H_ */
 
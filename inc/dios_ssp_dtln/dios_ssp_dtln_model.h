@@ -0,0 +1,48 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef _DIOS_SSP_DTLN_MODEL_H_
+#define _DIOS_SSP_DTLN_MODEL_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "tflite/c_api.h"
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_model_acquire
+Description:   // get a shared tflite model from the process-wide registry,
+                  models are keyed by path and the stat fingerprint of the file,
+                  the first call reads and parses the file, later calls only
+                  stat it and add a reference
+Input:         // modelpath: path of tflite model
+Output:        // none
+Return:        // success: return read-only model pointer
+                  failure: return NULL
+**********************************************************************************/
+const TfLiteModel* dios_ssp_dtln_model_acquire(const char *modelpath);
+
+/**********************************************************************************
+Function:      // dios_ssp_dtln_model_release
+Description:   // drop one reference, the model is deleted with the last one
+Input:         // model: model pointer returned by dios_ssp_dtln_model_acquire
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_dtln_model_release(const TfLiteModel *model);
+
+#endif  /* _DIOS_SSP_DTLN_MODEL_H_ */
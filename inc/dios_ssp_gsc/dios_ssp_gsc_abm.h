@@ -21,6 +21,7 @@ limitations under the License.
 #include "dios_ssp_gsc_globaldefs.h"
 #include "../dios_ssp_share/dios_ssp_share_rfft.h"
 #include "../dios_ssp_share/dios_ssp_share_complex_defs.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
 
 typedef struct {
     int nmic;        /* number of microphones */
@@ -35,7 +36,9 @@ typedef struct {
     int count_sigsegments;  /* counter for input signal segments */
     float **Xdline;  /* delayline of beamsteering output for causality */
     float *xrefdline;  /* delayline for adaptive filter input */
-    xcomplex *xfref; /* frequency-domain adaptive filter input */
+    xcomplex **xfref; /* frequency-domain adaptive filter inputs, per channel */
+    float **xfref_re; /* real and imaginary parts of xfref rows for the batched fft */
+    float **xfref_im;
     xcomplex **hf;   /* adaptive filter transfer functions */
     float *ytmp;     /* temporary signal buffer in time domain */
     xcomplex *yftmp; /* temporary signal buffer in frequency domain */
@@ -22,6 +22,7 @@ limitations under the License.
 #include "dios_ssp_gsc_dsptools.h"
 #include "../dios_ssp_share/dios_ssp_share_rfft.h"
 #include "../dios_ssp_share/dios_ssp_share_complex_defs.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
 
 typedef struct {
     WORD m_wNumMic;        /* number of microphones */
@@ -45,6 +46,8 @@ typedef struct {
     float **m_ppXrefDline;   /* delayline for reference signal synchronization im time domain */
     float *m_pXfbfDline;     /* delayline for fixed beamformer output */
     xcomplex **m_ppcfXref;   /* reference signals in the frequency domain */
+    float **m_ppfXrefRe;     /* real and imaginary parts of m_ppcfXref rows for the batched fft */
+    float **m_ppfXrefIm;
     xcomplex *m_pcfXcfbf;    /* complementary fbf output in frequency domain */
     xcomplex *m_pcfXfbf;     /* FBF output in frequency domain */
 
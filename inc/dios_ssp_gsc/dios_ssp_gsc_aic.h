@@ -22,6 +22,7 @@ limitations under the License.
 #include "dios_ssp_gsc_globaldefs.h"
 #include "../dios_ssp_share/dios_ssp_share_rfft.h"
 #include "../dios_ssp_share/dios_ssp_share_complex_defs.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
 
 typedef struct {
     int nmic;        /* number of microphones */
@@ -45,6 +46,8 @@ typedef struct {
     xcomplex ***Xfbdline;   /* block delay line for partitioned block adaptive filter input */
     float **Xdline;         /* block delay line for filter inputs in time domain */
     xcomplex **Xffilt;      /* adaptive filter input signal */
+    float **Xffilt_re;      /* real and imaginary parts of Xffilt rows for the batched fft */
+    float **Xffilt_im;
     xcomplex *yftmp; /* temporary vector in frequency domain */
     float *ytmp;     /* temporary vector in time domain */
     xcomplex *yhf;   /* adaptive filter output in frequency domain */
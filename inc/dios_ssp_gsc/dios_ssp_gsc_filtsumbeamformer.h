@@ -27,7 +27,9 @@ typedef struct {
     int fftoverlap;  /* overlap factor of FFT */
     int filtord;     /* filter order */
     float **Xdline;  /* delayline for FBF inputs in time domain */
-    xcomplex *xftmp; /* temporary buffer in frequency domain */
+    xcomplex **xftmp; /* fbf inputs in frequency domain, per channel */
+    float **xftmp_re; /* real and imaginary parts of xftmp rows for the batched fft */
+    float **xftmp_im;
     float *ytmp;     /* temporary buffer in time domain */
     xcomplex *yftmp; /* temporary buffer in frequency domain */
 
@@ -31,6 +31,21 @@ Return:        // success: return mvdr object pointer (void*)ptr_mvdr
 **********************************************************************************/
 void* dios_ssp_mvdr_init_api(int mic_num, void* mic_coord);
 
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_init_stft_api
+Description:   // mvdr init reading the microphone spectrum of a stft owned by the
+                  caller, no stft of its own is allocated; the caller processes and
+                  resets the stft and runs the mvdr with dios_ssp_mvdr_process_stft_api
+Input:         // mic_num: microphone number
+				  mic_coord: each microphone coordinate (PlaneCoord*)mic_coord
+                  stft: DEFAULT_MVDR_WIN_SIZE fft, DEFAULT_MVDR_SHIFT_SIZE hop and
+                        mic_num channels, NULL: same as dios_ssp_mvdr_init_api
+Output:        // none
+Return:        // success: return mvdr object pointer (void*)ptr_mvdr
+                  failure: return NULL
+**********************************************************************************/
+void* dios_ssp_mvdr_init_stft_api(int mic_num, void* mic_coord, objMchStft *stft);
+
 /**********************************************************************************
 Function:      // dios_ssp_mvdr_reset_api
 Description:   // mvdr reset
@@ -40,9 +55,45 @@ Return:        // success: return 0, failure: return ERROR_MVDR
 **********************************************************************************/
 int dios_ssp_mvdr_reset_api(void *ptr);
 
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_config_api
+Description:   // config mvdr module
+Input:         // ptr: mvdr object pointer
+                  inv_mode: MVDR_RNN_INV_DIRECT: factor every Rnn each frame (default)
+                            MVDR_RNN_INV_RECURSIVE: track Rnn^-1 with rank one
+                            updates, re-inverted every DEFAULT_MVDR_INV_REFRESH
+                            frames, for arrays with many microphones
+Output:        // none
+Return:        // success: return 0, failure: return ERROR_MVDR
+**********************************************************************************/
+int dios_ssp_mvdr_config_api(void *ptr, int inv_mode);
+
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_update_config_api
+Description:   // config how often the mvdr weights are recalculated
+Input:         // ptr: mvdr object pointer
+                  groups: 1: recalculate every bin each frame (default)
+                          N: recalculate 1/N of the bins each frame in turn and
+                             reuse the others, every bin is recalculated when the
+                             steering changes or the noise power moves by more
+                             than DEFAULT_MVDR_UPDATE_THRES
+Output:        // none
+Return:        // success: return 0, failure: return ERROR_MVDR
+**********************************************************************************/
+int dios_ssp_mvdr_update_config_api(void *ptr, int groups);
+
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_update_bins_get
+Description:   // number of bins whose weights were recalculated on the last frame
+Input:         // ptr: mvdr object pointer
+Output:        // none
+Return:        // success: return bin number, failure: return ERROR_MVDR
+**********************************************************************************/
+int dios_ssp_mvdr_update_bins_get(void *ptr);
+
 /**********************************************************************************
 Function:      // dios_ssp_mvdr_process_api
-Description:   // mvdr process
+Description:   // mvdr process, not for a mvdr created with a stft of the caller
 Input:         // ptr: mvdr object pointer
                   mic_data: mvdr input data, data type is float
                   loc_phi: direction of wakeup
@@ -51,6 +102,19 @@ Return:        // success: return 0, failure: return ERROR_MVDR
 **********************************************************************************/
 int dios_ssp_mvdr_process_api(void* ptr, float* mic_data, float* out_data, float loc_phi);
 
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_process_stft_api
+Description:   // mvdr process on a spectrum computed by the caller, lets doa and
+                  mvdr share one stft of the microphones
+Input:         // ptr: mvdr object pointer
+                  stft: microphone spectrum of this frame, DEFAULT_MVDR_WIN_SIZE
+                        fft and DEFAULT_MVDR_SHIFT_SIZE hop
+                  loc_phi: direction of wakeup
+Output:        // out_data: mvdr output signal
+Return:        // success: return 0, failure: return ERROR_MVDR
+**********************************************************************************/
+int dios_ssp_mvdr_process_stft_api(void* ptr, const objMchStft *stft, float* out_data, float loc_phi);
+
 /**********************************************************************************
 Function:      // dios_ssp_mvdr_uninit_api
 Description:   // mvdr delete
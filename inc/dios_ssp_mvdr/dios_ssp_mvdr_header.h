@@ -25,7 +25,9 @@ limitations under the License.
 #include "dios_ssp_mvdr_win.h"
 #include "../dios_ssp_share/dios_ssp_share_typedefs.h"
 #include "../dios_ssp_share/dios_ssp_share_rfft.h"
-#include "../dios_ssp_share/dios_ssp_share_cinv.h"
+#include "../dios_ssp_share/dios_ssp_share_stft.h"
+#include "../dios_ssp_share/dios_ssp_share_hsolve.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
 
 typedef struct {
     int		m_fs;
@@ -51,10 +53,11 @@ typedef struct {
     int		m_frame_sum;
 
     // buffer
-    float	**m_mch_buffer;
+    objMchStft	*stft;
+    int		m_stft_shared;  // stft belongs to the caller, see dios_ssp_mvdr_init_stft_api
     float	*m_win_data;
-    float	*m_re;
-    float	*m_im;
+    const float	*m_re;  // spectrum of the current frame
+    const float	*m_im;
     float	*m_re_temp;
     float	*m_im_temp;
 
@@ -67,14 +70,28 @@ typedef struct {
 
     // rxx
     int		m_rxx_size;
-    float	*m_rxx_in;
-    float	*m_irxx_out;
+    objHermSolve	*hsolve;
 
     // rnn
     float	*m_rnn_re;
     float	*m_rnn_im;
+
+    // recursive rnn inverse, full hermitian matrices
+    int		m_inv_mode;
+    int		m_inv_refresh;  // frames between two exact inversions
+    int		m_inv_count;
     float	*m_irnn_re;
     float	*m_irnn_im;
+    float	*m_pu_re;  // Rnn^-1 * xn of one bin
+    float	*m_pu_im;
+
+    // weight update schedule
+    int		m_update_groups;  // bins are refreshed in this many groups, one group per frame
+    int		m_update_group;   // group refreshed next
+    int		m_update_full;    // steering changed, refresh every bin on the next frame
+    float	m_update_thres;   // relative noise power change that refreshes every bin
+    float	m_update_power;   // noise power at the last full refresh
+    int		m_update_bins;    // bins refreshed on the last frame
 
     // capon spectrum
     int		m_angle_pre;
@@ -90,7 +107,6 @@ typedef struct {
 
     // mcra
     float	*m_ns_ps_cur_mic;
-    float	*m_ns_theta_cur_mic;
     float	*m_ns_ps;
     float	*m_P;
     float	*m_Ptmp;
@@ -104,14 +120,12 @@ typedef struct {
 
     float	*m_mvdr_out_re;
     float	*m_mvdr_out_im;
-    float	*m_out_bf;
+    objOlaBuf	*m_out_ola;
 
     PlaneCoord *cood;
     objMVDRCwin *mvdrwin;
-    void *mvdrinv;
     void *mvdr_fft;
     float *fft_in;
-    float *fft_out;
     float* dist;
 } objMVDR;
 
@@ -121,11 +135,12 @@ Description:   // mvdr init
 Input:         // ptr_mvdr:
 				  sensor_num: microphone number
 				  cood: micphone coordinate
+				  stft: stft of the caller, NULL to allocate one
 Output:        // none
-Return:        // success: return mvdr object pointer (void*)ptr_mvdr
-				  failure: return NULL
+Return:        // success: return 0
+				  failure: return -1
 **********************************************************************************/
-void dios_ssp_mvdr_init(objMVDR *ptr_mvdr, int sensor_num, PlaneCoord* cood);
+int dios_ssp_mvdr_init(objMVDR *ptr_mvdr, int sensor_num, PlaneCoord* cood, objMchStft *stft);
 
 /**********************************************************************************
 Function:      // dios_ssp_mvdr_reset
@@ -147,6 +162,16 @@ Output:        // out: mvdr process result
 **********************************************************************************/
 int dios_ssp_mvdr_process(objMVDR *ptr_mvdr, float* in, float* out, int angle);
 
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_process_stft
+Description:   // mvdr process on a spectrum computed by the caller
+Input:         // ptr_mvdr:
+				  stft: microphone spectrum of this frame
+				  angle: micphone sound source angle
+Output:        // out: mvdr process result
+**********************************************************************************/
+int dios_ssp_mvdr_process_stft(objMVDR *ptr_mvdr, const objMchStft *stft, float* out, int angle);
+
 /**********************************************************************************
 Function:      // dios_ssp_mvdr_mcra
 Description:   // mcra process
@@ -167,15 +192,40 @@ Return:        // success: return 0
 **********************************************************************************/
 int dios_ssp_mvdr_cal_rxx(objMVDR *ptr_mvdr);
 
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_update_irnn
+Description:   // rank one update of the tracked Rnn^-1 after dios_ssp_mvdr_cal_rxx,
+                  Rnn^-1 is inverted exactly on the first frame and every
+                  m_inv_refresh frames so the rounding error and the decay of the
+                  m_rnn_eps loading do not accumulate
+Input:         // ptr_mvdr:
+Output:        // none
+Return:        // success: return 0
+**********************************************************************************/
+int dios_ssp_mvdr_update_irnn(objMVDR *ptr_mvdr);
+
 /**********************************************************************************
 Function:      // dios_ssp_mvdr_cal_weights_adpmvdr
 Description:   // calculate mvdr adaptive weight
 Input:         // ptr_mvdr:
+				  bin_start: first bin to calculate, at least 1
+				  bin_num: number of bins
 Output:        // none
 Return:        // success: return 0
 				  failure: return NULL
 **********************************************************************************/
-int dios_ssp_mvdr_cal_weights_adpmvdr(objMVDR *ptr_mvdr);
+int dios_ssp_mvdr_cal_weights_adpmvdr(objMVDR *ptr_mvdr, int bin_start, int bin_num);
+
+/**********************************************************************************
+Function:      // dios_ssp_mvdr_update_weights
+Description:   // refresh the weights of one group of bins per frame and keep the
+				  others, every bin is refreshed when the steering changes or the
+				  noise power moves by more than m_update_thres
+Input:         // ptr_mvdr:
+Output:        // none
+Return:        // success: return 0
+**********************************************************************************/
+int dios_ssp_mvdr_update_weights(objMVDR *ptr_mvdr);
 
 /**********************************************************************************
 Function:      // dios_ssp_mvdr_delete
@@ -32,6 +32,13 @@ limitations under the License.
 #define DEFAULT_MVDR_ALPHA_D            (0.95f)
 #define DEFAULT_MVDR_L                  50
 #define DEFAULT_MVDR_DELTA_THRES        1.5
+#define DEFAULT_MVDR_DIAG_LOADING       (0.000001f)
+#define DEFAULT_MVDR_INV_REFRESH        64
+#define DEFAULT_MVDR_UPDATE_THRES       (0.5f)
+
+// how the weights get Rnn^-1
+#define MVDR_RNN_INV_DIRECT             0   // factor every Rnn each frame, O(M^3) per bin
+#define MVDR_RNN_INV_RECURSIVE          1   // track Rnn^-1 with the matrix inversion lemma, O(M^2) per bin
 
 #endif /* _DIOS_SSP_MVDR_MACROS_H_ */
 
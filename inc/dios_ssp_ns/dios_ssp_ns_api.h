@@ -22,6 +22,7 @@ limitations under the License.
 #include <stdlib.h>
 #include <math.h>
 #include "../dios_ssp_share/dios_ssp_share_rfft.h"
+#include "../dios_ssp_share/dios_ssp_share_ringbuf.h"
 #include "dios_ssp_ns_macros.h"
 
 /**********************************************************************************
@@ -31,40 +31,113 @@ typedef fcomplex xcomplex;
 #define DIOS_SSP_WORD16_MAX       32767
 #define DIOS_SSP_WORD16_MIN       -32768
 
-float xsqrt(float x);
-float xmax(float x, float y);
-float xmin(float x, float y);
-float xabs(float x);
-float xsmooth_proc(float y, float rate, float x);
+// scalar and complex element operations are defined here, inline, so that the
+// per element loops of the modules compile without a call per element
+static inline float xsqrt(float x)
+{
+    return((float)sqrt(x));
+}
+static inline float xmax(float x, float y)
+{
+    return((((x) > y)) ? (x) : (y));
+}
+static inline float xmin(float x, float y)
+{
+    return(((x) < (y)) ? (x) : (y));
+}
+static inline float xabs(float x)
+{
+    return((float)fabs(x));
+}
+static inline float xsmooth_proc(float y, float rate, float x)
+{
+    y += ((rate) * ((x)-y));
+    return(y);
+}
 
 float xsmooth_factor(float st);
 
 // complex generation
-xcomplex complex_gen(float re, float im);
+static inline xcomplex complex_gen(float re, float im)
+{
+    xcomplex c;
+
+    c.r = re;
+    c.i = im;
+
+    return c;
+}
 
 // complex conjugation
-xcomplex complex_conjg(xcomplex z);
+static inline xcomplex complex_conjg(xcomplex z)
+{
+    xcomplex c;
+
+    c.r = z.r;
+    c.i = -z.i;
+
+    return c;
+}
 
 // complex abs
 float complex_abs(xcomplex z);
 
 // complex number absolute value square
-float complex_abs2(xcomplex cp);
+static inline float complex_abs2(xcomplex cp)
+{
+    float y;
+
+    y = cp.r * cp.r + cp.i * cp.i;
+
+    return (y);
+}
 
 // complex sqrt
 xcomplex complex_sqrt(xcomplex z);
 
 // complex addition
-xcomplex complex_add(xcomplex a, xcomplex b);
+static inline xcomplex complex_add(xcomplex a, xcomplex b)
+{
+    xcomplex c;
+
+    c.r = a.r + b.r;
+    c.i = a.i + b.i;
+
+    return c;
+}
 
 // complex subtraction
-xcomplex complex_sub(xcomplex a, xcomplex b);
+static inline xcomplex complex_sub(xcomplex a, xcomplex b)
+{
+    xcomplex c;
+
+    c.r = a.r - b.r;
+    c.i = a.i - b.i;
+
+    return c;
+}
 
 // complex multiplication
-xcomplex complex_mul(xcomplex a, xcomplex b);
+static inline xcomplex complex_mul(xcomplex a, xcomplex b)
+{
+    xcomplex c;
+
+    c.r = a.r * b.r - a.i * b.i;
+    c.i = a.i * b.r + a.r * b.i;
+
+    return c;
+}
 
 // real and complex mutiplication
-xcomplex complex_real_complex_mul(float x, xcomplex a);
+static inline xcomplex complex_real_complex_mul(float x, xcomplex a)
+{
+    xcomplex c;
+
+    c.r = x * a.r;
+    c.i = x * a.i;
+
+    return c;
+}
 
 // complex division
 xcomplex complex_div(xcomplex a, xcomplex b);
@@ -73,7 +146,15 @@ xcomplex complex_div(xcomplex a, xcomplex b);
 xcomplex complex_div2(xcomplex a, xcomplex b);
 
 // complex number div real number
-xcomplex complex_div_real(xcomplex cp, float r);
+static inline xcomplex complex_div_real(xcomplex cp, float r)
+{
+    xcomplex tmpcp;
+
+    tmpcp.r = cp.r / r;
+    tmpcp.i = cp.i / r;
+
+    return (tmpcp);
+}
 
 // complex number averaging
 xcomplex complex_avg_vec(xcomplex *cpVec, int cpVecLen);
@@ -0,0 +1,100 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef _DIOS_SSP_SHARE_HSOLVE_H_
+#define _DIOS_SSP_SHARE_HSOLVE_H_
+
+#include <stdlib.h>
+#include <math.h>
+
+// smallest pivot the factorization accepts when there is no loading
+#define HSOLVE_MIN_PIVOT    (1e-30f)
+
+// batched Cholesky solver for hermitian positive definite matrices,
+// element (i, j) of every matrix is stored contiguously: u[(i * dim + j) * batch + b]
+typedef struct {
+    int dim;
+    int batch;
+    int count;          // matrices held by the last factorization
+    float *u_re;        // upper factor U, R = U^H * U, upper triangle only
+    float *u_im;
+    float *inv_diag;    // dim * batch, 1 / U(i, i)
+    float *load;        // batch, diagonal loading of each matrix
+    float *y_re;        // dim * batch, substitution workspace
+    float *y_im;
+} objHermSolve;
+
+/**********************************************************************************
+Function:      // dios_ssp_share_hsolve_init
+Description:   // allocate the solver and its workspace
+Input:         // dim: matrix dimension
+                  batch: maximum number of matrices factored at once
+Output:        // none
+Return:        // success: return solver pointer
+                  failure: return NULL
+**********************************************************************************/
+objHermSolve* dios_ssp_share_hsolve_init(int dim, int batch);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_hsolve_factor
+Description:   // factor count matrices, only the upper triangle (j >= i) is read,
+                  loading * trace / dim is added to each diagonal, an all zero
+                  matrix is factored as the identity
+Input:         // hs: solver pointer
+                  r_re: real part, element (i, j) of matrix b at r_re[b * stride + i * dim + j]
+                  r_im: imaginary part in the same layout, NULL for real matrices
+                  stride: distance between two matrices
+                  count: number of matrices, at most batch
+                  loading: relative diagonal loading
+Output:        // none
+Return:        // success: number of pivots clamped to the loading or HSOLVE_MIN_PIVOT
+                  (0 if all matrices were positive definite), failure: return -1
+**********************************************************************************/
+int dios_ssp_share_hsolve_factor(objHermSolve *hs, const float *r_re, const float *r_im,
+                                 int stride, int count, float loading);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_hsolve_solve
+Description:   // solve R * x = b for every factored matrix
+Input:         // hs: solver pointer
+                  b_re, b_im: right hand side of matrix m at b_re[m * stride + i]
+                  stride: distance between two vectors
+Output:        // x_re, x_im: solution in the same layout, may alias b
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_hsolve_solve(objHermSolve *hs, const float *b_re, const float *b_im,
+                                float *x_re, float *x_im, int stride);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_hsolve_inverse
+Description:   // write the full inverse of every factored matrix
+Input:         // hs: solver pointer
+                  stride: distance between two matrices
+Output:        // inv_re, inv_im: element (i, j) of matrix m at inv_re[m * stride + i * dim + j]
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_hsolve_inverse(objHermSolve *hs, float *inv_re, float *inv_im, int stride);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_hsolve_uninit
+Description:   // free the solver
+Input:         // hs: solver pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_hsolve_uninit(objHermSolve *hs);
+
+#endif  /* _DIOS_SSP_SHARE_HSOLVE_H_ */
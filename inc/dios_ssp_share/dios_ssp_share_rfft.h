@@ -25,8 +25,11 @@ limitations under the License.
 
 /**********************************************************************************
 Function:      // dios_ssp_share_rfft_init
-Description:   // rfft init
-Input:         // fft_len: fft length
+Description:   // rfft init. the twiddle and permutation tables are shared with every
+                  other handle of the same length through a thread-safe plan cache;
+                  the handle owns work buffers and must not be used by two threads
+                  at once
+Input:         // fft_len: fft length, a power of 2 and at least 4
 Output:        // none
 Return:        // success: return dios speech signal process rfft pointer
 	              failure: return NULL
@@ -53,9 +56,48 @@ Return:        // success: return 0, failure: return -1
 **********************************************************************************/
 int dios_ssp_share_irfft_process(void *rfft_handle, float *inbuffer, float *outbuffer);
 
+/**********************************************************************************
+Function:      // dios_ssp_share_rfft_batch_init
+Description:   // same as dios_ssp_share_rfft_init, plus the work buffers of
+                  dios_ssp_share_rfft_batch_process
+Input:         // fft_len: fft length, a power of 2 and at least 4
+Output:        // none
+Return:        // success: return dios speech signal process rfft pointer
+                  failure: return NULL
+**********************************************************************************/
+void *dios_ssp_share_rfft_batch_init(int fft_len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_rfft_batch_process
+Description:   // rfft of several channels at once, channels share the simd lanes of
+                  each butterfly. the spectrum is unpacked: X[k] = re[k] + j * im[k]
+                  for k = 0..fft_len/2, the imaginary parts of dc and nyquist are 0
+Input:         // rfft_handle: dios speech signal process rfft pointer
+                  inbuffer: channels pointers to fft_len time domain samples
+                  channels: channel number
+                  out_step: distance in floats between two bins of an output,
+                  1 for separate re/im arrays, 2 for xcomplex arrays
+Output:        // out_re: channels pointers to the real parts
+                  out_im: channels pointers to the imaginary parts
+Return:        // success: return 0, failure: return -1, also when rfft_handle was not
+                  created by dios_ssp_share_rfft_batch_init
+**********************************************************************************/
+int dios_ssp_share_rfft_batch_process(void *rfft_handle, float **inbuffer, int channels,
+                                      float **out_re, float **out_im, int out_step);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_rfft_plan_count
+Description:   // number of fft lengths whose tables are currently cached
+Input:         // none
+Output:        // none
+Return:        // plan count
+**********************************************************************************/
+int dios_ssp_share_rfft_plan_count(void);
+
 /**********************************************************************************
 Function:      // dios_ssp_share_rfft_uninit
-Description:   // free dios speech signal process rfft module
+Description:   // free dios speech signal process rfft module, the shared tables are
+                  freed with the last handle of their length
 Input:         // rfft_handle: dios speech signal process rfft pointer
 Output:        // none
 Return:        // success: return 0, failure: return -1
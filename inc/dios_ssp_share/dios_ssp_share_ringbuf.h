@@ -0,0 +1,152 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef _DIOS_SSP_SHARE_RINGBUF_H_
+#define _DIOS_SSP_SHARE_RINGBUF_H_
+
+#include <stdlib.h>
+#include <string.h>
+
+// sample fifo, every sample is stored twice so any window of up to size
+// samples is contiguous in memory and nothing is ever shifted
+typedef struct {
+    float *buf;     // 2 * size samples, buf[i + size] mirrors buf[i]
+    int size;       // capacity in samples
+    int head;       // position of the oldest sample, 0 <= head < size
+    int count;      // samples held
+} objRingBuf;
+
+// overlap-add accumulator, frames are added at an offset from the next
+// output sample and popped samples are cleared for reuse
+typedef struct {
+    float *buf;     // size samples, zero outside the pending frames
+    int size;       // capacity in samples
+    int head;       // position of the next output sample, 0 <= head < size
+} objOlaBuf;
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ringbuf_init
+Description:   // allocate an empty ring buffer
+Input:         // size: capacity in samples
+Output:        // none
+Return:        // success: return ring buffer pointer
+                  failure: return NULL
+**********************************************************************************/
+objRingBuf* dios_ssp_share_ringbuf_init(int size);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ringbuf_reset
+Description:   // clear the ring buffer and preload it with zero samples
+Input:         // rb: ring buffer pointer
+                  count: zero samples held after the reset, at most size
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ringbuf_reset(objRingBuf *rb, int count);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ringbuf_write
+Description:   // append samples after the newest one
+Input:         // rb: ring buffer pointer
+                  x: samples
+                  len: sample number, count + len must not exceed size
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ringbuf_write(objRingBuf *rb, const float *x, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ringbuf_window
+Description:   // get a contiguous view of the held samples
+Input:         // rb: ring buffer pointer
+                  offset: samples to skip from the oldest one
+Output:        // none
+Return:        // pointer to the sample at offset, the next size - offset samples
+                  are contiguous and valid until the next write
+**********************************************************************************/
+const float* dios_ssp_share_ringbuf_window(const objRingBuf *rb, int offset);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ringbuf_consume
+Description:   // drop the oldest samples
+Input:         // rb: ring buffer pointer
+                  len: sample number, at most count
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ringbuf_consume(objRingBuf *rb, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ringbuf_uninit
+Description:   // free the ring buffer
+Input:         // rb: ring buffer pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ringbuf_uninit(objRingBuf *rb);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ola_init
+Description:   // allocate a cleared overlap-add accumulator
+Input:         // size: capacity in samples, at least the largest offset + frame
+                  length passed to dios_ssp_share_ola_add
+Output:        // none
+Return:        // success: return overlap-add pointer
+                  failure: return NULL
+**********************************************************************************/
+objOlaBuf* dios_ssp_share_ola_init(int size);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ola_reset
+Description:   // clear the overlap-add accumulator
+Input:         // ola: overlap-add pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ola_reset(objOlaBuf *ola);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ola_add
+Description:   // add a frame into the accumulator
+Input:         // ola: overlap-add pointer
+                  offset: position of x[0] counted from the next output sample
+                  x: frame
+                  len: frame length, offset + len must not exceed size
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ola_add(objOlaBuf *ola, int offset, const float *x, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ola_pop
+Description:   // take finished output samples and clear them
+Input:         // ola: overlap-add pointer
+                  len: sample number, at most size
+Output:        // out: output samples
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ola_pop(objOlaBuf *ola, float *out, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_ola_uninit
+Description:   // free the overlap-add accumulator
+Input:         // ola: overlap-add pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_ola_uninit(objOlaBuf *ola);
+
+#endif  /* _DIOS_SSP_SHARE_RINGBUF_H_ */
@@ -0,0 +1,250 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef _DIOS_SSP_SHARE_SIMD_H_
+#define _DIOS_SSP_SHARE_SIMD_H_
+
+#include <math.h>
+#include "./dios_ssp_share_complex_defs.h"
+
+// vector code compiled in: AVX2 behind a runtime check on x86, NEON on aarch64
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DIOS_SSP_HAVE_AVX2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define DIOS_SSP_HAVE_NEON
+#endif
+
+// vector instruction set used by the kernels, selected at runtime
+#define DIOS_SSP_SIMD_NONE  (0)
+#define DIOS_SSP_SIMD_AVX2  (1)
+#define DIOS_SSP_SIMD_NEON  (2)
+
+// byte alignment of dios_ssp_share_simd_calloc, one AVX2 register
+#define DIOS_SSP_SIMD_ALIGN (32)
+
+/**********************************************************************************
+Function:      // dios_ssp_share_simd_level
+Description:   // get the vector instruction set the kernels dispatch to
+Input:         // none
+Output:        // none
+Return:        // DIOS_SSP_SIMD_NONE, DIOS_SSP_SIMD_AVX2 or DIOS_SSP_SIMD_NEON
+**********************************************************************************/
+int dios_ssp_share_simd_level(void);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_vec_abs
+Description:   // magnitude of a split complex vector, out[i] = sqrt(re^2 + im^2),
+                  the vector paths keep the operation order of the scalar loop
+Input:         // re: real part
+                  im: imaginary part
+                  len: vector length
+Output:        // out: magnitude, may alias neither re nor im
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_vec_abs(const float *re, const float *im, float *out, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_vec_scale_power
+Description:   // rescale a split complex vector to a target power keeping its phase,
+                  out = x * sqrt(target / power), a zero bin (phase 0) becomes
+                  sqrt(target) + 0j
+Input:         // re: real part of x
+                  im: imaginary part of x
+                  power: re^2 + im^2
+                  target: power of the output
+                  len: vector length
+Output:        // out_re, out_im: rescaled vector, may alias re and im
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_vec_scale_power(const float *re, const float *im, const float *power,
+                                    const float *target, float *out_re, float *out_im, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_mat_vec_acc
+Description:   // accumulate a column major matrix times a vector, y += A * x,
+                  y[r] += a[c * lda + r] * x[c] summed over c in column order
+Input:         // a: matrix, column c starts at a + c * lda
+                  rows: number of rows
+                  cols: number of columns
+                  lda: distance between two columns, >= rows
+                  x: vector of cols
+Output:        // y: vector of rows, accumulated in place
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_mat_vec_acc(const float *a, int rows, int cols, int lda, const float *x, float *y);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_simd_calloc
+Description:   // allocate zeroed floats aligned to DIOS_SSP_SIMD_ALIGN bytes
+Input:         // len: number of floats
+Output:        // none
+Return:        // success: return the buffer, release it with dios_ssp_share_simd_free
+                  failure: return NULL
+**********************************************************************************/
+float *dios_ssp_share_simd_calloc(int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_simd_free
+Description:   // free a buffer of dios_ssp_share_simd_calloc, NULL is ignored
+Input:         // ptr: buffer
+Output:        // none
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_simd_free(float *ptr);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_cvec_dot_conj
+Description:   // inner product of two split complex vectors, sum of conj(h[i]) * x[i]
+Input:         // hr, hi: real and imaginary part of h
+                  xr, xi: real and imaginary part of x
+                  len: vector length
+Output:        // out_re, out_im: the sum
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_cvec_dot_conj(const float *hr, const float *hi, const float *xr, const float *xi,
+                                  int len, float *out_re, float *out_im);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_cvec_power
+Description:   // weighted power of a split complex vector, sum of w[i] * |x[i]|^2
+Input:         // xr, xi: real and imaginary part of x
+                  w: weights, NULL for all ones
+                  len: vector length
+Output:        // none
+Return:        // the sum
+**********************************************************************************/
+float dios_ssp_share_cvec_power(const float *xr, const float *xi, const float *w, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_cvec_axpy
+Description:   // weighted complex axpy, y[i] += w[i] * (x[i] * a)
+Input:         // w: real weights
+                  xr, xi: real and imaginary part of x
+                  ar, ai: complex scalar a
+                  len: vector length
+Output:        // yr, yi: real and imaginary part of y, updated in place
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_cvec_axpy(const float *w, const float *xr, const float *xi, float ar, float ai,
+                              float *yr, float *yi, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_vec_mul_acc
+Description:   // elementwise multiply accumulate, y[i] += a[i] * b[i]
+Input:         // a, b: input vectors
+                  len: vector length
+Output:        // y: accumulator, updated in place
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_vec_mul_acc(const float *a, const float *b, float *y, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_cvec_mul_acc
+Description:   // elementwise complex multiply accumulate, y[i] += a[i] * b[i], or
+                  y[i] += conj(a[i]) * b[i] when conj_a is 1
+Input:         // ar, ai: real and imaginary part of a
+                  br, bi: real and imaginary part of b
+                  conj_a: 1 to conjugate a
+                  len: vector length
+Output:        // yr, yi: real and imaginary part of y, updated in place
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_cvec_mul_acc(const float *ar, const float *ai, const float *br, const float *bi,
+                                 int conj_a, float *yr, float *yi, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_popcount_mean
+Description:   // bit distance of a key to a history of 32-bit words and its recursive
+                  mean in q9: counts[i] = popcount(key ^ words[i]), then where
+                  shifts[i] > 0, mean[i] += (512 * counts[i] - mean[i]) / 2^shifts[i]
+                  rounded toward zero; entries with shifts[i] == 0 keep their mean
+Input:         // key: word compared with the history
+                  words: history words
+                  shifts: step size of each mean as a right shift, 0 to hold it
+                  len: history length
+Output:        // counts: bit distance of each word
+                  mean: mean distance in q9, updated in place
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_popcount_mean(unsigned int key, const unsigned int *words, const int *shifts,
+                                  int *counts, int *mean, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_vec_min_max_int
+Description:   // smallest and largest value of an int vector and the first position
+                  of the smallest
+Input:         // x: vector
+                  len: vector length, at least 1
+Output:        // min_val: smallest value
+                  min_pos: first position of the smallest value
+                  max_val: largest value
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_vec_min_max_int(const int *x, int *min_val, int *min_pos, int *max_val, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_xcvec_mul
+Description:   // elementwise product of interleaved complex vectors, y[i] = a[i] * b[i],
+                  or y[i] += a[i] * b[i] when acc is 1, the rounding of complex_mul
+                  and complex_add
+Input:         // a, b: complex vectors
+                  acc: 1 to accumulate into y
+                  len: vector length
+Output:        // y: complex vector, may alias a or b when acc is 0
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_xcvec_mul(const xcomplex *a, const xcomplex *b, int acc, xcomplex *y, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_xcvec_flms_update
+Description:   // frequency domain lms update of interleaved complex vectors,
+                  h[i] += conj(x[i]) * e[i] * mu[i], evaluated left to right with the
+                  rounding of complex_conjg, complex_mul and complex_add
+Input:         // x: reference spectrum
+                  e: error spectrum
+                  mu: step size of each bin
+                  len: vector length
+Output:        // h: filter coefficients, updated in place
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_xcvec_flms_update(const xcomplex *x, const xcomplex *e, const xcomplex *mu,
+                                      xcomplex *h, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_xcvec_mul_sub
+Description:   // leakage of interleaved complex coefficients, h[i] -= h[i] * nu[i], with
+                  the rounding of complex_mul and complex_sub
+Input:         // nu: leakage factor of each bin
+                  len: vector length
+Output:        // h: coefficients, updated in place
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_xcvec_mul_sub(const xcomplex *nu, xcomplex *h, int len);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_xcvec_abs2
+Description:   // squared magnitude of an interleaved complex vector, out[i] = |x[i]|^2,
+                  or out[i] += |x[i]|^2 when acc is 1, the rounding of complex_abs2
+Input:         // x: complex vector
+                  acc: 1 to accumulate into out
+                  len: vector length
+Output:        // out: squared magnitude
+Return:        // none
+**********************************************************************************/
+void dios_ssp_share_xcvec_abs2(const xcomplex *x, int acc, float *out, int len);
+
+#endif  /* _DIOS_SSP_SHARE_SIMD_H_ */
@@ -0,0 +1,82 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef _DIOS_SSP_SHARE_STFT_H_
+#define _DIOS_SSP_SHARE_STFT_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "dios_ssp_share_rfft.h"
+#include "dios_ssp_share_ringbuf.h"
+
+// multichannel analysis filterbank, hamming window and rfft per channel
+typedef struct {
+    int channels;
+    int fft_size;
+    int shift_size;
+    float *re;          // channels * fft_size, bins 0..fft_size/2 of each channel are set
+    float *im;
+    float *ana_win;
+    float *win_data;    // channels * fft_size windowed frames
+    float **win_ptr;    // per channel rows of win_data, re and im for the batched rfft
+    float **re_ptr;
+    float **im_ptr;
+    void *rfft_param;
+    objRingBuf **ring;  // per channel, fft_size - shift_size history samples
+} objMchStft;
+
+/**********************************************************************************
+Function:      // dios_ssp_share_stft_init
+Description:   // allocate a multichannel stft, the first frame sees zero history
+Input:         // channels: channel number
+                  fft_size: window and fft length
+                  shift_size: hop length
+Output:        // none
+Return:        // success: return stft pointer
+                  failure: return NULL
+**********************************************************************************/
+objMchStft* dios_ssp_share_stft_init(int channels, int fft_size, int shift_size);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_stft_reset
+Description:   // clear the history and the spectrum
+Input:         // stft: stft pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_stft_reset(objMchStft *stft);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_stft_process
+Description:   // analyse one hop of every channel into re/im
+Input:         // stft: stft pointer
+                  in: channels * shift_size samples, channel after channel
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_stft_process(objMchStft *stft, const float *in);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_stft_uninit
+Description:   // free the stft
+Input:         // stft: stft pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_stft_uninit(objMchStft *stft);
+
+#endif  /* _DIOS_SSP_SHARE_STFT_H_ */
@@ -21,20 +21,21 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 #include "dios_ssp_share_rfft.h"
+#include "dios_ssp_share_simd.h"
 
 typedef struct {
     int frm_len;
     int Ppf_tap; // WIN_LEN/FFT_LEN
     int Ppf_decm;
-    int *p_in;
-    int *p_h0;
+    int ana_pos;  // block of ana_xin holding the current frame
+    int comp_pos;  // block of comp_out holding the next output frame
     float scale;
-    float *ana_xin;  // time domain data input for analyze
+    float *ana_xin;  // Ppf_decm circular blocks of reversed input frames for analyze
     xcomplex *ana_cxout;  // frequency domain complex output for analyze
     float *ana_xout;  // time domain output for analyze
 
-    float *comp_in;  // time domain data input for compose
-    float *comp_out; // data output for compose
+    float *comp_in;  // reversed time domain data input for compose
+    float *comp_out; // Ppf_decm circular blocks of data output for compose
     float* lpf_coef;
     void *rfft_param;
     float *fftout_buffer;
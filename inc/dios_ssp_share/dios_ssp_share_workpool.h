@@ -0,0 +1,76 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef _DIOS_SSP_SHARE_WORKPOOL_H_
+#define _DIOS_SSP_SHARE_WORKPOOL_H_
+
+#include <stdlib.h>
+#include <pthread.h>
+
+// task of a job, called once for every index 0..task_num-1
+typedef void (*WorkpoolTask)(void *arg, int index);
+
+// persistent worker threads that run the tasks of one job at a time, the
+// thread that submits the job runs tasks too and returns once all are done
+typedef struct {
+    int thread_num;             // worker threads, not counting the caller
+    pthread_t *threads;
+    pthread_mutex_t lock;
+    pthread_cond_t job_cond;    // a job was submitted or the pool quits
+    pthread_cond_t done_cond;   // the last task of the job finished
+    WorkpoolTask task;
+    void *arg;
+    int task_num;
+    int next;                   // next task index to hand out
+    int pending;                // tasks not finished yet
+    int quit;
+} objWorkpool;
+
+/**********************************************************************************
+Function:      // dios_ssp_share_workpool_init
+Description:   // start the worker threads
+Input:         // thread_num: worker threads besides the calling thread, 0 runs
+                  every job on the calling thread
+Output:        // none
+Return:        // success: return work pool pointer
+                  failure: return NULL
+**********************************************************************************/
+objWorkpool* dios_ssp_share_workpool_init(int thread_num);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_workpool_run
+Description:   // run task(arg, i) for i = 0..task_num-1 on the pool and the calling
+                  thread, return when all tasks are finished. tasks may run in any
+                  order and must not write state shared with each other
+Input:         // pool: work pool pointer
+                  task: task function
+                  arg: argument passed to every task
+                  task_num: task number
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_workpool_run(objWorkpool *pool, WorkpoolTask task, void *arg, int task_num);
+
+/**********************************************************************************
+Function:      // dios_ssp_share_workpool_uninit
+Description:   // stop the worker threads and free the pool
+Input:         // pool: work pool pointer
+Output:        // none
+Return:        // success: return 0, failure: return -1
+**********************************************************************************/
+int dios_ssp_share_workpool_uninit(objWorkpool *pool);
+
+#endif  /* _DIOS_SSP_SHARE_WORKPOOL_H_ */
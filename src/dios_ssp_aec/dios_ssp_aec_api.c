@@ -53,13 +53,108 @@ typedef struct {
     float *mic_tde;
     float *ref_tde;
     int ref_buffer_len;//for ref fix delay
-    float *ref_buffer; //for ref fix delay
+    objRingBuf *ref_buffer; //for ref fix delay
+
+    /* pbfdaf engine, allocated by dios_ssp_aec_engine_config_api */
+    int engine;
+    objPbfdaf** st_pbfdaf;
+    objSubBand*** st_subband_echo; // subband analyse of the echo estimate of each mic and ref
+    float*** pbfdaf_echo;          // [mic][ref]
+    float** pbfdaf_err;            // [mic]
+    xcomplex*** pbfdaf_est_ref;    // [mic][ref]
+
+    /* microphone threads, allocated by dios_ssp_aec_thread_config_api */
+    objWorkpool* workpool;
+    float* io_buf;   // io buffer of the running process call
+    int* mic_ret;    // return value of each microphone
 
     /* some variable definition */
     int far_end_talk_holdtime;
     int* doubletalk_result;
 } objAEC;
 
+/* free the pbfdaf engine, also when dios_ssp_aec_engine_config_api stopped half way */
+static void aec_pbfdaf_free(objAEC* srv)
+{
+    int i_mic;
+    int i_ref;
+    for (i_mic = 0; i_mic < srv->mic_num; i_mic++) {
+        if (NULL != srv->st_pbfdaf) {
+            dios_ssp_aec_pbfdaf_uninit(srv->st_pbfdaf[i_mic]);
+        }
+        if (NULL != srv->pbfdaf_err) {
+            free(srv->pbfdaf_err[i_mic]);
+        }
+        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+            if (NULL != srv->st_subband_echo && NULL != srv->st_subband_echo[i_mic]) {
+                dios_ssp_share_subband_uninit(srv->st_subband_echo[i_mic][i_ref]);
+            }
+            if (NULL != srv->pbfdaf_echo && NULL != srv->pbfdaf_echo[i_mic]) {
+                free(srv->pbfdaf_echo[i_mic][i_ref]);
+            }
+            if (NULL != srv->pbfdaf_est_ref && NULL != srv->pbfdaf_est_ref[i_mic]) {
+                free(srv->pbfdaf_est_ref[i_mic][i_ref]);
+            }
+        }
+        if (NULL != srv->st_subband_echo) {
+            free(srv->st_subband_echo[i_mic]);
+        }
+        if (NULL != srv->pbfdaf_echo) {
+            free(srv->pbfdaf_echo[i_mic]);
+        }
+        if (NULL != srv->pbfdaf_est_ref) {
+            free(srv->pbfdaf_est_ref[i_mic]);
+        }
+    }
+    free(srv->st_pbfdaf);
+    free(srv->st_subband_echo);
+    free(srv->pbfdaf_echo);
+    free(srv->pbfdaf_err);
+    free(srv->pbfdaf_est_ref);
+    srv->st_pbfdaf = NULL;
+    srv->st_subband_echo = NULL;
+    srv->pbfdaf_echo = NULL;
+    srv->pbfdaf_err = NULL;
+    srv->pbfdaf_est_ref = NULL;
+}
+
+/* allocate the pbfdaf engine, the caller frees what was allocated on failure */
+static int aec_pbfdaf_alloc(objAEC* srv, int tail_ms)
+{
+    int i_mic;
+    int i_ref;
+    srv->st_pbfdaf = (objPbfdaf**)calloc(srv->mic_num, sizeof(objPbfdaf*));
+    srv->st_subband_echo = (objSubBand***)calloc(srv->mic_num, sizeof(objSubBand**));
+    srv->pbfdaf_echo = (float***)calloc(srv->mic_num, sizeof(float**));
+    srv->pbfdaf_err = (float**)calloc(srv->mic_num, sizeof(float*));
+    srv->pbfdaf_est_ref = (xcomplex***)calloc(srv->mic_num, sizeof(xcomplex**));
+    if (NULL == srv->st_pbfdaf || NULL == srv->st_subband_echo || NULL == srv->pbfdaf_echo
+        || NULL == srv->pbfdaf_err || NULL == srv->pbfdaf_est_ref) {
+        return ERR_AEC;
+    }
+    for (i_mic = 0; i_mic < srv->mic_num; i_mic++) {
+        srv->st_pbfdaf[i_mic] = dios_ssp_aec_pbfdaf_init(srv->ref_num, srv->frm_len, tail_ms);
+        srv->pbfdaf_err[i_mic] = (float*)calloc(srv->frm_len, sizeof(float));
+        srv->st_subband_echo[i_mic] = (objSubBand**)calloc(srv->ref_num, sizeof(objSubBand*));
+        srv->pbfdaf_echo[i_mic] = (float**)calloc(srv->ref_num, sizeof(float*));
+        srv->pbfdaf_est_ref[i_mic] = (xcomplex**)calloc(srv->ref_num, sizeof(xcomplex*));
+        if (NULL == srv->st_pbfdaf[i_mic] || NULL == srv->pbfdaf_err[i_mic] || NULL == srv->st_subband_echo[i_mic]
+            || NULL == srv->pbfdaf_echo[i_mic] || NULL == srv->pbfdaf_est_ref[i_mic]) {
+            return ERR_AEC;
+        }
+        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+            srv->st_subband_echo[i_mic][i_ref] = dios_ssp_share_subband_init(srv->frm_len);
+            srv->pbfdaf_echo[i_mic][i_ref] = (float*)calloc(srv->frm_len, sizeof(float));
+            srv->pbfdaf_est_ref[i_mic][i_ref] = (xcomplex*)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex));
+            if (NULL == srv->st_subband_echo[i_mic][i_ref] || NULL == srv->pbfdaf_echo[i_mic][i_ref]
+                || NULL == srv->pbfdaf_est_ref[i_mic][i_ref]) {
+                return ERR_AEC;
+            }
+        }
+    }
+    return 0;
+}
+
 void* dios_ssp_aec_init_api(int mic_num, int ref_num, int frm_len)
 {
     int i;
@@ -85,6 +180,7 @@ void* dios_ssp_aec_init_api(int mic_num, int ref_num, int frm_len)
     /* mic number related */
     srv->mic_tde = (float*)calloc(srv->mic_num * srv->frm_len, sizeof(float));
     srv->doubletalk_result = (int *)calloc(srv->mic_num, sizeof(int));
+    srv->mic_ret = (int *)calloc(srv->mic_num, sizeof(int));
     srv->input_mic_time = (float**)calloc(srv->mic_num, sizeof(float*));
     srv->input_mic_subband = (xcomplex**)calloc(srv->mic_num, sizeof(xcomplex*));
     srv->firfilter_out = (xcomplex**)calloc(srv->mic_num, sizeof(xcomplex*));
@@ -95,7 +191,7 @@ void* dios_ssp_aec_init_api(int mic_num, int ref_num, int frm_len)
     srv->st_doubletalk = (objDoubleTalk**)calloc(srv->mic_num, sizeof(objDoubleTalk*));
     srv->st_res = (objRES***)calloc(srv->mic_num, sizeof(objRES**));
 
-    srv->st_tde = dios_ssp_aec_tde_init(srv->mic_num, srv->ref_num, srv->frm_len);
+    srv->st_tde = dios_ssp_aec_tde_init(srv->mic_num, srv->ref_num, srv->frm_len, AEC_TDE_DEFAULT_DELAY_MS);
 
     for (i_mic = 0; i_mic < srv->mic_num; i_mic++) {
         srv->input_mic_time[i_mic] = (float*)calloc(srv->frm_len, sizeof(float));
@@ -124,7 +220,8 @@ void* dios_ssp_aec_init_api(int mic_num, int ref_num, int frm_len)
     }
 
     /* reference number related */
-    srv->ref_buffer = (float*)calloc(srv->ref_num * (srv->ref_buffer_len + srv->frm_len), sizeof(float));
+    srv->ref_buffer = dios_ssp_share_ringbuf_init(srv->ref_num * (srv->ref_buffer_len + srv->frm_len));
+    dios_ssp_share_ringbuf_reset(srv->ref_buffer, srv->ref_num * srv->ref_buffer_len);
     srv->ref_tde = (float*)calloc(srv->ref_num * srv->frm_len, sizeof(float));
     srv->abs_ref_avg = (float*)calloc(srv->ref_num, sizeof(float));
     srv->ref_psd = (float**)calloc(srv->ref_num, sizeof(float*));
@@ -238,6 +335,82 @@ int dios_ssp_aec_config_api(void* ptr, int mode)
     return 0;
 }
 
+int dios_ssp_aec_engine_config_api(void* ptr, int engine, int tail_ms)
+{
+    objAEC* srv = (objAEC*)ptr;
+
+    if (NULL == ptr) {
+        return ERR_AEC;
+    }
+    if (engine != AEC_ENGINE_SUBBAND && engine != AEC_ENGINE_PBFDAF) {
+        return ERR_AEC;
+    }
+    if (tail_ms == 0) {
+        tail_ms = AEC_PBFDAF_DEFAULT_TAIL_MS;
+    }
+    if (engine == AEC_ENGINE_PBFDAF && (tail_ms < 0 || tail_ms > AEC_PBFDAF_MAX_TAIL_MS)) {
+        return ERR_AEC;
+    }
+
+    aec_pbfdaf_free(srv);
+    srv->engine = engine;
+    if (engine == AEC_ENGINE_SUBBAND) {
+        return 0;
+    }
+
+    if (0 != aec_pbfdaf_alloc(srv, tail_ms)) {
+        aec_pbfdaf_free(srv);
+        srv->engine = AEC_ENGINE_SUBBAND;
+        return ERR_AEC;
+    }
+    return 0;
+}
+
+int dios_ssp_aec_thread_config_api(void* ptr, int thread_num)
+{
+    objAEC* srv = (objAEC*)ptr;
+
+    if (NULL == ptr || thread_num < 0) {
+        return ERR_AEC;
+    }
+    if (NULL != srv->workpool) {
+        dios_ssp_share_workpool_uninit(srv->workpool);
+        srv->workpool = NULL;
+    }
+    if (thread_num > srv->mic_num) {
+        thread_num = srv->mic_num;
+    }
+    if (thread_num <= 1) {
+        return 0;
+    }
+    /* the calling thread takes one share of the microphones */
+    srv->workpool = dios_ssp_share_workpool_init(thread_num - 1);
+    if (NULL == srv->workpool) {
+        return ERR_AEC;
+    }
+    return 0;
+}
+
+int dios_ssp_aec_delay_config_api(void* ptr, int max_delay_ms)
+{
+    objTDE* st_tde;
+    objAEC* srv = (objAEC*)ptr;
+
+    if (NULL == ptr) {
+        return ERR_AEC;
+    }
+    if (max_delay_ms == 0) {
+        max_delay_ms = AEC_TDE_DEFAULT_DELAY_MS;
+    }
+    st_tde = dios_ssp_aec_tde_init(srv->mic_num, srv->ref_num, srv->frm_len, max_delay_ms);
+    if (NULL == st_tde) {
+        return ERR_AEC;
+    }
+    dios_ssp_aec_tde_uninit(srv->st_tde);
+    srv->st_tde = st_tde;
+    return 0;
+}
+
 int dios_ssp_aec_reset_api(void* ptr)
 {
     int ret = 0;
@@ -252,7 +425,7 @@ int dios_ssp_aec_reset_api(void* ptr)
 
     srv->far_end_talk_holdtime = 1;
 
-    memset(srv->ref_buffer, 0, srv->ref_num * (srv->ref_buffer_len + srv->frm_len) * sizeof(float));
+    dios_ssp_share_ringbuf_reset(srv->ref_buffer, srv->ref_num * srv->ref_buffer_len);
 
     ret = dios_ssp_aec_tde_reset(srv->st_tde);
     if (0 != ret) {
@@ -282,6 +455,19 @@ int dios_ssp_aec_reset_api(void* ptr)
                 return ERR_AEC;
             }
         }
+
+        if (NULL != srv->st_pbfdaf) {
+            ret = dios_ssp_aec_pbfdaf_reset(srv->st_pbfdaf[i_mic]);
+            if (0 != ret) {
+                return ERR_AEC;
+            }
+            for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+                ret = dios_ssp_share_subband_reset(srv->st_subband_echo[i_mic][i_ref]);
+                if (0 != ret) {
+                    return ERR_AEC;
+                }
+            }
+        }
     }
 
     for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
@@ -309,6 +495,119 @@ int dios_ssp_aec_reset_api(void* ptr)
     return 0;
 }
 
+/* linear filter, erl estimate, residual echo suppression, double talk detection
+   and subband compose of one microphone */
+static int aec_mic_process(objAEC* srv, int i_mic, float* io_buf)
+{
+    int ret_process = 0;
+    int i_ref;
+    int ch;
+
+    /* mic subband analyse */
+    ret_process = dios_ssp_share_subband_analyse(srv->st_subband_mic[i_mic], srv->input_mic_time[i_mic], srv->input_mic_subband[i_mic]);
+    if (0 != ret_process) {
+        return ERR_AEC;
+    }
+    /* fir filter process */
+    srv->st_firfilter[i_mic]->far_end_talk_holdtime = srv->far_end_talk_holdtime;
+    srv->st_firfilter[i_mic]->dt_status = &srv->doubletalk_result[i_mic];
+
+    srv->st_firfilter[i_mic]->sig_mic_rec = srv->input_mic_subband[i_mic];
+    srv->st_firfilter[i_mic]->sig_spk_ref = srv->input_ref_subband;
+
+    srv->st_firfilter[i_mic]->noise_est_spk_part = srv->st_noise_est_spk_subband;
+    srv->st_firfilter[i_mic]->noise_est_spk_t = srv->st_noise_est_spk_t;
+
+    srv->st_firfilter[i_mic]->band_table = srv->band_table;
+    srv->st_firfilter[i_mic]->spk_part_band_energy = srv->spk_part_band_energy;
+    srv->st_firfilter[i_mic]->spk_peak = srv->spk_peak;
+    if (srv->engine == AEC_ENGINE_PBFDAF) {
+        /* adapt while the far end talks, slowly in double talk */
+        float myu = 0.0f;
+        if (srv->far_end_talk_holdtime > 0) {
+            myu = srv->doubletalk_result[i_mic] == DOUBLE_TALK_STATUS ? AEC_PBFDAF_MYU_DT : AEC_PBFDAF_MYU;
+        }
+        ret_process = dios_ssp_aec_pbfdaf_process(srv->st_pbfdaf[i_mic], srv->input_mic_time[i_mic], srv->input_ref_time,
+                                                  myu, srv->pbfdaf_echo[i_mic], srv->pbfdaf_err[i_mic]);
+        if (0 != ret_process) {
+            return ERR_AEC;
+        }
+        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+            ret_process = dios_ssp_share_subband_analyse(srv->st_subband_echo[i_mic][i_ref], srv->pbfdaf_echo[i_mic][i_ref],
+                                                         srv->pbfdaf_est_ref[i_mic][i_ref]);
+            if (0 != ret_process) {
+                return ERR_AEC;
+            }
+        }
+        ret_process = dios_ssp_aec_firfilter_external_process(srv->st_firfilter[i_mic], srv->pbfdaf_est_ref[i_mic],
+                                                              srv->firfilter_out[i_mic], srv->est_echo[i_mic]);
+    } else {
+        ret_process = dios_ssp_aec_firfilter_process(srv->st_firfilter[i_mic], srv->firfilter_out[i_mic], srv->est_echo[i_mic]);
+    }
+    if (0 != ret_process) {
+        return ERR_AEC;
+    }
+
+    /* save for 2nd stage res */
+    /* The 1st stage residual echo processing is to judge the double-talk state */
+    memcpy(srv->final_out[i_mic], srv->firfilter_out[i_mic], sizeof(xcomplex) * AEC_SUBBAND_NUM);
+
+    /* ERL estimate */
+    ret_process = dios_ssp_aec_erl_est_process(srv->st_firfilter[i_mic]);
+    if (ret_process != 0) {
+        return ERR_AEC;
+    }
+
+    /* aec output noise tracking */
+    for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
+        if (srv->far_end_talk_holdtime == 0) {
+            dios_ssp_share_noiselevel_process(srv->st_firfilter[i_mic]->noise_est_mic_chan[ch], srv->st_firfilter[i_mic]->power_mic_send_smooth[ch]);
+        }
+    }
+
+    /* 1st stage residual echo suppression to improve dtd result */
+    for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+        srv->st_res[i_mic][i_ref]->Xf_res_echo = srv->firfilter_out[i_mic];
+        srv->st_res[i_mic][i_ref]->Xf_echo = srv->est_echo[i_mic];
+        /* dtd result input(the 2nd parameter) is only for stage two, so this dtd result is useless */
+        ret_process = dios_ssp_aec_res_process(srv->st_res[i_mic][i_ref], srv->doubletalk_result[i_mic], 1);
+        if (0 != ret_process) {
+            return ERR_AEC;
+        }
+    }
+
+    /* double talk process */
+    dios_ssp_share_xcvec_abs2(srv->firfilter_out[i_mic], 0, srv->st_doubletalk[i_mic]->res1_psd, AEC_SUBBAND_NUM);
+    srv->st_doubletalk[i_mic]->mic_noise_bin = srv->st_firfilter[i_mic]->noise_est_mic_chan;
+    srv->st_doubletalk[i_mic]->erl_ratio = srv->st_firfilter[i_mic]->erl_ratio;
+    srv->st_doubletalk[i_mic]->far_end_talk_holdtime = srv->far_end_talk_holdtime;
+    ret_process = dios_ssp_aec_doubletalk_process(srv->st_doubletalk[i_mic], &srv->doubletalk_result[i_mic]);
+    if (0 != ret_process) {
+        return ERR_AEC;
+    }
+
+    /* 2nd stage residual echo suppression */
+    for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+        srv->st_res[i_mic][i_ref]->Xf_res_echo = srv->final_out[i_mic];
+        srv->st_res[i_mic][i_ref]->Xf_echo = srv->est_echo[i_mic];
+        ret_process = dios_ssp_aec_res_process(srv->st_res[i_mic][i_ref], srv->doubletalk_result[i_mic], 2);
+        if (0 != ret_process) {
+            return ERR_AEC;
+        }
+    }
+
+    /* subband compose */
+    ret_process = dios_ssp_share_subband_compose(srv->st_subband_mic[i_mic], srv->final_out[i_mic], &io_buf[i_mic * srv->frm_len]);
+    return ret_process;
+}
+
+/* workpool task of one microphone */
+static void aec_mic_task(void* arg, int i_mic)
+{
+    objAEC* srv = (objAEC*)arg;
+    srv->mic_ret[i_mic] = aec_mic_process(srv, i_mic, srv->io_buf);
+}
+
 // main function processed by AEC
 int dios_ssp_aec_process_api(void* ptr, float* io_buf, float* ref_buf, int* dt_st)
 {
@@ -316,7 +615,7 @@ int dios_ssp_aec_process_api(void* ptr, float* io_buf, float* ref_buf, int* dt_s
     int ret_process = 0;
     int i_mic;
     int i_ref;
-    int i, ii;
+    int i;
     int ch;
     int far_end_talk_flag = 0;
 
@@ -324,13 +623,11 @@ int dios_ssp_aec_process_api(void* ptr, float* io_buf, float* ref_buf, int* dt_s
         return ERR_AEC;
     }
     memcpy(srv->mic_tde, io_buf, srv->mic_num * srv->frm_len * sizeof(float));
-    memcpy(srv->ref_tde, ref_buf, srv->ref_num * srv->frm_len * sizeof(float));
 
     /* fixed delay process */
-    memcpy(srv->ref_buffer + srv->ref_num * srv->ref_buffer_len, srv->ref_tde, srv->ref_num * srv->frm_len * sizeof(float));
-    memcpy(srv->ref_tde, srv->ref_buffer, srv->ref_num * srv->frm_len * sizeof(float));
-    memmove(srv->ref_buffer, srv->ref_buffer + srv->ref_num * srv->frm_len, srv->ref_num * srv->ref_buffer_len * sizeof(float));
-    memset(srv->ref_buffer + srv->ref_num * srv->ref_buffer_len, 0, srv->ref_num * srv->frm_len * sizeof(float));
+    dios_ssp_share_ringbuf_write(srv->ref_buffer, ref_buf, srv->ref_num * srv->frm_len);
+    memcpy(srv->ref_tde, dios_ssp_share_ringbuf_window(srv->ref_buffer, 0), srv->ref_num * srv->frm_len * sizeof(float));
+    dios_ssp_share_ringbuf_consume(srv->ref_buffer, srv->ref_num * srv->frm_len);
 
     /* delay the processing function and align the data with the calculated delay */
     ret_process = dios_ssp_aec_tde_process(srv->st_tde, srv->ref_tde, srv->mic_tde);
@@ -383,9 +680,7 @@ int dios_ssp_aec_process_api(void* ptr, float* io_buf, float* ref_buf, int* dt_s
         }
 
         /* get reference signal psd */
-        for(ch = 0; ch < AEC_SUBBAND_NUM; ch++) {
-            srv->ref_psd[i_ref][ch] = complex_abs2(srv->input_ref_subband[i_ref][ch]);
-        }
+        dios_ssp_share_xcvec_abs2(srv->input_ref_subband[i_ref], 0, srv->ref_psd[i_ref], AEC_SUBBAND_NUM);
 
         /* get erl band energy */
         for(i = 0; i < ERL_BAND_NUM; i++) {
@@ -405,83 +700,19 @@ int dios_ssp_aec_process_api(void* ptr, float* io_buf, float* ref_buf, int* dt_s
         }
     }
 
-    for (i_mic = 0; i_mic < srv->mic_num; i_mic++) {
-        /* mic subband analyse */
-        ret_process = dios_ssp_share_subband_analyse(srv->st_subband_mic[i_mic], srv->input_mic_time[i_mic], srv->input_mic_subband[i_mic]);
-        if (0 != ret_process) {
-            return ERR_AEC;
-        }
-        /* fir filter process */
-        srv->st_firfilter[i_mic]->far_end_talk_holdtime = srv->far_end_talk_holdtime;
-        srv->st_firfilter[i_mic]->dt_status = &srv->doubletalk_result[i_mic];
-
-        srv->st_firfilter[i_mic]->sig_mic_rec = srv->input_mic_subband[i_mic];
-        srv->st_firfilter[i_mic]->sig_spk_ref = srv->input_ref_subband;
-
-        srv->st_firfilter[i_mic]->noise_est_spk_part = srv->st_noise_est_spk_subband;
-        srv->st_firfilter[i_mic]->noise_est_spk_t = srv->st_noise_est_spk_t;
-
-        srv->st_firfilter[i_mic]->band_table = srv->band_table;
-        srv->st_firfilter[i_mic]->spk_part_band_energy = srv->spk_part_band_energy;
-        srv->st_firfilter[i_mic]->spk_peak = srv->spk_peak;
-        ret_process = dios_ssp_aec_firfilter_process(srv->st_firfilter[i_mic], srv->firfilter_out[i_mic], srv->est_echo[i_mic]);
-        if (0 != ret_process) {
-            return ERR_AEC;
-        }
-
-        /* save for 2nd stage res */
-        /* The 1st stage residual echo processing is to judge the double-talk state */
-        memcpy(srv->final_out[i_mic], srv->firfilter_out[i_mic], sizeof(xcomplex) * AEC_SUBBAND_NUM);
-
-        /* ERL estimate */
-        ret_process = dios_ssp_aec_erl_est_process(srv->st_firfilter[i_mic]);
-        if (ret_process != 0) {
-            return ERR_AEC;
-        }
-
-        /* aec output noise tracking */
-        for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
-            if (srv->far_end_talk_holdtime == 0) {
-                dios_ssp_share_noiselevel_process(srv->st_firfilter[i_mic]->noise_est_mic_chan[ch], srv->st_firfilter[i_mic]->power_mic_send_smooth[ch]);
-            }
-        }
-
-        /* 1st stage residual echo suppression to improve dtd result */
-        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-            srv->st_res[i_mic][i_ref]->Xf_res_echo = srv->firfilter_out[i_mic];
-            srv->st_res[i_mic][i_ref]->Xf_echo = srv->est_echo[i_mic];
-            /* dtd result input(the 2nd parameter) is only for stage two, so this dtd result is useless */
-            ret_process = dios_ssp_aec_res_process(srv->st_res[i_mic][i_ref], srv->doubletalk_result[i_mic], 1);
-            if (0 != ret_process) {
-                return ERR_AEC;
-            }
-        }
-
-        /* double talk process */
-        for (ii = 0; ii< AEC_SUBBAND_NUM; ii++) {
-            srv->st_doubletalk[i_mic]->res1_psd[ii] = complex_abs2(srv->firfilter_out[i_mic][ii]);
+    /* microphones only share the reference analysis above, read only */
+    srv->io_buf = io_buf;
+    if (NULL != srv->workpool) {
+        dios_ssp_share_workpool_run(srv->workpool, aec_mic_task, srv, srv->mic_num);
+    } else {
+        for (i_mic = 0; i_mic < srv->mic_num; i_mic++) {
+            aec_mic_task(srv, i_mic);
         }
-        srv->st_doubletalk[i_mic]->mic_noise_bin = srv->st_firfilter[i_mic]->noise_est_mic_chan;
-        srv->st_doubletalk[i_mic]->erl_ratio = srv->st_firfilter[i_mic]->erl_ratio;
-        srv->st_doubletalk[i_mic]->far_end_talk_holdtime = srv->far_end_talk_holdtime;
-        ret_process = dios_ssp_aec_doubletalk_process(srv->st_doubletalk[i_mic], &srv->doubletalk_result[i_mic]);
-        if (0 != ret_process) {
+    }
+    for (i_mic = 0; i_mic < srv->mic_num; i_mic++) {
+        if (0 != srv->mic_ret[i_mic]) {
             return ERR_AEC;
         }
-
-        /* 2nd stage residual echo suppression */
-        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-            srv->st_res[i_mic][i_ref]->Xf_res_echo = srv->final_out[i_mic];
-            srv->st_res[i_mic][i_ref]->Xf_echo = srv->est_echo[i_mic];
-            ret_process = dios_ssp_aec_res_process(srv->st_res[i_mic][i_ref], srv->doubletalk_result[i_mic], 2);
-            if (0 != ret_process) {
-                return ERR_AEC;
-            }
-        }
-
-        /* subband compose */
-        ret_process = dios_ssp_share_subband_compose(srv->st_subband_mic[i_mic], srv->final_out[i_mic], &io_buf[i_mic * srv->frm_len]);
-
     }
     dt_st[0] = srv->doubletalk_result[0];
     return 0;
@@ -509,6 +740,7 @@ int dios_ssp_aec_uninit_api(void* ptr)
     }
     free(srv->mic_tde);
     free(srv->doubletalk_result);
+    free(srv->mic_ret);
     free(srv->input_mic_time);
     free(srv->input_mic_subband);
     free(srv->firfilter_out);
@@ -535,7 +767,7 @@ int dios_ssp_aec_uninit_api(void* ptr)
     free(srv->spk_peak);
     free(srv->ref_psd);
     free(srv->abs_ref_avg);
-    free(srv->ref_buffer);
+    dios_ssp_share_ringbuf_uninit(srv->ref_buffer);
     free(srv->ref_tde);
     free(srv->input_ref_time);
     free(srv->input_ref_subband);
@@ -586,6 +818,10 @@ int dios_ssp_aec_uninit_api(void* ptr)
     free(srv->st_firfilter);
     free(srv->st_res);
     free(srv->st_doubletalk);
+    aec_pbfdaf_free(srv);
+    if (NULL != srv->workpool) {
+        dios_ssp_share_workpool_uninit(srv->workpool);
+    }
     free(srv);
 
     return 0;
@@ -33,15 +33,16 @@ int dios_ssp_aec_erl_est_process(objFirFilter* srv)
         return ERR_AEC;
     }
 
-    for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
-        /* get psd */
-        srv->mic_rec_psd[ch] = complex_abs2(srv->sig_mic_rec[ch]);/* mic record signal */
-
-        for (i_spk = 0; i_spk < srv->ref_num; i_spk++) {
-            srv->ref_psd[i_spk][ch] = complex_abs2(srv->sig_spk_ref[i_spk][ch]); /* reference signal */
-            srv->power_echo_rtn_fir[i_spk][ch] = complex_abs2(srv->est_ref_fir[i_spk][ch]);
-            srv->power_echo_rtn_adpt[i_spk][ch] = complex_abs2(srv->est_ref_adf[i_spk][ch]);
-        }
+    /* get psd */
+    dios_ssp_share_xcvec_abs2(&srv->sig_mic_rec[AEC_LOW_CHAN], 0, &srv->mic_rec_psd[AEC_LOW_CHAN],
+                              AEC_HIGH_CHAN - AEC_LOW_CHAN); /* mic record signal */
+    for (i_spk = 0; i_spk < srv->ref_num; i_spk++) {
+        dios_ssp_share_xcvec_abs2(&srv->sig_spk_ref[i_spk][AEC_LOW_CHAN], 0, &srv->ref_psd[i_spk][AEC_LOW_CHAN],
+                                  AEC_HIGH_CHAN - AEC_LOW_CHAN); /* reference signal */
+        dios_ssp_share_xcvec_abs2(&srv->est_ref_fir[i_spk][AEC_LOW_CHAN], 0, &srv->power_echo_rtn_fir[i_spk][AEC_LOW_CHAN],
+                                  AEC_HIGH_CHAN - AEC_LOW_CHAN);
+        dios_ssp_share_xcvec_abs2(&srv->est_ref_adf[i_spk][AEC_LOW_CHAN], 0, &srv->power_echo_rtn_adpt[i_spk][AEC_LOW_CHAN],
+                                  AEC_HIGH_CHAN - AEC_LOW_CHAN);
     }
     for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
         if (srv->energy_err_fir[ch] < srv->energy_err_adf[ch]) {
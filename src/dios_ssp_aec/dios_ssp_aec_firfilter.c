@@ -16,34 +16,46 @@ limitations under the License.
 Description: the core part of linear echo cancellation. The filter coefficients
 consist of two groups for stability of filter: adf_coef and fir_coef, the best
 one will be chosen according to the residual error signal level, the adf_coef
-is updated with IPNLMS.
+is updated with IPNLMS. Both filters and the reference history are stored as
+split real/imaginary rows, one row of AEC_TAP_STRIDE floats per reference and
+subband, so the convolution and the update run as vector kernels.
 ==============================================================================*/
 
 /* include file */
 #include "dios_ssp_aec_firfilter.h"
 
+/* offset of the row of reference i_ref, subband ch in the filter arrays */
+static int aec_tap_offset(int i_ref, int ch)
+{
+    return (i_ref * AEC_SUBBAND_NUM + ch) * AEC_TAP_STRIDE;
+}
+
 /* estimate echo and calculate residual */
 void dios_ssp_aec_residual(objFirFilter *srv)
 {
     int ch;
     int i_ref;
-    int i;
     for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
         for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
+            int M = srv->num_main_subband_adf[ch];
+            int off = aec_tap_offset(i_ref, ch);
+            float *xr = srv->stack_sigIn_re + off;
+            float *xi = srv->stack_sigIn_im + off;
+
             /* get reference vector for fir filter */
-            complex_data_push(srv->num_main_subband_adf[ch] + 1, srv->sig_spk_ref[i_ref][ch], srv->stack_sigIn_adf[i_ref][ch]);
+            memmove(xr + 1, xr, M * sizeof(float));
+            memmove(xi + 1, xi, M * sizeof(float));
+            xr[0] = srv->sig_spk_ref[i_ref][ch].r;
+            xi[0] = srv->sig_spk_ref[i_ref][ch].i;
 
             /* get echo signal: conv: y = conj(h) * x */
-            srv->est_ref_fir[i_ref][ch] = complex_conv(srv->num_main_subband_adf[ch], srv->fir_coef[i_ref][ch],
-                                          srv->stack_sigIn_adf[i_ref][ch]);
-            srv->est_ref_adf[i_ref][ch] = complex_conv(srv->num_main_subband_adf[ch], srv->adf_coef[i_ref][ch],
-                                          srv->stack_sigIn_adf[i_ref][ch]);
+            dios_ssp_share_cvec_dot_conj(srv->fir_coef_re + off, srv->fir_coef_im + off, xr, xi, M,
+                                         &srv->est_ref_fir[i_ref][ch].r, &srv->est_ref_fir[i_ref][ch].i);
+            dios_ssp_share_cvec_dot_conj(srv->adf_coef_re + off, srv->adf_coef_im + off, xr, xi, M,
+                                         &srv->est_ref_adf[i_ref][ch].r, &srv->est_ref_adf[i_ref][ch].i);
 
             /* get power of reference vector */
-            srv->power_in_ntaps_smooth[i_ref][ch] = 0.0f;
-            for (i = 0; i < srv->num_main_subband_adf[ch]; i++) {
-                srv->power_in_ntaps_smooth[i_ref][ch] += complex_abs2(srv->stack_sigIn_adf[i_ref][ch][i]);
-            }
+            srv->power_in_ntaps_smooth[i_ref][ch] = dios_ssp_share_cvec_power(xr, xi, NULL, M);
         }
     }
     for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
@@ -64,15 +76,14 @@ void dios_ssp_aec_residual(objFirFilter *srv)
 /* filter convergence detection */
 void dios_ssp_aec_firfilter_detect(objFirFilter *srv)
 {
-    int ch, i_ref, i;
+    int ch, i_ref;
     for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
+        size_t row = srv->num_main_subband_adf[ch] * sizeof(float);
         /* filter convergence detection */
         if (srv->mse_adpt[ch] > srv->mse_mic_in[ch] * MSE_RATIO_OUT_IN) {
             for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-                for (i = 0; i < srv->num_main_subband_adf[ch]; i++) {
-                    srv->adf_coef[i_ref][ch][i].r = 0.0;
-                    srv->adf_coef[i_ref][ch][i].i = 0.0;
-                }
+                memset(srv->adf_coef_re + aec_tap_offset(i_ref, ch), 0, row);
+                memset(srv->adf_coef_im + aec_tap_offset(i_ref, ch), 0, row);
             }
             srv->mse_mic_in[ch] = 0.0;
             srv->mse_adpt[ch] = 0.0;
@@ -80,9 +91,8 @@ void dios_ssp_aec_firfilter_detect(objFirFilter *srv)
         } else if ((srv->mse_mic_in[ch] > srv->mse_adpt[ch] * MSE_RATIO_OUT_IN)
                    && (srv->mse_adpt[ch] < FILTER_COPY_FAC * srv->mse_main[ch])) {
             for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-                for (i = 0; i < srv->num_main_subband_adf[ch]; i++) {
-                    srv->fir_coef[i_ref][ch][i] = srv->adf_coef[i_ref][ch][i];
-                }
+                memcpy(srv->fir_coef_re + aec_tap_offset(i_ref, ch), srv->adf_coef_re + aec_tap_offset(i_ref, ch), row);
+                memcpy(srv->fir_coef_im + aec_tap_offset(i_ref, ch), srv->adf_coef_im + aec_tap_offset(i_ref, ch), row);
             }
             srv->mse_mic_in[ch] = 0.0;
             srv->mse_adpt[ch] = 0.0;
@@ -91,10 +101,8 @@ void dios_ssp_aec_firfilter_detect(objFirFilter *srv)
 
         if (srv->mse_main[ch] > srv->mse_mic_in[ch] * MSE_RATIO_OUT_IN) {
             for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-                for (i = 0; i < srv->num_main_subband_adf[ch]; i++) {
-                    srv->fir_coef[i_ref][ch][i].r = 0.0;
-                    srv->fir_coef[i_ref][ch][i].i = 0.0;
-                }
+                memset(srv->fir_coef_re + aec_tap_offset(i_ref, ch), 0, row);
+                memset(srv->fir_coef_im + aec_tap_offset(i_ref, ch), 0, row);
             }
             srv->mse_main[ch] = 0.0;
             srv->mse_adpt[ch] = 0.0;
@@ -102,9 +110,8 @@ void dios_ssp_aec_firfilter_detect(objFirFilter *srv)
         } else if ((srv->mse_mic_in[ch] > srv->mse_main[ch] * MSE_RATIO_OUT_IN)
                    && (srv->mse_main[ch] < FILTER_COPY_FAC * srv->mse_adpt[ch])) {
             for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-                for (i = 0; i<srv->num_main_subband_adf[ch]; i++) {
-                    srv->adf_coef[i_ref][ch][i] = srv->fir_coef[i_ref][ch][i];
-                }
+                memcpy(srv->adf_coef_re + aec_tap_offset(i_ref, ch), srv->fir_coef_re + aec_tap_offset(i_ref, ch), row);
+                memcpy(srv->adf_coef_im + aec_tap_offset(i_ref, ch), srv->fir_coef_im + aec_tap_offset(i_ref, ch), row);
             }
             srv->mse_mic_in[ch] = 0.0;
             srv->mse_adpt[ch] = 0.0;
@@ -166,33 +173,30 @@ void ipnlms_complex(int ch, objFirFilter *srv, int i_ref)
     int m, M = srv->num_main_subband_adf[ch];
     float aec_ns_alpha = 0;
     float myu = srv->weight[ch * 2];
-    xcomplex delta, z;
+    xcomplex delta;
     float Padf = 0.0;
     float kl[NUM_MAX_BAND];
     float ip_alpha = 0.5;
-    float x2_kl = 0.0;
     float norm_aec = 0.0;
+    int off = aec_tap_offset(i_ref, ch);
+    float *hr = srv->adf_coef_re + off;
+    float *hi = srv->adf_coef_im + off;
     for (m = 0; m < M; m++) {
-        kl[m] = complex_abs2(srv->adf_coef[i_ref][ch][m]);
+        kl[m] = hr[m] * hr[m] + hi[m] * hi[m];
         Padf += kl[m];
     }
 
     for (ii_spk = 0; ii_spk < srv->ref_num; ii_spk++) {
-        x2_kl = 0.0;
+        int off_spk = aec_tap_offset(ii_spk, ch);
         for (m = 0; m < M; m++) {
             kl[m] = (1 - ip_alpha) / (2 * M) + (1 + ip_alpha)*kl[m] / (Padf * 2 + 1e-5f);
-            x2_kl += complex_abs2(srv->stack_sigIn_adf[ii_spk][ch][m])*kl[m];
         }
-        norm_aec += x2_kl;
+        norm_aec += dios_ssp_share_cvec_power(srv->stack_sigIn_re + off_spk, srv->stack_sigIn_im + off_spk, kl, M);
     }
 
     aec_ns_alpha = myu / (norm_aec + 0.01f);
     delta = complex_real_complex_mul(aec_ns_alpha, complex_conjg(srv->err_adf[ch]));
-    for (m = 0; m < M; m++) {
-        z = complex_mul(srv->stack_sigIn_adf[i_ref][ch][m], delta);
-        z = complex_real_complex_mul(kl[m], z);
-        srv->adf_coef[i_ref][ch][m] = complex_add(srv->adf_coef[i_ref][ch][m], z);
-    }
+    dios_ssp_share_cvec_axpy(kl, srv->stack_sigIn_re + off, srv->stack_sigIn_im + off, delta.r, delta.i, hr, hi, M);
 }
 
 //aec fir filter init
@@ -207,9 +211,18 @@ objFirFilter* dios_ssp_aec_firfilter_init(int ref_num)
     srv->ref_num = ref_num;
     srv->myu = 0.5f;
     srv->beta = 1e-008f;
-    srv->fir_coef = (xcomplex ***)calloc(srv->ref_num, sizeof(xcomplex**));
-    srv->adf_coef = (xcomplex ***)calloc(srv->ref_num, sizeof(xcomplex**));
-    srv->stack_sigIn_adf = (xcomplex ***)calloc(srv->ref_num, sizeof(xcomplex**));
+    int rows = srv->ref_num * AEC_SUBBAND_NUM * AEC_TAP_STRIDE;
+    srv->coef_block = dios_ssp_share_simd_calloc(6 * rows);
+    if (NULL == srv->coef_block) {
+        free(srv);
+        return NULL;
+    }
+    srv->fir_coef_re = srv->coef_block;
+    srv->fir_coef_im = srv->coef_block + rows;
+    srv->adf_coef_re = srv->coef_block + 2 * rows;
+    srv->adf_coef_im = srv->coef_block + 3 * rows;
+    srv->stack_sigIn_re = srv->coef_block + 4 * rows;
+    srv->stack_sigIn_im = srv->coef_block + 5 * rows;
     srv->err_adf = (xcomplex *)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex));
     srv->err_fir = (xcomplex *)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex));
     srv->est_ref_adf = (xcomplex **)calloc(srv->ref_num, sizeof(xcomplex*));
@@ -236,17 +249,8 @@ objFirFilter* dios_ssp_aec_firfilter_init(int ref_num)
     for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
         srv->ref_psd[i_ref] = (float *)calloc(AEC_SUBBAND_NUM, sizeof(float));
         srv->power_in_ntaps_smooth[i_ref] = (float *)calloc(AEC_SUBBAND_NUM, sizeof(float));
-        srv->adf_coef[i_ref] = (xcomplex **)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex*));
-        srv->fir_coef[i_ref] = (xcomplex **)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex*));
-        srv->stack_sigIn_adf[i_ref] = (xcomplex **)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex*));
         srv->power_echo_rtn_fir[i_ref] = (float *)calloc(AEC_SUBBAND_NUM, sizeof(float));
         srv->power_echo_rtn_adpt[i_ref] = (float *)calloc(AEC_SUBBAND_NUM, sizeof(float));
-        for (i = 0; i < AEC_SUBBAND_NUM; i++) {
-            srv->adf_coef[i_ref][i] = (xcomplex *)calloc((NUM_MAX_BAND + 1), sizeof(xcomplex));
-            srv->fir_coef[i_ref][i] = (xcomplex *)calloc((NUM_MAX_BAND + 1), sizeof(xcomplex));
-            srv->stack_sigIn_adf[i_ref][i] = (xcomplex *)calloc((NUM_MAX_BAND + 1), sizeof(xcomplex));
-        }
-
         srv->est_ref_adf[i_ref] = (xcomplex *)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex));
         srv->est_ref_fir[i_ref] = (xcomplex *)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex));
         srv->power_echo_rtn_smooth[i_ref] = (float *)calloc(AEC_SUBBAND_NUM, sizeof(float));
@@ -276,7 +280,6 @@ objFirFilter* dios_ssp_aec_firfilter_init(int ref_num)
 int dios_ssp_aec_firfilter_reset(objFirFilter* srv)
 {
     int i;
-    int n;
     int i_ref;
     int ret = 0;
 
@@ -315,21 +318,13 @@ int dios_ssp_aec_firfilter_reset(objFirFilter* srv)
             srv->power_in_ntaps_smooth[i_ref][i] = 0.0f;
         }
 
-        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-            for (n = 0; n < NUM_MAX_BAND + 1; n++) {
-                srv->adf_coef[i_ref][i][n].r = 0.0f;
-                srv->adf_coef[i_ref][i][n].i = 0.0f;
-                srv->fir_coef[i_ref][i][n].r = 0.0f;
-                srv->fir_coef[i_ref][i][n].i = 0.0f;
-                srv->stack_sigIn_adf[i_ref][i][n].r = 0.0f;
-                srv->stack_sigIn_adf[i_ref][i][n].i = 0.0f;
-            }
-        }
         srv->mse_adpt[i] = 0.0f;
         srv->mse_main[i] = 0.0f;
         srv->mse_mic_in[i] = 0.0f;
     }
 
+    memset(srv->coef_block, 0, 6 * srv->ref_num * AEC_SUBBAND_NUM * AEC_TAP_STRIDE * sizeof(float));
+
     for (i = 0; i < ERL_BAND_NUM; i++) {
         srv->mic_rec_part_band_energy[i] = 0.0f;
         srv->mic_send_part_band_energy[i] = 0.0f;
@@ -423,24 +418,48 @@ int dios_ssp_aec_firfilter_process(objFirFilter* srv, xcomplex* output_buf, xcom
     return 0;
 }
 
-int dios_ssp_aec_firfilter_uninit(objFirFilter* srv)
+int dios_ssp_aec_firfilter_external_process(objFirFilter* srv, xcomplex** est_ref, xcomplex* output_buf,
+                                            xcomplex* est_echo)
 {
-    int i;
+    int ch;
     int i_ref;
+
     if (NULL == srv) {
         return ERR_AEC;
     }
-    for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-        for (i = 0; i < AEC_SUBBAND_NUM; i++) {
-            free(srv->adf_coef[i_ref][i]);
-            free(srv->fir_coef[i_ref][i]);
-            free(srv->stack_sigIn_adf[i_ref][i]);
+
+    /* both filter groups hold the external estimate */
+    for (ch = AEC_LOW_CHAN; ch < AEC_HIGH_CHAN; ch++) {
+        srv->err_fir[ch] = srv->sig_mic_rec[ch];
+        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+            srv->est_ref_fir[i_ref][ch] = est_ref[i_ref][ch];
+            srv->est_ref_adf[i_ref][ch] = est_ref[i_ref][ch];
+            srv->err_fir[ch] = complex_sub(srv->err_fir[ch], est_ref[i_ref][ch]);
         }
+        srv->err_adf[ch] = srv->err_fir[ch];
+    }
 
-        free(srv->adf_coef[i_ref]);
-        free(srv->fir_coef[i_ref]);
-        free(srv->stack_sigIn_adf[i_ref]);
+    for (ch = 0; ch < AEC_LOW_CHAN; ch++) {
+        output_buf[ch].r = 0.0f;
+        output_buf[ch].i = 0.0f;
+    }
+    for (ch = AEC_HIGH_CHAN; ch < AEC_SUBBAND_NUM; ch++) {
+        output_buf[ch].r = 0.0f;
+        output_buf[ch].i = 0.0f;
+    }
+    dios_ssp_estecho_output(srv, output_buf, est_echo);
+    return 0;
+}
 
+int dios_ssp_aec_firfilter_uninit(objFirFilter* srv)
+{
+    int i;
+    int i_ref;
+    if (NULL == srv) {
+        return ERR_AEC;
+    }
+    dios_ssp_share_simd_free(srv->coef_block);
+    for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
         free(srv->power_in_ntaps_smooth[i_ref]);
         free(srv->est_ref_adf[i_ref]);
         free(srv->est_ref_fir[i_ref]);
@@ -451,9 +470,6 @@ int dios_ssp_aec_firfilter_uninit(objFirFilter* srv)
     }
     free(srv->power_echo_rtn_fir);
     free(srv->power_echo_rtn_adpt);
-    free(srv->fir_coef);
-    free(srv->adf_coef);
-    free(srv->stack_sigIn_adf);
     free(srv->err_adf);
     free(srv->err_fir);
     free(srv->est_ref_adf);
@@ -0,0 +1,288 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Description: Partitioned block frequency domain adaptive filter (PBFDAF, also
+known as MDF) for long echo tails. The echo path of each reference is split
+into part_num partitions of frm_len samples; one overlap-save fft of 2 * frm_len
+points per reference and frame feeds a ring of reference spectra, and the echo
+spectrum is the sum over partitions of filter times reference. The update is
+normalized by the smoothed power of each bin, with the error of each bin bounded
+relative to it, and shared among the partitions in proportion to their magnitude
+so that partitions past the end of the echo stay quiet. The gradient constraint,
+which keeps each partition a linear convolution, is applied to one partition per
+frame in turn, so a frame costs two extra ffts whatever the tail length.
+==============================================================================*/
+
+/* include file */
+#include "dios_ssp_aec_pbfdaf.h"
+
+/* offset of the spectrum of reference i_ref, partition part */
+static int pbfdaf_offset(const objPbfdaf *srv, int i_ref, int part)
+{
+    return (i_ref * srv->part_num + part) * srv->bin_stride;
+}
+
+/* floats of the aligned block: spectra, time buffers and partition gains */
+static int pbfdaf_block_len(const objPbfdaf *srv)
+{
+    return 4 * srv->ref_num * srv->part_num * srv->bin_stride + (2 * srv->ref_num + 3) * srv->bin_stride
+           + (srv->ref_num + 2) * srv->fft_len + srv->part_num;
+}
+
+/* packed spectrum of the rfft module from split bins 0..N */
+static void pbfdaf_pack(const objPbfdaf *srv, const float *re, const float *im, float *out)
+{
+    int k;
+    for (k = 0; k <= srv->frm_len; k++) {
+        out[k] = re[k];
+    }
+    for (k = 1; k < srv->frm_len; k++) {
+        out[srv->fft_len - k] = -im[k];
+    }
+}
+
+/* zero the second half of the impulse response of one partition */
+static void pbfdaf_constrain(objPbfdaf *srv, float *re, float *im)
+{
+    int i;
+    float scale = 1.0f / srv->fft_len;
+    pbfdaf_pack(srv, re, im, srv->fft_buf);
+    dios_ssp_share_irfft_process(srv->rfft_param, srv->fft_buf, srv->time_buf);
+    for (i = 0; i < srv->frm_len; i++) {
+        srv->time_buf[i] *= scale;
+    }
+    memset(srv->time_buf + srv->frm_len, 0, srv->frm_len * sizeof(float));
+    srv->batch_in[0] = srv->time_buf;
+    srv->batch_re[0] = re;
+    srv->batch_im[0] = im;
+    dios_ssp_share_rfft_batch_process(srv->rfft_param, srv->batch_in, 1, srv->batch_re, srv->batch_im, 1);
+}
+
+objPbfdaf* dios_ssp_aec_pbfdaf_init(int ref_num, int frm_len, int tail_ms)
+{
+    int ret = 0;
+    int spectra;
+    objPbfdaf* srv = NULL;
+
+    if (ref_num <= 0 || frm_len <= 0 || tail_ms <= 0 || tail_ms > AEC_PBFDAF_MAX_TAIL_MS) {
+        return NULL;
+    }
+    srv = (objPbfdaf*)calloc(1, sizeof(objPbfdaf));
+    if (NULL == srv) {
+        return NULL;
+    }
+
+    srv->ref_num = ref_num;
+    srv->frm_len = frm_len;
+    srv->fft_len = 2 * frm_len;
+    srv->bin_num = frm_len + 1;
+    srv->bin_stride = (srv->bin_num + 7) & ~7;
+    srv->part_num = (tail_ms * AEC_SAMPLE_RATE / 1000 + frm_len - 1) / frm_len;
+
+    srv->rfft_param = dios_ssp_share_rfft_batch_init(srv->fft_len);
+    if (NULL == srv->rfft_param) {
+        dios_ssp_aec_pbfdaf_uninit(srv);
+        return NULL;
+    }
+
+    spectra = ref_num * srv->part_num * srv->bin_stride;
+    srv->block = dios_ssp_share_simd_calloc(pbfdaf_block_len(srv));
+    if (NULL == srv->block) {
+        dios_ssp_aec_pbfdaf_uninit(srv);
+        return NULL;
+    }
+    srv->ref_re = srv->block;
+    srv->ref_im = srv->ref_re + spectra;
+    srv->coef_re = srv->ref_im + spectra;
+    srv->coef_im = srv->coef_re + spectra;
+    srv->echo_re = srv->coef_im + spectra;
+    srv->echo_im = srv->echo_re + ref_num * srv->bin_stride;
+    srv->err_re = srv->echo_im + ref_num * srv->bin_stride;
+    srv->err_im = srv->err_re + srv->bin_stride;
+    srv->ref_power = srv->err_im + srv->bin_stride;
+    srv->ref_time = srv->ref_power + srv->bin_stride;
+    srv->fft_buf = srv->ref_time + ref_num * srv->fft_len;
+    srv->time_buf = srv->fft_buf + srv->fft_len;
+    srv->part_gain = srv->time_buf + srv->fft_len;
+
+    srv->batch_in = (float **)calloc(ref_num, sizeof(float*));
+    srv->batch_re = (float **)calloc(ref_num, sizeof(float*));
+    srv->batch_im = (float **)calloc(ref_num, sizeof(float*));
+    if (NULL == srv->batch_in || NULL == srv->batch_re || NULL == srv->batch_im) {
+        dios_ssp_aec_pbfdaf_uninit(srv);
+        return NULL;
+    }
+
+    ret = dios_ssp_aec_pbfdaf_reset(srv);
+    if (0 != ret) {
+        dios_ssp_aec_pbfdaf_uninit(srv);
+        return NULL;
+    }
+    return srv;
+}
+
+int dios_ssp_aec_pbfdaf_reset(objPbfdaf* srv)
+{
+    if (NULL == srv) {
+        return ERR_AEC;
+    }
+    memset(srv->block, 0, pbfdaf_block_len(srv) * sizeof(float));
+    srv->part_pos = 0;
+    srv->constrain_pos = 0;
+    return 0;
+}
+
+int dios_ssp_aec_pbfdaf_process(objPbfdaf* srv, const float* mic, float** ref, float myu,
+                                float** echo, float* err)
+{
+    int i, k, p;
+    int i_ref;
+    int n;
+    float scale;
+
+    if (NULL == srv) {
+        return ERR_AEC;
+    }
+    n = srv->frm_len;
+    scale = 1.0f / srv->fft_len;
+
+    /* newest reference spectra take the slot of the oldest ones */
+    srv->part_pos = (srv->part_pos + srv->part_num - 1) % srv->part_num;
+    for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+        float *x = srv->ref_time + i_ref * srv->fft_len;
+        memmove(x, x + n, n * sizeof(float));
+        memcpy(x + n, ref[i_ref], n * sizeof(float));
+        srv->batch_in[i_ref] = x;
+        srv->batch_re[i_ref] = srv->ref_re + pbfdaf_offset(srv, i_ref, srv->part_pos);
+        srv->batch_im[i_ref] = srv->ref_im + pbfdaf_offset(srv, i_ref, srv->part_pos);
+    }
+    dios_ssp_share_rfft_batch_process(srv->rfft_param, srv->batch_in, srv->ref_num,
+                                      srv->batch_re, srv->batch_im, 1);
+
+    /* echo of each reference: partition p filters the spectrum p frames old,
+       the last frm_len samples of the overlap-save output are valid */
+    memcpy(err, mic, n * sizeof(float));
+    for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+        float *yr = srv->echo_re + i_ref * srv->bin_stride;
+        float *yi = srv->echo_im + i_ref * srv->bin_stride;
+        memset(yr, 0, srv->bin_num * sizeof(float));
+        memset(yi, 0, srv->bin_num * sizeof(float));
+        for (p = 0; p < srv->part_num; p++) {
+            int off_coef = pbfdaf_offset(srv, i_ref, p);
+            int off_ref = pbfdaf_offset(srv, i_ref, (srv->part_pos + p) % srv->part_num);
+            dios_ssp_share_cvec_mul_acc(srv->coef_re + off_coef, srv->coef_im + off_coef,
+                                        srv->ref_re + off_ref, srv->ref_im + off_ref, 0, yr, yi, srv->bin_num);
+        }
+        pbfdaf_pack(srv, yr, yi, srv->fft_buf);
+        dios_ssp_share_irfft_process(srv->rfft_param, srv->fft_buf, srv->time_buf);
+        for (i = 0; i < n; i++) {
+            echo[i_ref][i] = srv->time_buf[n + i] * scale;
+            err[i] -= echo[i_ref][i];
+        }
+    }
+
+    if (myu <= 0.0f) {
+        return 0;
+    }
+
+    /* error spectrum of [0, err] */
+    memset(srv->time_buf, 0, n * sizeof(float));
+    memcpy(srv->time_buf + n, err, n * sizeof(float));
+    srv->batch_in[0] = srv->time_buf;
+    srv->batch_re[0] = srv->err_re;
+    srv->batch_im[0] = srv->err_im;
+    dios_ssp_share_rfft_batch_process(srv->rfft_param, srv->batch_in, 1, srv->batch_re, srv->batch_im, 1);
+
+    /* step normalized per bin by the smoothed power of the newest reference
+       spectra, times part_num as the update runs over all partitions. the error
+       of a bin is bounded relative to that power: between the harmonics of a
+       talker the reference holds little more than noise while the error spectrum
+       of the half window still leaks harmonic energy, and the unbounded step
+       would blow the coefficients up once the pitch moves a harmonic into the bin */
+    for (k = 0; k < srv->bin_num; k++) {
+        float power = 0.0f;
+        for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+            int off = pbfdaf_offset(srv, i_ref, srv->part_pos);
+            power += srv->ref_re[off + k] * srv->ref_re[off + k] + srv->ref_im[off + k] * srv->ref_im[off + k];
+        }
+        srv->ref_power[k] = AEC_PBFDAF_POWER_ALPHA * srv->ref_power[k] + (1.0f - AEC_PBFDAF_POWER_ALPHA) * power;
+    }
+    for (k = 0; k < srv->bin_num; k++) {
+        float power = srv->part_num * srv->ref_power[k] + AEC_PBFDAF_DELTA * srv->fft_len;
+        float err_power = srv->err_re[k] * srv->err_re[k] + srv->err_im[k] * srv->err_im[k];
+        float bound = AEC_PBFDAF_ERR_BOUND * AEC_PBFDAF_ERR_BOUND * power;
+        float step = myu / power;
+        if (err_power > bound) {
+            step *= sqrtf(bound / err_power);
+        }
+        srv->err_re[k] *= step;
+        srv->err_im[k] *= step;
+    }
+
+    for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
+        float *step_re = srv->echo_re + i_ref * srv->bin_stride;
+        float *step_im = srv->echo_im + i_ref * srv->bin_stride;
+        float norm_sum = 0.0f;
+
+        /* proportionate gain of each partition, averaging 1: a share spread evenly
+           and a share following the magnitude of the partition, the partitions
+           holding the echo adapt faster and those past its end add little noise */
+        for (p = 0; p < srv->part_num; p++) {
+            int off_coef = pbfdaf_offset(srv, i_ref, p);
+            srv->part_gain[p] = sqrtf(dios_ssp_share_cvec_power(srv->coef_re + off_coef, srv->coef_im + off_coef,
+                                                                NULL, srv->bin_num));
+            norm_sum += srv->part_gain[p];
+        }
+        for (p = 0; p < srv->part_num; p++) {
+            srv->part_gain[p] = norm_sum > 0.0f ? 1.0f - AEC_PBFDAF_PROP_SHARE
+                                + AEC_PBFDAF_PROP_SHARE * srv->part_num * srv->part_gain[p] / norm_sum : 1.0f;
+        }
+
+        /* W += gain * conj(X) * E, the echo spectra are spent and hold the scaled
+           error, then constrain one partition */
+        for (p = 0; p < srv->part_num; p++) {
+            int off_coef = pbfdaf_offset(srv, i_ref, p);
+            int off_ref = pbfdaf_offset(srv, i_ref, (srv->part_pos + p) % srv->part_num);
+            for (k = 0; k < srv->bin_num; k++) {
+                step_re[k] = srv->part_gain[p] * srv->err_re[k];
+                step_im[k] = srv->part_gain[p] * srv->err_im[k];
+            }
+            dios_ssp_share_cvec_mul_acc(srv->ref_re + off_ref, srv->ref_im + off_ref, step_re, step_im, 1,
+                                        srv->coef_re + off_coef, srv->coef_im + off_coef, srv->bin_num);
+        }
+        p = pbfdaf_offset(srv, i_ref, srv->constrain_pos);
+        pbfdaf_constrain(srv, srv->coef_re + p, srv->coef_im + p);
+    }
+    srv->constrain_pos = (srv->constrain_pos + 1) % srv->part_num;
+    return 0;
+}
+
+int dios_ssp_aec_pbfdaf_uninit(objPbfdaf* srv)
+{
+    int ret = 0;
+    if (NULL == srv) {
+        return ERR_AEC;
+    }
+    dios_ssp_share_simd_free(srv->block);
+    free(srv->batch_in);
+    free(srv->batch_re);
+    free(srv->batch_im);
+    ret = dios_ssp_share_rfft_uninit(srv->rfft_param);
+    free(srv);
+    if (0 != ret) {
+        return ERR_AEC;
+    }
+    return 0;
+}
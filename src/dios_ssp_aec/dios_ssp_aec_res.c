@@ -45,10 +45,9 @@ int dios_ssp_aec_res_get_residual_echo(objRES* srv, float *residual_echo, int dt
     }
     if (stage == 1) {
         /* Compute power spectrum of the echo */
+        dios_ssp_share_xcvec_abs2(&srv->Xf_echo[AEC_LOW_CHAN], 0, &srv->echoPsd[AEC_LOW_CHAN], AEC_HIGH_CHAN - AEC_LOW_CHAN);
+        dios_ssp_share_xcvec_abs2(&srv->Xf_res_echo[AEC_LOW_CHAN], 0, &resPsd[AEC_LOW_CHAN], AEC_HIGH_CHAN - AEC_LOW_CHAN);
         for (i = AEC_LOW_CHAN; i < AEC_HIGH_CHAN; i++) {
-            srv->echoPsd[i] = complex_abs2(srv->Xf_echo[i]);
-            resPsd[i] = complex_abs2(srv->Xf_res_echo[i]);
-
             /* Compute filtered spectra and (cross-)correlations */
             Eh = resPsd[i] - srv->Eh[i];
             Yh = srv->echoPsd[i] - srv->Yh[i];
@@ -268,9 +267,7 @@ int dios_ssp_aec_res_process(objRES *srv, int dt_st, int stage)
 
     srv->res_echo_psd = resEchoPsd;
 
-    for (i = AEC_LOW_CHAN; i < AEC_HIGH_CHAN; i++) {
-        ps[i] = complex_abs2(srv->Xf_res_echo[i]);
-    }
+    dios_ssp_share_xcvec_abs2(&srv->Xf_res_echo[AEC_LOW_CHAN], 0, &ps[AEC_LOW_CHAN], AEC_HIGH_CHAN - AEC_LOW_CHAN);
 
     /* Cal post ser and priori ser */
     if (stage == 1) {
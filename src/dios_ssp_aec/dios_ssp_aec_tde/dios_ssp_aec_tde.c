@@ -22,16 +22,25 @@ reference and mic signal.
 /* include file */
 #include "dios_ssp_aec_tde.h"
 
-objTDE* dios_ssp_aec_tde_init(int mic_num, int ref_num, int frm_len)
+objTDE* dios_ssp_aec_tde_init(int mic_num, int ref_num, int frm_len, int max_delay_ms)
 {
     int i;
     int ret;
     objTDE *srv = NULL;
+
+    if (max_delay_ms < AEC_TDE_MIN_DELAY_MS || max_delay_ms > AEC_TDE_MAX_DELAY_MS) {
+        return NULL;
+    }
     srv = (objTDE *)calloc(1, sizeof(objTDE));
 
     srv->mic_num = mic_num;
     srv->ref_num = ref_num;
     srv->frm_len = frm_len;
+    srv->max_delay_long = (max_delay_ms * (AEC_SAMPLE_RATE / 1000) + PART_LEN - 1) / PART_LEN;
+    /* the reference is read back by the long-term delay plus the short-term
+       delay less half its range, the push side never wraps inside a frame */
+    srv->buf_len = srv->max_delay_long * PART_LEN + MAX_DELAY_SHORT * PART_LEN / 2;
+    srv->buf_len = (srv->buf_len + frm_len - 1) / frm_len * frm_len;
 
     srv->tde_short = NULL;
     srv->tde_long = NULL;
@@ -44,19 +53,19 @@ objTDE* dios_ssp_aec_tde_init(int mic_num, int ref_num, int frm_len)
 
     srv->audioBuf_mic = (float **)calloc(srv->mic_num, sizeof(float*));
     for (i = 0; i < srv->mic_num; i++) {
-        srv->audioBuf_mic[i] = (float*)calloc(DELAY_BUFFER_SIZE, sizeof(float));
+        srv->audioBuf_mic[i] = (float*)calloc(srv->buf_len, sizeof(float));
     }
 
     srv->audioBuf_ref = (float **)calloc(srv->ref_num, sizeof(float*));
     for(i = 0; i < srv->ref_num; i++) {
-        srv->audioBuf_ref[i] = (float *)calloc(DELAY_BUFFER_SIZE, sizeof(float));
+        srv->audioBuf_ref[i] = (float *)calloc(srv->buf_len, sizeof(float));
     }
 
     srv->tdeBuf_ref = (float *)calloc(PART_LEN, sizeof(float));
     srv->tdeBuf_mic = (float *)calloc(PART_LEN, sizeof(float));
 
     /* long-term tde */
-    ret = dios_ssp_aec_tde_creatcore(&srv->tde_long, MAX_DELAY_LONG, DELAY_WIN_SLIDE_TDE);
+    ret = dios_ssp_aec_tde_creatcore(&srv->tde_long, srv->max_delay_long, DELAY_WIN_SLIDE_TDE);
     if (ret != 0) {
         printf("dios_ssp_aec_tde_creatcore Error!\n");
     }
@@ -91,11 +100,11 @@ int dios_ssp_aec_tde_reset(objTDE *srv)
     srv->flag_delayfind = 0;
 
     for(i = 0; i < srv->mic_num; i++) {
-        memset(srv->audioBuf_mic[i], 0, DELAY_BUFFER_SIZE * sizeof(float));
+        memset(srv->audioBuf_mic[i], 0, srv->buf_len * sizeof(float));
     }
 
     for(i = 0; i < srv->ref_num; i++) {
-        memset(srv->audioBuf_ref[i], 0, DELAY_BUFFER_SIZE * sizeof(float));
+        memset(srv->audioBuf_ref[i], 0, srv->buf_len * sizeof(float));
     }
     memset(srv->tdeBuf_ref, 0, PART_LEN * sizeof(float));
     memset(srv->tdeBuf_mic, 0, PART_LEN * sizeof(float));
@@ -144,18 +153,21 @@ int dios_ssp_aec_tde_process(objTDE *srv, float* refbuf, float* micbuf)
 
 #if (DIOS_SSP_AEC_TDE_ON == 1)
     int idx;
+    /* both estimators see the same near end blocks, the long-term one transforms
+       them and the short-term one reuses the spectra */
+    float near_abs[2][PART_LEN1];
     /* long-term delay estimation */
     srv->flag_delayfind = 0;
     for (i_tde = 0; i_tde < 2; i_tde++) {
         for (i = 0; i < PART_LEN; i++) {
             idx = srv->pt_buf_push + i + i_tde * PART_LEN - look_ahead;
             if (idx < 0) {
-                idx += DELAY_BUFFER_SIZE;
+                idx += srv->buf_len;
             }
             srv->tdeBuf_mic[i] =  srv->audioBuf_mic[0][idx];
             srv->tdeBuf_ref[i] =  srv->audioBuf_ref[0][srv->pt_buf_push + i + i_tde * PART_LEN];
         }
-        int flag1 = dios_ssp_aec_tde_ProcessBlock(srv->tde_long, srv->tdeBuf_ref, srv->tdeBuf_mic);
+        int flag1 = dios_ssp_aec_tde_ProcessBlock(srv->tde_long, srv->tdeBuf_ref, srv->tdeBuf_mic, near_abs[i_tde]);
         srv->CalibrateCounter--;
         if (srv->CalibrateCounter == 0) {
             srv->CalibrateEnable = 1;
@@ -177,20 +189,15 @@ int dios_ssp_aec_tde_process(objTDE *srv, float* refbuf, float* micbuf)
 
     /* short-term delay estimation */
     for (i_tde = 0; i_tde < 2; i_tde++) {
-        int j1, j2;
+        int j2;
         for (i = 0; i < PART_LEN; i++) {
-            j1 =  srv->pt_buf_push + i + i_tde * PART_LEN - look_ahead;
-            if (j1 < 0) {
-                j1 += DELAY_BUFFER_SIZE;
-            }
-            srv->tdeBuf_mic[i] =  srv->audioBuf_mic[0][j1];
             j2 = srv->pt_buf_push + i + i_tde * PART_LEN - srv->tde_long_shift_smpl;
             if (j2 < 0) {
-                j2 += DELAY_BUFFER_SIZE;
+                j2 += srv->buf_len;
             }
             srv->tdeBuf_ref[i] =  srv->audioBuf_ref[0][j2];
         }
-        int flag2 = dios_ssp_aec_tde_ProcessBlock(srv->tde_short, srv->tdeBuf_ref, srv->tdeBuf_mic);
+        int flag2 = dios_ssp_aec_tde_ProcessBlock(srv->tde_short, srv->tdeBuf_ref, NULL, near_abs[i_tde]);
         if (flag2) {
             srv->tde_short_shift_smpl = get_tde_final(srv->tde_short);
         } else {
@@ -219,11 +226,11 @@ int dios_ssp_aec_tde_process(objTDE *srv, float* refbuf, float* micbuf)
     /* mic signal */
     pt_pop = srv->pt_buf_push - look_ahead;
     if (pt_pop < 0) {
-        pt_pop += DELAY_BUFFER_SIZE;
+        pt_pop += srv->buf_len;
     }
     for (i_mic = 0; i_mic < srv->mic_num; i_mic++) {
-        if (pt_pop < DELAY_BUFFER_SIZE && (pt_pop + srv->frm_len > DELAY_BUFFER_SIZE)) {
-            int len = DELAY_BUFFER_SIZE - pt_pop;
+        if (pt_pop < srv->buf_len && (pt_pop + srv->frm_len > srv->buf_len)) {
+            int len = srv->buf_len - pt_pop;
             memcpy(micbuf + i_mic * srv->frm_len, srv->audioBuf_mic[i_mic] + pt_pop, len * sizeof(float));
             memcpy(micbuf + i_mic * srv->frm_len + len, srv->audioBuf_mic[i_mic], (srv->frm_len - len) * sizeof(float));
         } else {
@@ -233,13 +240,13 @@ int dios_ssp_aec_tde_process(objTDE *srv, float* refbuf, float* micbuf)
 
     /* ref signal */
     if (srv->pt_buf_push - srv->act_delay_smpl < 0) {
-        pp = DELAY_BUFFER_SIZE + (srv->pt_buf_push - srv->act_delay_smpl);
+        pp = srv->buf_len + (srv->pt_buf_push - srv->act_delay_smpl);
     } else {
         pp = srv->pt_buf_push - srv->act_delay_smpl;
     }
     for (i_ref = 0; i_ref < srv->ref_num; i_ref++) {
-        if (pp < DELAY_BUFFER_SIZE && (pp + srv->frm_len > DELAY_BUFFER_SIZE)) {
-            int len = DELAY_BUFFER_SIZE - pp;
+        if (pp < srv->buf_len && (pp + srv->frm_len > srv->buf_len)) {
+            int len = srv->buf_len - pp;
             memcpy(refbuf + i_ref * srv->frm_len, srv->audioBuf_ref[i_ref] + pp, len * sizeof(float));
             memcpy(refbuf + i_ref * srv->frm_len + len, srv->audioBuf_ref[i_ref], (srv->frm_len - len) * sizeof(float));
         } else {
@@ -247,11 +254,27 @@ int dios_ssp_aec_tde_process(objTDE *srv, float* refbuf, float* micbuf)
         }
     }
 
-    srv->pt_buf_push = (srv->pt_buf_push + srv->frm_len) % DELAY_BUFFER_SIZE;
+    srv->pt_buf_push = (srv->pt_buf_push + srv->frm_len) % srv->buf_len;
 
     return 0;
 }
 
+int dios_ssp_aec_tde_memory_get(objTDE* srv)
+{
+    int bytes;
+    if (NULL == srv) {
+        return ERR_AEC;
+    }
+
+    bytes = sizeof(objTDE);
+    bytes += (srv->mic_num + srv->ref_num) * (sizeof(float*) + srv->buf_len * sizeof(float));
+    bytes += 2 * PART_LEN * sizeof(float);
+    bytes += dios_ssp_aec_tde_corememory(srv->tde_long);
+    bytes += dios_ssp_aec_tde_corememory(srv->tde_short);
+
+    return bytes;
+}
+
 int dios_ssp_aec_tde_uninit(objTDE* srv)
 {
     int i_mic;
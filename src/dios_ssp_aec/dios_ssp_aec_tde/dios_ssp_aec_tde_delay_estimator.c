@@ -67,6 +67,16 @@ void dios_ssp_aec_tde_meanestimate(int new_value, int factor, int* mean_value)
     *mean_value += diff;
 }
 
+/* Subtracts |value| from the histogram of delays [start, end), floored at 0 */
+static void HistogramDecrease(float* histogram, int start, int end, float value)
+{
+    int i;
+    for (i = start; i < end; i++) {
+        histogram[i] -= value;
+        histogram[i] = (histogram[i] < 0 ? 0 : histogram[i]);
+    }
+}
+
 /* Collects necessary statistics */
 static void UpdateRobustValidationStatistics(BinaryDelayEstimator* self,
         int candidate_delay,
@@ -94,16 +104,33 @@ static void UpdateRobustValidationStatistics(BinaryDelayEstimator* self,
         decrease_in_last_set = (self->mean_bit_counts[self->compare_delay] - valley_level_q14) * kQ14Scaling;
     }
 
-    for (i = 0; i < self->farend->history_size; ++i) {
-        int is_in_last_set = (i >= self->last_delay - 2) && (i <= self->last_delay + 1) && (i != candidate_delay);
-        int is_in_candidate_set = (i >= candidate_delay - 2) && (i <= candidate_delay + 1);
+    // Delays outside the last and the candidate set all lose |valley_depth|, in
+    // bulk between the two sets; the at most 8 delays of the sets one by one.
+    int set_start[2] = { self->last_delay - 2, candidate_delay - 2 };
+    int set_end[2] = { self->last_delay + 2, candidate_delay + 2 };
+    int first = (set_start[1] < set_start[0]);
+    int pos = 0;
+    int k;
+    for (k = 0; k < 2; k++) {
+        int start = set_start[first ^ k] < pos ? pos : set_start[first ^ k];
+        int end = set_end[first ^ k] > self->farend->history_size ? self->farend->history_size : set_end[first ^ k];
+        if (start >= end) {
+            continue;
+        }
+        HistogramDecrease(self->histogram, pos, start, valley_depth);
+        for (i = start; i < end; ++i) {
+            int is_in_last_set = (i >= self->last_delay - 2) && (i <= self->last_delay + 1) && (i != candidate_delay);
+            int is_in_candidate_set = (i >= candidate_delay - 2) && (i <= candidate_delay + 1);
 
-        self->histogram[i] -= decrease_in_last_set * is_in_last_set + valley_depth * (!is_in_last_set && !is_in_candidate_set);
+            self->histogram[i] -= decrease_in_last_set * is_in_last_set + valley_depth * (!is_in_last_set && !is_in_candidate_set);
 
-        if (self->histogram[i] < 0) {
-            self->histogram[i] = 0;
+            if (self->histogram[i] < 0) {
+                self->histogram[i] = 0;
+            }
         }
+        pos = end;
     }
+    HistogramDecrease(self->histogram, pos, self->farend->history_size, valley_depth);
 }
 
 // Validates the |candidate_delay|, estimated in dios_ssp_aec_tde_processbinaryspectrum(),
@@ -140,9 +167,10 @@ int dios_ssp_aec_tde_processbinaryspectrum(BinaryDelayEstimator* self, unsigned
     int valid_candidate = 0;
     int value_best_candidate = kMaxBitCountsQ9;
     int value_worst_candidate = 0;
+    int value_min = 0;
+    int value_max = 0;
+    int min_delay = 0;
     int valley_depth = 0;
-    int shifts = 0;
-    int bit_count = 0;
     int threshold = 0;
     int is_histogram_valid = 0;
     int is_robust = 0;
@@ -151,25 +179,42 @@ int dios_ssp_aec_tde_processbinaryspectrum(BinaryDelayEstimator* self, unsigned
         return -1;
     }
 
-    for (i = 0; i < self->farend->history_size; i++) {
-        // Compare with delayed spectra and store the |bit_counts| for each delay.
-        self->bit_counts[i] = (int) BitCount(binary_near_spectrum ^ self->farend->binary_far_history[i]);
-        bit_count = 512 * self->bit_counts[i];
-
-        // Update |mean_bit_counts| only when far-end signal has something to
-        // contribute. If |far_bit_counts| is zero the far-end signal is weak and
-        // we likely have a poor echo condition, hence don't update.
-        if (self->farend->far_bit_counts[i] > 0) {
-            shifts = kShiftsAtZero;
-            shifts -= (int) (kShiftsLinearSlope * self->farend->far_bit_counts[i]) / 16;
-            dios_ssp_aec_tde_meanestimate(bit_count, shifts, &(self->mean_bit_counts[i]));
-        }
-
-        if (self->mean_bit_counts[i] < value_best_candidate) {
-            value_best_candidate = self->mean_bit_counts[i];
-            candidate_delay = i;
-        } else if (self->mean_bit_counts[i] > value_worst_candidate) {
-            value_worst_candidate = self->mean_bit_counts[i];
+    // Compare with delayed spectra and store the |bit_counts| for each delay,
+    // all delays at once. |mean_bit_counts| is updated only when far-end signal
+    // has something to contribute. If the far-end spectrum is empty its shift
+    // is zero, the far-end signal is weak and we likely have a poor echo
+    // condition, hence don't update.
+    dios_ssp_share_popcount_mean(binary_near_spectrum,
+                                 self->farend->binary_far_history + self->farend->history_pos,
+                                 self->farend->far_shifts + self->farend->history_pos,
+                                 self->bit_counts, self->mean_bit_counts, self->farend->history_size);
+
+    // Find the valley. The best candidate is the first smallest mean below
+    // |kMaxBitCountsQ9|. The worst candidate is the largest mean that is not a
+    // new running minimum, which is the overall largest mean unless that is
+    // found at delay zero only; that rare case is scanned once more.
+    dios_ssp_share_vec_min_max_int(self->mean_bit_counts, &value_min, &min_delay, &value_max,
+                                   self->farend->history_size);
+    if (value_min < kMaxBitCountsQ9) {
+        value_best_candidate = value_min;
+        candidate_delay = min_delay;
+    }
+    if (value_max > 0) {
+        value_worst_candidate = value_max;
+        if ((self->mean_bit_counts[0] == value_max) && (value_max < kMaxBitCountsQ9)) {
+            for (i = 1; (i < self->farend->history_size) && (self->mean_bit_counts[i] != value_max); i++) {
+            }
+            if (i == self->farend->history_size) {
+                value_worst_candidate = 0;
+                value_min = kMaxBitCountsQ9;
+                for (i = 0; i < self->farend->history_size; i++) {
+                    if (self->mean_bit_counts[i] < value_min) {
+                        value_min = self->mean_bit_counts[i];
+                    } else if (self->mean_bit_counts[i] > value_worst_candidate) {
+                        value_worst_candidate = self->mean_bit_counts[i];
+                    }
+                }
+            }
         }
     }
 
@@ -219,16 +264,29 @@ int dios_ssp_aec_tde_processbinaryspectrum(BinaryDelayEstimator* self, unsigned
 
 void dios_ssp_aec_tde_addbinaryfarspectrum(BinaryDelayEstimatorFarend* handle, unsigned int binary_far_spectrum)
 {
+    int far_bit_count;
+    int shifts = 0;
+    int pos;
+
     if(handle == NULL) {
         return;
     }
 
-    // Shift binary spectrum history and insert current |binary_far_spectrum|.
-    memmove(&(handle->binary_far_history[1]), &(handle->binary_far_history[0]), (handle->history_size - 1) * sizeof(unsigned int));
-    handle->binary_far_history[0] = binary_far_spectrum;
+    // Number of right shifts for the mean update is linearly depending on
+    // number of bits in the far-end binary spectrum.
+    far_bit_count = BitCount(binary_far_spectrum);
+    if (far_bit_count > 0) {
+        shifts = kShiftsAtZero - (kShiftsLinearSlope * far_bit_count) / 16;
+    }
 
-    memmove(&(handle->far_bit_counts[1]), &(handle->far_bit_counts[0]), (handle->history_size - 1) * sizeof(int));
-    handle->far_bit_counts[0] = BitCount(binary_far_spectrum);
+    // Insert current |binary_far_spectrum| in front of the history, in both
+    // halves of the ring.
+    pos = (handle->history_pos == 0 ? handle->history_size : handle->history_pos) - 1;
+    handle->binary_far_history[pos] = binary_far_spectrum;
+    handle->binary_far_history[pos + handle->history_size] = binary_far_spectrum;
+    handle->far_shifts[pos] = shifts;
+    handle->far_shifts[pos + handle->history_size] = shifts;
+    handle->history_pos = pos;
 }
 
 /* initialization subfunction */
@@ -241,8 +299,8 @@ void dios_ssp_aec_tde_freebinarydelayestimatorfarend(BinaryDelayEstimatorFarend*
     free(self->binary_far_history);
     self->binary_far_history = NULL;
 
-    free(self->far_bit_counts);
-    self->far_bit_counts = NULL;
+    free(self->far_shifts);
+    self->far_shifts = NULL;
 
     free(self);
 }
@@ -261,11 +319,11 @@ BinaryDelayEstimatorFarend* dios_ssp_aec_tde_creatbinarydelayestimatorfarend(int
         self->history_size = history_size;
 
         // Allocate memory for history buffers.
-        self->binary_far_history = (unsigned int*)calloc(history_size, sizeof(unsigned int));
+        self->binary_far_history = (unsigned int*)calloc(2 * history_size, sizeof(unsigned int));
         malloc_fail |= (self->binary_far_history == NULL);
 
-        self->far_bit_counts = (int*)calloc(history_size, sizeof(int));
-        malloc_fail |= (self->far_bit_counts == NULL);
+        self->far_shifts = (int*)calloc(2 * history_size, sizeof(int));
+        malloc_fail |= (self->far_shifts == NULL);
 
         if (malloc_fail) {
             dios_ssp_aec_tde_freebinarydelayestimatorfarend(self);
@@ -281,8 +339,9 @@ void dios_ssp_aec_tde_initbinarydelayestimatorfarend(BinaryDelayEstimatorFarend*
     if(self == NULL) {
         return;
     }
-    memset(self->binary_far_history, 0, sizeof(unsigned int) * self->history_size);
-    memset(self->far_bit_counts, 0, sizeof(int) * self->history_size);
+    memset(self->binary_far_history, 0, sizeof(unsigned int) * 2 * self->history_size);
+    memset(self->far_shifts, 0, sizeof(int) * 2 * self->history_size);
+    self->history_pos = 0;
 }
 
 void dios_ssp_aec_tde_freebinarydelayestimator(BinaryDelayEstimator* self)
@@ -29,30 +29,6 @@ enum { kBandFirst = 12 };
 enum { kBandLast = 43 };
 
 /* third level function begin */
-short dios_ssp_aec_tde_maxabsvalueW16C(float* vector, int length)
-{
-    int i = 0, absolute = 0, maximum = 0;
-
-    if (vector == NULL || length <= 0) {
-        return -1;
-    }
-
-    for (i = 0; i < length; i++) {
-        absolute = abs((int)vector[i]);
-
-        if (absolute > maximum) {
-            maximum = absolute;
-        }
-    }
-
-    // Guard the case for abs(-32768).
-    if (maximum > DIOS_SSP_WORD16_MAX) {
-        maximum = DIOS_SSP_WORD16_MAX;
-    }
-
-    return (short)maximum;
-}
-
 /* Computes the binary spectrum by comparing the input |spectrum| with a |threshold_spectrum|. */
 // Input:
 // spectrum: Spectrum of which the binary spectrum should be calculated.
@@ -91,40 +67,28 @@ static unsigned int BinarySpectrum(float* spectrum, SpectrumType* threshold_spec
 /* third level function end */
 
 /* second level function begin*/
-/* Description: Transforms a time domain signal into the frequency domain, outputting the complex valued signal,
- * absolute value and sum of absolute values.
+/* Description: Transforms a time domain signal into the frequency domain, outputting the
+ * absolute value of bins kBandFirst to kBandLast, the only ones BinarySpectrum reads.
+ * The spectra are float, so there is no Q-domain to track.
  * Input:
  * time_signal:  Pointer to time domain signal
  * Output:
- * freq_signal_real: Pointer to real part of frequency domain array freq_signal_imag: Pointer to
- * imaginary part of frequency domain array
  * freq_signal_abs: Pointer to absolute value of frequency domain array
- * Return:
- * The Q-domain of current frequency values
  */
 
-static int TimeToFrequencyDomain(AecmCore_t* srv, float* time_signal, float* freq_signal_abs)
+static void TimeToFrequencyDomain(AecmCore_t* srv, const float* time_signal, float* freq_signal_abs)
 {
     int i = 0;
-    int time_signal_scaling = 0;
-    short tmp16no1;
     float fft[PART_LEN2];
 
-    tmp16no1 = dios_ssp_aec_tde_maxabsvalueW16C(time_signal, PART_LEN2);
-    time_signal_scaling = NormW16(tmp16no1);
-
     for (i = 0; i < PART_LEN2; i++) {
         fft[i] = time_signal[i] * srv->tde_ana_win[i];
     }
     dios_ssp_share_rfft_process(srv->rfft_param, fft, srv->fft_out);
 
-    freq_signal_abs[0] = (float)sqrt(srv->fft_out[0] * srv->fft_out[0]);
-    freq_signal_abs[PART_LEN] = (float)sqrt(srv->fft_out[PART_LEN] * srv->fft_out[PART_LEN]);
-    for (i = 1; i < PART_LEN; i++) {
-        freq_signal_abs[i] = (float)sqrt(srv->fft_out[i] * srv->fft_out[i] + srv->fft_out[PART_LEN2 - i] * srv->fft_out[PART_LEN2 - i]);
+    for (i = kBandFirst; i <= kBandLast; i++) {
+        freq_signal_abs[i] = sqrtf(srv->fft_out[i] * srv->fft_out[i] + srv->fft_out[PART_LEN2 - i] * srv->fft_out[PART_LEN2 - i]);
     }
-
-    return time_signal_scaling;
 }
 
 int dios_ssp_aec_tde_addfarspectrum(void* handle, float* far_spectrum, int spectrum_size, int far_q)
@@ -187,50 +151,36 @@ int dios_ssp_aec_tde_delayestimateprocess(void* handle, float* near_spectrum, in
 /* first level function begin */
 int dios_ssp_aec_tde_ProcessBlock(AecmCore_t * srv,
                                   float * farend,
-                                  float * nearendNoisy)
+                                  float * nearendNoisy,
+                                  float * near_abs)
 {
-    int i;
     int flag_delayfind = 0;
-    int max_v, max_i;  /* find maximal value and index of histogram */
+    int oldest;
     float xfa[PART_LEN1];    /* farend signal frequency domain amplitude */
-    float dfaNoisy[PART_LEN1];   /* near end signal frequency domain amplitude */
     int delay;
-    short zerosDBufNoisy;
-    int far_q;
 
+    // Buffer far end signal
     memcpy(srv->xBuf, srv->xBuf + PART_LEN, sizeof(float) * PART_LEN);
-    memcpy(srv->dBufNoisy,srv->dBufNoisy + PART_LEN, sizeof(float) * PART_LEN);
-    // Buffer near and far end signals
     memcpy(srv->xBuf + PART_LEN, farend, sizeof(float) * PART_LEN);
-    memcpy(srv->dBufNoisy + PART_LEN, nearendNoisy, sizeof(float) * PART_LEN);
 
     /* hanning window FFT. multiply 128points with a 128-point hanning window, then FFT*/
     // Transform far end signal from time domain to frequency domain.
-    far_q = TimeToFrequencyDomain(srv,
-                                  srv->xBuf,
-                                  xfa);
+    TimeToFrequencyDomain(srv, srv->xBuf, xfa);
 
-    // Transform noisy near end signal from time domain to frequency domain.
-    zerosDBufNoisy = TimeToFrequencyDomain(srv,
-                                           srv->dBufNoisy,
-                                           dfaNoisy);
+    // Transform noisy near end signal from time domain to frequency domain,
+    // unless the caller passes the spectrum of an estimator fed the same blocks
+    if (NULL != nearendNoisy) {
+        memcpy(srv->dBufNoisy, srv->dBufNoisy + PART_LEN, sizeof(float) * PART_LEN);
+        memcpy(srv->dBufNoisy + PART_LEN, nearendNoisy, sizeof(float) * PART_LEN);
+        TimeToFrequencyDomain(srv, srv->dBufNoisy, near_abs);
+    }
 
     // Get the delay
     // Save far-end history and estimate delay
-    // Get new buffer position
-    srv->far_history_pos++;
-    if (srv->far_history_pos >= srv->max_delay_history_size) {
-        srv->far_history_pos = 0;
-    }
-    // Update Q-domain buffer
-    srv->far_q_domains[srv->far_history_pos] = far_q;
-    // Update far end spectrum buffer
-    memcpy(&(srv->far_history[srv->far_history_pos * PART_LEN1]), xfa, sizeof(float) * PART_LEN1);
-
-    if (dios_ssp_aec_tde_addfarspectrum(srv->delay_estimator_farend, xfa, PART_LEN1, far_q) == -1) {
+    if (dios_ssp_aec_tde_addfarspectrum(srv->delay_estimator_farend, xfa, PART_LEN1, 0) == -1) {
         return -1;
     }
-    delay = dios_ssp_aec_tde_delayestimateprocess(srv->delay_estimator, dfaNoisy, PART_LEN1, zerosDBufNoisy);
+    delay = dios_ssp_aec_tde_delayestimateprocess(srv->delay_estimator, near_abs, PART_LEN1, 0);
 
     if (delay == -1) {
         return -1;
@@ -245,30 +195,25 @@ int dios_ssp_aec_tde_ProcessBlock(AecmCore_t * srv,
         delay = srv->fixedDelay;
     }
 
-    // histogram
-    memmove(srv->delayN+1, srv->delayN, (srv->win_slide-1) * sizeof(int)); // DELAY_WIN_SLIDE
-    srv->delayN[0] = delay; //delay_t0;
-    memset(srv->delayHistVect,0, srv->max_delay_size*sizeof(int));
-    for (i = 0; i < srv->win_slide; i++) { // DELAY_WIN_SLIDE
-        if (srv->delayN[i] >= 0 && srv->delayN[i] < srv->max_delay_size) {
-            srv->delayHistVect[srv->delayN[i]]++;
-        } else {
-            printf("Delay exceed the estimate range!");
-        }
+    // histogram of the last win_slide delays, the newest one replaces the oldest
+    oldest = srv->delayN[srv->delayN_pos];
+    if (oldest >= 0 && oldest < srv->max_delay_size) {
+        srv->delayHistVect[oldest]--;
     }
-
-    srv->delayHistVect[0] = 0;
-    max_v = srv->delayHistVect[0];
-    max_i = 0;
-    for (i = 1; i < srv->max_delay_size; i++) {
-        if (srv->delayHistVect[i] > max_v) {
-            max_v = srv->delayHistVect[i];
-            max_i = i;
-        }
+    srv->delayN[srv->delayN_pos] = delay;
+    srv->delayN_pos = (srv->delayN_pos + 1) % srv->win_slide; // DELAY_WIN_SLIDE
+    if (delay >= 0 && delay < srv->max_delay_size) {
+        srv->delayHistVect[delay]++;
+    } else {
+        printf("Delay exceed the estimate range!");
     }
-    if ((max_v > srv->win_slide * 0.8f) && (max_i!=0) && (max_i > srv->delay_nframe + 2 || max_i < srv->delay_nframe - 2)) {
-        srv->delay_nframe = max_i;
-        srv->delay_nsample = max_i * PART_LEN;
+
+    // a delay is taken once it holds more than 80% of the window, at most one
+    // delay can, and only the newest one may have just crossed the line
+    if ((delay > 0) && (delay < srv->max_delay_size) && (srv->delayHistVect[delay] > srv->win_slide * 0.8f)
+        && (delay > srv->delay_nframe + 2 || delay < srv->delay_nframe - 2)) {
+        srv->delay_nframe = delay;
+        srv->delay_nsample = delay * PART_LEN;
         flag_delayfind = 1;
     }
 
@@ -508,7 +453,6 @@ int dios_ssp_aec_tde_creatcore(AecmCore_t **aecmInst, int max_delay_size, int wi
 
     srv->win_slide = win_slide;
     srv->max_delay_size = max_delay_size; // 100
-    //srv->max_long_delay_size = MAX_DELAY_LONG; // 750
     srv->delayHistVect    = NULL;
     srv->delayN    = NULL;
     srv->delayHistVect = (int *)calloc(srv->max_delay_size, sizeof(int));
@@ -544,11 +488,6 @@ int dios_ssp_aec_tde_initcore(AecmCore_t * const srv)
     if (dios_ssp_aec_tde_initdelayestimator(srv->delay_estimator) != 0) {
         return -1;
     }
-    // Set far end histories to zero
-    memset(srv->far_history, 0, sizeof(float) * PART_LEN1 * MAX_DELAY_LONG);
-    memset(srv->far_q_domains, 0, sizeof(int) * MAX_DELAY_LONG);
-    srv->far_history_pos = srv->max_delay_history_size; // increase est. delay range
-
     srv->fixedDelay = -1;
 
     // Shape the initial noise level to an approximate pink noise.
@@ -571,8 +510,13 @@ int dios_ssp_aec_tde_initcore(AecmCore_t * const srv)
     srv->delay_nsample    = 0;
     memset(srv->delayHistVect, 0, srv->max_delay_size * sizeof(int));
     memset(srv->delayN, 0, srv->win_slide * sizeof(int));
+    srv->delayHistVect[0] = srv->win_slide; // the window starts full of zero delays
+    srv->delayN_pos = 0;
 
-    srv->rfft_param = dios_ssp_share_rfft_init(PART_LEN2);
+    // initcore also runs on every reset, keep the handle of the first one
+    if (NULL == srv->rfft_param) {
+        srv->rfft_param = dios_ssp_share_rfft_init(PART_LEN2);
+    }
     memset(srv->fft_out, 0, sizeof(srv->fft_out));
     for (i=0; i < PART_LEN2; i++) {
         srv->tde_ana_win[i] = (float)sqrt(0.5 * (1-cos(2*PI*i/PART_LEN2)));
@@ -580,6 +524,29 @@ int dios_ssp_aec_tde_initcore(AecmCore_t * const srv)
     return 0;
 }
 
+int dios_ssp_aec_tde_corememory(AecmCore_t *srv)
+{
+    int history;
+    int bytes;
+
+    if (srv == NULL) {
+        return -1;
+    }
+    history = srv->max_delay_history_size;
+    bytes = sizeof(AecmCore_t);
+    bytes += 4 * (FRAME_LEN + PART_LEN) * sizeof(short);
+    bytes += (srv->max_delay_size + srv->win_slide) * sizeof(int);
+    // far end: mirrored binary history and mean update shifts, mean spectrum
+    bytes += sizeof(DelayEstimatorFarend) + sizeof(BinaryDelayEstimatorFarend);
+    bytes += 2 * history * (sizeof(unsigned int) + sizeof(int)) + PART_LEN1 * sizeof(SpectrumType);
+    // near end: bit counts and their means, robust validation histogram
+    bytes += sizeof(DelayEstimator) + sizeof(BinaryDelayEstimator);
+    bytes += (2 * history + 1) * sizeof(int) + (history + 1) * sizeof(float);
+    bytes += sizeof(unsigned int) + PART_LEN1 * sizeof(SpectrumType);
+
+    return bytes;
+}
+
 int dios_ssp_aec_tde_freecore(AecmCore_t *srv)
 {
     if (srv == NULL) {
@@ -37,6 +37,7 @@ typedef struct {
     void* ptr_gsc;
     void* ptr_doa;
     void* ptr_dtln;
+    objMchStft* ptr_stft;  // microphone spectrum shared by doa and mvdr
 
     /* necessary buffer definition */
     float* ptr_mic_buf;
@@ -56,11 +57,56 @@ typedef struct {
     PolarCoord *loc_result;  // save source localization result
 } objDios_ssp;
 
+// free what a failed dios_ssp_init_api allocated so far, returns NULL
+static void* dios_ssp_init_fail(objDios_ssp* srv)
+{
+    if(srv->ptr_hpf != NULL) {
+        dios_ssp_hpf_uninit_api(srv->ptr_hpf);
+    }
+    if(srv->ptr_aec != NULL) {
+        dios_ssp_aec_uninit_api(srv->ptr_aec);
+    }
+    if(srv->ptr_doa != NULL) {
+        dios_ssp_doa_uninit_api(srv->ptr_doa);
+    }
+    if(srv->ptr_mvdr != NULL) {
+        dios_ssp_mvdr_uninit_api(srv->ptr_mvdr);
+    }
+    if(srv->ptr_gsc != NULL) {
+        dios_ssp_gsc_uninit_api(srv->ptr_gsc);
+    }
+    if(srv->ptr_vad != NULL) {
+        dios_ssp_vad_uninit_api(srv->ptr_vad);
+    }
+    if(srv->ptr_ns != NULL) {
+        dios_ssp_ns_uninit_api(srv->ptr_ns);
+    }
+    if(srv->ptr_agc != NULL) {
+        dios_ssp_agc_uninit_api(srv->ptr_agc);
+    }
+    if(srv->ptr_dtln != NULL) {
+        dios_ssp_dtln_uninit_api(srv->ptr_dtln);
+    }
+    if(srv->ptr_stft != NULL) {
+        dios_ssp_share_stft_uninit(srv->ptr_stft);
+    }
+    free(srv->ptr_mic_buf);
+    free(srv->ptr_ref_buf);
+    free(srv->ptr_data_buf);
+    free(srv->loc_result);
+    free(srv);
+    return NULL;
+}
+
 void* dios_ssp_init_api(objSSP_Param *SSP_PARAM)
 {
     int i;
+    int ret = 0;
     void* ptr = NULL;
     ptr = (void*)calloc(1, sizeof(objDios_ssp));
+    if(ptr == NULL) {
+        return NULL;
+    }
     objDios_ssp* srv = (objDios_ssp*)ptr;
 
     // params init
@@ -80,12 +126,63 @@ void* dios_ssp_init_api(objSSP_Param *SSP_PARAM)
     }
     if(SSP_PARAM->AEC_KEY == 1) {
         srv->ptr_aec = dios_ssp_aec_init_api(srv->cfg_mic_num, srv->cfg_ref_num, srv->cfg_frame_len);
+        if(srv->ptr_aec == NULL) {
+            return dios_ssp_init_fail(srv);
+        }
+        if (SSP_PARAM->aec_engine != AEC_ENGINE_SUBBAND) {
+            ret = dios_ssp_aec_engine_config_api(srv->ptr_aec, SSP_PARAM->aec_engine, SSP_PARAM->aec_tail_ms);
+        }
+        if (ret == 0 && SSP_PARAM->aec_max_delay_ms != 0 && SSP_PARAM->aec_max_delay_ms != AEC_TDE_DEFAULT_DELAY_MS) {
+            ret = dios_ssp_aec_delay_config_api(srv->ptr_aec, SSP_PARAM->aec_max_delay_ms);
+        }
+        if (ret == 0 && SSP_PARAM->aec_threads > 1) {
+            ret = dios_ssp_aec_thread_config_api(srv->ptr_aec, SSP_PARAM->aec_threads);
+        }
+        if(ret != 0) {
+            printf("aec config failed!\n");
+            return dios_ssp_init_fail(srv);
+        }
+    }
+    // doa and mvdr read the microphone spectrum of one stft owned here
+    if(SSP_PARAM->DOA_KEY == 1 || SSP_PARAM->BF_KEY == 1) {
+        srv->ptr_stft = dios_ssp_share_stft_init(srv->cfg_mic_num, DEFAULT_MVDR_WIN_SIZE, DEFAULT_MVDR_SHIFT_SIZE);
+        if(srv->ptr_stft == NULL) {
+            return dios_ssp_init_fail(srv);
+        }
     }
     if(SSP_PARAM->DOA_KEY == 1) {
-        srv->ptr_doa = dios_ssp_doa_init_api(srv->cfg_mic_num, (PlaneCoord*)srv->cfg_mic_coord);
+        srv->ptr_doa = dios_ssp_doa_init_stft_api(srv->cfg_mic_num, (PlaneCoord*)srv->cfg_mic_coord, srv->ptr_stft);
+        if(srv->ptr_doa == NULL) {
+            return dios_ssp_init_fail(srv);
+        }
+        if (SSP_PARAM->doa_delta_angle > 0 || SSP_PARAM->doa_coarse_angle > 0) {
+            ret = dios_ssp_doa_config_api(srv->ptr_doa, SSP_PARAM->doa_delta_angle > 0 ? SSP_PARAM->doa_delta_angle : DEFAULT_DOA_DELTA_ANGLE,
+                                          SSP_PARAM->doa_coarse_angle);
+        }
+        if (ret == 0) {
+            ret = dios_ssp_doa_engine_config_api(srv->ptr_doa, SSP_PARAM->doa_engine);
+        }
+        if (ret == 0 && SSP_PARAM->doa_search_interval > 1) {
+            ret = dios_ssp_doa_update_config_api(srv->ptr_doa, SSP_PARAM->doa_search_interval);
+        }
+        if(ret != 0) {
+            printf("doa config failed!\n");
+            return dios_ssp_init_fail(srv);
+        }
     }
     if(SSP_PARAM->BF_KEY == 1) {
-        srv->ptr_mvdr = dios_ssp_mvdr_init_api(srv->cfg_mic_num, (void*)srv->cfg_mic_coord);
+        srv->ptr_mvdr = dios_ssp_mvdr_init_stft_api(srv->cfg_mic_num, (void*)srv->cfg_mic_coord, srv->ptr_stft);
+        if(srv->ptr_mvdr == NULL) {
+            return dios_ssp_init_fail(srv);
+        }
+        ret = dios_ssp_mvdr_config_api(srv->ptr_mvdr, SSP_PARAM->mvdr_inv_mode);
+        if (ret == 0 && SSP_PARAM->mvdr_update_groups > 1) {
+            ret = dios_ssp_mvdr_update_config_api(srv->ptr_mvdr, SSP_PARAM->mvdr_update_groups);
+        }
+        if(ret != 0) {
+            printf("mvdr config failed!\n");
+            return dios_ssp_init_fail(srv);
+        }
     }
     if(SSP_PARAM->BF_KEY == 2) {
         srv->ptr_gsc = dios_ssp_gsc_init_api(srv->cfg_mic_num, (void*)srv->cfg_mic_coord);
@@ -99,7 +196,16 @@ void* dios_ssp_init_api(objSSP_Param *SSP_PARAM)
         srv->ptr_agc = dios_ssp_agc_init_api(srv->cfg_frame_len, 26000.0, 0);
     }
     if(SSP_PARAM->DTLN_KEY == 1) {
-        srv->ptr_dtln = dios_ssp_dtln_init_api(SSP_PARAM->modelpath, srv->cfg_frame_len);
+        srv->ptr_dtln = dios_ssp_dtln_init_api(SSP_PARAM->modelpath, srv->cfg_frame_len,
+                                               SSP_PARAM->dtln_num_threads, SSP_PARAM->dtln_delegate);
+        if(srv->ptr_dtln == NULL) {
+            printf("dtln init failed!\n");
+            return dios_ssp_init_fail(srv);
+        }
+        if (SSP_PARAM->dtln_pipeline == 1 && dios_ssp_dtln_config_api(srv->ptr_dtln, 1) != 0) {
+            printf("dtln config failed!\n");
+            return dios_ssp_init_fail(srv);
+        }
     }
 
     // allocate memory
@@ -164,6 +270,10 @@ int dios_ssp_reset_api(void* ptr, objSSP_Param *SSP_PARAM)
         }
     }
 
+    if(srv->ptr_stft != NULL) {
+        dios_ssp_share_stft_reset(srv->ptr_stft);
+    }
+
     ret = dios_ssp_vad_reset_api(srv->ptr_vad);
     if(ret != 0) {
         return ERROR_VAD;
@@ -238,13 +348,18 @@ int dios_ssp_process_api(void* ptr, short* mic_buf, short* ref_buf, short* out_b
     // save mic1
     memcpy(srv->ptr_data_buf, &srv->ptr_mic_buf[0], srv->cfg_frame_len * sizeof(float));
 
+    // doa and mvdr read the one stft of the microphones
+    if(srv->ptr_stft != NULL) {
+        dios_ssp_share_stft_process(srv->ptr_stft, srv->ptr_mic_buf);
+    }
+
     if(SSP_PARAM->DOA_KEY == 1) {
-        srv->cfg_wakeup_loc_phi = dios_ssp_doa_process_api(srv->ptr_doa, srv->ptr_mic_buf, srv->vad_result, srv->dt_st);
+        srv->cfg_wakeup_loc_phi = dios_ssp_doa_process_stft_api(srv->ptr_doa, srv->ptr_stft, srv->vad_result, srv->dt_st);
     }
 
     // MVDR process
     if(SSP_PARAM->BF_KEY == 1) {
-        ret = dios_ssp_mvdr_process_api(srv->ptr_mvdr, srv->ptr_mic_buf, srv->ptr_data_buf, srv->cfg_wakeup_loc_phi);
+        ret = dios_ssp_mvdr_process_stft_api(srv->ptr_mvdr, srv->ptr_stft, srv->ptr_data_buf, srv->cfg_wakeup_loc_phi);
         if(ret != 0) {
             return ERROR_MVDR;
         }
@@ -401,6 +516,10 @@ int dios_ssp_uninit_api(void* ptr, objSSP_Param *SSP_PARAM)
         }
     }
 
+    if(srv->ptr_stft != NULL) {
+        dios_ssp_share_stft_uninit(srv->ptr_stft);
+    }
+
     free(srv->loc_result);
     free(srv);
     return OK_AUDIO_PROCESS;
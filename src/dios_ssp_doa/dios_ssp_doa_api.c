@@ -17,6 +17,8 @@ Description: This is a DOA (Direction Of Arrival) module which uses the Capon
 algorithm to get the direction of the sound source. The main function of the
 Capon algorithm is the Capon beamformer, also called MVDR. The Capon spectrum
 is estimated by using Rxx matrix and steering vector in frequency domain.
+The SRP-PHAT engine steers the phase transformed cross spectra of the
+microphone pairs instead and needs no matrix inversion.
 ==============================================================================*/
 
 #include "dios_ssp_doa_api.h"
@@ -64,16 +66,115 @@ int dios_ssp_doa_init_steering_vectors_g(objDOA *ptr_doa)
     float theta = 0.0f;
     float phi = PI * 0.5f;
     float omega = 0.0f;
-    int i, j, k;
-
-    for (i = 0; i < ptr_doa->m_angle_num; ++i ) {
-        theta = (float)i * (float)ptr_doa->m_delta_angle * PI / 180.0f;
-        for (k = 0; k < ptr_doa->m_sp_size; ++k ) {
-            omega = 2.0f * PI * ptr_doa->m_deta_fs * (float)k;
+    int i, j, l, n, p;
+    float *gstv_re = (float*)calloc(ptr_doa->m_channels, sizeof(float));
+    float *gstv_im = (float*)calloc(ptr_doa->m_channels, sizeof(float));
+
+    // only the analysis bands are scanned, store conj(a_i)*a_j of every channel pair
+    for (n = 0; n < ptr_doa->m_frq_bin_num; ++n) {
+        float *gpair = ptr_doa->m_gpair + n*ptr_doa->m_pair_dim*ptr_doa->m_angle_num;
+        omega = 2.0f * PI * ptr_doa->m_deta_fs * (float)ptr_doa->m_doa_fid[n];
+        for (i = 0; i < ptr_doa->m_angle_num; ++i ) {
+            theta = (float)i * (float)ptr_doa->m_delta_angle * PI / 180.0f;
             for (j = 0; j < ptr_doa->m_channels; ++j ) {
                 deta = (float)(omega * (ptr_doa->cood[j].x * cos(theta) * sin(phi) + ptr_doa->cood[j].y * sin(theta) * sin(phi) + ptr_doa->cood[j].z * cos(phi))/ VELOCITY);
-                ptr_doa->m_gstv_re[i*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+j] = (float)cos(deta);
-                ptr_doa->m_gstv_im[i*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+j] = (float)sin(deta);
+                gstv_re[j] = (float)cos(deta);
+                gstv_im[j] = (float)sin(deta);
+            }
+            p = 0;
+            for (j = 0; j < ptr_doa->m_channels; ++j ) {
+                for (l = j+1; l < ptr_doa->m_channels; ++l ) {
+                    gpair[p*ptr_doa->m_angle_num+i] = gstv_re[j]*gstv_re[l] + gstv_im[j]*gstv_im[l];
+                    gpair[(ptr_doa->m_pair_num+p)*ptr_doa->m_angle_num+i] = gstv_re[j]*gstv_im[l] - gstv_im[j]*gstv_re[l];
+                    p++;
+                }
+            }
+        }
+    }
+
+    if (ptr_doa->m_coarse_angle > 0) {
+        for (n = 0; n < ptr_doa->m_frq_bin_num*ptr_doa->m_pair_dim; ++n) {
+            for (i = 0; i < ptr_doa->m_coarse_num; ++i) {
+                ptr_doa->m_gpair_coarse[n*ptr_doa->m_coarse_num+i] = ptr_doa->m_gpair[n*ptr_doa->m_angle_num+i*ptr_doa->m_coarse_ratio];
+            }
+        }
+    }
+
+    free(gstv_re);
+    free(gstv_im);
+
+    return 0;
+}
+
+int dios_ssp_doa_init_scan(objDOA *ptr_doa)
+{
+    free(ptr_doa->m_capon_spectrum);
+    free(ptr_doa->m_capon_q);
+    free(ptr_doa->m_capon_coarse);
+    free(ptr_doa->m_gpair);
+    free(ptr_doa->m_gpair_coarse);
+
+    ptr_doa->m_angle_num = (int)((360.0-0.0)/ ptr_doa->m_delta_angle);
+    ptr_doa->m_coarse_ratio = ptr_doa->m_coarse_angle / ptr_doa->m_delta_angle;
+    ptr_doa->m_coarse_num = ptr_doa->m_coarse_angle > 0 ? 360 / ptr_doa->m_coarse_angle : 0;
+
+    ptr_doa->m_capon_spectrum = (float*)calloc(ptr_doa->m_angle_num, sizeof(float));
+    ptr_doa->m_capon_q = (float*)calloc(ptr_doa->m_angle_num, sizeof(float));
+    ptr_doa->m_capon_coarse = (float*)calloc(ptr_doa->m_coarse_num + 1, sizeof(float));
+    ptr_doa->m_gpair = (float*)calloc(ptr_doa->m_frq_bin_num*ptr_doa->m_pair_dim*ptr_doa->m_angle_num, sizeof(float));
+    ptr_doa->m_gpair_coarse = (float*)calloc(ptr_doa->m_frq_bin_num*ptr_doa->m_pair_dim*ptr_doa->m_coarse_num + 1, sizeof(float));
+
+    return dios_ssp_doa_init_steering_vectors_g(ptr_doa);
+}
+
+int dios_ssp_doa_scan(objDOA *ptr_doa, const float *gpair, int lda, int start, int num, float *spectrum)
+{
+    int i, j, p, n, m;
+    float trace;
+
+    for (n = 0; n < ptr_doa->m_frq_bin_num; ++n) {
+        // a^H R a = sum R_ii + 2 * Re(sum_{i<j} conj(a_i) R_ij a_j), |a_i| = 1
+        trace = 0;
+        p = 0;
+        if (ptr_doa->m_engine == DOA_ENGINE_SRP_PHAT) {
+            // R is the band cross spectrum with unit magnitude, the diagonal is constant
+            const float *rxx_re = ptr_doa->m_rxx_band_re + n*ptr_doa->m_rxx_size;
+            const float *rxx_im = ptr_doa->m_rxx_band_im + n*ptr_doa->m_rxx_size;
+            for (i = 0; i < ptr_doa->m_channels; ++i) {
+                for (j = i+1; j < ptr_doa->m_channels; ++j) {
+                    float re = rxx_re[i*ptr_doa->m_channels+j];
+                    float im = rxx_im[i*ptr_doa->m_channels+j];
+                    float mag = sqrtf(re*re + im*im);
+                    float phat = mag > 0.0f ? 2.0f / mag : 0.0f;
+                    ptr_doa->m_irxx_pair[p] = phat * re;
+                    ptr_doa->m_irxx_pair[ptr_doa->m_pair_num+p] = -phat * im;
+                    p++;
+                }
+            }
+        } else {
+            const float *irxx_re = ptr_doa->m_irxx_re + n*ptr_doa->m_rxx_size;
+            const float *irxx_im = ptr_doa->m_irxx_im + n*ptr_doa->m_rxx_size;
+            for (i = 0; i < ptr_doa->m_channels; ++i) {
+                trace += irxx_re[i*ptr_doa->m_channels+i];
+                for (j = i+1; j < ptr_doa->m_channels; ++j) {
+                    ptr_doa->m_irxx_pair[p] = 2.0f * irxx_re[i*ptr_doa->m_channels+j];
+                    ptr_doa->m_irxx_pair[ptr_doa->m_pair_num+p] = -2.0f * irxx_im[i*ptr_doa->m_channels+j];
+                    p++;
+                }
+            }
+        }
+        for (m = 0; m < num; ++m) {
+            ptr_doa->m_capon_q[m] = trace;
+        }
+        dios_ssp_share_mat_vec_acc(gpair + n*ptr_doa->m_pair_dim*lda + start, num, ptr_doa->m_pair_dim, lda,
+                                   ptr_doa->m_irxx_pair, ptr_doa->m_capon_q);
+        if (ptr_doa->m_engine == DOA_ENGINE_SRP_PHAT) {
+            for (m = 0; m < num; ++m) {
+                spectrum[start+m] += ptr_doa->m_capon_q[m];
+            }
+        } else {
+            for (m = 0; m < num; ++m) {
+                spectrum[start+m] += ptr_doa->m_channels / ptr_doa->m_capon_q[m];
             }
         }
     }
@@ -82,12 +183,19 @@ int dios_ssp_doa_init_steering_vectors_g(objDOA *ptr_doa)
 }
 
 void* dios_ssp_doa_init_api(int mic_num, PlaneCoord* mic_coord)
+{
+    return dios_ssp_doa_init_stft_api(mic_num, mic_coord, NULL);
+}
+
+void* dios_ssp_doa_init_stft_api(int mic_num, PlaneCoord* mic_coord, objMchStft *stft)
 {
     void* st = NULL;
     st = (void*)calloc(1, sizeof(objDOA));
+    if (NULL == st) {
+        return NULL;
+    }
     objDOA* ptr_doa = (objDOA*)st;
 
-    int i;
     ptr_doa->m_channels = mic_num;
     ptr_doa->cood = mic_coord;
     ptr_doa->m_fs = DEFAULT_DOA_SAMPLING_FRQ;
@@ -100,8 +208,8 @@ void* dios_ssp_doa_init_api(int mic_num, PlaneCoord* mic_coord)
     ptr_doa->m_eps = DEFAULT_DOA_EPS;
     ptr_doa->m_alpha_rxx = DEFAULT_DOA_ALPHA_RXX;
     ptr_doa->m_beta_rxx = 1-ptr_doa->m_alpha_rxx;
+    ptr_doa->m_search_interval = DEFAULT_DOA_SEARCH_INTERVAL;
     ptr_doa->m_deta_fs = ptr_doa->m_fs / (float)ptr_doa->m_fft_size;
-    ptr_doa->m_angle_num = (int)((360.0-0.0)/ ptr_doa->m_delta_angle);
     ptr_doa->m_angle_smooth = 90.0f;
     ptr_doa->m_frq_bin_num = (int)((ptr_doa->m_high_frq - ptr_doa->m_low_frq)/ptr_doa->m_frq_sp + 1);
     ptr_doa->m_low_fid = (int)(ptr_doa->m_low_frq*ptr_doa->m_fft_size/ptr_doa->m_fs);
@@ -109,216 +217,301 @@ void* dios_ssp_doa_init_api(int mic_num, PlaneCoord* mic_coord)
     ptr_doa->m_rxx_size = ptr_doa->m_channels * ptr_doa->m_channels;
     ptr_doa->m_frq_bin_width = (int)(ptr_doa->m_frq_sp/ptr_doa->m_deta_fs);
 
-    ptr_doa->m_capon_spectrum = (float*)calloc(ptr_doa->m_angle_num, sizeof(float));
-    ptr_doa->m_doa_fid = (int*)calloc(ptr_doa->m_angle_num, sizeof(int));
-    ptr_doa->m_irxx_re = (float*)calloc(ptr_doa->m_sp_size*ptr_doa->m_rxx_size, sizeof(float));
-    ptr_doa->m_irxx_im = (float*)calloc(ptr_doa->m_sp_size*ptr_doa->m_rxx_size, sizeof(float));
-    ptr_doa->m_vec_re = (float*)calloc(ptr_doa->m_channels, sizeof(float));
-    ptr_doa->m_vec_im = (float*)calloc(ptr_doa->m_channels, sizeof(float));
-    ptr_doa->m_gstv_re = (float*)calloc(ptr_doa->m_sp_size*ptr_doa->m_angle_num*ptr_doa->m_channels, sizeof(float));
-    ptr_doa->m_gstv_im = (float*)calloc(ptr_doa->m_sp_size*ptr_doa->m_angle_num*ptr_doa->m_channels, sizeof(float));
-    ptr_doa->m_rxx_in = (float*)calloc(2*ptr_doa->m_rxx_size, sizeof(float));
+    ptr_doa->m_pair_num = ptr_doa->m_channels*(ptr_doa->m_channels-1)/2;
+    ptr_doa->m_pair_dim = 2*ptr_doa->m_pair_num;
+
+    // a stft of the caller is read by pointer, otherwise the doa runs its own
+    if (NULL != stft) {
+        if (stft->channels != ptr_doa->m_channels || stft->fft_size != ptr_doa->m_fft_size
+            || stft->shift_size != ptr_doa->m_shift_size) {
+            printf("doa stft must have %d channels, a %d fft and a %d hop\n", ptr_doa->m_channels,
+                   ptr_doa->m_fft_size, ptr_doa->m_shift_size);
+            free(st);
+            return NULL;
+        }
+        ptr_doa->stft = stft;
+        ptr_doa->m_stft_shared = 1;
+    } else {
+        ptr_doa->stft = dios_ssp_share_stft_init(ptr_doa->m_channels, ptr_doa->m_fft_size, ptr_doa->m_shift_size);
+        if (NULL == ptr_doa->stft) {
+            free(st);
+            return NULL;
+        }
+    }
+    ptr_doa->m_re = ptr_doa->stft->re;
+    ptr_doa->m_im = ptr_doa->stft->im;
+
+    ptr_doa->m_doa_fid = (int*)calloc(ptr_doa->m_frq_bin_num, sizeof(int));
+    for(int i = 0; i < ptr_doa->m_frq_bin_num; ++i) {
+        ptr_doa->m_doa_fid[i] = ptr_doa->m_low_fid + (i*ptr_doa->m_frq_sp*ptr_doa->m_fft_size)/ptr_doa->m_fs;
+    }
+    ptr_doa->m_irxx_re = (float*)calloc(ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size, sizeof(float));
+    ptr_doa->m_irxx_im = (float*)calloc(ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size, sizeof(float));
+    ptr_doa->m_irxx_pair = (float*)calloc(ptr_doa->m_pair_dim + 1, sizeof(float));
+    ptr_doa->m_rxx_band_re = (float*)calloc(ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size, sizeof(float));
+    ptr_doa->m_rxx_band_im = (float*)calloc(ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size, sizeof(float));
     ptr_doa->m_rxx_re = (float*)calloc(ptr_doa->m_sp_size*ptr_doa->m_rxx_size, sizeof(float));
     ptr_doa->m_rxx_im = (float*)calloc(ptr_doa->m_sp_size*ptr_doa->m_rxx_size, sizeof(float));
-    ptr_doa->m_mch_buffer = (float**)calloc(ptr_doa->m_channels, sizeof(float*));
-    for (i = 0; i < ptr_doa->m_channels; ++i ) {
-        ptr_doa->m_mch_buffer[i] = (float*)calloc(ptr_doa->m_fft_size, sizeof(float));
-    }
-    ptr_doa->doa_fft = dios_ssp_share_rfft_init(ptr_doa->m_fft_size);
-    ptr_doa->fft_out = (float *)calloc(ptr_doa->m_fft_size, sizeof(float));
-    ptr_doa->m_win_data = (float*)calloc(ptr_doa->m_fft_size*ptr_doa->m_channels, sizeof(float));
-    ptr_doa->m_re = (float*)calloc(ptr_doa->m_fft_size*ptr_doa->m_channels, sizeof(float));
-    ptr_doa->m_im = (float*)calloc(ptr_doa->m_fft_size*ptr_doa->m_channels, sizeof(float));
-    ptr_doa->m_irxx_out = (float*)calloc(2*ptr_doa->m_rxx_size, sizeof(float));
-    ptr_doa->m_gstv_dim = ptr_doa->m_sp_size*ptr_doa->m_channels;
-    ptr_doa->doainv = dios_ssp_matrix_inv_init(ptr_doa->m_channels);
-    ptr_doa->doawin = (objDOACwin*)calloc(1, sizeof(objDOACwin));
-    dios_ssp_doa_win_init(ptr_doa->doawin, ptr_doa->m_fft_size, ptr_doa->m_shift_size);
-
-    dios_ssp_doa_init_steering_vectors_g(ptr_doa);
+    ptr_doa->hsolve = dios_ssp_share_hsolve_init(ptr_doa->m_channels, ptr_doa->m_frq_bin_num);
+
+    dios_ssp_doa_init_scan(ptr_doa);
 
     return st;
 }
 
+int dios_ssp_doa_config_api(void *ptr, int delta_angle, int coarse_angle)
+{
+    objDOA* ptr_doa;
+    if (NULL == ptr) {
+        printf("doa handle not init!\n");
+        return ERROR_DOA;
+    }
+    ptr_doa = (objDOA*)ptr;
+
+    if (delta_angle <= 0 || 360 % delta_angle != 0) {
+        printf("doa delta angle %d must divide 360\n", delta_angle);
+        return ERROR_DOA;
+    }
+    if (coarse_angle < 0 || (coarse_angle > 0 && (coarse_angle % delta_angle != 0 || 360 % coarse_angle != 0 || coarse_angle >= 360))) {
+        printf("doa coarse angle %d must be a multiple of %d dividing 360\n", coarse_angle, delta_angle);
+        return ERROR_DOA;
+    }
+
+    ptr_doa->m_delta_angle = delta_angle;
+    ptr_doa->m_coarse_angle = coarse_angle;
+    dios_ssp_doa_init_scan(ptr_doa);
+
+    return 0;
+}
+
 int dios_ssp_doa_reset_api(void *ptr)
 {
-    int i;
     objDOA* ptr_doa;
     ptr_doa = (objDOA*)ptr;
 
     ptr_doa->m_first_frame_flag = 1;
-    //fft
-    for (i = 0; i < ptr_doa->m_fft_size; ++i ) {
-        ptr_doa->fft_out[i] = 0.0;
-    }
+    ptr_doa->m_search_wait = ptr_doa->m_search_interval;
+    ptr_doa->m_search_count = 0;
 
-    for(i = 0; i < ptr_doa->m_frq_bin_num; ++i) {
-        ptr_doa->m_doa_fid[i] = ptr_doa->m_low_fid + (i*ptr_doa->m_frq_sp*ptr_doa->m_fft_size)/ptr_doa->m_fs;
-    }
-    for (i = 0; i < ptr_doa->m_channels; ++i ) {
-        memset( ptr_doa->m_mch_buffer[i], 0, sizeof(float)*ptr_doa->m_fft_size );
+    // a shared stft is reset by its owner
+    if (!ptr_doa->m_stft_shared) {
+        dios_ssp_share_stft_reset(ptr_doa->stft);
     }
-    memset( ptr_doa->m_win_data, 0, sizeof(float)*ptr_doa->m_channels*ptr_doa->m_fft_size );
-    memset( ptr_doa->m_re, 0, sizeof(float)*ptr_doa->m_channels*ptr_doa->m_fft_size );
-    memset( ptr_doa->m_im, 0, sizeof(float)*ptr_doa->m_channels*ptr_doa->m_fft_size );
+    ptr_doa->m_re = ptr_doa->stft->re;
+    ptr_doa->m_im = ptr_doa->stft->im;
     memset( ptr_doa->m_capon_spectrum, 0, sizeof(float)*ptr_doa->m_angle_num );
-    memset( ptr_doa->m_irxx_re, 0, sizeof(float)*ptr_doa->m_sp_size*ptr_doa->m_rxx_size );
-    memset( ptr_doa->m_irxx_im, 0, sizeof(float)*ptr_doa->m_sp_size*ptr_doa->m_rxx_size );
-    memset( ptr_doa->m_vec_re, 0, sizeof(float)*ptr_doa->m_channels );
-    memset( ptr_doa->m_vec_im, 0, sizeof(float)*ptr_doa->m_channels );
-    memset( ptr_doa->m_rxx_in, 0, sizeof(float)*2*ptr_doa->m_rxx_size );
+    memset( ptr_doa->m_irxx_re, 0, sizeof(float)*ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size );
+    memset( ptr_doa->m_irxx_im, 0, sizeof(float)*ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size );
+    memset( ptr_doa->m_rxx_band_re, 0, sizeof(float)*ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size );
+    memset( ptr_doa->m_rxx_band_im, 0, sizeof(float)*ptr_doa->m_frq_bin_num*ptr_doa->m_rxx_size );
     memset( ptr_doa->m_rxx_re, 0, sizeof(float)*ptr_doa->m_sp_size*ptr_doa->m_rxx_size );
     memset( ptr_doa->m_rxx_im, 0, sizeof(float)*ptr_doa->m_sp_size*ptr_doa->m_rxx_size );
-    memset( ptr_doa->m_irxx_out, 0, sizeof(float)*2*ptr_doa->m_rxx_size );
 
     return 0;
 }
 
 float dios_ssp_doa_process_api(void* ptr, float* in, int vad_result, int dt_st)
+{
+    objDOA* ptr_doa;
+    ptr_doa = (objDOA*)ptr;
+
+    if (ptr_doa->m_stft_shared) {
+        printf("doa stft is shared, call dios_ssp_doa_process_stft_api\n");
+        return ptr_doa->m_angle_smooth;
+    }
+    // stft
+    dios_ssp_share_stft_process(ptr_doa->stft, in);
+
+    return dios_ssp_doa_process_stft_api(ptr, ptr_doa->stft, vad_result, dt_st);
+}
+
+float dios_ssp_doa_process_stft_api(void* ptr, const objMchStft *stft, int vad_result, int dt_st)
 {
     int   max_ind = 0;
     float max_spectrum = 0;
-    float re_temp, im_temp;
 
     objDOA* ptr_doa;
     ptr_doa = (objDOA*)ptr;
 
-    for (int ch_idx = 0; ch_idx < ptr_doa->m_channels; ++ch_idx) {
-        for (int i = 0; i < ptr_doa->m_shift_size; ++i) {
-            ptr_doa->m_mch_buffer[ch_idx][ptr_doa->m_fft_size - ptr_doa->m_shift_size + i] = in[ch_idx * ptr_doa->m_shift_size + i];
-        }
-    }
-
-    // add ana window
-    for (int ch_idx = 0; ch_idx < ptr_doa->m_channels; ++ch_idx ) {
-        dios_ssp_doa_win_add_ana_win(ptr_doa->doawin, ptr_doa->m_mch_buffer[ch_idx], ptr_doa->m_win_data+ch_idx*ptr_doa->m_fft_size);
-    }
-    // stft
-    for (int ch_idx = 0; ch_idx < ptr_doa->m_channels; ++ch_idx ) {
-        dios_ssp_share_rfft_process(ptr_doa->doa_fft, ptr_doa->m_win_data+ch_idx*ptr_doa->m_fft_size, ptr_doa->fft_out);
-        for (int i = 0; i < ptr_doa->m_fft_size / 2 + 1; i++) {
-            ptr_doa->m_re[i + ch_idx * ptr_doa->m_fft_size] = ptr_doa->fft_out[i];
-        }
-        ptr_doa->m_im[0 + ch_idx * ptr_doa->m_fft_size] = ptr_doa->m_im[ptr_doa->m_fft_size / 2 + ch_idx * ptr_doa->m_fft_size] = 0.0;
-        for (int i = 1; i < ptr_doa->m_fft_size / 2; i++) {
-            ptr_doa->m_im[i + ch_idx * ptr_doa->m_fft_size] = -ptr_doa->fft_out[ptr_doa->m_fft_size - i];
-        }
+    if (stft->channels != ptr_doa->m_channels || stft->fft_size != ptr_doa->m_fft_size) {
+        printf("doa stft must have %d channels and a %d fft\n", ptr_doa->m_channels, ptr_doa->m_fft_size);
+        return ptr_doa->m_angle_smooth;
     }
+    ptr_doa->m_re = stft->re;
+    ptr_doa->m_im = stft->im;
 
     dios_ssp_doa_cal_rxx(ptr_doa);
 
+    // the covariance is accumulated every frame, the search only runs when its
+    // result is kept and m_search_interval frames have passed since the last one
+    ptr_doa->m_search_wait++;
+    if (!(vad_result == 1 || dt_st != 1) || ptr_doa->m_search_wait < ptr_doa->m_search_interval) {
+        return ptr_doa->m_angle_smooth;
+    }
+    ptr_doa->m_search_wait = 0;
+    ptr_doa->m_search_count++;
+
     for ( int n = 0; n < ptr_doa->m_frq_bin_num; ++n) {
         int k = ptr_doa->m_doa_fid[n];
-
-        memset( ptr_doa->m_rxx_in, 0, sizeof(float)*2*ptr_doa->m_rxx_size );
+        float *band_re = ptr_doa->m_rxx_band_re + n*ptr_doa->m_rxx_size;
+        float *band_im = ptr_doa->m_rxx_band_im + n*ptr_doa->m_rxx_size;
 
         for ( int i = 0; i < ptr_doa->m_channels; ++i) {
-            for(int m = 0; m < ptr_doa->m_frq_bin_width; ++m) {
-                ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*i] += ptr_doa->m_rxx_re[(k-m+ptr_doa->m_frq_bin_width/2-1)*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+i];
-                ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*i+1] += ptr_doa->m_rxx_im[(k-m+ptr_doa->m_frq_bin_width/2-1)*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+i];
-            }
-            ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*i] /= ptr_doa->m_frq_bin_width;
-            ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*i+1] /= ptr_doa->m_frq_bin_width;
-            for ( int j = i+1; j < ptr_doa->m_channels; ++j) {
+            for ( int j = i; j < ptr_doa->m_channels; ++j) {
+                float sum_re = 0, sum_im = 0;
                 for( int m = 0; m < ptr_doa->m_frq_bin_width; ++m) {
-                    ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*j] += ptr_doa->m_rxx_re[(k-m+ptr_doa->m_frq_bin_width/2-1)*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j];
-                    ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*j+1] += ptr_doa->m_rxx_im[(k-m+ptr_doa->m_frq_bin_width/2-1)*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j];
+                    sum_re += ptr_doa->m_rxx_re[(k-m+ptr_doa->m_frq_bin_width/2-1)*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j];
+                    sum_im += ptr_doa->m_rxx_im[(k-m+ptr_doa->m_frq_bin_width/2-1)*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j];
                 }
-                ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*j] /= ptr_doa->m_frq_bin_width;
-                ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*j+1] /= ptr_doa->m_frq_bin_width;
-                ptr_doa->m_rxx_in[j*ptr_doa->m_channels*2+2*i] = ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*j];
-                ptr_doa->m_rxx_in[j*ptr_doa->m_channels*2+2*i+1] = -ptr_doa->m_rxx_in[i*ptr_doa->m_channels*2+2*j+1];
-            }
-        }
-        dios_ssp_matrix_inv_process(ptr_doa->doainv, ptr_doa->m_rxx_in, ptr_doa->m_irxx_out);
-        for ( int i = 0; i < ptr_doa->m_channels; ++i) {
-            for ( int j = 0; j < ptr_doa->m_channels; ++j) {
-                ptr_doa->m_irxx_re[k*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j] =  ptr_doa->m_irxx_out[i*ptr_doa->m_channels*2+2*j];
-                ptr_doa->m_irxx_im[k*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j] =  ptr_doa->m_irxx_out[i*ptr_doa->m_channels*2+2*j+1];
+                band_re[i*ptr_doa->m_channels+j] = sum_re / ptr_doa->m_frq_bin_width;
+                band_im[i*ptr_doa->m_channels+j] = sum_im / ptr_doa->m_frq_bin_width;
             }
         }
     }
+    if (ptr_doa->m_engine == DOA_ENGINE_CAPON) {
+        dios_ssp_share_hsolve_factor(ptr_doa->hsolve, ptr_doa->m_rxx_band_re, ptr_doa->m_rxx_band_im,
+                                     ptr_doa->m_rxx_size, ptr_doa->m_frq_bin_num, DEFAULT_DOA_DIAG_LOADING);
+        dios_ssp_share_hsolve_inverse(ptr_doa->hsolve, ptr_doa->m_irxx_re, ptr_doa->m_irxx_im, ptr_doa->m_rxx_size);
+    }
 
     memset(ptr_doa->m_capon_spectrum, 0, sizeof(float)*ptr_doa->m_angle_num);
-    for ( int n = 0; n < ptr_doa->m_frq_bin_num; ++n) {
-        int k = ptr_doa->m_doa_fid[n];
-        for ( int m = 0; m < ptr_doa->m_angle_num; ++m ) {
-            for (int i = 0; i < ptr_doa->m_channels; i++) {
-                re_temp = im_temp = 0;
-                for (int j = 0; j < ptr_doa->m_channels; j++) {
-                    re_temp += ptr_doa->m_irxx_re[k*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j] * ptr_doa->m_gstv_re[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+j]
-                               - ptr_doa->m_irxx_im[k*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j] * ptr_doa->m_gstv_im[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+j];
-                    im_temp += ptr_doa->m_irxx_re[k*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j] * ptr_doa->m_gstv_im[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+j]
-                               + ptr_doa->m_irxx_im[k*ptr_doa->m_rxx_size+i*ptr_doa->m_channels+j] * ptr_doa->m_gstv_re[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+j];
-                }
-                ptr_doa->m_vec_re[i] = re_temp;
-                ptr_doa->m_vec_im[i] = im_temp;
+    if (ptr_doa->m_coarse_angle > 0) {
+        // coarse scan, then the fine angles between the two coarse neighbours of the peak
+        memset(ptr_doa->m_capon_coarse, 0, sizeof(float)*ptr_doa->m_coarse_num);
+        dios_ssp_doa_scan(ptr_doa, ptr_doa->m_gpair_coarse, ptr_doa->m_coarse_num, 0, ptr_doa->m_coarse_num, ptr_doa->m_capon_coarse);
+        max_ind = 0;
+        max_spectrum = ptr_doa->m_capon_coarse[0];
+        for ( int m = 1; m < ptr_doa->m_coarse_num; ++m ) {
+            if ( ptr_doa->m_capon_coarse[m] > max_spectrum ) {
+                max_ind = m;
+                max_spectrum = ptr_doa->m_capon_coarse[m];
             }
-            re_temp = im_temp = 0;
-            for (int i = 0; i < ptr_doa->m_channels; i++) {
-                re_temp += ptr_doa->m_gstv_re[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+i]*ptr_doa->m_vec_re[i] + ptr_doa->m_gstv_im[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+i]*ptr_doa->m_vec_im[i];
-                im_temp += ptr_doa->m_gstv_re[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+i]*ptr_doa->m_vec_im[i] - ptr_doa->m_gstv_im[m*ptr_doa->m_gstv_dim+k*ptr_doa->m_channels+i]*ptr_doa->m_vec_re[i];
+        }
+
+        int start = max_ind*ptr_doa->m_coarse_ratio - ptr_doa->m_coarse_ratio + 1;
+        int num = 2*ptr_doa->m_coarse_ratio - 1;
+        if (start < 0) {
+            start += ptr_doa->m_angle_num;
+        }
+        if (start + num > ptr_doa->m_angle_num) {
+            dios_ssp_doa_scan(ptr_doa, ptr_doa->m_gpair, ptr_doa->m_angle_num, start, ptr_doa->m_angle_num-start, ptr_doa->m_capon_spectrum);
+            dios_ssp_doa_scan(ptr_doa, ptr_doa->m_gpair, ptr_doa->m_angle_num, 0, start+num-ptr_doa->m_angle_num, ptr_doa->m_capon_spectrum);
+        } else {
+            dios_ssp_doa_scan(ptr_doa, ptr_doa->m_gpair, ptr_doa->m_angle_num, start, num, ptr_doa->m_capon_spectrum);
+        }
+
+        max_ind = start;
+        max_spectrum = ptr_doa->m_capon_spectrum[start];
+        for ( int m = 1; m < num; ++m ) {
+            int idx = (start + m) % ptr_doa->m_angle_num;
+            if ( ptr_doa->m_capon_spectrum[idx] > max_spectrum ) {
+                max_ind = idx;
+                max_spectrum = ptr_doa->m_capon_spectrum[idx];
+            }
+        }
+    } else {
+        dios_ssp_doa_scan(ptr_doa, ptr_doa->m_gpair, ptr_doa->m_angle_num, 0, ptr_doa->m_angle_num, ptr_doa->m_capon_spectrum);
+
+        max_ind = 0;
+        max_spectrum = ptr_doa->m_capon_spectrum[0];
+        for ( int m = 1; m < ptr_doa->m_angle_num; ++m ) {
+            if ( ptr_doa->m_capon_spectrum[m] > max_spectrum ) {
+                max_ind = m;
+                max_spectrum = ptr_doa->m_capon_spectrum[m];
             }
-            ptr_doa->m_capon_spectrum[m] += ptr_doa->m_channels / re_temp;
         }
     }
 
-    max_ind = 0;
-    max_spectrum = ptr_doa->m_capon_spectrum[0];
-    for ( int m = 1; m < ptr_doa->m_angle_num; ++m ) {
-        if ( ptr_doa->m_capon_spectrum[m] > max_spectrum ) {
-            max_ind = m;
-            max_spectrum = ptr_doa->m_capon_spectrum[m];
-        }
+    ptr_doa->m_angle_smooth = (float)(max_ind*ptr_doa->m_delta_angle);
+
+    return ptr_doa->m_angle_smooth;
+}
+
+int dios_ssp_doa_update_config_api(void *ptr, int interval)
+{
+    objDOA* ptr_doa;
+    if (NULL == ptr) {
+        printf("doa handle not init!\n");
+        return ERROR_DOA;
     }
+    ptr_doa = (objDOA*)ptr;
 
-    if(vad_result == 1 || dt_st != 1) {
-        ptr_doa->m_angle_smooth = (float)(max_ind*ptr_doa->m_delta_angle);
+    if (interval < 1) {
+        printf("doa search interval %d must be at least 1\n", interval);
+        return ERROR_DOA;
     }
+    ptr_doa->m_search_interval = interval;
+    ptr_doa->m_search_wait = interval;
 
-    for (int ch_idx = 0; ch_idx < ptr_doa->m_channels; ++ch_idx) {
-        memmove(ptr_doa->m_mch_buffer[ch_idx], ptr_doa->m_mch_buffer[ch_idx] + ptr_doa->m_shift_size, sizeof(float) * (ptr_doa->m_fft_size - ptr_doa->m_shift_size));
+    return 0;
+}
+
+int dios_ssp_doa_search_count_get(void *ptr)
+{
+    objDOA* ptr_doa;
+    if (NULL == ptr) {
+        printf("doa handle not init!\n");
+        return ERROR_DOA;
     }
+    ptr_doa = (objDOA*)ptr;
 
-    return ptr_doa->m_angle_smooth;
+    return ptr_doa->m_search_count;
 }
 
-int dios_ssp_doa_uninit_api(void *ptr)
+int dios_ssp_doa_engine_config_api(void *ptr, int engine)
 {
     objDOA* ptr_doa;
+    if (NULL == ptr) {
+        printf("doa handle not init!\n");
+        return ERROR_DOA;
+    }
     ptr_doa = (objDOA*)ptr;
+
+    if (engine != DOA_ENGINE_CAPON && engine != DOA_ENGINE_SRP_PHAT) {
+        printf("doa engine %d not supported\n", engine);
+        return ERROR_DOA;
+    }
+    ptr_doa->m_engine = engine;
+
+    return 0;
+}
+
+int dios_ssp_doa_uninit_api(void *ptr)
+{
+    objDOA* ptr_doa;
     int ret = 0;
+    if (NULL == ptr) {
+        printf("doa handle not init!\n");
+        return ERROR_DOA;
+    }
+    ptr_doa = (objDOA*)ptr;
 
-    dios_ssp_doa_win_delete(ptr_doa->doawin);
-    ret = dios_ssp_share_rfft_uninit(ptr_doa->doa_fft);
-    if (0 != ret) {
-        ptr_doa->doa_fft = NULL;
+    if (!ptr_doa->m_stft_shared) {
+        ret = dios_ssp_share_stft_uninit(ptr_doa->stft);
+        if (0 != ret) {
+            ptr_doa->stft = NULL;
+        }
     }
 
-    ret = dios_ssp_matrix_inv_delete(ptr_doa->doainv);
+    ret = dios_ssp_share_hsolve_uninit(ptr_doa->hsolve);
     if (0 != ret) {
-        ptr_doa->doainv = NULL;
+        ptr_doa->hsolve = NULL;
     }
-    for (int i = 0; i < ptr_doa->m_channels; ++i ) {
-        free(ptr_doa->m_mch_buffer[i]);
-    }
-    free(ptr_doa->fft_out);
-    free(ptr_doa->m_win_data);
-    free(ptr_doa->m_re);
-    free(ptr_doa->m_im);
-    free(ptr_doa->m_mch_buffer);
     free(ptr_doa->m_capon_spectrum);
     free(ptr_doa->m_doa_fid);
     free(ptr_doa->m_irxx_re);
     free(ptr_doa->m_irxx_im);
-    free(ptr_doa->m_vec_re);
-    free(ptr_doa->m_vec_im);
-    free(ptr_doa->m_gstv_re);
-    free(ptr_doa->m_gstv_im);
-    free(ptr_doa->m_rxx_in);
+    free(ptr_doa->m_irxx_pair);
+    free(ptr_doa->m_capon_q);
+    free(ptr_doa->m_capon_coarse);
+    free(ptr_doa->m_gpair);
+    free(ptr_doa->m_gpair_coarse);
+    free(ptr_doa->m_rxx_band_re);
+    free(ptr_doa->m_rxx_band_im);
     free(ptr_doa->m_rxx_re);
     free(ptr_doa->m_rxx_im);
-    free(ptr_doa->m_irxx_out);
+
+    free(ptr_doa);
 
     return 0;
 }
@@ -25,59 +25,107 @@ Adverse Environments: Improved Minima Controlled Recursive Averaging"
 ==============================================================================*/
 
 #include "dios_ssp_dtln_api.h"
-#include "tflite/c_api.h"
+#include "dios_ssp_dtln_header.h"
+#include "../dios_ssp_share/dios_ssp_share_simd.h"
 
-typedef struct {
-    int frame_len;
-    int m_wav_len2;
-    int m_max_pack_len;
-    int m_shift_size;
-    int m_fft_size;
-    int m_frame_sum;
-    int m_sp_size;
-    float *m_wav_buffer;
-    float *m_out_buffer;
-    float *m_win_wav;
-    float* m_re;
-    float* m_im;
+int dtln_type_size(TfLiteType type)
+{
+    switch (type) {
+    case kTfLiteFloat32:
+        return sizeof(float);
+    case kTfLiteFloat16:
+        return sizeof(uint16_t);
+    case kTfLiteInt8:
+        return sizeof(int8_t);
+    default:
+        return 0;
+    }
+}
 
-    //anaylsis window & synthesis window
-    float *m_ana_win;
-    float *m_syn_win;
-    float *m_norm_win;
+int dtln_check_tensor(const TfLiteTensor *tensor, int len, int batch)
+{
+    if (NULL == tensor || NULL == TfLiteTensorData(tensor)) {
+        return -1;
+    }
+    if (kTfLiteFloat32 != TfLiteTensorType(tensor) ||
+            TfLiteTensorByteSize(tensor) != (size_t)len * batch * sizeof(float)) {
+        return -1;
+    }
 
-    //stft_process & istft_process
-    float *fftin_buffer;
-    float *fft_out;
-    void *rfft_param;
+    return 0;
+}
 
-    float *m_dtln_out_data;
+int dtln_bind_tensor(objDTLNTensor *dst, const TfLiteTensor *tensor, int len)
+{
+    if (NULL == tensor || NULL == TfLiteTensorData(tensor)) {
+        return -1;
+    }
 
-    // dtln
-    float states[DTLN_MODEL_NUM][DTLN_FRAME_SIZE];
+    TfLiteType type = TfLiteTensorType(tensor);
+    int type_size = dtln_type_size(type);
+    if (0 == type_size || TfLiteTensorByteSize(tensor) != (size_t)len * type_size) {
+        return -1;
+    }
 
-    TfLiteTensor *inDetails[DTLN_MODEL_NUM][2];
-    const TfLiteTensor *outDetails[DTLN_MODEL_NUM][2];
+    TfLiteQuantizationParams quant = TfLiteTensorQuantizationParams(tensor);
+    if (kTfLiteInt8 == type && quant.scale <= 0.0f) {
+        return -1;
+    }
 
-    TfLiteInterpreter *interpreter[DTLN_MODEL_NUM];
-    TfLiteModel *model[DTLN_MODEL_NUM];
+    dst->data = TfLiteTensorData(tensor);
+    dst->type = type;
+    dst->scale = kTfLiteInt8 == type ? quant.scale : 1.0f;
+    dst->inv_scale = 1.0f / dst->scale;
+    dst->zero_point = kTfLiteInt8 == type ? quant.zero_point : 0;
 
-    TfLiteInterpreterOptions *options;
+    return 0;
+}
 
-    float *m_mag;
-    float *m_phase;
-    float *m_dtln_out_freq;
-    float *m_dtln_out_time;
-} objDTLN;
+void dtln_bind_float(objDTLNTensor *dst, float *data)
+{
+    dst->data = data;
+    dst->type = kTfLiteFloat32;
+    dst->scale = 1.0f;
+    dst->inv_scale = 1.0f;
+    dst->zero_point = 0;
+}
 
-void* dios_ssp_dtln_init_api(const char *modelpath[], int frame_len)
+// bind every model input and output in place, the tensors are float32,
+// float16 or int8 with the dtln shapes
+int dtln_bind_tensors(objDTLN* srv)
 {
-    if (NULL == modelpath ||
-            NULL == modelpath[0] || NULL == modelpath[1] ||
-            strlen(modelpath[0]) <= 0 || strlen(modelpath[1]) <= 0) {
-        return NULL;
+    int i;
+    int in_len[DTLN_MODEL_NUM] = { srv->m_sp_size, srv->m_fft_size };
+
+    // the arena pointers stay valid until the tensors are reallocated
+    for (i = 0; i < DTLN_MODEL_NUM; i++) {
+        if (0 != dtln_bind_tensor(&srv->m_in[i][0], srv->inDetails[i][0], in_len[i]) ||
+                0 != dtln_bind_tensor(&srv->m_out[i][0], srv->outDetails[i][0], in_len[i]) ||
+                0 != dtln_bind_tensor(&srv->m_in[i][1], srv->inDetails[i][1], DTLN_FRAME_SIZE) ||
+                0 != dtln_bind_tensor(&srv->m_out[i][1], srv->outDetails[i][1], DTLN_FRAME_SIZE)) {
+            printf("dtln: tensors of model %d are not float32, float16 or int8 of the dtln shapes\n", i);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void dtln_clear_states(objDTLN* srv)
+{
+    int i;
+
+    memset(srv->states, 0, sizeof(srv->states));
+    // streams of the batch engine have no tensors of their own
+    for (i = 0; i < DTLN_MODEL_NUM; i++) {
+        if (NULL != srv->m_in[i][1].data) {
+            dtln_store_tensor(&srv->m_in[i][1], srv->states[i], DTLN_FRAME_SIZE);
+        }
     }
+}
 
+objDTLN* dtln_create(int frame_len)
+{
     objDTLN *srv = (objDTLN *)malloc(sizeof(objDTLN));
     if (NULL == srv) {
         return NULL;
@@ -85,139 +133,196 @@ void* dios_ssp_dtln_init_api(const char *modelpath[], int frame_len)
     memset(srv, 0, sizeof(objDTLN));
 
     srv->frame_len = frame_len;
-    srv->m_max_pack_len = DTLN_SAMPLE_RATE + 512;
     srv->m_shift_size = DTLN_FRAME_SHIFT;
     srv->m_fft_size = DTLN_FRAME_SIZE;
     srv->m_sp_size = srv->m_fft_size / 2 +1;
     srv->m_frame_sum = 0;
-    srv->m_wav_len2 = 0;
-    // 输入缓存
-    srv->m_wav_buffer = (float *)calloc(srv->m_max_pack_len, sizeof(float));
-    if (NULL == srv->m_wav_buffer) {
-        dios_ssp_dtln_uninit_api(srv);
+    // 输入缓存, at most fft_size - 1 samples are left over between calls
+    srv->m_wav_ring = dios_ssp_share_ringbuf_init(srv->m_fft_size + frame_len);
+    if (NULL == srv->m_wav_ring) {
+        dtln_delete(srv);
         return NULL;
     }
 
-    // 输出缓存
-    srv->m_out_buffer = (float *)calloc(srv->m_max_pack_len, sizeof(float));
-    if (NULL == srv->m_out_buffer) {
-        dios_ssp_dtln_uninit_api(srv);
+    // 输出缓存, one more hop for the pipelined delay
+    srv->m_out_ola = dios_ssp_share_ola_init(srv->m_fft_size + frame_len + srv->m_shift_size);
+    if (NULL == srv->m_out_ola) {
+        dtln_delete(srv);
         return NULL;
     }
 
     // 加窗结果 / fft输入 / ifft输出
     srv->m_win_wav = (float *)calloc(srv->m_fft_size, sizeof(float));
     if (NULL == srv->m_win_wav) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     // fft实部
     srv->m_re = (float *)calloc(srv->m_fft_size, sizeof(float));
     if (NULL == srv->m_re) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     // fft虚部
     srv->m_im = (float *)calloc(srv->m_fft_size, sizeof(float));
     if (NULL == srv->m_im) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     //
     srv->fft_out = (float *)calloc(srv->m_fft_size, sizeof(float));
     if (NULL ==	srv->fft_out) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     srv->fftin_buffer = (float*)calloc(srv->m_fft_size, sizeof(float));
     if (NULL ==	srv->fftin_buffer) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     srv->m_ana_win = (float *)calloc(srv->m_fft_size, sizeof(float));
     if (NULL ==	srv->m_ana_win) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     srv->m_syn_win = (float *)calloc(srv->m_fft_size, sizeof(float));
     if (NULL ==	srv->m_syn_win) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     srv->m_norm_win = (float *)calloc(srv->m_fft_size, sizeof(float));
     if (NULL ==	srv->m_norm_win) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     srv->m_dtln_out_data = (float *)calloc(2 * srv->frame_len, sizeof(float));
     if (NULL == srv->m_dtln_out_data) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
     srv->rfft_param = dios_ssp_share_rfft_init(srv->m_fft_size);
     if (NULL ==	srv->rfft_param) {
-        dios_ssp_dtln_uninit_api(srv);
-        return NULL;
-    }
-
-    srv->options = TfLiteInterpreterOptionsCreate();
-    if (NULL == srv->options) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
-    TfLiteInterpreterOptionsSetNumThreads(srv->options, 1);
 
     srv->m_mag = (float *)calloc(srv->m_sp_size, sizeof(float));
     if (NULL == srv->m_mag) {
-        dios_ssp_dtln_uninit_api(srv);
+        dtln_delete(srv);
         return NULL;
     }
 
-    srv->m_phase = (float *)calloc(srv->m_sp_size, sizeof(float));
-    if (NULL == srv->m_phase) {
-        dios_ssp_dtln_uninit_api(srv);
+    return srv;
+}
+
+TfLiteDelegate* dtln_create_delegate(int delegate, int num_threads)
+{
+#ifdef DTLN_USE_XNNPACK
+    if (DTLN_DELEGATE_XNNPACK == delegate) {
+        TfLiteXNNPackDelegateOptions xnn_options = TfLiteXNNPackDelegateOptionsDefault();
+        xnn_options.num_threads = num_threads;
+        return TfLiteXNNPackDelegateCreate(&xnn_options);
+    }
+#else
+    (void)delegate;
+    (void)num_threads;
+#endif
+    return NULL;
+}
+
+void dtln_delete_delegate(TfLiteDelegate *delegate)
+{
+#ifdef DTLN_USE_XNNPACK
+    TfLiteXNNPackDelegateDelete(delegate);
+#else
+    (void)delegate;
+#endif
+}
+
+TfLiteInterpreter* dtln_create_interpreter(objDTLN* srv, int i, int num_threads, int delegate)
+{
+    TfLiteInterpreter *interpreter = NULL;
+    TfLiteInterpreterOptions *options = TfLiteInterpreterOptionsCreate();
+    if (NULL == options) {
         return NULL;
     }
+    TfLiteInterpreterOptionsSetNumThreads(options, num_threads);
 
-    srv->m_dtln_out_freq = (float *)calloc(srv->m_sp_size, sizeof(float));
-    if (NULL == srv->m_dtln_out_freq) {
-        dios_ssp_dtln_uninit_api(srv);
+    if (DTLN_DELEGATE_NONE != delegate) {
+        srv->delegate[i] = dtln_create_delegate(delegate, num_threads);
+        if (NULL != srv->delegate[i]) {
+            TfLiteInterpreterOptionsAddDelegate(options, srv->delegate[i]);
+            interpreter = TfLiteInterpreterCreate(srv->model[i], options);
+        }
+        if (NULL == interpreter) {
+            // delegate not built in or not applicable to the graph, run on
+            // the builtin cpu kernels instead
+            printf("dtln: delegate %d unavailable for model %d, using builtin kernels\n", delegate, i);
+            if (NULL != srv->delegate[i]) {
+                dtln_delete_delegate(srv->delegate[i]);
+                srv->delegate[i] = NULL;
+            }
+            TfLiteInterpreterOptionsDelete(options);
+            options = TfLiteInterpreterOptionsCreate();
+            if (NULL == options) {
+                return NULL;
+            }
+            TfLiteInterpreterOptionsSetNumThreads(options, num_threads);
+        }
+    }
+
+    if (NULL == interpreter) {
+        interpreter = TfLiteInterpreterCreate(srv->model[i], options);
+    }
+    TfLiteInterpreterOptionsDelete(options);
+
+    return interpreter;
+}
+
+void* dios_ssp_dtln_init_api(const char *modelpath[], int frame_len, int num_threads, int delegate)
+{
+    if (NULL == modelpath ||
+            NULL == modelpath[0] || NULL == modelpath[1] ||
+            strlen(modelpath[0]) <= 0 || strlen(modelpath[1]) <= 0) {
         return NULL;
     }
 
-    srv->m_dtln_out_time = (float *)calloc(srv->m_fft_size, sizeof(float));
-    if (NULL ==	srv->m_dtln_out_time) {
-        dios_ssp_dtln_uninit_api(srv);
+    objDTLN *srv = dtln_create(frame_len);
+    if (NULL == srv) {
         return NULL;
     }
 
+    if (num_threads <= 0) {
+        num_threads = 1;
+    }
+
     for (int i = 0; i < DTLN_MODEL_NUM; i++) {
-        // load model
-        srv->model[i] = TfLiteModelCreateFromFile(modelpath[i]);
+        // load model, parsed once per process and shared by all instances
+        srv->model[i] = dios_ssp_dtln_model_acquire(modelpath[i]);
         if (NULL == srv->model[i]) {
-            dios_ssp_dtln_uninit_api(srv);
+            dtln_delete(srv);
             return NULL;
         }
 
         // create interpreter
-        srv->interpreter[i] = TfLiteInterpreterCreate(srv->model[i], srv->options);
+        srv->interpreter[i] = dtln_create_interpreter(srv, i, num_threads, delegate);
         if (NULL == srv->interpreter[i]) {
-            dios_ssp_dtln_uninit_api(srv);
+            dtln_delete(srv);
             return NULL;
         }
 
         // allocate tensor buffers
         if (kTfLiteOk != TfLiteInterpreterAllocateTensors(srv->interpreter[i])) {
-            dios_ssp_dtln_uninit_api(srv);
+            dtln_delete(srv);
             return NULL;
         }
 
@@ -229,6 +334,13 @@ void* dios_ssp_dtln_init_api(const char *modelpath[], int frame_len)
         memset(srv->states[i], 0, sizeof(float)*DTLN_FRAME_SIZE);
     }
 
+    // use the tensor buffers in place, quantization is folded into the stft loops
+    if (0 != dtln_bind_tensors(srv)) {
+        dtln_delete(srv);
+        return NULL;
+    }
+    dtln_clear_states(srv);
+
     return srv;
 }
 
@@ -242,15 +354,21 @@ int dios_ssp_dtln_reset_api(void* ptr)
     int i = 0;
     int j = 0;
 
-    srv->m_wav_len2 = 0;
+    if (srv->m_pipeline) {
+        dtln_pipeline_reset(srv);
+    }
+
     srv->m_frame_sum = 0;
-    memset(srv->m_wav_buffer, 0, sizeof(float)*srv->m_max_pack_len);
-    memset(srv->m_out_buffer, 0, sizeof(float)*srv->m_max_pack_len);
+    dios_ssp_share_ringbuf_reset(srv->m_wav_ring, 0);
+    dios_ssp_share_ola_reset(srv->m_out_ola);
     memset(srv->m_dtln_out_data, 0, sizeof(float)*2*srv->frame_len);
     memset(srv->m_win_wav, 0, sizeof(float)*srv->m_fft_size);
     memset(srv->m_re, 0, sizeof(float)*srv->m_fft_size);
     memset(srv->m_im, 0, sizeof(float)*srv->m_fft_size);
 
+    // clear the lstm states
+    dtln_clear_states(srv);
+
     for (i = 0; i < srv->m_fft_size; i++) {
         srv->m_ana_win[i] = 0.54f - 0.46f * (float)cos( (2*i)*PI / (srv->m_fft_size-1) );
         srv->m_norm_win[i] = srv->m_ana_win[i] * srv->m_ana_win[i];
@@ -258,7 +376,7 @@ int dios_ssp_dtln_reset_api(void* ptr)
 
     int m_block_num = srv->m_fft_size / srv->m_shift_size;
     float temp = 0.0f;
-    for (i = 0; i <srv->m_fft_size; i++) {
+    for (i = 0; i < srv->m_shift_size; i++) {
         temp = 0;
         for (j = 0; j < m_block_num; ++j ) {
             temp += srv->m_norm_win[i+j*srv->m_shift_size];
@@ -277,7 +395,7 @@ int dios_ssp_dtln_reset_api(void* ptr)
     return 0;
 }
 
-void dtln_add_ana_win(objDTLN* srv, float *x, float *x_win )
+void dtln_add_ana_win(objDTLN* srv, const float *x, float *x_win )
 {
     int i;
     for (i = 0; i < srv->m_fft_size; ++i ) {
@@ -285,7 +403,7 @@ void dtln_add_ana_win(objDTLN* srv, float *x, float *x_win )
     }
 }
 
-void dtln_add_syn_win(objDTLN* srv, float *x, float *x_win )
+void dtln_add_syn_win(objDTLN* srv, const float *x, float *x_win )
 {
     int i;
     for (i = 0; i < srv->m_fft_size; ++i ) {
@@ -293,118 +411,329 @@ void dtln_add_syn_win(objDTLN* srv, float *x, float *x_win )
     }
 }
 
-void dtln_calc_mag(objDTLN* srv, float *real, float *imag, float *mag)
+float dtln_half_to_float(uint16_t h)
 {
-    int i;
-    for (i = 0; i < srv->m_sp_size; i++) {
-        mag[i] = sqrtf(real[i]*real[i] + imag[i]*imag[i]);
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t man = h & 0x3ff;
+    union { uint32_t u; float f; } v;
+
+    if (0 == exp) {
+        // zero or subnormal
+        v.f = (float)man * 5.9604644775390625e-8f;
+        v.u |= sign;
+        return v.f;
+    }
+    if (0x1f == exp) {
+        v.u = sign | 0x7f800000 | (man << 13);
+    } else {
+        v.u = sign | ((exp + 112) << 23) | (man << 13);
+    }
+    return v.f;
+}
+
+uint16_t dtln_float_to_half(float f)
+{
+    union { uint32_t u; float f; } v;
+    v.f = f;
+    uint16_t sign = (uint16_t)((v.u >> 16) & 0x8000);
+    int32_t exp = (int32_t)((v.u >> 23) & 0xff) - 112;
+    uint32_t man = v.u & 0x7fffff;
+
+    if (exp >= 0x1f) {
+        // overflow saturates to inf, nan keeps a mantissa bit
+        return sign | 0x7c00 | (((v.u & 0x7fffffff) > 0x7f800000) ? 0x200 : 0);
+    }
+    if (exp <= 0) {
+        if (exp < -10) {
+            return sign;
+        }
+        man |= 0x800000;
+        uint32_t shift = 14 - exp;
+        uint32_t half = man >> shift;
+        uint32_t rem = man & ((1u << shift) - 1);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1))) {
+            half++;
+        }
+        return sign | (uint16_t)half;
+    }
+
+    uint32_t half = ((uint32_t)exp << 10) | (man >> 13);
+    uint32_t rem = man & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) {
+        half++;  // may carry into the exponent, which is still correct
     }
+    return sign | (uint16_t)half;
 }
 
-void dtln_calc_phase(objDTLN* srv, float *real, float *imag, float *phase)
+int8_t dtln_quantize_int8(const objDTLNTensor *t, float x)
+{
+    int q = (int)lrintf(x * t->inv_scale) + t->zero_point;
+    if (q > 127) {
+        q = 127;
+    } else if (q < -128) {
+        q = -128;
+    }
+    return (int8_t)q;
+}
+
+void dtln_store_tensor(const objDTLNTensor *t, const float *x, int len)
 {
     int i;
-    for (i = 0; i < srv->m_sp_size; i++) {
-        phase[i] = atan2f(imag[i], real[i]);
+    switch (t->type) {
+    case kTfLiteFloat16:
+        for (i = 0; i < len; i++) {
+            ((uint16_t *)t->data)[i] = dtln_float_to_half(x[i]);
+        }
+        break;
+    case kTfLiteInt8:
+        for (i = 0; i < len; i++) {
+            ((int8_t *)t->data)[i] = dtln_quantize_int8(t, x[i]);
+        }
+        break;
+    default:
+        if (t->data != x) {
+            memcpy(t->data, x, len * sizeof(float));
+        }
+        break;
     }
 }
 
-int dtln_process(objDTLN* srv, float *in_data, float *out_data)
+void dtln_load_tensor(const objDTLNTensor *t, float *x, int len)
 {
     int i;
+    switch (t->type) {
+    case kTfLiteFloat16:
+        for (i = 0; i < len; i++) {
+            x[i] = dtln_half_to_float(((const uint16_t *)t->data)[i]);
+        }
+        break;
+    case kTfLiteInt8:
+        for (i = 0; i < len; i++) {
+            x[i] = t->scale * (((const int8_t *)t->data)[i] - t->zero_point);
+        }
+        break;
+    default:
+        if (t->data != x) {
+            memcpy(x, t->data, len * sizeof(float));
+        }
+        break;
+    }
+}
+
+void dtln_copy_tensor(const objDTLNTensor *dst, const objDTLNTensor *src, int len, float *tmp)
+{
+    if (dst->type == src->type && dst->scale == src->scale && dst->zero_point == src->zero_point) {
+        memcpy(dst->data, src->data, len * dtln_type_size(src->type));
+    } else {
+        dtln_load_tensor(src, tmp, len);
+        dtln_store_tensor(dst, tmp, len);
+    }
+}
+
+void dtln_calc_mag(objDTLN* srv, float *real, float *imag, const objDTLNTensor *mag_t)
+{
+    if (kTfLiteFloat32 == mag_t->type) {
+        dios_ssp_share_vec_abs(real, imag, (float *)mag_t->data, srv->m_sp_size);
+    } else {
+        dios_ssp_share_vec_abs(real, imag, srv->m_mag, srv->m_sp_size);
+        dtln_store_tensor(mag_t, srv->m_mag, srv->m_sp_size);
+    }
+}
 
+int dtln_push_input(objDTLN* srv, const float *in_data)
+{
     // input (frame_len是一帧帧长，相当于一个ringbuf，来处理帧长与实际帧长之间的不匹配)
-    for (i = 0 ; i < srv->frame_len; ++i ) {
-        srv->m_wav_buffer[i+srv->m_wav_len2] = in_data[i];
+    if (0 != dios_ssp_share_ringbuf_write(srv->m_wav_ring, in_data, srv->frame_len)) {
+        printf("dtln: input buffer full, frame dropped\n");
+        return -1;
     }
-    srv->m_wav_len2 += srv->frame_len;
 
-    // dtln loop
-    int sta;
-    for ( sta = 0; sta + srv->m_fft_size <= srv->m_wav_len2; sta += srv->m_shift_size ) {
-        srv->m_frame_sum ++;
-        // 1. add anaylsis window
-        dtln_add_ana_win(srv, srv->m_wav_buffer+sta, srv->m_win_wav);
-
-        // 2. stft
-        dios_ssp_share_rfft_process(srv->rfft_param, srv->m_win_wav, srv->fft_out);
-        for (i = 0; i < srv->m_sp_size-1; i++) {
-            srv->m_re[i] = srv->fft_out[i];
-        }
+    return 0;
+}
 
-        srv->m_im[0] = srv->m_im[srv->m_sp_size-1] = 0.0;
-        for (i = 1; i < srv->m_sp_size-1; i++) {
-            srv->m_im[i] = -srv->fft_out[srv->m_fft_size - i];
-        }
+void dtln_analysis(objDTLN* srv, int sta, const objDTLNTensor *mag)
+{
+    int i;
 
-        // 3. dtln in freq domain
-        dtln_calc_mag(srv, srv->m_re, srv->m_im, srv->m_mag);
-        dtln_calc_phase(srv, srv->m_re, srv->m_im, srv->m_phase);
+    srv->m_frame_sum ++;
+    // 1. add anaylsis window
+    dtln_add_ana_win(srv, dios_ssp_share_ringbuf_window(srv->m_wav_ring, sta), srv->m_win_wav);
 
-        TfLiteTensorCopyFromBuffer(srv->inDetails[0][0], srv->m_mag, srv->m_sp_size*sizeof(float));
-        TfLiteTensorCopyFromBuffer(srv->inDetails[0][1], srv->states[0], srv->m_fft_size*sizeof(float));
+    // 2. stft
+    dios_ssp_share_rfft_process(srv->rfft_param, srv->m_win_wav, srv->fft_out);
+    for (i = 0; i < srv->m_sp_size-1; i++) {
+        srv->m_re[i] = srv->fft_out[i];
+    }
 
-        if (TfLiteInterpreterInvoke(srv->interpreter[0]) != kTfLiteOk) {
-            printf("Error invoking detection model in freq domain\n");
-        }
+    srv->m_im[0] = srv->m_im[srv->m_sp_size-1] = 0.0;
+    for (i = 1; i < srv->m_sp_size-1; i++) {
+        srv->m_im[i] = -srv->fft_out[srv->m_fft_size - i];
+    }
 
-        TfLiteTensorCopyToBuffer(srv->outDetails[0][0], srv->m_dtln_out_freq, srv->m_sp_size*sizeof(float));
-        TfLiteTensorCopyToBuffer(srv->outDetails[0][1], srv->states[0], srv->m_fft_size*sizeof(float));
+    // 3. magnitude feeds model_1, the spectrum is kept for the synthesis
+    dtln_calc_mag(srv, srv->m_re, srv->m_im, mag);
+}
 
-        for (int i = 0; i < srv->m_sp_size; i++) {
-            srv->m_re[i] = srv->m_mag[i] * srv->m_dtln_out_freq[i] * cosf(srv->m_phase[i]);
-            srv->m_im[i] = srv->m_mag[i] * srv->m_dtln_out_freq[i] * sinf(srv->m_phase[i]);
+void dtln_synthesis(objDTLN* srv, const objDTLNTensor *mask, const objDTLNTensor *time_in)
+{
+    int i;
+    float gain;
+
+    // the mask is real, so |X|*mask*e^(j*phase) is just X*mask
+    switch (mask->type) {
+    case kTfLiteFloat16:
+        for (i = 0; i < srv->m_sp_size; i++) {
+            gain = dtln_half_to_float(((const uint16_t *)mask->data)[i]);
+            srv->m_re[i] *= gain;
+            srv->m_im[i] *= gain;
+        }
+        break;
+    case kTfLiteInt8:
+        for (i = 0; i < srv->m_sp_size; i++) {
+            gain = mask->scale * (((const int8_t *)mask->data)[i] - mask->zero_point);
+            srv->m_re[i] *= gain;
+            srv->m_im[i] *= gain;
         }
+        break;
+    default:
+        for (i = 0; i < srv->m_sp_size; i++) {
+            srv->m_re[i] *= ((const float *)mask->data)[i];
+            srv->m_im[i] *= ((const float *)mask->data)[i];
+        }
+        break;
+    }
+
+    // 4. istft
+    srv->fftin_buffer[0] = srv->m_re[0];
+    srv->fftin_buffer[srv->frame_len] = srv->m_re[srv->frame_len];
+    for (i = 1; i < srv->frame_len; i++) {
+        srv->fftin_buffer[i] = srv->m_re[i];
+        srv->fftin_buffer[srv->m_fft_size - i] = -srv->m_im[i];
+    }
 
-        // 4. istft
-        srv->fftin_buffer[0] = srv->m_re[0];
-        srv->fftin_buffer[srv->frame_len] = srv->m_re[srv->frame_len];
-        for (i = 1; i < srv->frame_len; i++) {
-            srv->fftin_buffer[i] = srv->m_re[i];
-            srv->fftin_buffer[srv->m_fft_size - i] = -srv->m_im[i];
+    if (kTfLiteFloat32 == time_in->type) {
+        float *out = (float *)time_in->data;
+        dios_ssp_share_irfft_process(srv->rfft_param, srv->fftin_buffer, out);
+        for (i = 0; i < srv->m_fft_size; ++i) {
+            out[i] = out[i] / srv->m_fft_size;//FFT coefficient 1/N
         }
+    } else {
+        // 1/N and the model_2 input quantization in one pass
         dios_ssp_share_irfft_process(srv->rfft_param, srv->fftin_buffer, srv->m_win_wav);
         for (i = 0; i < srv->m_fft_size; ++i) {
-            srv->m_win_wav[i] = srv->m_win_wav[i] / srv->m_fft_size;//FFT coefficient 1/N
+            srv->m_win_wav[i] = srv->m_win_wav[i] / srv->m_fft_size;
         }
+        dtln_store_tensor(time_in, srv->m_win_wav, srv->m_fft_size);
+    }
+}
 
-        // 5. dtln in time domain
-        TfLiteTensorCopyFromBuffer(srv->inDetails[1][0], srv->m_win_wav, srv->m_fft_size*sizeof(float));
-        TfLiteTensorCopyFromBuffer(srv->inDetails[1][1], srv->states[1], srv->m_fft_size*sizeof(float));
-
-        if (TfLiteInterpreterInvoke(srv->interpreter[1]) != kTfLiteOk) {
-            printf("Error invoking detection model in time domain\n");
-        }
+void dtln_overlap_add(objDTLN* srv, int sta, const objDTLNTensor *time_out)
+{
+    // 6. add synthesis window
+    if (kTfLiteFloat32 == time_out->type) {
+        dtln_add_syn_win(srv, (const float *)time_out->data, srv->m_re);
+    } else {
+        dtln_load_tensor(time_out, srv->m_re, srv->m_fft_size);
+        dtln_add_syn_win(srv, srv->m_re, srv->m_re);
+    }
+    // 7. ola
+    dios_ssp_share_ola_add(srv->m_out_ola, sta, srv->m_re, srv->m_fft_size);
+}
 
-        TfLiteTensorCopyToBuffer(srv->outDetails[1][0], srv->m_dtln_out_time, srv->m_fft_size*sizeof(float));
-        TfLiteTensorCopyToBuffer(srv->outDetails[1][1], srv->states[1], srv->m_fft_size*sizeof(float));
+int dtln_invoke(objDTLN* srv, int i)
+{
+    const char *name[DTLN_MODEL_NUM] = { "freq", "time" };
 
-        // 6. add synthesis window
-        dtln_add_syn_win(srv, srv->m_dtln_out_time, srv->m_re);
-        // 7. ola
-        for (i = 0; i < srv->m_fft_size; ++i ) {
-            srv->m_out_buffer[i+sta] += srv->m_re[i];
-        }
+    if (TfLiteInterpreterInvoke(srv->interpreter[i]) != kTfLiteOk) {
+        printf("Error invoking detection model in %s domain\n", name[i]);
+        return -1;
     }
 
+    // feed the new lstm states straight back to the input tensor. The c_api
+    // has no custom allocation, so the input tensor cannot be pointed at the
+    // output buffer or at a second state buffer and the 2 KB are copied
+    dtln_copy_tensor(&srv->m_in[i][1], &srv->m_out[i][1], DTLN_FRAME_SIZE, srv->states[i]);
+
+    return 0;
+}
+
+void dtln_pop_output(objDTLN* srv, int sta, float *out_data)
+{
+    int i;
+
+    dios_ssp_share_ola_pop(srv->m_out_ola, out_data, sta);
     for (i = 0; i < sta; ++i ) {
-        if ( srv->m_out_buffer[i] > 32767 ) {
+        if ( out_data[i] > 32767 ) {
             out_data[i] = 32767;
-        } else if ( srv->m_out_buffer[i] < -32768 ) {
+        } else if ( out_data[i] < -32768 ) {
             out_data[i] = -32768;
-        } else {
-            out_data[i] = srv->m_out_buffer[i];
         }
     }
 
-    memmove( srv->m_out_buffer, srv->m_out_buffer+sta, sizeof(float)*(srv->m_fft_size-srv->m_shift_size) );
-    memset( srv->m_out_buffer+srv->m_fft_size-srv->m_shift_size, 0, sizeof(float)*sta );
-    memmove( srv->m_wav_buffer, srv->m_wav_buffer+sta, sizeof(float)*(srv->m_wav_len2-sta) );
-    srv->m_wav_len2 -= sta;
+    dios_ssp_share_ringbuf_consume(srv->m_wav_ring, sta);
+}
+
+int dtln_process(objDTLN* srv, float *in_data, float *out_data)
+{
+    if (srv->m_pipeline) {
+        return dtln_pipeline_process(srv, in_data, out_data);
+    }
+
+    int ret = dtln_push_input(srv, in_data);
+
+    // dtln loop, a failed hop is still consumed to keep the stream aligned
+    int sta;
+    for ( sta = 0; sta + srv->m_fft_size <= srv->m_wav_ring->count; sta += srv->m_shift_size ) {
+        // dtln in freq domain
+        dtln_analysis(srv, sta, &srv->m_in[0][0]);
+        if (0 != dtln_invoke(srv, 0)) {
+            ret = -1;
+        }
+        dtln_synthesis(srv, &srv->m_out[0][0], &srv->m_in[1][0]);
+
+        // 5. dtln in time domain
+        if (0 != dtln_invoke(srv, 1)) {
+            ret = -1;
+        }
+        dtln_overlap_add(srv, sta, &srv->m_out[1][0]);
+    }
+
+    dtln_pop_output(srv, sta, out_data);
+
+    return ret;
+}
+
+int dios_ssp_dtln_config_api(void* ptr, int pipeline)
+{
+    if (NULL == ptr) {
+        return -1;
+    }
+
+    objDTLN *srv = (objDTLN*)ptr;
+    if (pipeline && !srv->m_pipeline) {
+        return dtln_pipeline_start(srv);
+    }
+    if (!pipeline && srv->m_pipeline) {
+        dtln_pipeline_stop(srv);
+        dios_ssp_dtln_reset_api(srv);
+    }
 
     return 0;
 }
 
+int dios_ssp_dtln_latency_get(void *ptr)
+{
+    if (NULL == ptr) {
+        return -1;
+    }
+
+    objDTLN *srv = (objDTLN*)ptr;
+
+    return srv->m_fft_size - srv->m_shift_size + srv->m_ola_delay;
+}
+
 int dios_ssp_dtln_process(void *ptr, float *in_data)
 {
     if (NULL == ptr) {
@@ -414,29 +743,28 @@ int dios_ssp_dtln_process(void *ptr, float *in_data)
     int i;
     objDTLN* srv = (objDTLN*)ptr;
 
-    dtln_process(srv, in_data, srv->m_dtln_out_data);
+    int ret = dtln_process(srv, in_data, srv->m_dtln_out_data);
 
     for(i = 0; i < srv->frame_len; i++) {
         in_data[i] = srv->m_dtln_out_data[i];
     }
 
-    return 0;
+    return ret;
 }
 
-int dios_ssp_dtln_uninit_api(void* ptr)
+void dtln_delete(objDTLN* srv)
 {
     int ret;
-    if (NULL == ptr) {
-        return -1;
-    }
 
-    objDTLN *srv = (objDTLN *)ptr;
+    if (srv->m_pipeline) {
+        dtln_pipeline_stop(srv);
+    }
 
-    if (srv->m_wav_buffer) {
-        free(srv->m_wav_buffer);
+    if (srv->m_wav_ring) {
+        dios_ssp_share_ringbuf_uninit(srv->m_wav_ring);
     }
-    if (srv->m_out_buffer) {
-        free(srv->m_out_buffer);
+    if (srv->m_out_ola) {
+        dios_ssp_share_ola_uninit(srv->m_out_ola);
     }
     if (srv->m_win_wav) {
         free(srv->m_win_wav);
@@ -469,18 +797,6 @@ int dios_ssp_dtln_uninit_api(void* ptr)
         free(srv->m_mag);
     }
 
-    if (srv->m_phase) {
-        free(srv->m_phase);
-    }
-
-    if (srv->m_dtln_out_freq) {
-        free(srv->m_dtln_out_freq);
-    }
-
-    if (srv->m_dtln_out_time) {
-        free(srv->m_dtln_out_time);
-    }
-
     if (srv->rfft_param) {
         ret = dios_ssp_share_rfft_uninit(srv->rfft_param);
         if (0 != ret) {
@@ -494,13 +810,28 @@ int dios_ssp_dtln_uninit_api(void* ptr)
             srv->interpreter[i] = NULL;
         }
         if (NULL != srv->model[i]) {
-            TfLiteModelDelete(srv->model[i]);
+            dios_ssp_dtln_model_release(srv->model[i]);
             srv->model[i] = NULL;
         }
     }
-    TfLiteInterpreterOptionsDelete(srv->options);
+    // delegates must outlive the interpreters using them
+    for (int i = 0; i < DTLN_MODEL_NUM; i++) {
+        if (NULL != srv->delegate[i]) {
+            dtln_delete_delegate(srv->delegate[i]);
+            srv->delegate[i] = NULL;
+        }
+    }
 
     free(srv);
+}
+
+int dios_ssp_dtln_uninit_api(void* ptr)
+{
+    if (NULL == ptr) {
+        return -1;
+    }
+
+    dtln_delete((objDTLN *)ptr);
 
     return 0;
 }
@@ -0,0 +1,390 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Description: Batched DTLN inference for many independent streams. Every
+stream keeps its own STFT buffers and LSTM states, while the two models are
+run by one shared pair of interpreters whose inputs are resized to
+[N,...]. The per-stream hops are gathered into the first rows of the batch
+tensors, each model is invoked once, and masks, outputs and states are
+scattered back to the streams. N only grows: it doubles, up to max_streams,
+when a round has more hops than rows, and rows without a hop stay idle.
+A fluctuating set of streams thus reallocates the tensors at most
+log2(max_streams) times, in exchange for invoking the idle rows of the
+largest round seen so far. Batching is limited to float32 models.
+==============================================================================*/
+
+#include "dios_ssp_dtln_api.h"
+#include "dios_ssp_dtln_batch.h"
+#include "dios_ssp_dtln_header.h"
+
+typedef struct {
+    int frame_len;
+    int max_streams;
+    int m_sp_size;
+    int m_fft_size;
+
+    // streams, only buffers and states, no interpreter
+    objDTLN **stream;
+    int *m_sta;
+    int *m_hop_stream;
+
+    const TfLiteModel *model[DTLN_MODEL_NUM];
+    TfLiteInterpreterOptions *options;
+    TfLiteInterpreter *interpreter[DTLN_MODEL_NUM];
+    TfLiteTensor *inDetails[DTLN_MODEL_NUM][2];
+    const TfLiteTensor *outDetails[DTLN_MODEL_NUM][2];
+
+    // batch size the tensors are allocated for, only grows, and the batch-1 input shapes
+    int m_batch;
+    int in_dims_size[DTLN_MODEL_NUM][2];
+    int in_dims[DTLN_MODEL_NUM][2][4];
+} objDTLNBatch;
+
+int dtln_batch_resize(objDTLNBatch *srv, int batch)
+{
+    int i, j;
+    int dims[4];
+    int in_len[DTLN_MODEL_NUM] = { srv->m_sp_size, srv->m_fft_size };
+
+    if (batch == srv->m_batch) {
+        return 0;
+    }
+
+    srv->m_batch = 0;
+    for (i = 0; i < DTLN_MODEL_NUM; i++) {
+        for (j = 0; j < 2; j++) {
+            memcpy(dims, srv->in_dims[i][j], sizeof(dims));
+            dims[0] = batch;
+            if (kTfLiteOk != TfLiteInterpreterResizeInputTensor(srv->interpreter[i], j,
+                        dims, srv->in_dims_size[i][j])) {
+                return -1;
+            }
+        }
+        if (kTfLiteOk != TfLiteInterpreterAllocateTensors(srv->interpreter[i])) {
+            return -1;
+        }
+
+        srv->inDetails[i][0]  = TfLiteInterpreterGetInputTensor(srv->interpreter[i], 0);
+        srv->inDetails[i][1]  = TfLiteInterpreterGetInputTensor(srv->interpreter[i], 1);
+        srv->outDetails[i][0] = TfLiteInterpreterGetOutputTensor(srv->interpreter[i], 0);
+        srv->outDetails[i][1] = TfLiteInterpreterGetOutputTensor(srv->interpreter[i], 1);
+
+        if (0 != dtln_check_tensor(srv->inDetails[i][0], in_len[i], batch) ||
+                0 != dtln_check_tensor(srv->outDetails[i][0], in_len[i], batch) ||
+                0 != dtln_check_tensor(srv->inDetails[i][1], DTLN_FRAME_SIZE, batch) ||
+                0 != dtln_check_tensor(srv->outDetails[i][1], DTLN_FRAME_SIZE, batch)) {
+            printf("dtln batch: tensors of model %d are not float32 of the dtln shapes at batch %d, "
+                   "int8 and float16 models cannot be batched\n", i, batch);
+            return -1;
+        }
+
+        // idle rows are invoked too, keep them finite
+        memset(TfLiteTensorData(srv->inDetails[i][0]), 0, (size_t)in_len[i] * batch * sizeof(float));
+        memset(TfLiteTensorData(srv->inDetails[i][1]), 0, (size_t)DTLN_FRAME_SIZE * batch * sizeof(float));
+    }
+    srv->m_batch = batch;
+
+    return 0;
+}
+
+// make room for hop_num rows, the batch is doubled so that it is
+// reallocated a few times while the number of streams ramps up, not in
+// every round whose number of hops differs from the previous one
+int dtln_batch_reserve(objDTLNBatch *srv, int hop_num)
+{
+    int batch = srv->m_batch > 0 ? srv->m_batch : 1;
+
+    if (hop_num <= srv->m_batch) {
+        return 0;
+    }
+    while (batch < hop_num) {
+        batch *= 2;
+    }
+    if (batch > srv->max_streams) {
+        batch = srv->max_streams;
+    }
+
+    return dtln_batch_resize(srv, batch);
+}
+
+void* dios_ssp_dtln_batch_init_api(const char *modelpath[], int frame_len, int max_streams)
+{
+    int i, j, k;
+
+    if (NULL == modelpath ||
+            NULL == modelpath[0] || NULL == modelpath[1] ||
+            strlen(modelpath[0]) <= 0 || strlen(modelpath[1]) <= 0 ||
+            max_streams <= 0) {
+        return NULL;
+    }
+
+    objDTLNBatch *srv = (objDTLNBatch *)calloc(1, sizeof(objDTLNBatch));
+    if (NULL == srv) {
+        return NULL;
+    }
+
+    srv->frame_len = frame_len;
+    srv->max_streams = max_streams;
+    srv->m_fft_size = DTLN_FRAME_SIZE;
+    srv->m_sp_size = DTLN_FFTOUT_SIZE;
+
+    srv->stream = (objDTLN **)calloc(max_streams, sizeof(objDTLN *));
+    srv->m_sta = (int *)calloc(max_streams, sizeof(int));
+    srv->m_hop_stream = (int *)calloc(max_streams, sizeof(int));
+    if (NULL == srv->stream || NULL == srv->m_sta || NULL == srv->m_hop_stream) {
+        dios_ssp_dtln_batch_uninit_api(srv);
+        return NULL;
+    }
+
+    for (i = 0; i < max_streams; i++) {
+        srv->stream[i] = dtln_create(frame_len);
+        if (NULL == srv->stream[i]) {
+            dios_ssp_dtln_batch_uninit_api(srv);
+            return NULL;
+        }
+        dios_ssp_dtln_reset_api(srv->stream[i]);
+    }
+
+    srv->options = TfLiteInterpreterOptionsCreate();
+    if (NULL == srv->options) {
+        dios_ssp_dtln_batch_uninit_api(srv);
+        return NULL;
+    }
+    TfLiteInterpreterOptionsSetNumThreads(srv->options, 1);
+
+    for (i = 0; i < DTLN_MODEL_NUM; i++) {
+        srv->model[i] = dios_ssp_dtln_model_acquire(modelpath[i]);
+        if (NULL == srv->model[i]) {
+            dios_ssp_dtln_batch_uninit_api(srv);
+            return NULL;
+        }
+
+        srv->interpreter[i] = TfLiteInterpreterCreate(srv->model[i], srv->options);
+        if (NULL == srv->interpreter[i]) {
+            dios_ssp_dtln_batch_uninit_api(srv);
+            return NULL;
+        }
+
+        if (kTfLiteOk != TfLiteInterpreterAllocateTensors(srv->interpreter[i])) {
+            dios_ssp_dtln_batch_uninit_api(srv);
+            return NULL;
+        }
+
+        // remember the batch-1 shapes, dim 0 is replaced by the batch size
+        for (j = 0; j < 2; j++) {
+            const TfLiteTensor *tensor = TfLiteInterpreterGetInputTensor(srv->interpreter[i], j);
+            srv->in_dims_size[i][j] = TfLiteTensorNumDims(tensor);
+            if (srv->in_dims_size[i][j] < 1 || srv->in_dims_size[i][j] > 4 ||
+                    1 != TfLiteTensorDim(tensor, 0)) {
+                dios_ssp_dtln_batch_uninit_api(srv);
+                return NULL;
+            }
+            for (k = 0; k < srv->in_dims_size[i][j]; k++) {
+                srv->in_dims[i][j][k] = TfLiteTensorDim(tensor, k);
+            }
+        }
+    }
+
+    // fail early if the models cannot be batched at all, then start from one
+    // row and let dios_ssp_dtln_batch_process grow the batch
+    if (0 != dtln_batch_resize(srv, max_streams) || 0 != dtln_batch_resize(srv, 1)) {
+        dios_ssp_dtln_batch_uninit_api(srv);
+        return NULL;
+    }
+
+    return srv;
+}
+
+int dios_ssp_dtln_batch_reset_api(void *ptr, int stream)
+{
+    if (NULL == ptr) {
+        return -1;
+    }
+
+    objDTLNBatch *srv = (objDTLNBatch *)ptr;
+    if (stream < 0 || stream >= srv->max_streams) {
+        return -1;
+    }
+
+    return dios_ssp_dtln_reset_api(srv->stream[stream]);
+}
+
+int dios_ssp_dtln_batch_process(void *ptr, float *in_data[], int stream_num)
+{
+    if (NULL == ptr || NULL == in_data) {
+        return -1;
+    }
+
+    objDTLNBatch *srv = (objDTLNBatch *)ptr;
+    int i, k;
+    int hop_num;
+    int ret = 0;
+    objDTLN *st;
+
+    if (stream_num > srv->max_streams) {
+        return -1;
+    }
+
+    for (i = 0; i < stream_num; i++) {
+        srv->m_sta[i] = 0;
+        if (NULL != in_data[i] && 0 != dtln_push_input(srv->stream[i], in_data[i])) {
+            ret = -1;
+        }
+    }
+
+    // one round per hop, a round batches every stream that still has a hop.
+    // the lstm states of both models are only scattered back once both invokes
+    // of the round succeeded, so a failed invoke leaves every state untouched
+    // and adds nothing to the output. Its hops, like those of a round whose
+    // batch could not be grown, are still consumed to keep the streams aligned
+    while (1) {
+        hop_num = 0;
+        for (i = 0; i < stream_num; i++) {
+            st = srv->stream[i];
+            if (NULL != in_data[i] && srv->m_sta[i] + st->m_fft_size <= st->m_wav_ring->count) {
+                srv->m_hop_stream[hop_num++] = i;
+            }
+        }
+        if (0 == hop_num) {
+            break;
+        }
+
+        if (0 != dtln_batch_reserve(srv, hop_num)) {
+            printf("Error growing dtln batch to %d\n", hop_num);
+            ret = -1;
+            for (k = 0; k < hop_num; k++) {
+                i = srv->m_hop_stream[k];
+                srv->m_sta[i] += srv->stream[i]->m_shift_size;
+            }
+            continue;
+        }
+
+        // dtln in freq domain
+        objDTLNTensor row;
+        float *mag = (float *)TfLiteTensorData(srv->inDetails[0][0]);
+        float *state_in = (float *)TfLiteTensorData(srv->inDetails[0][1]);
+        for (k = 0; k < hop_num; k++) {
+            i = srv->m_hop_stream[k];
+            dtln_bind_float(&row, mag + k * srv->m_sp_size);
+            dtln_analysis(srv->stream[i], srv->m_sta[i], &row);
+            memcpy(state_in + k * DTLN_FRAME_SIZE, srv->stream[i]->states[0], DTLN_FRAME_SIZE * sizeof(float));
+        }
+
+        if (TfLiteInterpreterInvoke(srv->interpreter[0]) != kTfLiteOk) {
+            printf("Error invoking detection model in freq domain\n");
+            ret = -1;
+            for (k = 0; k < hop_num; k++) {
+                i = srv->m_hop_stream[k];
+                srv->m_sta[i] += srv->stream[i]->m_shift_size;
+            }
+            continue;
+        }
+
+        objDTLNTensor time_row;
+        float *mask = (float *)TfLiteTensorData(srv->outDetails[0][0]);
+        float *time_in = (float *)TfLiteTensorData(srv->inDetails[1][0]);
+        for (k = 0; k < hop_num; k++) {
+            i = srv->m_hop_stream[k];
+            dtln_bind_float(&row, mask + k * srv->m_sp_size);
+            dtln_bind_float(&time_row, time_in + k * srv->m_fft_size);
+            dtln_synthesis(srv->stream[i], &row, &time_row);
+        }
+
+        // dtln in time domain
+        state_in = (float *)TfLiteTensorData(srv->inDetails[1][1]);
+        for (k = 0; k < hop_num; k++) {
+            i = srv->m_hop_stream[k];
+            memcpy(state_in + k * DTLN_FRAME_SIZE, srv->stream[i]->states[1], DTLN_FRAME_SIZE * sizeof(float));
+        }
+
+        if (TfLiteInterpreterInvoke(srv->interpreter[1]) != kTfLiteOk) {
+            printf("Error invoking detection model in time domain\n");
+            ret = -1;
+            for (k = 0; k < hop_num; k++) {
+                i = srv->m_hop_stream[k];
+                srv->m_sta[i] += srv->stream[i]->m_shift_size;
+            }
+            continue;
+        }
+
+        // both invokes succeeded, the model_1 outputs are still valid
+        float *time_out = (float *)TfLiteTensorData(srv->outDetails[1][0]);
+        const float *state_out[DTLN_MODEL_NUM] = {
+            (const float *)TfLiteTensorData(srv->outDetails[0][1]),
+            (const float *)TfLiteTensorData(srv->outDetails[1][1])
+        };
+        for (k = 0; k < hop_num; k++) {
+            i = srv->m_hop_stream[k];
+            memcpy(srv->stream[i]->states[0], state_out[0] + k * DTLN_FRAME_SIZE, DTLN_FRAME_SIZE * sizeof(float));
+            memcpy(srv->stream[i]->states[1], state_out[1] + k * DTLN_FRAME_SIZE, DTLN_FRAME_SIZE * sizeof(float));
+            dtln_bind_float(&time_row, time_out + k * srv->m_fft_size);
+            dtln_overlap_add(srv->stream[i], srv->m_sta[i], &time_row);
+            srv->m_sta[i] += srv->stream[i]->m_shift_size;
+        }
+    }
+
+    for (i = 0; i < stream_num; i++) {
+        if (NULL == in_data[i]) {
+            continue;
+        }
+        st = srv->stream[i];
+        dtln_pop_output(st, srv->m_sta[i], st->m_dtln_out_data);
+        memcpy(in_data[i], st->m_dtln_out_data, srv->frame_len * sizeof(float));
+    }
+
+    return ret;
+}
+
+int dios_ssp_dtln_batch_uninit_api(void *ptr)
+{
+    int i;
+    if (NULL == ptr) {
+        return -1;
+    }
+
+    objDTLNBatch *srv = (objDTLNBatch *)ptr;
+
+    if (NULL != srv->stream) {
+        for (i = 0; i < srv->max_streams; i++) {
+            if (NULL != srv->stream[i]) {
+                dtln_delete(srv->stream[i]);
+            }
+        }
+        free(srv->stream);
+    }
+    if (NULL != srv->m_sta) {
+        free(srv->m_sta);
+    }
+    if (NULL != srv->m_hop_stream) {
+        free(srv->m_hop_stream);
+    }
+
+    for (i = 0; i < DTLN_MODEL_NUM; i++) {
+        if (NULL != srv->interpreter[i]) {
+            TfLiteInterpreterDelete(srv->interpreter[i]);
+        }
+        if (NULL != srv->model[i]) {
+            dios_ssp_dtln_model_release(srv->model[i]);
+        }
+    }
+    if (NULL != srv->options) {
+        TfLiteInterpreterOptionsDelete(srv->options);
+    }
+
+    free(srv);
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Description: Process-wide registry of DTLN tflite models. Every stream
+instance owns its own interpreter, but the parsed flatbuffer is immutable
+and shared by all instances that load the same file. Entries are keyed by
+path and the stat fingerprint of the file (device, inode, size, mtime), so
+a cache hit does not touch the file and a replaced model file is loaded
+again. Entries are reference counted and protected by a mutex; the first
+acquire of a file reads and parses it outside the mutex while later
+acquires of the same file wait for it, so instances may be created and
+freed from different threads.
+==============================================================================*/
+
+#include <pthread.h>
+#include <sys/stat.h>
+#include "dios_ssp_dtln_model.h"
+
+typedef struct objDTLNModelEntry {
+    char *path;
+    dev_t dev;         // stat fingerprint of the file the model was read from
+    ino_t ino;
+    off_t size;
+    time_t mtime;
+    void *data;        // flatbuffer, must outlive the model
+    TfLiteModel *model;
+    int loading;       // 1 while the first acquire reads and parses the file
+    int ref_count;
+    struct objDTLNModelEntry *next;
+} objDTLNModelEntry;
+
+static objDTLNModelEntry *g_dtln_models = NULL;
+static pthread_mutex_t g_dtln_models_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_dtln_models_cond = PTHREAD_COND_INITIALIZER;
+
+static void* dtln_model_read_file(const char *modelpath, size_t *size)
+{
+    FILE *fp = fopen(modelpath, "rb");
+    if (NULL == fp) {
+        return NULL;
+    }
+
+    void *data = NULL;
+    long len = 0;
+    if (0 == fseek(fp, 0, SEEK_END) && (len = ftell(fp)) > 0 && 0 == fseek(fp, 0, SEEK_SET)) {
+        data = malloc(len);
+        if (NULL != data && fread(data, 1, len, fp) != (size_t)len) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(fp);
+
+    *size = (size_t)len;
+    return data;
+}
+
+static void dtln_model_free_entry(objDTLNModelEntry *entry)
+{
+    if (entry->model) {
+        TfLiteModelDelete(entry->model);
+    }
+    free(entry->data);
+    free(entry->path);
+    free(entry);
+}
+
+// called with the lock held
+static void dtln_model_unlink(objDTLNModelEntry *entry)
+{
+    objDTLNModelEntry **link = &g_dtln_models;
+    while (NULL != *link && *link != entry) {
+        link = &(*link)->next;
+    }
+    if (NULL != *link) {
+        *link = entry->next;
+    }
+}
+
+const TfLiteModel* dios_ssp_dtln_model_acquire(const char *modelpath)
+{
+    if (NULL == modelpath) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (0 != stat(modelpath, &st)) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_dtln_models_lock);
+    objDTLNModelEntry *entry = g_dtln_models;
+    while (NULL != entry) {
+        if (entry->dev == st.st_dev && entry->ino == st.st_ino &&
+                entry->size == st.st_size && entry->mtime == st.st_mtime &&
+                0 == strcmp(entry->path, modelpath)) {
+            break;
+        }
+        entry = entry->next;
+    }
+
+    TfLiteModel *model = NULL;
+    if (NULL != entry) {
+        entry->ref_count++;
+        while (entry->loading) {
+            pthread_cond_wait(&g_dtln_models_cond, &g_dtln_models_lock);
+        }
+        model = entry->model;
+        // the load failed and the entry is already unlinked
+        if (NULL == model && 0 == --entry->ref_count) {
+            dtln_model_free_entry(entry);
+        }
+        pthread_mutex_unlock(&g_dtln_models_lock);
+        return model;
+    }
+
+    entry = (objDTLNModelEntry *)calloc(1, sizeof(objDTLNModelEntry));
+    if (NULL != entry) {
+        entry->path = (char *)malloc(strlen(modelpath) + 1);
+    }
+    if (NULL == entry || NULL == entry->path) {
+        pthread_mutex_unlock(&g_dtln_models_lock);
+        free(entry);
+        return NULL;
+    }
+    strcpy(entry->path, modelpath);
+    entry->dev = st.st_dev;
+    entry->ino = st.st_ino;
+    entry->size = st.st_size;
+    entry->mtime = st.st_mtime;
+    entry->loading = 1;
+    entry->ref_count = 1;
+    entry->next = g_dtln_models;
+    g_dtln_models = entry;
+    pthread_mutex_unlock(&g_dtln_models_lock);
+
+    // read and parse without the lock, acquires of other models go on meanwhile
+    size_t size = 0;
+    void *data = dtln_model_read_file(modelpath, &size);
+    if (NULL != data) {
+        model = TfLiteModelCreate(data, size);
+    }
+
+    pthread_mutex_lock(&g_dtln_models_lock);
+    entry->loading = 0;
+    if (NULL == model) {
+        free(data);
+        dtln_model_unlink(entry);
+        if (0 == --entry->ref_count) {
+            dtln_model_free_entry(entry);
+        }
+    } else {
+        entry->data = data;
+        entry->model = model;
+    }
+    pthread_cond_broadcast(&g_dtln_models_cond);
+    pthread_mutex_unlock(&g_dtln_models_lock);
+
+    return model;
+}
+
+int dios_ssp_dtln_model_release(const TfLiteModel *model)
+{
+    if (NULL == model) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_dtln_models_lock);
+    objDTLNModelEntry **link = &g_dtln_models;
+    while (NULL != *link && (*link)->model != model) {
+        link = &(*link)->next;
+    }
+    if (NULL == *link) {
+        pthread_mutex_unlock(&g_dtln_models_lock);
+        return -1;
+    }
+
+    objDTLNModelEntry *entry = *link;
+    if (--entry->ref_count > 0) {
+        pthread_mutex_unlock(&g_dtln_models_lock);
+        return 0;
+    }
+    *link = entry->next;
+    pthread_mutex_unlock(&g_dtln_models_lock);
+
+    dtln_model_free_entry(entry);
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Description: Two-stage DTLN pipeline. The calling thread runs the analysis,
+model_1 and the masked ifft of hop t+1 while a worker thread runs model_2 on
+hop t. Every hop therefore leaves the pipeline one hop later than in the
+sequential mode: the overlap-add position is moved one hop further and the
+output buffer keeps one more hop, which adds DTLN_FRAME_SHIFT samples of
+latency (see dios_ssp_dtln_latency_get). The worker only touches the
+model_2 interpreter, the model_2 states and its own frame buffers, so no
+other state needs locking.
+==============================================================================*/
+
+#include "dios_ssp_dtln_api.h"
+#include "dios_ssp_dtln_header.h"
+
+int dtln_pipeline_invoke(objDTLN* srv, const float *in, float *out)
+{
+    dtln_store_tensor(&srv->m_in[1][0], in, srv->m_fft_size);
+
+    if (TfLiteInterpreterInvoke(srv->interpreter[1]) != kTfLiteOk) {
+        printf("Error invoking detection model in time domain\n");
+        return -1;
+    }
+
+    dtln_copy_tensor(&srv->m_in[1][1], &srv->m_out[1][1], DTLN_FRAME_SIZE, srv->states[1]);
+    dtln_load_tensor(&srv->m_out[1][0], out, srv->m_fft_size);
+
+    return 0;
+}
+
+void* dtln_pipeline_worker(void *arg)
+{
+    objDTLN *srv = (objDTLN *)arg;
+    int slot;
+    int ret;
+
+    pthread_mutex_lock(&srv->m_pipe_lock);
+    while (1) {
+        while (!srv->m_pipe_busy && !srv->m_pipe_quit) {
+            pthread_cond_wait(&srv->m_pipe_cond, &srv->m_pipe_lock);
+        }
+        if (srv->m_pipe_quit) {
+            break;
+        }
+        slot = srv->m_pipe_slot;
+        pthread_mutex_unlock(&srv->m_pipe_lock);
+
+        ret = dtln_pipeline_invoke(srv, srv->m_pipe_in[slot], srv->m_pipe_out[slot]);
+
+        pthread_mutex_lock(&srv->m_pipe_lock);
+        if (0 != ret) {
+            srv->m_pipe_error = 1;
+        }
+        srv->m_pipe_busy = 0;
+        pthread_cond_broadcast(&srv->m_pipe_cond);
+    }
+    pthread_mutex_unlock(&srv->m_pipe_lock);
+
+    return NULL;
+}
+
+void dtln_pipeline_wait(objDTLN* srv)
+{
+    pthread_mutex_lock(&srv->m_pipe_lock);
+    while (srv->m_pipe_busy) {
+        pthread_cond_wait(&srv->m_pipe_cond, &srv->m_pipe_lock);
+    }
+    pthread_mutex_unlock(&srv->m_pipe_lock);
+}
+
+// overlap-add the hop that finished on the worker
+void dtln_pipeline_collect(objDTLN* srv)
+{
+    objDTLNTensor frame;
+
+    dtln_pipeline_wait(srv);
+    if (srv->m_pipe_pending) {
+        dtln_bind_float(&frame, srv->m_pipe_out[srv->m_pipe_slot]);
+        dtln_overlap_add(srv, srv->m_pipe_pos, &frame);
+        srv->m_pipe_pending = 0;
+    }
+}
+
+int dtln_pipeline_start(objDTLN* srv)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        srv->m_pipe_in[i] = (float *)calloc(srv->m_fft_size, sizeof(float));
+        srv->m_pipe_out[i] = (float *)calloc(srv->m_fft_size, sizeof(float));
+        if (NULL == srv->m_pipe_in[i] || NULL == srv->m_pipe_out[i]) {
+            dtln_pipeline_stop(srv);
+            return -1;
+        }
+    }
+
+    srv->m_pipe_busy = 0;
+    srv->m_pipe_quit = 0;
+    srv->m_pipe_pending = 0;
+    srv->m_pipe_error = 0;
+    srv->m_pipe_slot = 0;
+    pthread_mutex_init(&srv->m_pipe_lock, NULL);
+    pthread_cond_init(&srv->m_pipe_cond, NULL);
+    if (0 != pthread_create(&srv->m_pipe_thread, NULL, dtln_pipeline_worker, srv)) {
+        pthread_cond_destroy(&srv->m_pipe_cond);
+        pthread_mutex_destroy(&srv->m_pipe_lock);
+        dtln_pipeline_stop(srv);
+        return -1;
+    }
+
+    srv->m_pipeline = 1;
+    srv->m_ola_delay = srv->m_shift_size;
+    // the output buffer layout changes with the delay, start from scratch
+    dios_ssp_dtln_reset_api(srv);
+
+    return 0;
+}
+
+int dtln_pipeline_process(objDTLN* srv, float *in_data, float *out_data)
+{
+    objDTLNTensor frame;
+    int slot = srv->m_pipe_slot;
+    int ret = dtln_push_input(srv, in_data);
+
+    int sta;
+    for ( sta = 0; sta + srv->m_fft_size <= srv->m_wav_ring->count; sta += srv->m_shift_size ) {
+        // stage 1 of hop t+1, overlaps model_2 of hop t on the worker
+        slot ^= 1;
+        dtln_analysis(srv, sta, &srv->m_in[0][0]);
+        if (0 != dtln_invoke(srv, 0)) {
+            ret = -1;
+        }
+        dtln_bind_float(&frame, srv->m_pipe_in[slot]);
+        dtln_synthesis(srv, &srv->m_out[0][0], &frame);
+
+        dtln_pipeline_collect(srv);
+
+        // stage 2 of hop t+1
+        pthread_mutex_lock(&srv->m_pipe_lock);
+        srv->m_pipe_slot = slot;
+        srv->m_pipe_pos = sta + srv->m_ola_delay;
+        srv->m_pipe_pending = 1;
+        srv->m_pipe_busy = 1;
+        pthread_cond_broadcast(&srv->m_pipe_cond);
+        pthread_mutex_unlock(&srv->m_pipe_lock);
+    }
+
+    dtln_pop_output(srv, sta, out_data);
+    srv->m_pipe_pos -= sta;
+
+    // a model_2 failure surfaces with the frame that collected its hop
+    pthread_mutex_lock(&srv->m_pipe_lock);
+    if (srv->m_pipe_error) {
+        srv->m_pipe_error = 0;
+        ret = -1;
+    }
+    pthread_mutex_unlock(&srv->m_pipe_lock);
+
+    return ret;
+}
+
+void dtln_pipeline_reset(objDTLN* srv)
+{
+    dtln_pipeline_wait(srv);
+    srv->m_pipe_pending = 0;
+    srv->m_pipe_error = 0;
+}
+
+void dtln_pipeline_stop(objDTLN* srv)
+{
+    int i;
+
+    if (srv->m_pipeline) {
+        pthread_mutex_lock(&srv->m_pipe_lock);
+        srv->m_pipe_quit = 1;
+        pthread_cond_broadcast(&srv->m_pipe_cond);
+        pthread_mutex_unlock(&srv->m_pipe_lock);
+        pthread_join(srv->m_pipe_thread, NULL);
+        pthread_cond_destroy(&srv->m_pipe_cond);
+        pthread_mutex_destroy(&srv->m_pipe_lock);
+        srv->m_pipeline = 0;
+        srv->m_ola_delay = 0;
+        srv->m_pipe_pending = 0;
+    }
+
+    for (i = 0; i < 2; i++) {
+        if (srv->m_pipe_in[i]) {
+            free(srv->m_pipe_in[i]);
+            srv->m_pipe_in[i] = NULL;
+        }
+        if (srv->m_pipe_out[i]) {
+            free(srv->m_pipe_out[i]);
+            srv->m_pipe_out[i] = NULL;
+        }
+    }
+}
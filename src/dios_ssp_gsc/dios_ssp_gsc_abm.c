@@ -27,6 +27,8 @@ void dios_ssp_gsc_gscabm_init(objFGSCabm *gscabm, int num_mic, int fft_size, int
     gscabm->Xdline = NULL;
     gscabm->xrefdline = NULL;
     gscabm->xfref = NULL;
+    gscabm->xfref_re = NULL;
+    gscabm->xfref_im = NULL;
     gscabm->ytmp = NULL;
     gscabm->yf = NULL;
     gscabm->e = NULL;
@@ -58,7 +60,14 @@ void dios_ssp_gsc_gscabm_init(objFGSCabm *gscabm, int num_mic, int fft_size, int
         gscabm->Xdline[i_mic] = (float*)calloc(gscabm->fftsize, sizeof(float));
     }
     gscabm->xrefdline = (float*)calloc(gscabm->fftsize / 2 + gscabm->syncdly, sizeof(float));
-    gscabm->xfref = (xcomplex*)calloc(gscabm->fftsize / 2 + 1, sizeof(xcomplex));
+    gscabm->xfref = (xcomplex**)calloc(gscabm->nmic, sizeof(xcomplex*));
+    gscabm->xfref_re = (float**)calloc(gscabm->nmic, sizeof(float*));
+    gscabm->xfref_im = (float**)calloc(gscabm->nmic, sizeof(float*));
+    for (int i_mic = 0; i_mic < gscabm->nmic; i_mic++) {
+        gscabm->xfref[i_mic] = (xcomplex*)calloc(gscabm->fftsize / 2 + 1, sizeof(xcomplex));
+        gscabm->xfref_re[i_mic] = &gscabm->xfref[i_mic][0].r;
+        gscabm->xfref_im[i_mic] = &gscabm->xfref[i_mic][0].i;
+    }
     gscabm->ytmp = (float*)calloc(gscabm->fftsize, sizeof(float));
     gscabm->yf = (xcomplex*)calloc(gscabm->fftsize / 2 + 1, sizeof(xcomplex));
     gscabm->e = (float*)calloc(gscabm->fftsize, sizeof(float));
@@ -104,7 +113,7 @@ void dios_ssp_gsc_gscabm_init(objFGSCabm *gscabm, int num_mic, int fft_size, int
         gscabm->m_upper_bound[gscabm->fftsize / 4 + 3] = 0.1f;
         gscabm->m_upper_bound[gscabm->fftsize / 4 - 3] = 0.1f;
     }
-    gscabm->abm_FFT =dios_ssp_share_rfft_init(gscabm->fftsize);
+    gscabm->abm_FFT = dios_ssp_share_rfft_batch_init(gscabm->fftsize);
     gscabm->fft_out = (float*)calloc(gscabm->fftsize, sizeof(float));
     gscabm->fft_in = (float*)calloc(gscabm->fftsize, sizeof(float));
 
@@ -124,10 +133,11 @@ int dios_ssp_gsc_gscabm_reset(objFGSCabm *gscabm)
     }
     memset(gscabm->xrefdline, 0, sizeof(float) * (gscabm->fftsize / 2 + gscabm->syncdly));
 
+    /* init adaptive filter inputs in the frequency domain */
+    for (int m = 0; m < gscabm->nmic; m++) {
+        memset(gscabm->xfref[m], 0, sizeof(xcomplex) * (gscabm->fftsize / 2 + 1));
+    }
     for (int n = 0; n < gscabm->fftsize / 2 + 1; n++) {
-        /* init adaptive filter input in the frequency domain */
-        gscabm->xfref[n].i = 0.0f;
-        gscabm->xfref[n].r = 0.0f;
         /* adaptive filter output in frequency domain */
         gscabm->yf[n].i = 0.0f;
         gscabm->yf[n].r = 0.0f;
@@ -248,18 +258,14 @@ int dios_ssp_gsc_gscabm_process(objFGSCabm *gscabm, float **X, float *xref, floa
 int dios_ssp_gsc_gscabm_processonedatablock(objFGSCabm *gscabm, float *ctrl_abm, float *ctrl_aic)
 {
     int i;
+    /* adaptive filter inputs in the frequency domain, all channels at once */
+    dios_ssp_share_rfft_batch_process(gscabm->abm_FFT, gscabm->Xdline, gscabm->nmic,
+                                      gscabm->xfref_re, gscabm->xfref_im, 2);
     for (int ch = 0; ch < gscabm->nmic; ch++) {
-        dios_ssp_share_rfft_process(gscabm->abm_FFT, gscabm->Xdline[ch], gscabm->fft_out);
-        for (i = 0; i < gscabm->fftsize / 2 + 1; i++) {
-            gscabm->xfref[i].r = gscabm->fft_out[i];
-        }
-        gscabm->xfref[0].i = gscabm->xfref[gscabm->fftsize / 2].i = 0.0;
-        for (i = 1; i < gscabm->fftsize / 2; i++) {
-            gscabm->xfref[i].i = -gscabm->fft_out[gscabm->fftsize - i];
-        }
+        xcomplex *xfref = gscabm->xfref[ch];
 
+        dios_ssp_share_xcvec_abs2(xfref, 0, gscabm->pxfref, gscabm->fftsize / 2 + 1);
         for (i = 0; i < gscabm->fftsize / 2 + 1; i++) {
-            gscabm->pxfref[i] = gscabm->xfref[i].r * gscabm->xfref[i].r + gscabm->xfref[i].i * gscabm->xfref[i].i;
             gscabm->sf[ch][i] = gscabm->lambda * gscabm->sf[ch][i] + (1.f - gscabm->lambda) * gscabm->pxfref[i];
 
             /* 1.normalization term of FLMS -> muf */
@@ -281,9 +287,9 @@ int dios_ssp_gsc_gscabm_processonedatablock(objFGSCabm *gscabm, float *ctrl_abm,
             gscabm->nuf[i].r = ctrl_aic[i];
             gscabm->nuf[i].i = 0.0;
             gscabm->nuf[i] = complex_mul(gscabm->nuf[i], gscabm->nu);
-            /* 5.compute adaptive filter output */
-            gscabm->yf[i] = complex_mul(gscabm->xfref[i], gscabm->hf[ch][i]);
         }
+        /* 5.compute adaptive filter output */
+        dios_ssp_share_xcvec_mul(xfref, gscabm->hf[ch], 0, gscabm->yf, gscabm->fftsize / 2 + 1);
 
         /* ifft of adaptive filter output: y is then constrained to be y = [0 | new] */
         // gscabm->m_pFFT->FFTInv_CToR(gscabm->yf, gscabm->ytmp);
@@ -314,24 +320,10 @@ int dios_ssp_gsc_gscabm_processonedatablock(objFGSCabm *gscabm, float *ctrl_abm,
         for (i = 1; i < gscabm->fftsize / 2; i++) {
             gscabm->ef[i].i = -gscabm->fft_out[gscabm->fftsize - i];
         }
-        /* update of adaptive filter */
-        for (i = 0; i < gscabm->fftsize / 2 + 1; i++) {
-            /* 1.conjugate of reference signal */
-            gscabm->yftmp[i] = complex_conjg(gscabm->xfref[i]);
-
-            /* 2.enovation term */
-            gscabm->yftmp[i] = complex_mul(gscabm->yftmp[i], gscabm->ef[i]);
-
-            /* 3.stepsize term */
-            gscabm->yftmp[i] = complex_mul(gscabm->yftmp[i], gscabm->muf[i]);
-
-            /* 4.update */
-            gscabm->hf[ch][i] = complex_add(gscabm->hf[ch][i], gscabm->yftmp[i]);
-        }
+        /* update of adaptive filter: conjugate of reference signal, enovation term, stepsize term */
+        dios_ssp_share_xcvec_flms_update(xfref, gscabm->ef, gscabm->muf, gscabm->hf[ch], gscabm->fftsize / 2 + 1);
         /* against freezing of the adaptive filter coefficients */
-        for (i = 0; i < gscabm->fftsize / 2 + 1; i++) {
-            gscabm->hf[ch][i] = complex_sub(gscabm->hf[ch][i], complex_mul(gscabm->hf[ch][i], gscabm->nuf[i]));
-        }
+        dios_ssp_share_xcvec_mul_sub(gscabm->nuf, gscabm->hf[ch], gscabm->fftsize / 2 + 1);
 
         /* circular correlation constraint (hf = [new | 0]) -> hf */
         // gscabm->m_pFFT->FFTInv_CToR(gscabm->hf[ch], gscabm->ytmp);
@@ -381,7 +373,12 @@ int dios_ssp_gsc_gscabm_delete(objFGSCabm *gscabm)
     }
     free(gscabm->Xdline);
     free(gscabm->xrefdline);
+    for (int i_mic = 0; i_mic < gscabm->nmic; i_mic++) {
+        free(gscabm->xfref[i_mic]);
+    }
     free(gscabm->xfref);
+    free(gscabm->xfref_re);
+    free(gscabm->xfref_im);
     free(gscabm->ytmp);
     free(gscabm->yf);
     free(gscabm->e);
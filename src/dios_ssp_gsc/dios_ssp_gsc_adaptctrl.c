@@ -39,6 +39,8 @@ void dios_ssp_gsc_gscadaptctrl_init(objFGSCadaptctrl *gscadaptctrl, const DWORD
     gscadaptctrl->m_ppXrefDline = NULL;
     gscadaptctrl->m_pXfbfDline = NULL;
     gscadaptctrl->m_ppcfXref = NULL;
+    gscadaptctrl->m_ppfXrefRe = NULL;
+    gscadaptctrl->m_ppfXrefIm = NULL;
     gscadaptctrl->m_pcfXfbf = NULL;
     gscadaptctrl->m_pcfXcfbf = NULL;
     gscadaptctrl->m_pfPref = NULL;
@@ -70,7 +72,7 @@ void dios_ssp_gsc_gscadaptctrl_init(objFGSCadaptctrl *gscadaptctrl, const DWORD
     gscadaptctrl->npsdosms2 =  (objCNPsdOsMs*)calloc(1, sizeof(objCNPsdOsMs));
     dios_ssp_gsc_rmnpsdosms_init(gscadaptctrl->npsdosms2, (float)(gscadaptctrl->m_dwSampRate), gscadaptctrl->m_nCCSSize, (int)(gscadaptctrl->m_dwFftSize / gscadaptctrl->m_wFftOverlap), dwNumSubWindowsMinStat, dwSizeSubWindowsMinStat);
 
-    gscadaptctrl->adapt_FFT = dios_ssp_share_rfft_init((int)gscadaptctrl->m_dwFftSize);
+    gscadaptctrl->adapt_FFT = dios_ssp_share_rfft_batch_init((int)gscadaptctrl->m_dwFftSize);
     gscadaptctrl->fft_out = (float*)calloc(gscadaptctrl->m_dwFftSize, sizeof(float));
     gscadaptctrl->m_ppXrefDline = (float**)calloc(gscadaptctrl->m_wNumMic, sizeof(float*));
     for (int i_mic = 0; i_mic < gscadaptctrl->m_wNumMic; i_mic++) {
@@ -78,8 +80,12 @@ void dios_ssp_gsc_gscadaptctrl_init(objFGSCadaptctrl *gscadaptctrl, const DWORD
     }
     gscadaptctrl->m_pXfbfDline = (float*)calloc(gscadaptctrl->m_dwFftSize + gscadaptctrl->m_wSyncDlyYfbf, sizeof(float));
     gscadaptctrl->m_ppcfXref = (xcomplex**)calloc(gscadaptctrl->m_wNumMic, sizeof(xcomplex*));
+    gscadaptctrl->m_ppfXrefRe = (float**)calloc(gscadaptctrl->m_wNumMic, sizeof(float*));
+    gscadaptctrl->m_ppfXrefIm = (float**)calloc(gscadaptctrl->m_wNumMic, sizeof(float*));
     for (int i_mic = 0; i_mic < gscadaptctrl->m_wNumMic; i_mic++) {
         gscadaptctrl->m_ppcfXref[i_mic] = (xcomplex*)calloc(gscadaptctrl->m_nCCSSize, sizeof(xcomplex));
+        gscadaptctrl->m_ppfXrefRe[i_mic] = &gscadaptctrl->m_ppcfXref[i_mic][0].r;
+        gscadaptctrl->m_ppfXrefIm[i_mic] = &gscadaptctrl->m_ppcfXref[i_mic][0].i;
     }
     gscadaptctrl->m_pcfXfbf = (xcomplex*)calloc(gscadaptctrl->m_nCCSSize, sizeof(xcomplex));
     gscadaptctrl->m_pcfXcfbf = (xcomplex*)calloc(gscadaptctrl->m_nCCSSize, sizeof(xcomplex));
@@ -158,9 +164,7 @@ int dios_ssp_gsc_gscadaptctrl_process(objFGSCadaptctrl *gscadaptctrl, float *pXf
     }
 
     /* instantaneous power spectrum estimation of output of fbf */
-    for (int k = 0; k < gscadaptctrl->m_nCCSSize; k++) {
-        gscadaptctrl->m_pfPfbf[k] = gscadaptctrl->m_pcfXfbf[k].r * gscadaptctrl->m_pcfXfbf[k].r + gscadaptctrl->m_pcfXfbf[k].i * gscadaptctrl->m_pcfXfbf[k].i;
-    }
+    dios_ssp_share_xcvec_abs2(gscadaptctrl->m_pcfXfbf, 0, gscadaptctrl->m_pfPfbf, gscadaptctrl->m_nCCSSize);
 
     memset(gscadaptctrl->m_pfPcfbf, 0, gscadaptctrl->m_nCCSSize * sizeof(float));
 
@@ -171,23 +175,15 @@ int dios_ssp_gsc_gscadaptctrl_process(objFGSCadaptctrl *gscadaptctrl, float *pXf
         delayline(&ppXref[i][dwIndXref], gscadaptctrl->m_ppXrefDline[i],
                   (int)(gscadaptctrl->m_dwFftSize + gscadaptctrl->m_wSyncDlyXref - gscadaptctrl->m_dwFftSize / (2 * gscadaptctrl->m_wFftOverlap)),
                   (int)(gscadaptctrl->m_dwFftSize + gscadaptctrl->m_wSyncDlyXref));
+    }
 
+    /* reference mic signals in the frequency domain, all channels at once */
+    dios_ssp_share_rfft_batch_process(gscadaptctrl->adapt_FFT, gscadaptctrl->m_ppXrefDline, gscadaptctrl->m_wNumMic,
+                                      gscadaptctrl->m_ppfXrefRe, gscadaptctrl->m_ppfXrefIm, 2);
 
-        dios_ssp_share_rfft_process(gscadaptctrl->adapt_FFT, gscadaptctrl->m_ppXrefDline[i], gscadaptctrl->fft_out);
-        for (DWORD j = 0; j < gscadaptctrl->m_dwFftSize / 2 + 1; j++) {
-            gscadaptctrl->m_ppcfXref[i][j].r = gscadaptctrl->fft_out[j];
-        }
-        gscadaptctrl->m_ppcfXref[i][0].i = gscadaptctrl->m_ppcfXref[i][gscadaptctrl->m_dwFftSize / 2].i = 0.0;
-        for (DWORD j = 1; j < gscadaptctrl->m_dwFftSize / 2; j++) {
-            gscadaptctrl->m_ppcfXref[i][j].i = -gscadaptctrl->fft_out[gscadaptctrl->m_dwFftSize - j];
-        }
-        for (int j = 0; j < gscadaptctrl->m_nCCSSize; j++) {
-            /* 1.power spectrum estimation of reference mic signals */
-            gscadaptctrl->m_pfBuffer[j] = gscadaptctrl->m_ppcfXref[i][j].r * gscadaptctrl->m_ppcfXref[i][j].r + gscadaptctrl->m_ppcfXref[i][j].i * gscadaptctrl->m_ppcfXref[i][j].i;
-
-            /* 2.summation over all channels */
-            gscadaptctrl->m_pfPref[j] += gscadaptctrl->m_pfBuffer[j];
-        }
+    for (int i = 0; i < gscadaptctrl->m_wNumMic; ++i) {
+        /* power spectrum estimation of reference mic signals, summed over all channels */
+        dios_ssp_share_xcvec_abs2(gscadaptctrl->m_ppcfXref[i], 1, gscadaptctrl->m_pfPref, gscadaptctrl->m_nCCSSize);
     }
 
     /* instantaneous power spectrum estimate of reference mic signals */
@@ -297,6 +293,8 @@ int dios_ssp_gsc_gscadaptctrl_delete(objFGSCadaptctrl *gscadaptctrl)
         free(gscadaptctrl->m_ppcfXref[i_mic]);
     }
     free(gscadaptctrl->m_ppcfXref);
+    free(gscadaptctrl->m_ppfXrefRe);
+    free(gscadaptctrl->m_ppfXrefIm);
     free(gscadaptctrl->m_pcfXfbf);
     free(gscadaptctrl->m_pcfXcfbf);
     free(gscadaptctrl->m_pfPref);
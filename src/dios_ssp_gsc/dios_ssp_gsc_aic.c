@@ -34,6 +34,8 @@ void dios_ssp_gsc_gscaic_init(objFGSCaic *gscaic, int dlysync, int num_mic, int
     gscaic->Xdline = NULL;
     gscaic->Xfbdline = NULL;
     gscaic->Xffilt = NULL;
+    gscaic->Xffilt_re = NULL;
+    gscaic->Xffilt_im = NULL;
     gscaic->yftmp = NULL;
     gscaic->ytmp = NULL;
     gscaic->yhf = NULL;
@@ -87,8 +89,12 @@ void dios_ssp_gsc_gscaic_init(objFGSCaic *gscaic, int dlysync, int num_mic, int
 
     }
     gscaic->Xffilt = (xcomplex**)calloc(gscaic->nmic, sizeof(xcomplex*));
+    gscaic->Xffilt_re = (float**)calloc(gscaic->nmic, sizeof(float*));
+    gscaic->Xffilt_im = (float**)calloc(gscaic->nmic, sizeof(float*));
     for (int i_mic = 0; i_mic < gscaic->nmic; i_mic++) {
         gscaic->Xffilt[i_mic] = (xcomplex*)calloc(gscaic->fftsize / 2 + 1, sizeof(xcomplex));
+        gscaic->Xffilt_re[i_mic] = &gscaic->Xffilt[i_mic][0].r;
+        gscaic->Xffilt_im[i_mic] = &gscaic->Xffilt[i_mic][0].i;
     }
     gscaic->yftmp = (xcomplex*)calloc(gscaic->fftsize / 2 + 1, sizeof(xcomplex));
     gscaic->ytmp = (float*)calloc(gscaic->fftsize, sizeof(float));
@@ -110,7 +116,7 @@ void dios_ssp_gsc_gscaic_init(objFGSCaic *gscaic, int dlysync, int num_mic, int
     gscaic->muf = (xcomplex*)calloc(gscaic->fftsize / 2 + 1, sizeof(xcomplex));
     gscaic->nuf = (xcomplex*)calloc(gscaic->fftsize / 2 + 1, sizeof(xcomplex));
 
-    gscaic->aic_FFT = dios_ssp_share_rfft_init(gscaic->fftsize);
+    gscaic->aic_FFT = dios_ssp_share_rfft_batch_init(gscaic->fftsize);
     gscaic->fft_out = (float*)calloc(gscaic->fftsize, sizeof(float));
     gscaic->fft_in = (float*)calloc(gscaic->fftsize, sizeof(float));
 }
@@ -218,17 +224,11 @@ int dios_ssp_gsc_gscaic_processonedatablock(objFGSCaic *gscaic, float *ctrl_abm,
     memset(gscaic->yhf, 0, (gscaic->fftsize / 2 + 1) * sizeof(xcomplex));
     memset(gscaic->pXf, 0, (gscaic->fftsize / 2 + 1) * sizeof(float));
 
-    for (int k = 0; k < gscaic->nmic; k++) {
-        /* fft of filter inputs */
-        dios_ssp_share_rfft_process(gscaic->aic_FFT, gscaic->Xdline[k], gscaic->fft_out);
-        for (int i = 0; i < gscaic->fftsize / 2 + 1; i++) {
-            gscaic->Xffilt[k][i].r = gscaic->fft_out[i];
-        }
-        gscaic->Xffilt[k][0].i = gscaic->Xffilt[k][gscaic->fftsize / 2].i = 0.0;
-        for (int i = 1; i < gscaic->fftsize / 2; i++) {
-            gscaic->Xffilt[k][i].i = -gscaic->fft_out[gscaic->fftsize - i];
-        }
+    /* fft of filter inputs, all channels at once */
+    dios_ssp_share_rfft_batch_process(gscaic->aic_FFT, gscaic->Xdline, gscaic->nmic,
+                                      gscaic->Xffilt_re, gscaic->Xffilt_im, 2);
 
+    for (int k = 0; k < gscaic->nmic; k++) {
         /* block delay line for partitioned block adaptive filters
          * pbdlinesize = 1, no delay */
         for(i = 0; i < gscaic->pbdlinesize-1; i++) {
@@ -237,16 +237,10 @@ int dios_ssp_gsc_gscaic_processonedatablock(objFGSCaic *gscaic, float *ctrl_abm,
         memcpy(gscaic->Xfbdline[k][0], gscaic->Xffilt[k], (gscaic->fftsize / 2 + 1) * sizeof(xcomplex));
 
         for (i = 0; i < 1; i++) {
-            for (j = 0; j < gscaic->fftsize / 2 + 1; j++) {
-                /* 1.power estimate of adaptive filter inputs	for later recursion */
-                gscaic->sftmp[j] = gscaic->Xfbdline[k][i][j].r * gscaic->Xfbdline[k][i][j].r + gscaic->Xfbdline[k][i][j].i * gscaic->Xfbdline[k][i][j].i;
-                /* 2.summing up power estimate */
-                gscaic->pXf[j] += gscaic->sftmp[j];
-                /* 3.filter with adaptive filters */
-                gscaic->yftmp[j] = complex_mul(gscaic->Hf[k][i][j], gscaic->Xfbdline[k][i][j]);
-                /* 4.summing up filter outputs */
-                gscaic->yhf[j] = complex_add(gscaic->yhf[j], gscaic->yftmp[j]);
-            }
+            /* 1.summing up power estimate of adaptive filter inputs for later recursion */
+            dios_ssp_share_xcvec_abs2(gscaic->Xfbdline[k][i], 1, gscaic->pXf, gscaic->fftsize / 2 + 1);
+            /* 2.filter with adaptive filters and sum up filter outputs */
+            dios_ssp_share_xcvec_mul(gscaic->Hf[k][i], gscaic->Xfbdline[k][i], 1, gscaic->yhf, gscaic->fftsize / 2 + 1);
         }
     }
 
@@ -334,21 +328,12 @@ int dios_ssp_gsc_gscaic_processonedatablock(objFGSCaic *gscaic, float *ctrl_abm,
 
     for (k = 0; k < gscaic->nmic; k++) {
         for (i = 0; i < 1; i++) {
+            /* 1.update: conjugate of reference signal, enovation term, stepsize term */
+            dios_ssp_share_xcvec_flms_update(gscaic->Xfbdline[k][i], gscaic->ef, gscaic->muf,
+                                             gscaic->Hf[k][i], gscaic->fftsize / 2 + 1);
 
+            /* 2.norm constraint */
             for (j = 0; j < gscaic->fftsize / 2 + 1; j++) {
-                /* 1.conjugate of reference signal */
-                gscaic->yftmp[j] = complex_conjg(gscaic->Xfbdline[k][i][j]);
-
-                /* 2.enovation term */
-                gscaic->yftmp[j] = complex_mul(gscaic->yftmp[j], gscaic->ef[j]);
-
-                /* 3.stepsize term */
-                gscaic->yftmp[j] = complex_mul(gscaic->yftmp[j], gscaic->muf[j]);
-
-                /* 4.update */
-                gscaic->Hf[k][i][j] = complex_add(gscaic->Hf[k][i][j], gscaic->yftmp[j]);
-
-                /* 5.norm constraint */
                 norm += gscaic->Hf[k][i][j].r * gscaic->Hf[k][i][j].r + gscaic->Hf[k][i][j].i * gscaic->Hf[k][i][j].i;
             }
         }
@@ -365,9 +350,7 @@ int dios_ssp_gsc_gscaic_processonedatablock(objFGSCaic *gscaic, float *ctrl_abm,
     for (k = 0; k < gscaic->nmic; k++) {
         for (int i = 0; i < 1; i++) {
             /* against freezing of the adaptive filter coefficients */
-            for (int j = 0; j < gscaic->fftsize / 2 + 1; j++) {
-                gscaic->Hf[k][i][j] = complex_sub(gscaic->Hf[k][i][j], complex_mul(gscaic->Hf[k][i][j], gscaic->nuf[j]));
-            }
+            dios_ssp_share_xcvec_mul_sub(gscaic->nuf, gscaic->Hf[k][i], gscaic->fftsize / 2 + 1);
 
             /* circular correlation constraint (Hf[k][i] = [new | 0]) -> Hf[k][i] */
             // gscaic->m_pFFT->FFTInv_CToR(gscaic->Hf[k][i], gscaic->ytmp);
@@ -430,6 +413,8 @@ int dios_ssp_gsc_gscaic_delete(objFGSCaic *gscaic)
         free(gscaic->Xffilt[i_mic]);
     }
     free(gscaic->Xffilt);
+    free(gscaic->Xffilt_re);
+    free(gscaic->Xffilt_im);
     free(gscaic->yftmp);
     free(gscaic->ytmp);
     free(gscaic->yhf);
@@ -28,6 +28,8 @@ void dios_ssp_gsc_gscfiltsumbeamformer_init(objFGSCfiltsumbeamformer* gscfiltsum
     /* reset all pointers to NULL */
     gscfiltsumbeamformer->Xdline = NULL;
     gscfiltsumbeamformer->xftmp = NULL;
+    gscfiltsumbeamformer->xftmp_re = NULL;
+    gscfiltsumbeamformer->xftmp_im = NULL;
     gscfiltsumbeamformer->ytmp = NULL;
     gscfiltsumbeamformer->yftmp = NULL;
     // gscfiltsumbeamformer->m_pFFT = NULL;
@@ -42,11 +44,18 @@ void dios_ssp_gsc_gscfiltsumbeamformer_init(objFGSCfiltsumbeamformer* gscfiltsum
     for (int i_mic = 0; i_mic < gscfiltsumbeamformer->nmic; i_mic++) {
         gscfiltsumbeamformer->Xdline[i_mic] = (float*)calloc(gscfiltsumbeamformer->fftlength, sizeof(float));
     }
-    gscfiltsumbeamformer->xftmp = (xcomplex*)calloc(gscfiltsumbeamformer->fftlength / 2 + 1, sizeof(xcomplex));
+    gscfiltsumbeamformer->xftmp = (xcomplex**)calloc(gscfiltsumbeamformer->nmic, sizeof(xcomplex*));
+    gscfiltsumbeamformer->xftmp_re = (float**)calloc(gscfiltsumbeamformer->nmic, sizeof(float*));
+    gscfiltsumbeamformer->xftmp_im = (float**)calloc(gscfiltsumbeamformer->nmic, sizeof(float*));
+    for (int i_mic = 0; i_mic < gscfiltsumbeamformer->nmic; i_mic++) {
+        gscfiltsumbeamformer->xftmp[i_mic] = (xcomplex*)calloc(gscfiltsumbeamformer->fftlength / 2 + 1, sizeof(xcomplex));
+        gscfiltsumbeamformer->xftmp_re[i_mic] = &gscfiltsumbeamformer->xftmp[i_mic][0].r;
+        gscfiltsumbeamformer->xftmp_im[i_mic] = &gscfiltsumbeamformer->xftmp[i_mic][0].i;
+    }
     gscfiltsumbeamformer->ytmp = (float*)calloc(gscfiltsumbeamformer->fftlength, sizeof(float));
     gscfiltsumbeamformer->yftmp = (xcomplex*)calloc(gscfiltsumbeamformer->fftlength / 2 + 1, sizeof(xcomplex));
 
-    gscfiltsumbeamformer->filt_FFT = dios_ssp_share_rfft_init(gscfiltsumbeamformer->fftlength);
+    gscfiltsumbeamformer->filt_FFT = dios_ssp_share_rfft_batch_init(gscfiltsumbeamformer->fftlength);
     gscfiltsumbeamformer->fft_out = (float*)calloc(gscfiltsumbeamformer->fftlength, sizeof(float));
     gscfiltsumbeamformer->fft_in = (float*)calloc(gscfiltsumbeamformer->fftlength, sizeof(float));
 }
@@ -56,8 +65,8 @@ int dios_ssp_gsc_gscfiltsumbeamformer_reset(objFGSCfiltsumbeamformer* gscfiltsum
     for (int m = 0; m < gscfiltsumbeamformer->nmic; m++) {
         memset(gscfiltsumbeamformer->Xdline[m], 0, sizeof(float) * gscfiltsumbeamformer->fftlength);
         for (int n = 0; n < gscfiltsumbeamformer->fftlength / 2 + 1; n++) {
-            gscfiltsumbeamformer->xftmp[n].i = 0.0f;
-            gscfiltsumbeamformer->xftmp[n].r = 0.0f;
+            gscfiltsumbeamformer->xftmp[m][n].i = 0.0f;
+            gscfiltsumbeamformer->xftmp[m][n].r = 0.0f;
             gscfiltsumbeamformer->yftmp[n].i = 0.0f;
             gscfiltsumbeamformer->yftmp[n].r = 0.0f;
         }
@@ -85,21 +94,18 @@ int dios_ssp_gsc_gscfiltsumbeamformer_process(objFGSCfiltsumbeamformer* gscfilts
     for (int k = 0; k < gscfiltsumbeamformer->nmic; k++) {
         /* move new samples into the buffers */
         delayline(&X[k][index], gscfiltsumbeamformer->Xdline[k], ind_newblock, gscfiltsumbeamformer->fftlength);
+    }
 
-        dios_ssp_share_rfft_process(gscfiltsumbeamformer->filt_FFT, gscfiltsumbeamformer->Xdline[k], gscfiltsumbeamformer->fft_out);
-        for (int i = 0; i < gscfiltsumbeamformer->fftlength / 2 + 1; i++) {
-            gscfiltsumbeamformer->xftmp[i].r = gscfiltsumbeamformer->fft_out[i];
-        }
-        gscfiltsumbeamformer->xftmp[0].i = gscfiltsumbeamformer->xftmp[gscfiltsumbeamformer->fftlength / 2].i = 0.0;
-        for (int i = 1; i < gscfiltsumbeamformer->fftlength / 2; i++) {
-            gscfiltsumbeamformer->xftmp[i].i = -gscfiltsumbeamformer->fft_out[gscfiltsumbeamformer->fftlength - i];
-        }
+    dios_ssp_share_rfft_batch_process(gscfiltsumbeamformer->filt_FFT, gscfiltsumbeamformer->Xdline, gscfiltsumbeamformer->nmic,
+                                      gscfiltsumbeamformer->xftmp_re, gscfiltsumbeamformer->xftmp_im, 2);
+    for (int k = 0; k < gscfiltsumbeamformer->nmic; k++) {
+        xcomplex *xftmp = gscfiltsumbeamformer->xftmp[k];
 
         for (i = 0; i < gscfiltsumbeamformer->fftlength / 2 + 1; i++) {
-            gscfiltsumbeamformer->xftmp[i].r *= vol;
-            gscfiltsumbeamformer->xftmp[i].i *= vol;
-            gscfiltsumbeamformer->yftmp[i].r = gscfiltsumbeamformer->xftmp[i].r + gscfiltsumbeamformer->yftmp[i].r;
-            gscfiltsumbeamformer->yftmp[i].i = gscfiltsumbeamformer->xftmp[i].i + gscfiltsumbeamformer->yftmp[i].i;
+            xftmp[i].r *= vol;
+            xftmp[i].i *= vol;
+            gscfiltsumbeamformer->yftmp[i].r = xftmp[i].r + gscfiltsumbeamformer->yftmp[i].r;
+            gscfiltsumbeamformer->yftmp[i].i = xftmp[i].i + gscfiltsumbeamformer->yftmp[i].i;
         }
     }
 
@@ -128,7 +134,12 @@ int dios_ssp_gsc_gscfiltsumbeamformer_delete(objFGSCfiltsumbeamformer* gscfiltsu
     }
     free(gscfiltsumbeamformer->Xdline);
 
+    for (int i_mic = 0; i_mic < gscfiltsumbeamformer->nmic; i_mic++) {
+        free(gscfiltsumbeamformer->xftmp[i_mic]);
+    }
     free(gscfiltsumbeamformer->xftmp);
+    free(gscfiltsumbeamformer->xftmp_re);
+    free(gscfiltsumbeamformer->xftmp_im);
     free(gscfiltsumbeamformer->ytmp);
     free(gscfiltsumbeamformer->yftmp);
     free(gscfiltsumbeamformer->fft_out);
@@ -26,11 +26,23 @@ microphones(mic_coord) beforehand.
 #include "dios_ssp_mvdr_api.h"
 
 void* dios_ssp_mvdr_init_api(int mic_num, void* mic_coord)
+{
+    return dios_ssp_mvdr_init_stft_api(mic_num, mic_coord, NULL);
+}
+
+void* dios_ssp_mvdr_init_stft_api(int mic_num, void* mic_coord, objMchStft *stft)
 {
     void* st = NULL;
     st = (void*)calloc(1, sizeof(objMVDR));
+    if (NULL == st) {
+        return NULL;
+    }
     objMVDR* ptr = (objMVDR*)st;
-    dios_ssp_mvdr_init(ptr, mic_num, (PlaneCoord*)mic_coord);
+    if (0 != dios_ssp_mvdr_init(ptr, mic_num, (PlaneCoord*)mic_coord, stft)) {
+        dios_ssp_mvdr_delete(ptr);
+        free(st);
+        return NULL;
+    }
 
     return st;
 }
@@ -49,22 +61,92 @@ int dios_ssp_mvdr_reset_api(void *ptr)
     return 0;
 }
 
+int dios_ssp_mvdr_config_api(void *ptr, int inv_mode)
+{
+    if(ptr == NULL) {
+        printf("mvdr handle not init!\n");
+        return ERROR_MVDR;
+    }
+    if(inv_mode != MVDR_RNN_INV_DIRECT && inv_mode != MVDR_RNN_INV_RECURSIVE) {
+        return ERROR_MVDR;
+    }
+
+    objMVDR* ptr_mvdr;
+    ptr_mvdr = (objMVDR*)ptr;
+    if(inv_mode != ptr_mvdr->m_inv_mode) {
+        // the tracked inverse is stale, invert Rnn exactly on the next frame
+        ptr_mvdr->m_inv_count = ptr_mvdr->m_inv_refresh;
+    }
+    ptr_mvdr->m_inv_mode = inv_mode;
+
+    return 0;
+}
+
+int dios_ssp_mvdr_update_config_api(void *ptr, int groups)
+{
+    if(ptr == NULL) {
+        printf("mvdr handle not init!\n");
+        return ERROR_MVDR;
+    }
+
+    objMVDR* ptr_mvdr;
+    ptr_mvdr = (objMVDR*)ptr;
+    if(groups < 1 || groups > ptr_mvdr->m_sp_size - 1) {
+        return ERROR_MVDR;
+    }
+    ptr_mvdr->m_update_groups = groups;
+    ptr_mvdr->m_update_group = 0;
+    ptr_mvdr->m_update_full = 1;
+
+    return 0;
+}
+
+int dios_ssp_mvdr_update_bins_get(void *ptr)
+{
+    if(ptr == NULL) {
+        return ERROR_MVDR;
+    }
+
+    return ((objMVDR*)ptr)->m_update_bins;
+}
+
 int dios_ssp_mvdr_process_api(void* ptr, float* mic_data, float* out_data, float loc_phi)
 {
     int angle;
     angle = (int)(loc_phi + 0.5);
     objMVDR *ptr_mvdr;
     ptr_mvdr= (objMVDR*)ptr;
-    dios_ssp_mvdr_process(ptr_mvdr, mic_data, out_data, angle);
+    if (0 != dios_ssp_mvdr_process(ptr_mvdr, mic_data, out_data, angle)) {
+        return ERROR_MVDR;
+    }
+
+    return 0;
+}
+
+int dios_ssp_mvdr_process_stft_api(void* ptr, const objMchStft *stft, float* out_data, float loc_phi)
+{
+    int angle;
+    angle = (int)(loc_phi + 0.5);
+    objMVDR *ptr_mvdr;
+    ptr_mvdr= (objMVDR*)ptr;
+
+    if (0 != dios_ssp_mvdr_process_stft(ptr_mvdr, stft, out_data, angle)) {
+        return ERROR_MVDR;
+    }
 
     return 0;
 }
 
 int dios_ssp_mvdr_uninit_api(void *ptr)
 {
+    if(ptr == NULL) {
+        printf("mvdr handle not init!\n");
+        return ERROR_MVDR;
+    }
     objMVDR *ptr_mvdr;
     ptr_mvdr= (objMVDR*)ptr;
     dios_ssp_mvdr_delete(ptr_mvdr);
+    free(ptr_mvdr);
 
     return 0;
 }
@@ -33,45 +33,38 @@ int dios_ssp_mvdr_init_diffuse_rnn(objMVDR *ptr_mvdr)
                 ptr_mvdr->m_sd_rnn_re[k*ptr_mvdr->m_rxx_size+j*ptr_mvdr->m_channels+i] = ptr_mvdr->m_sd_rnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j];
             }
         }
-        for (i = 0; i < ptr_mvdr->m_channels; i++) {
-            for (j = 0; j < ptr_mvdr->m_channels; j++) {
-                ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*j] = ptr_mvdr->m_sd_rnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j];
-                ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*j+1] = 0;
-            }
-        }
-        dios_ssp_matrix_inv_process(ptr_mvdr->mvdrinv, ptr_mvdr->m_rxx_in, ptr_mvdr->m_irxx_out);
-        for (i = 0; i < ptr_mvdr->m_channels; ++i) {
-            for (j = 0; j < ptr_mvdr->m_channels; ++j) {
-                ptr_mvdr->m_sd_irnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j] = ptr_mvdr->m_irxx_out[i*ptr_mvdr->m_channels*2+2*j];
-                ptr_mvdr->m_sd_irnn_im[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j] = ptr_mvdr->m_irxx_out[i*ptr_mvdr->m_channels*2+2*j+1];
-            }
-        }
     }
+    dios_ssp_share_hsolve_factor(ptr_mvdr->hsolve, ptr_mvdr->m_sd_rnn_re+ptr_mvdr->m_rxx_size, NULL,
+                                 ptr_mvdr->m_rxx_size, ptr_mvdr->m_sp_size-1, DEFAULT_MVDR_DIAG_LOADING);
+    dios_ssp_share_hsolve_inverse(ptr_mvdr->hsolve, ptr_mvdr->m_sd_irnn_re+ptr_mvdr->m_rxx_size,
+                                  ptr_mvdr->m_sd_irnn_im+ptr_mvdr->m_rxx_size, ptr_mvdr->m_rxx_size);
 
     return 0;
 }
 
 int dios_ssp_mvdr_alloc_mem(objMVDR *ptr_mvdr)
 {
-    int i;
-    ptr_mvdr->m_mch_buffer = (float**)calloc(ptr_mvdr->m_channels, sizeof(float*));
-    for (i = 0; i < ptr_mvdr->m_channels; ++i ) {
-        ptr_mvdr->m_mch_buffer[i] = (float*)calloc(ptr_mvdr->m_fft_size, sizeof(float));
+    // a stft of the caller is read by pointer, otherwise the mvdr runs its own
+    if (NULL == ptr_mvdr->stft) {
+        ptr_mvdr->stft = dios_ssp_share_stft_init(ptr_mvdr->m_channels, ptr_mvdr->m_fft_size, ptr_mvdr->m_shift_size);
+        if (NULL == ptr_mvdr->stft) {
+            return -1;
+        }
     }
+    ptr_mvdr->m_re = ptr_mvdr->stft->re;
+    ptr_mvdr->m_im = ptr_mvdr->stft->im;
 
-    ptr_mvdr->m_win_data = (float*)calloc(ptr_mvdr->m_fft_size*ptr_mvdr->m_channels, sizeof(float));
-    ptr_mvdr->m_re = (float*)calloc(ptr_mvdr->m_fft_size*ptr_mvdr->m_channels, sizeof(float));
-    ptr_mvdr->m_im = (float*)calloc(ptr_mvdr->m_fft_size*ptr_mvdr->m_channels, sizeof(float));
+    ptr_mvdr->m_win_data = (float*)calloc(ptr_mvdr->m_fft_size, sizeof(float));
     ptr_mvdr->m_re_temp = (float*)calloc(ptr_mvdr->m_fft_size*ptr_mvdr->m_channels, sizeof(float));
     ptr_mvdr->m_im_temp = (float*)calloc(ptr_mvdr->m_fft_size*ptr_mvdr->m_channels, sizeof(float));
 
     ptr_mvdr->m_rnn_re = (float*)calloc(ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size, sizeof(float));
     ptr_mvdr->m_rnn_im = (float*)calloc(ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size, sizeof(float));
+    ptr_mvdr->hsolve = dios_ssp_share_hsolve_init(ptr_mvdr->m_channels, ptr_mvdr->m_sp_size-1);
     ptr_mvdr->m_irnn_re = (float*)calloc(ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size, sizeof(float));
     ptr_mvdr->m_irnn_im = (float*)calloc(ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size, sizeof(float));
-
-    ptr_mvdr->m_rxx_in = (float*)calloc(2*ptr_mvdr->m_rxx_size, sizeof(float));
-    ptr_mvdr->m_irxx_out = (float*)calloc(2*ptr_mvdr->m_rxx_size, sizeof(float));
+    ptr_mvdr->m_pu_re = (float*)calloc(ptr_mvdr->m_channels, sizeof(float));
+    ptr_mvdr->m_pu_im = (float*)calloc(ptr_mvdr->m_channels, sizeof(float));
 
     ptr_mvdr->m_sd_rnn_re = (float*)calloc(ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size, sizeof(float));
     ptr_mvdr->m_sd_irnn_re = (float*)calloc(ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size, sizeof(float));
@@ -85,7 +78,7 @@ int dios_ssp_mvdr_alloc_mem(objMVDR *ptr_mvdr)
 
     ptr_mvdr->m_mvdr_out_re = (float*)calloc(ptr_mvdr->m_fft_size, sizeof(float));
     ptr_mvdr->m_mvdr_out_im = (float*)calloc(ptr_mvdr->m_fft_size, sizeof(float));
-    ptr_mvdr->m_out_bf = (float*)calloc(ptr_mvdr->m_fft_size, sizeof(float));
+    ptr_mvdr->m_out_ola = dios_ssp_share_ola_init(ptr_mvdr->m_fft_size);
 
     // grid steering vectors
     ptr_mvdr->m_gstv_re = (float*)calloc(ptr_mvdr->m_sp_size*ptr_mvdr->m_angle_num*ptr_mvdr->m_channels, sizeof(float));
@@ -95,7 +88,6 @@ int dios_ssp_mvdr_alloc_mem(objMVDR *ptr_mvdr)
 
     // mcra
     ptr_mvdr->m_ns_ps_cur_mic = (float*)calloc(ptr_mvdr->m_fft_size, sizeof(float));
-    ptr_mvdr->m_ns_theta_cur_mic = (float*)calloc(ptr_mvdr->m_fft_size, sizeof(float));
     ptr_mvdr->m_ns_ps = (float*)calloc(ptr_mvdr->m_channels*ptr_mvdr->m_fft_size, sizeof(float));
     ptr_mvdr->m_P = (float*)calloc(ptr_mvdr->m_channels*ptr_mvdr->m_fft_size, sizeof(float));
     ptr_mvdr->m_Ptmp = (float*)calloc(ptr_mvdr->m_channels*ptr_mvdr->m_fft_size, sizeof(float));
@@ -181,25 +173,20 @@ int dios_ssp_mvdr_init_sd_weights(objMVDR *ptr_mvdr)
 
 int dios_ssp_mvdr_free_mem(objMVDR *ptr_mvdr)
 {
-    int i;
-
-    for (i = 0; i < ptr_mvdr->m_channels; ++i ) {
-        free(ptr_mvdr->m_mch_buffer[i]);
+    if (!ptr_mvdr->m_stft_shared) {
+        dios_ssp_share_stft_uninit(ptr_mvdr->stft);
     }
-    free(ptr_mvdr->m_mch_buffer);
     free(ptr_mvdr->m_win_data);
-    free(ptr_mvdr->m_re);
-    free(ptr_mvdr->m_im);
     free(ptr_mvdr->m_re_temp);
     free(ptr_mvdr->m_im_temp);
 
     free(ptr_mvdr->m_rnn_re);
     free(ptr_mvdr->m_rnn_im);
+    dios_ssp_share_hsolve_uninit(ptr_mvdr->hsolve);
     free(ptr_mvdr->m_irnn_re);
     free(ptr_mvdr->m_irnn_im);
-
-    free(ptr_mvdr->m_rxx_in);
-    free(ptr_mvdr->m_irxx_out);
+    free(ptr_mvdr->m_pu_re);
+    free(ptr_mvdr->m_pu_im);
 
     free(ptr_mvdr->m_sd_rnn_re);
     free(ptr_mvdr->m_sd_irnn_re);
@@ -213,7 +200,7 @@ int dios_ssp_mvdr_free_mem(objMVDR *ptr_mvdr)
 
     free(ptr_mvdr->m_mvdr_out_re);
     free(ptr_mvdr->m_mvdr_out_im);
-    free(ptr_mvdr->m_out_bf);
+    dios_ssp_share_ola_uninit(ptr_mvdr->m_out_ola);
 
     free(ptr_mvdr->m_gstv_re);
     free(ptr_mvdr->m_gstv_im);
@@ -222,7 +209,6 @@ int dios_ssp_mvdr_free_mem(objMVDR *ptr_mvdr)
 
     // mcra
     free(ptr_mvdr->m_ns_ps_cur_mic);
-    free(ptr_mvdr->m_ns_theta_cur_mic);
     free(ptr_mvdr->m_ns_ps);
     free(ptr_mvdr->m_P);
     free(ptr_mvdr->m_Ptmp);
@@ -234,7 +220,7 @@ int dios_ssp_mvdr_free_mem(objMVDR *ptr_mvdr)
     return 0;
 }
 
-void dios_ssp_mvdr_init(objMVDR *ptr_mvdr, int sensor_num, PlaneCoord* cood)
+int dios_ssp_mvdr_init(objMVDR *ptr_mvdr, int sensor_num, PlaneCoord* cood, objMchStft *stft)
 {
     int i, j;
 
@@ -266,53 +252,74 @@ void dios_ssp_mvdr_init(objMVDR *ptr_mvdr, int sensor_num, PlaneCoord* cood)
     ptr_mvdr->m_gstv_dim = ptr_mvdr->m_sp_size*ptr_mvdr->m_channels;
 
     ptr_mvdr->m_beta_rnn = 1-ptr_mvdr->m_alpha_rnn;
+    ptr_mvdr->m_inv_mode = MVDR_RNN_INV_DIRECT;
+    ptr_mvdr->m_inv_refresh = DEFAULT_MVDR_INV_REFRESH;
+    ptr_mvdr->m_update_groups = 1;
+    ptr_mvdr->m_update_thres = DEFAULT_MVDR_UPDATE_THRES;
 
     ptr_mvdr->cood = cood;
 
+    if (NULL != stft) {
+        if (stft->channels != ptr_mvdr->m_channels || stft->fft_size != ptr_mvdr->m_fft_size
+            || stft->shift_size != ptr_mvdr->m_shift_size) {
+            printf("mvdr stft must have %d channels, a %d fft and a %d hop\n", ptr_mvdr->m_channels,
+                   ptr_mvdr->m_fft_size, ptr_mvdr->m_shift_size);
+            return -1;
+        }
+        ptr_mvdr->stft = stft;
+        ptr_mvdr->m_stft_shared = 1;
+    }
+
     ptr_mvdr->dist = (float*)calloc(ptr_mvdr->m_channels * ptr_mvdr->m_channels, sizeof(float));
     for (i = 0; i < ptr_mvdr->m_channels; i++) {
         for (j = i+1; j < ptr_mvdr->m_channels; j++) {
             ptr_mvdr->dist[i* ptr_mvdr->m_channels + j] = (float)sqrt(pow(ptr_mvdr->cood[i].x - ptr_mvdr->cood[j].x, 2) + pow(ptr_mvdr->cood[i].y * ptr_mvdr->cood[i].y, 2) + pow(ptr_mvdr->cood[i].z * ptr_mvdr->cood[i].z, 2));
         }
     }
-    ptr_mvdr->mvdrinv = dios_ssp_matrix_inv_init(ptr_mvdr->m_channels);
     ptr_mvdr->m_angle_num = (int)((360.0-0.0)/ ptr_mvdr->m_delta_angle);
     ptr_mvdr->mvdrwin = (objMVDRCwin*)calloc(1, sizeof(objMVDRCwin));
     dios_ssp_mvdr_win_init(ptr_mvdr->mvdrwin, ptr_mvdr->m_fft_size, ptr_mvdr->m_shift_size);
 
     ptr_mvdr->mvdr_fft = dios_ssp_share_rfft_init(ptr_mvdr->m_fft_size);
     ptr_mvdr->fft_in = (float *)calloc(ptr_mvdr->m_fft_size, sizeof(float));
-    ptr_mvdr->fft_out = (float *)calloc(ptr_mvdr->m_fft_size, sizeof(float));
 
-    dios_ssp_mvdr_alloc_mem(ptr_mvdr);
+    if (0 != dios_ssp_mvdr_alloc_mem(ptr_mvdr)) {
+        return -1;
+    }
 
     dios_ssp_mvdr_init_steering_vectors_g(ptr_mvdr);
 
     dios_ssp_mvdr_init_sd_weights(ptr_mvdr);
+
+    return 0;
 }
 
 void dios_ssp_mvdr_reset(objMVDR *ptr_mvdr)
 {
     int i, k;
     ptr_mvdr->m_frame_sum = 0;
+    ptr_mvdr->m_inv_count = 0;
+    ptr_mvdr->m_update_group = 0;
+    ptr_mvdr->m_update_full = 1;
+    ptr_mvdr->m_update_power = 0;
+    ptr_mvdr->m_update_bins = 0;
     ptr_mvdr->m_angle_pre = 89;
-    for (i = 0; i < ptr_mvdr->m_channels; ++i ) {
-        memset( ptr_mvdr->m_mch_buffer[i], 0, sizeof(float)*ptr_mvdr->m_fft_size );
+    // a shared stft is reset by its owner
+    if (!ptr_mvdr->m_stft_shared) {
+        dios_ssp_share_stft_reset(ptr_mvdr->stft);
     }
-    memset( ptr_mvdr->m_win_data, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
-    memset( ptr_mvdr->m_re, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
-    memset( ptr_mvdr->m_im, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
+    ptr_mvdr->m_re = ptr_mvdr->stft->re;
+    ptr_mvdr->m_im = ptr_mvdr->stft->im;
+    memset( ptr_mvdr->m_win_data, 0, sizeof(float)*ptr_mvdr->m_fft_size );
     memset( ptr_mvdr->m_re_temp, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
     memset( ptr_mvdr->m_im_temp, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
     memset( ptr_mvdr->m_rnn_re, 0, sizeof(float)*ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size );
     memset( ptr_mvdr->m_rnn_im, 0, sizeof(float)*ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size );
     memset( ptr_mvdr->m_irnn_re, 0, sizeof(float)*ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size );
     memset( ptr_mvdr->m_irnn_im, 0, sizeof(float)*ptr_mvdr->m_sp_size*ptr_mvdr->m_rxx_size );
-    memset( ptr_mvdr->m_rxx_in, 0, sizeof(float)*2*ptr_mvdr->m_rxx_size );
-    memset( ptr_mvdr->m_irxx_out, 0, sizeof(float)*2*ptr_mvdr->m_rxx_size );
     memset( ptr_mvdr->m_mvdr_out_re, 0, sizeof(float)*ptr_mvdr->m_fft_size );
     memset( ptr_mvdr->m_mvdr_out_im, 0, sizeof(float)*ptr_mvdr->m_fft_size );
-    memset( ptr_mvdr->m_out_bf, 0, sizeof(float)*ptr_mvdr->m_fft_size );
+    dios_ssp_share_ola_reset(ptr_mvdr->m_out_ola);
     for(k = 0; k < ptr_mvdr->m_sp_size; ++k) {
         for(i = 0; i < ptr_mvdr->m_channels; ++i) {
             ptr_mvdr->m_stv_re[k*ptr_mvdr->m_channels+i] = 1;
@@ -321,7 +328,6 @@ void dios_ssp_mvdr_reset(objMVDR *ptr_mvdr)
     }
     // mcra
     memset( ptr_mvdr->m_ns_ps_cur_mic, 0, sizeof(float)*ptr_mvdr->m_fft_size );
-    memset( ptr_mvdr->m_ns_theta_cur_mic, 0, sizeof(float)*ptr_mvdr->m_fft_size );
     memset( ptr_mvdr->m_ns_ps, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
     memset( ptr_mvdr->m_P, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
     memset( ptr_mvdr->m_Ptmp, 0, sizeof(float)*ptr_mvdr->m_channels*ptr_mvdr->m_fft_size );
@@ -333,49 +339,48 @@ void dios_ssp_mvdr_reset(objMVDR *ptr_mvdr)
     //fft
     for (i = 0; i < ptr_mvdr->m_fft_size; ++i ) {
         ptr_mvdr->fft_in[i] = 0.0;
-        ptr_mvdr->fft_out[i] = 0.0;
     }
 
 }
 
 int dios_ssp_mvdr_process(objMVDR *ptr_mvdr, float* in, float* out, int angle)
 {
-    int i, k, ch_idx = 0;
-    for ( ch_idx = 0; ch_idx < ptr_mvdr->m_channels; ++ch_idx ) {
-        for (i = 0; i < ptr_mvdr->m_shift_size; ++i ) {
-            ptr_mvdr->m_mch_buffer[ch_idx][ptr_mvdr->m_fft_size - ptr_mvdr->m_shift_size + i] = in[ch_idx * ptr_mvdr->m_shift_size + i];
-        }
+    if (ptr_mvdr->m_stft_shared) {
+        printf("mvdr stft is shared, call dios_ssp_mvdr_process_stft_api\n");
+        return -1;
     }
+    // stft
+    dios_ssp_share_stft_process(ptr_mvdr->stft, in);
+
+    return dios_ssp_mvdr_process_stft(ptr_mvdr, ptr_mvdr->stft, out, angle);
+}
+
+int dios_ssp_mvdr_process_stft(objMVDR *ptr_mvdr, const objMchStft *stft, float* out, int angle)
+{
+    int i, k;
+
+    if (stft->channels != ptr_mvdr->m_channels || stft->fft_size != ptr_mvdr->m_fft_size) {
+        printf("mvdr stft must have %d channels and a %d fft\n", ptr_mvdr->m_channels, ptr_mvdr->m_fft_size);
+        return -1;
+    }
+    ptr_mvdr->m_re = stft->re;
+    ptr_mvdr->m_im = stft->im;
 
     if( angle != ptr_mvdr->m_angle_pre ) {
         int ang_region = angle/ptr_mvdr->m_delta_angle;
         memcpy(ptr_mvdr->m_stv_re, ptr_mvdr->m_gstv_re+ang_region*ptr_mvdr->m_gstv_dim, sizeof(float)*ptr_mvdr->m_sp_size*ptr_mvdr->m_channels);
         memcpy(ptr_mvdr->m_stv_im, ptr_mvdr->m_gstv_im+ang_region*ptr_mvdr->m_gstv_dim, sizeof(float)*ptr_mvdr->m_sp_size*ptr_mvdr->m_channels);
         ptr_mvdr->m_angle_pre = angle;
+        ptr_mvdr->m_update_full = 1;
     }
 
     ptr_mvdr->m_frame_sum++;
-    // add ana window
-    for ( ch_idx = 0; ch_idx < ptr_mvdr->m_channels; ++ch_idx ) {
-        dios_ssp_mvdr_win_add_ana_win(ptr_mvdr->mvdrwin, ptr_mvdr->m_mch_buffer[ch_idx], ptr_mvdr->m_win_data+ch_idx*ptr_mvdr->m_fft_size);
-    }
-    // stft
-    for ( ch_idx = 0; ch_idx < ptr_mvdr->m_channels; ++ch_idx ) {
-        dios_ssp_share_rfft_process(ptr_mvdr->mvdr_fft, ptr_mvdr->m_win_data+ch_idx*ptr_mvdr->m_fft_size, ptr_mvdr->fft_out);
-        for (i = 0; i < ptr_mvdr->m_fft_size / 2 + 1; i++) {
-            ptr_mvdr->m_re[i + ch_idx * ptr_mvdr->m_fft_size] = ptr_mvdr->fft_out[i];
-        }
-        ptr_mvdr->m_im[0] = ptr_mvdr->m_im[ptr_mvdr->m_fft_size / 2] = 0.0;
-        for (i = 1; i < ptr_mvdr->m_fft_size / 2; i++) {
-            ptr_mvdr->m_im[i + ch_idx * ptr_mvdr->m_fft_size] = -ptr_mvdr->fft_out[ptr_mvdr->m_fft_size - i];
-        }
-    }
 
     dios_ssp_mvdr_mcra(ptr_mvdr);
 
     dios_ssp_mvdr_cal_rxx(ptr_mvdr);
 
-    dios_ssp_mvdr_cal_weights_adpmvdr(ptr_mvdr);
+    dios_ssp_mvdr_update_weights(ptr_mvdr);
 
     for (k = 1; k < ptr_mvdr->m_fft_size/2; k++ ) {
         ptr_mvdr->m_mvdr_out_re[k] = ptr_mvdr->m_mvdr_out_im[k] = 0;
@@ -401,19 +406,8 @@ int dios_ssp_mvdr_process(objMVDR *ptr_mvdr, float* in, float* out, int angle)
     dios_ssp_mvdr_win_add_syn_win(ptr_mvdr->mvdrwin, ptr_mvdr->m_win_data, ptr_mvdr->m_re_temp);
 
     // ola
-    for (i = 0; i < ptr_mvdr->m_fft_size; ++i ) {
-        ptr_mvdr->m_out_bf[i] += ptr_mvdr->m_re_temp[i];
-    }
-
-    for (i = 0; i < ptr_mvdr->m_shift_size; ++i ) {
-        out[i] = ptr_mvdr->m_out_bf[i];
-    }
-
-    for (ch_idx = 0; ch_idx < ptr_mvdr->m_channels; ++ch_idx) {
-        memmove(ptr_mvdr->m_mch_buffer[ch_idx], ptr_mvdr->m_mch_buffer[ch_idx] + ptr_mvdr->m_shift_size, sizeof(float) * (ptr_mvdr->m_fft_size - ptr_mvdr->m_shift_size));
-    }
-    memmove( ptr_mvdr->m_out_bf, ptr_mvdr->m_out_bf + ptr_mvdr->m_shift_size, sizeof(float) * (ptr_mvdr->m_fft_size - ptr_mvdr->m_shift_size) );
-    memset( ptr_mvdr->m_out_bf + ptr_mvdr->m_fft_size - ptr_mvdr->m_shift_size, 0, sizeof(float) * ptr_mvdr->m_shift_size);
+    dios_ssp_share_ola_add(ptr_mvdr->m_out_ola, 0, ptr_mvdr->m_re_temp, ptr_mvdr->m_fft_size);
+    dios_ssp_share_ola_pop(ptr_mvdr->m_out_ola, out, ptr_mvdr->m_shift_size);
 
     return 0;
 }
@@ -423,18 +417,18 @@ int dios_ssp_mvdr_mcra(objMVDR *ptr_mvdr)
     int i, k;
     for(i = 0; i < ptr_mvdr->m_channels; ++i) {
 
-        float Srk = 0, ik = 0, adk = 0, xn_amp = 0;
+        float Srk = 0, ik = 0, adk = 0;
 
-        for(k = 0; k < ptr_mvdr->m_fft_size; ++k) {
+        // only bins 0..m_sp_size-1 are estimated, the rest of the spectrum is conjugate
+        for(k = 0; k < ptr_mvdr->m_sp_size; ++k) {
             ptr_mvdr->m_ns_ps_cur_mic[k] = ptr_mvdr->m_re[i*ptr_mvdr->m_fft_size+k]*ptr_mvdr->m_re[i*ptr_mvdr->m_fft_size+k] + ptr_mvdr->m_im[i*ptr_mvdr->m_fft_size+k]*ptr_mvdr->m_im[i*ptr_mvdr->m_fft_size+k];
-            ptr_mvdr->m_ns_theta_cur_mic[k] = (float)atan2(ptr_mvdr->m_im[i*ptr_mvdr->m_fft_size+k], ptr_mvdr->m_re[i*ptr_mvdr->m_fft_size+k]);
         }
 
         if( ptr_mvdr->m_frame_sum == 1 ) {
-            memcpy(ptr_mvdr->m_ns_ps+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_fft_size);
-            memcpy(ptr_mvdr->m_P+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_fft_size);
-            memcpy(ptr_mvdr->m_Ptmp+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_fft_size);
-            memcpy(ptr_mvdr->m_Pmin+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_fft_size);
+            memcpy(ptr_mvdr->m_ns_ps+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_sp_size);
+            memcpy(ptr_mvdr->m_P+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_sp_size);
+            memcpy(ptr_mvdr->m_Ptmp+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_sp_size);
+            memcpy(ptr_mvdr->m_Pmin+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_ns_ps_cur_mic, sizeof(float)*ptr_mvdr->m_sp_size);
         } else {
             for(k = 0; k < ptr_mvdr->m_sp_size; ++k) {
                 ptr_mvdr->m_P[i*ptr_mvdr->m_fft_size+k] = ptr_mvdr->m_alpha_s*ptr_mvdr->m_P[i*ptr_mvdr->m_fft_size+k] + (1 - ptr_mvdr->m_alpha_s)*ptr_mvdr->m_ns_ps_cur_mic[k];
@@ -461,15 +455,10 @@ int dios_ssp_mvdr_mcra(objMVDR *ptr_mvdr)
             ptr_mvdr->m_ns_ps[i*ptr_mvdr->m_fft_size+k] = adk*ptr_mvdr->m_ns_ps[i*ptr_mvdr->m_fft_size+k] + (1 - adk)*ptr_mvdr->m_ns_ps_cur_mic[k];
         }
 
-        for(k = 1; k < ptr_mvdr->m_fft_size/2; ++k) {
-            ptr_mvdr->m_ns_ps[i*ptr_mvdr->m_fft_size+ptr_mvdr->m_fft_size-k] = ptr_mvdr->m_ns_ps[i*ptr_mvdr->m_fft_size+k];
-        }
-
-        for(k = 0; k < ptr_mvdr->m_fft_size; ++k) {
-            xn_amp = (float)sqrt(ptr_mvdr->m_ns_ps[i*ptr_mvdr->m_fft_size+k]);
-            ptr_mvdr->m_xn_re[i*ptr_mvdr->m_fft_size+k] = (float)(xn_amp*cos(ptr_mvdr->m_ns_theta_cur_mic[k]));
-            ptr_mvdr->m_xn_im[i*ptr_mvdr->m_fft_size+k] = (float)(xn_amp*sin(ptr_mvdr->m_ns_theta_cur_mic[k]));
-        }
+        // noise with the phase of the input: x * sqrt(noise / |x|^2)
+        dios_ssp_share_vec_scale_power(ptr_mvdr->m_re+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_im+i*ptr_mvdr->m_fft_size,
+                                       ptr_mvdr->m_ns_ps_cur_mic, ptr_mvdr->m_ns_ps+i*ptr_mvdr->m_fft_size,
+                                       ptr_mvdr->m_xn_re+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_xn_im+i*ptr_mvdr->m_fft_size, ptr_mvdr->m_sp_size);
     }
 
     return 0;
@@ -522,42 +511,114 @@ int dios_ssp_mvdr_cal_rxx(objMVDR *ptr_mvdr)
     return 0;
 }
 
-int dios_ssp_mvdr_cal_weights_adpmvdr(objMVDR *ptr_mvdr)
+int dios_ssp_mvdr_update_irnn(objMVDR *ptr_mvdr)
 {
     int i, j, k;
-    for(k = 1; k < ptr_mvdr->m_sp_size; ++k) {
-        for (i = 0; i < ptr_mvdr->m_channels; i++) {
-            ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*i] = ptr_mvdr->m_rnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+i];
-            ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*i+1] = ptr_mvdr->m_rnn_im[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+i];
-            for (j = i+1; j < ptr_mvdr->m_channels; j++) {
-                ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*j] = ptr_mvdr->m_rnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j];
-                ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*j+1] = ptr_mvdr->m_rnn_im[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j];
-                ptr_mvdr->m_rxx_in[j*ptr_mvdr->m_channels*2+2*i] = ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*j];
-                ptr_mvdr->m_rxx_in[j*ptr_mvdr->m_channels*2+2*i+1] = -ptr_mvdr->m_rxx_in[i*ptr_mvdr->m_channels*2+2*j+1];
+    int M = ptr_mvdr->m_channels;
+    float *u_re = ptr_mvdr->m_pu_re;
+    float *u_im = ptr_mvdr->m_pu_im;
+
+    if ( ptr_mvdr->m_frame_sum == 1 || ++ptr_mvdr->m_inv_count >= ptr_mvdr->m_inv_refresh ) {
+        dios_ssp_share_hsolve_factor(ptr_mvdr->hsolve, ptr_mvdr->m_rnn_re+ptr_mvdr->m_rxx_size, ptr_mvdr->m_rnn_im+ptr_mvdr->m_rxx_size,
+                                     ptr_mvdr->m_rxx_size, ptr_mvdr->m_sp_size-1, DEFAULT_MVDR_DIAG_LOADING);
+        dios_ssp_share_hsolve_inverse(ptr_mvdr->hsolve, ptr_mvdr->m_irnn_re+ptr_mvdr->m_rxx_size, ptr_mvdr->m_irnn_im+ptr_mvdr->m_rxx_size,
+                                      ptr_mvdr->m_rxx_size);
+        ptr_mvdr->m_inv_count = 0;
+        return 0;
+    }
+
+    // Rnn = alpha*Rnn + beta*xn*xn^H, so
+    // Rnn^-1 = (Rnn^-1 - beta*u*u^H/(alpha + beta*xn^H*u))/alpha with u = Rnn^-1*xn
+    for (k = 1; k < ptr_mvdr->m_sp_size; k++) {
+        float *p_re = ptr_mvdr->m_irnn_re + k*ptr_mvdr->m_rxx_size;
+        float *p_im = ptr_mvdr->m_irnn_im + k*ptr_mvdr->m_rxx_size;
+        float xhu = 0, scale = 0;
+
+        for (i = 0; i < M; i++) {
+            float re_temp = 0, im_temp = 0;
+            for (j = 0; j < M; j++) {
+                float x_re = ptr_mvdr->m_xn_re[j*ptr_mvdr->m_fft_size+k];
+                float x_im = ptr_mvdr->m_xn_im[j*ptr_mvdr->m_fft_size+k];
+                re_temp += p_re[i*M+j]*x_re - p_im[i*M+j]*x_im;
+                im_temp += p_re[i*M+j]*x_im + p_im[i*M+j]*x_re;
             }
+            u_re[i] = re_temp;
+            u_im[i] = im_temp;
+            xhu += ptr_mvdr->m_xn_re[i*ptr_mvdr->m_fft_size+k]*re_temp + ptr_mvdr->m_xn_im[i*ptr_mvdr->m_fft_size+k]*im_temp;
         }
-        dios_ssp_matrix_inv_process(ptr_mvdr->mvdrinv, ptr_mvdr->m_rxx_in, ptr_mvdr->m_irxx_out);
-        for (i = 0; i < ptr_mvdr->m_channels; ++i) {
-            for (j = 0; j < ptr_mvdr->m_channels; ++j) {
-                ptr_mvdr->m_irnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j] = ptr_mvdr->m_irxx_out[i*ptr_mvdr->m_channels*2+2*j];
-                ptr_mvdr->m_irnn_im[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j] = ptr_mvdr->m_irxx_out[i*ptr_mvdr->m_channels*2+2*j+1];
+
+        xhu = ptr_mvdr->m_alpha_rnn + ptr_mvdr->m_beta_rnn*xhu;
+        if (!(xhu > 0)) {
+            // lost positive definiteness, start over from Rnn on the next frame
+            ptr_mvdr->m_inv_count = ptr_mvdr->m_inv_refresh;
+            continue;
+        }
+        scale = ptr_mvdr->m_beta_rnn / xhu;
+        for (i = 0; i < M; i++) {
+            for (j = i; j < M; j++) {
+                p_re[i*M+j] = (p_re[i*M+j] - scale*(u_re[i]*u_re[j] + u_im[i]*u_im[j])) / ptr_mvdr->m_alpha_rnn;
+                p_im[i*M+j] = (p_im[i*M+j] - scale*(u_im[i]*u_re[j] - u_re[i]*u_im[j])) / ptr_mvdr->m_alpha_rnn;
+                p_re[j*M+i] = p_re[i*M+j];
+                p_im[j*M+i] = -p_im[i*M+j];
+            }
+        }
+
+        // Rnn also gains beta*m_rnn_eps on its diagonal every frame, which is
+        // not rank one; feed it to one channel per frame in turn instead,
+        // Rnn += M*beta*m_rnn_eps*e_c*e_c^H, so the loading does not decay
+        // between two exact inversions
+        int c = ptr_mvdr->m_frame_sum % M;
+        float load = M * ptr_mvdr->m_beta_rnn * ptr_mvdr->m_rnn_eps;
+        for (i = 0; i < M; i++) {
+            u_re[i] = p_re[i*M+c];
+            u_im[i] = p_im[i*M+c];
+        }
+        scale = load / (1.0f + load * u_re[c]);
+        for (i = 0; i < M; i++) {
+            for (j = i; j < M; j++) {
+                p_re[i*M+j] -= scale*(u_re[i]*u_re[j] + u_im[i]*u_im[j]);
+                p_im[i*M+j] -= scale*(u_im[i]*u_re[j] - u_re[i]*u_im[j]);
+                p_re[j*M+i] = p_re[i*M+j];
+                p_im[j*M+i] = -p_im[i*M+j];
             }
         }
     }
 
-    float re_temp = 0, im_temp = 0, power = 0, re_temp2 = 0, im_temp2 = 0;
-    for (k = 1; k < ptr_mvdr->m_sp_size; k++ ) {
-        for (i = 0; i < ptr_mvdr->m_channels; i++) {
-            re_temp = im_temp = 0;
-            for (j = 0; j < ptr_mvdr->m_channels; j++) {
-                re_temp += ptr_mvdr->m_irnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_re[k*ptr_mvdr->m_channels+j]
-                           - ptr_mvdr->m_irnn_im[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_im[k*ptr_mvdr->m_channels+j];
-                im_temp += ptr_mvdr->m_irnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_im[k*ptr_mvdr->m_channels+j]
-                           + ptr_mvdr->m_irnn_im[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_re[k*ptr_mvdr->m_channels+j];
+    return 0;
+}
+
+int dios_ssp_mvdr_cal_weights_adpmvdr(objMVDR *ptr_mvdr, int bin_start, int bin_num)
+{
+    int i, j, k;
+    int bin_end = bin_start + bin_num;
+
+    if ( ptr_mvdr->m_inv_mode == MVDR_RNN_INV_RECURSIVE ) {
+        // weight = Rnn^-1 * stv with the tracked inverse
+        for (k = bin_start; k < bin_end; k++) {
+            const float *p_re = ptr_mvdr->m_irnn_re + k*ptr_mvdr->m_rxx_size;
+            const float *p_im = ptr_mvdr->m_irnn_im + k*ptr_mvdr->m_rxx_size;
+            for (i = 0; i < ptr_mvdr->m_channels; i++) {
+                float re_temp = 0, im_temp = 0;
+                for (j = 0; j < ptr_mvdr->m_channels; j++) {
+                    re_temp += p_re[i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_re[k*ptr_mvdr->m_channels+j]
+                               - p_im[i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_im[k*ptr_mvdr->m_channels+j];
+                    im_temp += p_re[i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_im[k*ptr_mvdr->m_channels+j]
+                               + p_im[i*ptr_mvdr->m_channels+j]*ptr_mvdr->m_stv_re[k*ptr_mvdr->m_channels+j];
+                }
+                ptr_mvdr->m_weight_re[k*ptr_mvdr->m_channels+i] = re_temp;
+                ptr_mvdr->m_weight_im[k*ptr_mvdr->m_channels+i] = im_temp;
             }
-            ptr_mvdr->m_weight_re[k*ptr_mvdr->m_channels+i] = re_temp;
-            ptr_mvdr->m_weight_im[k*ptr_mvdr->m_channels+i] = im_temp;
         }
+    } else {
+        // weight = Rnn^-1 * stv, the whole bin range in one batch
+        dios_ssp_share_hsolve_factor(ptr_mvdr->hsolve, ptr_mvdr->m_rnn_re+bin_start*ptr_mvdr->m_rxx_size, ptr_mvdr->m_rnn_im+bin_start*ptr_mvdr->m_rxx_size,
+                                     ptr_mvdr->m_rxx_size, bin_num, DEFAULT_MVDR_DIAG_LOADING);
+        dios_ssp_share_hsolve_solve(ptr_mvdr->hsolve, ptr_mvdr->m_stv_re+bin_start*ptr_mvdr->m_channels, ptr_mvdr->m_stv_im+bin_start*ptr_mvdr->m_channels,
+                                    ptr_mvdr->m_weight_re+bin_start*ptr_mvdr->m_channels, ptr_mvdr->m_weight_im+bin_start*ptr_mvdr->m_channels, ptr_mvdr->m_channels);
+    }
+
+    float re_temp = 0, im_temp = 0, power = 0, re_temp2 = 0, im_temp2 = 0;
+    for (k = bin_start; k < bin_end; k++ ) {
         re_temp = im_temp = 0;
         for (i = 0; i < ptr_mvdr->m_channels; i++ ) {
             re_temp += ptr_mvdr->m_stv_re[k*ptr_mvdr->m_channels+i]*ptr_mvdr->m_weight_re[k*ptr_mvdr->m_channels+i]
@@ -578,20 +639,68 @@ int dios_ssp_mvdr_cal_weights_adpmvdr(objMVDR *ptr_mvdr)
     return 0;
 }
 
+int dios_ssp_mvdr_update_weights(objMVDR *ptr_mvdr)
+{
+    int i, k;
+    int bin_num = ptr_mvdr->m_sp_size - 1;
+    float power = 0;
+
+    if ( ptr_mvdr->m_inv_mode == MVDR_RNN_INV_RECURSIVE ) {
+        // the tracked inverse must see every frame even when no weight is refreshed
+        dios_ssp_mvdr_update_irnn(ptr_mvdr);
+    }
+
+    if ( ptr_mvdr->m_update_groups <= 1 ) {
+        dios_ssp_mvdr_cal_weights_adpmvdr(ptr_mvdr, 1, bin_num);
+        ptr_mvdr->m_update_bins = bin_num;
+        return 0;
+    }
+
+    // total noise power, a jump means the noise field moved and all weights are stale
+    for (k = 1; k < ptr_mvdr->m_sp_size; k++) {
+        for (i = 0; i < ptr_mvdr->m_channels; i++) {
+            power += ptr_mvdr->m_rnn_re[k*ptr_mvdr->m_rxx_size+i*ptr_mvdr->m_channels+i];
+        }
+    }
+    if ( fabsf(power - ptr_mvdr->m_update_power) > ptr_mvdr->m_update_thres*ptr_mvdr->m_update_power ) {
+        ptr_mvdr->m_update_full = 1;
+    }
+
+    if ( ptr_mvdr->m_update_full ) {
+        dios_ssp_mvdr_cal_weights_adpmvdr(ptr_mvdr, 1, bin_num);
+        ptr_mvdr->m_update_bins = bin_num;
+        ptr_mvdr->m_update_power = power;
+        ptr_mvdr->m_update_full = 0;
+        ptr_mvdr->m_update_group = 0;
+        return 0;
+    }
+
+    // one contiguous group of bins per frame, in turn
+    int group_len = (bin_num + ptr_mvdr->m_update_groups - 1) / ptr_mvdr->m_update_groups;
+    int bin_start = 1 + ptr_mvdr->m_update_group*group_len;
+    if ( bin_start + group_len > ptr_mvdr->m_sp_size ) {
+        group_len = ptr_mvdr->m_sp_size - bin_start;
+    }
+    if ( group_len > 0 ) {
+        dios_ssp_mvdr_cal_weights_adpmvdr(ptr_mvdr, bin_start, group_len);
+    }
+    ptr_mvdr->m_update_bins = group_len > 0 ? group_len : 0;
+    ptr_mvdr->m_update_group = (ptr_mvdr->m_update_group + 1) % ptr_mvdr->m_update_groups;
+
+    return 0;
+}
+
 void dios_ssp_mvdr_delete(objMVDR *ptr_mvdr)
 {
     int ret = 0;
     dios_ssp_mvdr_win_delete(ptr_mvdr->mvdrwin);
-    free(ptr_mvdr->fft_out);
+    free(ptr_mvdr->mvdrwin);
+    free(ptr_mvdr->dist);
     free(ptr_mvdr->fft_in);
     ret = dios_ssp_share_rfft_uninit(ptr_mvdr->mvdr_fft);
     if (0 != ret) {
         ptr_mvdr->mvdr_fft = NULL;
     }
-    ret = dios_ssp_matrix_inv_delete(ptr_mvdr->mvdrinv);
-    if (0 != ret) {
-        ptr_mvdr->mvdrinv = NULL;
-    }
     dios_ssp_mvdr_free_mem(ptr_mvdr);
 }
 
@@ -98,6 +98,9 @@ int dios_ssp_mvdr_win_add_syn_win(objMVDRCwin *mvdrwin, const float *x, float *x
 
 int dios_ssp_mvdr_win_delete(objMVDRCwin *mvdrwin)
 {
+    if (NULL == mvdrwin) {
+        return -1;
+    }
     free(mvdrwin->m_ana_win);
     free(mvdrwin->m_syn_win);
     free(mvdrwin->m_norm_win);
@@ -83,17 +83,15 @@ static float first_modified_Bessel( int n, float x )
 
 typedef struct {
     int frame_len;
-    int m_wav_len2;
     int m_buffer_len;
-    int m_max_pack_len;
     float *m_out_mmse_data;
 
     //mmse_process
     int m_shift_size;
     int m_fft_size;
     int m_frame_sum;
-    float *m_wav_buffer;
-    float *m_out_buffer;
+    objRingBuf *m_wav_ring;
+    objOlaBuf *m_out_ola;
     float *m_win_wav;
     float* m_re;
     float* m_im;
@@ -160,16 +158,14 @@ void* dios_ssp_ns_init_api(int frame_len)
     objNSMMSE* srv = (objNSMMSE*)ptr;
 
     srv->frame_len = frame_len;
-    srv->m_wav_len2 = 0;
     srv->m_buffer_len = 5120;
-    srv->m_max_pack_len = NS_SAMPLE_RATE + 512;
     srv->m_out_mmse_data = (float *)calloc(2 * srv->frame_len, sizeof(float));
 
     srv->m_shift_size = NS_FFT_LEN / 2;
     srv->m_fft_size  = NS_FFT_LEN;
     srv->m_frame_sum = 0;
-    srv->m_wav_buffer = (float *)calloc(srv->m_max_pack_len, sizeof(float));
-    srv->m_out_buffer = (float *)calloc(srv->m_max_pack_len, sizeof(float));
+    srv->m_wav_ring = dios_ssp_share_ringbuf_init(srv->m_fft_size + srv->frame_len);
+    srv->m_out_ola = dios_ssp_share_ola_init(srv->m_fft_size + srv->frame_len);
     srv->m_win_wav = (float *)calloc(srv->m_fft_size, sizeof(float));
     srv->m_re = (float *)calloc(srv->m_fft_size, sizeof(float));
     srv->m_im = (float *)calloc(srv->m_fft_size, sizeof(float));
@@ -240,17 +236,13 @@ int dios_ssp_ns_reset_api(void* ptr)
 
     m_block_num = srv->m_fft_size / srv->m_shift_size;
 
-    srv->m_wav_len2 = 0;
-
     for (j = 0; j <2 * srv->frame_len; j++)	{
         srv->m_out_mmse_data[j] = 0.0;
     }
 
     srv->m_frame_sum = 0;
-    for (j = 0; j <srv->m_max_pack_len; j++) {
-        srv->m_wav_buffer[j] = 0.0;
-        srv->m_out_buffer[j] = 0.0;
-    }
+    dios_ssp_share_ringbuf_reset(srv->m_wav_ring, 0);
+    dios_ssp_share_ola_reset(srv->m_out_ola);
     for (j = 0; j <srv->m_fft_size; j++) {
         srv->m_win_wav[j] = 0.0;
         srv->m_re[j] = 0.0;
@@ -261,7 +253,7 @@ int dios_ssp_ns_reset_api(void* ptr)
     for (j = 0; j <srv->m_fft_size; j++) {
         srv->m_norm_win[j] = srv->m_ana_win[j] * srv->m_ana_win[j];
     }
-    for (i = 0; i <srv->m_fft_size; i++) {
+    for (i = 0; i < srv->m_shift_size; i++) {
         temp = 0;
         for (j = 0; j < m_block_num; ++j ) {
             temp += srv->m_norm_win[i+j*srv->m_shift_size];
@@ -335,7 +327,7 @@ int dios_ssp_ns_reset_api(void* ptr)
     return 0;
 }
 
-void add_ana_win(objNSMMSE* srv, float *x, float *x_win )
+void add_ana_win(objNSMMSE* srv, const float *x, float *x_win )
 {
     int i;
     for (i = 0; i < srv->m_fft_size; ++i ) {
@@ -500,17 +492,14 @@ int mmse_process(objNSMMSE* srv, float *in_data, float *out_data)
     int i;
 
     // input
-    for (i = 0 ; i < srv->frame_len; ++i ) {
-        srv->m_wav_buffer[i+srv->m_wav_len2] = in_data[i];
-    }
+    dios_ssp_share_ringbuf_write(srv->m_wav_ring, in_data, srv->frame_len);
 
-    srv->m_wav_len2 += srv->frame_len;
     // mmse gain
     int sta;
-    for ( sta = 0; sta + srv->m_fft_size <= srv->m_wav_len2; sta += srv->m_shift_size ) {
+    for ( sta = 0; sta + srv->m_fft_size <= srv->m_wav_ring->count; sta += srv->m_shift_size ) {
         srv->m_frame_sum ++;
         // 1. add anaylsis window
-        add_ana_win(srv, srv->m_wav_buffer+sta, srv->m_win_wav);
+        add_ana_win(srv, dios_ssp_share_ringbuf_window(srv->m_wav_ring, sta), srv->m_win_wav);
 
         // 2. stft
         dios_ssp_share_rfft_process(srv->rfft_param, srv->m_win_wav, srv->fft_out);
@@ -543,25 +532,19 @@ int mmse_process(objNSMMSE* srv, float *in_data, float *out_data)
         // 6. add synthesis window
         add_syn_win(srv, srv->m_win_wav, srv->m_re);
         // 7. ola
-        for (i = 0; i < srv->m_fft_size; ++i ) {
-            srv->m_out_buffer[i+sta] += srv->m_re[i];
-        }
+        dios_ssp_share_ola_add(srv->m_out_ola, sta, srv->m_re, srv->m_fft_size);
     }
 
+    dios_ssp_share_ola_pop(srv->m_out_ola, out_data, sta);
     for (i = 0; i < sta; ++i ) {
-        if ( srv->m_out_buffer[i] > 32767 ) {
+        if ( out_data[i] > 32767 ) {
             out_data[i] = 32767;
-        } else if ( srv->m_out_buffer[i] < -32768 ) {
+        } else if ( out_data[i] < -32768 ) {
             out_data[i] = -32768;
-        } else {
-            out_data[i] = srv->m_out_buffer[i];
         }
     }
 
-    memmove( srv->m_out_buffer, srv->m_out_buffer+sta, sizeof(float)*(srv->m_fft_size-srv->m_shift_size) );
-    memset( srv->m_out_buffer+srv->m_fft_size-srv->m_shift_size, 0, sizeof(float)*sta );
-    memmove( srv->m_wav_buffer, srv->m_wav_buffer+sta, sizeof(float)*(srv->m_wav_len2-sta) );
-    srv->m_wav_len2 -= sta;
+    dios_ssp_share_ringbuf_consume(srv->m_wav_ring, sta);
 
     return 0;
 }
@@ -593,8 +576,8 @@ int dios_ssp_ns_uninit_api(void* ptr)
     objNSMMSE *srv = (objNSMMSE *)ptr;
 
     free(srv->m_out_mmse_data);
-    free(srv->m_wav_buffer);
-    free(srv->m_out_buffer);
+    dios_ssp_share_ringbuf_uninit(srv->m_wav_ring);
+    dios_ssp_share_ola_uninit(srv->m_out_ola);
     free(srv->m_win_wav);
     free(srv->m_re);
     free(srv->m_im);
@@ -0,0 +1,270 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Description: Batched solver for hermitian positive definite matrices, as the
+spatial covariances of MVDR and DOA are. Every bin of a frame is factored
+together with a Cholesky decomposition; the innermost loops run across the
+bins so they map onto SIMD lanes, and all workspace is allocated at init.
+==============================================================================*/
+
+#include "dios_ssp_share_hsolve.h"
+
+#define U_RE(hs, i, j)  ((hs)->u_re + ((i) * (hs)->dim + (j)) * (hs)->batch)
+#define U_IM(hs, i, j)  ((hs)->u_im + ((i) * (hs)->dim + (j)) * (hs)->batch)
+
+objHermSolve* dios_ssp_share_hsolve_init(int dim, int batch)
+{
+    if (dim <= 0 || batch <= 0) {
+        return NULL;
+    }
+
+    objHermSolve *hs = (objHermSolve *)calloc(1, sizeof(objHermSolve));
+    if (NULL == hs) {
+        return NULL;
+    }
+    hs->dim = dim;
+    hs->batch = batch;
+    hs->u_re = (float *)calloc(dim * dim * batch, sizeof(float));
+    hs->u_im = (float *)calloc(dim * dim * batch, sizeof(float));
+    hs->inv_diag = (float *)calloc(dim * batch, sizeof(float));
+    hs->load = (float *)calloc(batch, sizeof(float));
+    hs->y_re = (float *)calloc(dim * batch, sizeof(float));
+    hs->y_im = (float *)calloc(dim * batch, sizeof(float));
+    if (NULL == hs->u_re || NULL == hs->u_im || NULL == hs->inv_diag || NULL == hs->load
+        || NULL == hs->y_re || NULL == hs->y_im) {
+        dios_ssp_share_hsolve_uninit(hs);
+        return NULL;
+    }
+
+    return hs;
+}
+
+int dios_ssp_share_hsolve_factor(objHermSolve *hs, const float *r_re, const float *r_im,
+                                 int stride, int count, float loading)
+{
+    int i, j, k, b;
+    int clamped = 0;
+
+    if (NULL == hs || NULL == r_re || count <= 0 || count > hs->batch) {
+        return -1;
+    }
+    hs->count = count;
+
+    // gather the upper triangles, bin index innermost
+    for (i = 0; i < hs->dim; i++) {
+        for (j = i; j < hs->dim; j++) {
+            float *ur = U_RE(hs, i, j);
+            float *ui = U_IM(hs, i, j);
+            for (b = 0; b < count; b++) {
+                ur[b] = r_re[b * stride + i * hs->dim + j];
+            }
+            if (r_im && j > i) {
+                for (b = 0; b < count; b++) {
+                    ui[b] = r_im[b * stride + i * hs->dim + j];
+                }
+            } else {
+                for (b = 0; b < count; b++) {
+                    ui[b] = 0.0f;
+                }
+            }
+        }
+    }
+
+    for (b = 0; b < count; b++) {
+        hs->load[b] = 0.0f;
+    }
+    for (i = 0; i < hs->dim; i++) {
+        const float *ur = U_RE(hs, i, i);
+        for (b = 0; b < count; b++) {
+            hs->load[b] += ur[b];
+        }
+    }
+    for (b = 0; b < count; b++) {
+        // an all zero matrix has no scale to load against, solve it as identity
+        hs->load[b] = hs->load[b] > 0.0f ? hs->load[b] * loading / hs->dim : 1.0f;
+    }
+
+    // R = U^H * U, row i of U only depends on the rows above it
+    for (i = 0; i < hs->dim; i++) {
+        float *dr = U_RE(hs, i, i);
+        float *inv_d = hs->inv_diag + i * hs->batch;
+
+        for (b = 0; b < count; b++) {
+            dr[b] += hs->load[b];
+        }
+        for (k = 0; k < i; k++) {
+            const float *kr = U_RE(hs, k, i);
+            const float *ki = U_IM(hs, k, i);
+            for (b = 0; b < count; b++) {
+                dr[b] -= kr[b] * kr[b] + ki[b] * ki[b];
+            }
+        }
+        // with the loading added every pivot is at least load in exact
+        // arithmetic, anything below is rounding on a rank deficient matrix
+        for (b = 0; b < count; b++) {
+            float min_pivot = hs->load[b] > HSOLVE_MIN_PIVOT ? hs->load[b] : HSOLVE_MIN_PIVOT;
+            if (!(dr[b] > min_pivot)) {
+                dr[b] = min_pivot;
+                clamped++;
+            }
+            dr[b] = sqrtf(dr[b]);
+            inv_d[b] = 1.0f / dr[b];
+        }
+
+        for (j = i + 1; j < hs->dim; j++) {
+            float *ur = U_RE(hs, i, j);
+            float *ui = U_IM(hs, i, j);
+            for (k = 0; k < i; k++) {
+                const float *kir = U_RE(hs, k, i);
+                const float *kii = U_IM(hs, k, i);
+                const float *kjr = U_RE(hs, k, j);
+                const float *kji = U_IM(hs, k, j);
+                // u(i, j) -= conj(u(k, i)) * u(k, j)
+                for (b = 0; b < count; b++) {
+                    ur[b] -= kir[b] * kjr[b] + kii[b] * kji[b];
+                    ui[b] -= kir[b] * kji[b] - kii[b] * kjr[b];
+                }
+            }
+            for (b = 0; b < count; b++) {
+                ur[b] *= inv_d[b];
+                ui[b] *= inv_d[b];
+            }
+        }
+    }
+
+    return clamped;
+}
+
+/* U^H * y = y and U * y = y in place on the workspace vectors */
+static void hsolve_substitute(objHermSolve *hs)
+{
+    int i, k, b;
+    int count = hs->count;
+
+    for (i = 0; i < hs->dim; i++) {
+        float *yr = hs->y_re + i * hs->batch;
+        float *yi = hs->y_im + i * hs->batch;
+        const float *inv_d = hs->inv_diag + i * hs->batch;
+        for (k = 0; k < i; k++) {
+            const float *ur = U_RE(hs, k, i);
+            const float *ui = U_IM(hs, k, i);
+            const float *xr = hs->y_re + k * hs->batch;
+            const float *xi = hs->y_im + k * hs->batch;
+            // y(i) -= conj(u(k, i)) * y(k)
+            for (b = 0; b < count; b++) {
+                yr[b] -= ur[b] * xr[b] + ui[b] * xi[b];
+                yi[b] -= ur[b] * xi[b] - ui[b] * xr[b];
+            }
+        }
+        for (b = 0; b < count; b++) {
+            yr[b] *= inv_d[b];
+            yi[b] *= inv_d[b];
+        }
+    }
+
+    for (i = hs->dim - 1; i >= 0; i--) {
+        float *yr = hs->y_re + i * hs->batch;
+        float *yi = hs->y_im + i * hs->batch;
+        const float *inv_d = hs->inv_diag + i * hs->batch;
+        for (k = i + 1; k < hs->dim; k++) {
+            const float *ur = U_RE(hs, i, k);
+            const float *ui = U_IM(hs, i, k);
+            const float *xr = hs->y_re + k * hs->batch;
+            const float *xi = hs->y_im + k * hs->batch;
+            // y(i) -= u(i, k) * y(k)
+            for (b = 0; b < count; b++) {
+                yr[b] -= ur[b] * xr[b] - ui[b] * xi[b];
+                yi[b] -= ur[b] * xi[b] + ui[b] * xr[b];
+            }
+        }
+        for (b = 0; b < count; b++) {
+            yr[b] *= inv_d[b];
+            yi[b] *= inv_d[b];
+        }
+    }
+}
+
+int dios_ssp_share_hsolve_solve(objHermSolve *hs, const float *b_re, const float *b_im,
+                                float *x_re, float *x_im, int stride)
+{
+    int i, b;
+
+    if (NULL == hs || NULL == b_re || NULL == b_im || NULL == x_re || NULL == x_im
+        || hs->count <= 0) {
+        return -1;
+    }
+
+    for (i = 0; i < hs->dim; i++) {
+        for (b = 0; b < hs->count; b++) {
+            hs->y_re[i * hs->batch + b] = b_re[b * stride + i];
+            hs->y_im[i * hs->batch + b] = b_im[b * stride + i];
+        }
+    }
+    hsolve_substitute(hs);
+    for (i = 0; i < hs->dim; i++) {
+        for (b = 0; b < hs->count; b++) {
+            x_re[b * stride + i] = hs->y_re[i * hs->batch + b];
+            x_im[b * stride + i] = hs->y_im[i * hs->batch + b];
+        }
+    }
+
+    return 0;
+}
+
+int dios_ssp_share_hsolve_inverse(objHermSolve *hs, float *inv_re, float *inv_im, int stride)
+{
+    int i, j, b;
+
+    if (NULL == hs || NULL == inv_re || NULL == inv_im || hs->count <= 0) {
+        return -1;
+    }
+
+    // one unit vector per column
+    for (j = 0; j < hs->dim; j++) {
+        for (i = 0; i < hs->dim; i++) {
+            float e = (i == j) ? 1.0f : 0.0f;
+            for (b = 0; b < hs->count; b++) {
+                hs->y_re[i * hs->batch + b] = e;
+                hs->y_im[i * hs->batch + b] = 0.0f;
+            }
+        }
+        hsolve_substitute(hs);
+        for (i = 0; i < hs->dim; i++) {
+            for (b = 0; b < hs->count; b++) {
+                inv_re[b * stride + i * hs->dim + j] = hs->y_re[i * hs->batch + b];
+                inv_im[b * stride + i * hs->dim + j] = hs->y_im[i * hs->batch + b];
+            }
+        }
+    }
+
+    return 0;
+}
+
+int dios_ssp_share_hsolve_uninit(objHermSolve *hs)
+{
+    if (NULL == hs) {
+        return -1;
+    }
+
+    free(hs->u_re);
+    free(hs->u_im);
+    free(hs->inv_diag);
+    free(hs->load);
+    free(hs->y_re);
+    free(hs->y_im);
+    free(hs);
+
+    return 0;
+}
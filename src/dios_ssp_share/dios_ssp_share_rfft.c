@@ -13,45 +13,577 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 
-Description: Basic operation: FFT and IFFT.
+Description: Basic operation: FFT and IFFT. A real fft of fft_len points is
+computed as a complex fft of fft_len/2 points on the interleaved even and odd
+samples followed by a split step. The complex fft works on separate real and
+imaginary arrays: the input is loaded through a precomputed bit-reversal
+table, then radix-4 (radix-2^2) decimation in time stages run with one
+contiguous twiddle table per stage, and a single radix-2 stage first when the
+number of stages is odd. Stages with at least 8 (AVX2) or 4 (NEON) butterflies
+per group use vector kernels. The batch transform interleaves 8 (AVX2) or 4
+(NEON) channels point by point, so every butterfly of every stage works on one
+vector of channels with broadcast twiddles. The tables live in a plan shared through a
+process-wide, reference counted cache keyed by fft length; a handle only owns
+its work buffers.
 ==============================================================================*/
 
 /* include file */
 #include "dios_ssp_share_rfft.h"
+#include "dios_ssp_share_simd.h"
+#include <pthread.h>
 
-typedef struct {
+#if defined(DIOS_SSP_HAVE_AVX2)
+#include <immintrin.h>
+#elif defined(DIOS_SSP_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+/* tables of one fft length, read only once built and shared by every handle of that length */
+typedef struct RfftPlan {
     int fft_len;
-    int Mq_max;
-    float *wr;
-    float *wi;
+    int half_len;       /* points of the complex fft */
+    int first_radix2;   /* 1: log2(half_len) is odd, run one radix-2 stage first */
+    int *bitrev;        /* bit-reversal permutation of half_len */
+    float *stage_tw;    /* per radix-4 stage with group length L: w1 = W(2L)^j, w2 = W(4L)^j, j < L, re then im */
+    float *split_wr;    /* W(fft_len)^k for the split step, k <= fft_len/4 */
+    float *split_wi;
+    int simd;
+    int ref_count;      /* handles using the plan, guarded by rfft_plan_lock */
+    struct RfftPlan *next;
+} RFFT_PLAN;
+
+typedef struct {
+    const RFFT_PLAN *plan;
+    float *work_re;
+    float *work_im;
+    int batch_lanes;    /* channels per batch pass, 0 without simd */
+    float *batch_re;    /* half_len * batch_lanes, allocated by dios_ssp_share_rfft_batch_init */
+    float *batch_im;
+    float *batch_nyq;
+    float *batch_out;   /* packed spectrum of a channel done alone */
 } RFFT_PARAM;
 
+/* process-wide plan cache keyed by fft length */
+static RFFT_PLAN *rfft_plan_list = NULL;
+static pthread_mutex_t rfft_plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void rfft_radix2_first(float *re, float *im, int n)
+{
+    int j;
+    float tr, ti;
+    for (j = 0; j < n; j += 2) {
+        tr = re[j + 1];
+        ti = im[j + 1];
+        re[j + 1] = re[j] - tr;
+        im[j + 1] = im[j] - ti;
+        re[j] += tr;
+        im[j] += ti;
+    }
+}
+
+static void rfft_radix4_stage_scalar(float *re, float *im, int n, int len, const float *tw)
+{
+    const float *w1r = tw;
+    const float *w1i = tw + len;
+    const float *w2r = tw + 2 * len;
+    const float *w2i = tw + 3 * len;
+    int b, j;
+    for (b = 0; b < n; b += 4 * len) {
+        float *ar = re + b, *ai = im + b;
+        float *br = ar + len, *bi = ai + len;
+        float *cr = br + len, *ci = bi + len;
+        float *dr = cr + len, *di = ci + len;
+        for (j = 0; j < len; j++) {
+            float xbr = br[j] * w1r[j] - bi[j] * w1i[j];
+            float xbi = br[j] * w1i[j] + bi[j] * w1r[j];
+            float xdr = dr[j] * w1r[j] - di[j] * w1i[j];
+            float xdi = dr[j] * w1i[j] + di[j] * w1r[j];
+            float s0r = ar[j] + xbr, s0i = ai[j] + xbi;
+            float s1r = ar[j] - xbr, s1i = ai[j] - xbi;
+            float d0r = cr[j] + xdr, d0i = ci[j] + xdi;
+            float d1r = cr[j] - xdr, d1i = ci[j] - xdi;
+            float t0r = d0r * w2r[j] - d0i * w2i[j];
+            float t0i = d0r * w2i[j] + d0i * w2r[j];
+            float t1r = d1r * w2r[j] - d1i * w2i[j];
+            float t1i = d1r * w2i[j] + d1i * w2r[j];
+            ar[j] = s0r + t0r;
+            ai[j] = s0i + t0i;
+            cr[j] = s0r - t0r;
+            ci[j] = s0i - t0i;
+            /* W(4L)^(j+L) = -i * W(4L)^j */
+            br[j] = s1r + t1i;
+            bi[j] = s1i - t1r;
+            dr[j] = s1r - t1i;
+            di[j] = s1i + t1r;
+        }
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static void rfft_radix4_stage_avx2(float *re, float *im, int n, int len, const float *tw)
+{
+    const float *w1r = tw;
+    const float *w1i = tw + len;
+    const float *w2r = tw + 2 * len;
+    const float *w2i = tw + 3 * len;
+    int b, j;
+    for (b = 0; b < n; b += 4 * len) {
+        float *ar = re + b, *ai = im + b;
+        float *br = ar + len, *bi = ai + len;
+        float *cr = br + len, *ci = bi + len;
+        float *dr = cr + len, *di = ci + len;
+        for (j = 0; j < len; j += 8) {
+            __m256 vw1r = _mm256_loadu_ps(w1r + j), vw1i = _mm256_loadu_ps(w1i + j);
+            __m256 vw2r = _mm256_loadu_ps(w2r + j), vw2i = _mm256_loadu_ps(w2i + j);
+            __m256 vbr = _mm256_loadu_ps(br + j), vbi = _mm256_loadu_ps(bi + j);
+            __m256 vdr = _mm256_loadu_ps(dr + j), vdi = _mm256_loadu_ps(di + j);
+            __m256 var = _mm256_loadu_ps(ar + j), vai = _mm256_loadu_ps(ai + j);
+            __m256 vcr = _mm256_loadu_ps(cr + j), vci = _mm256_loadu_ps(ci + j);
+            __m256 xbr = _mm256_sub_ps(_mm256_mul_ps(vbr, vw1r), _mm256_mul_ps(vbi, vw1i));
+            __m256 xbi = _mm256_add_ps(_mm256_mul_ps(vbr, vw1i), _mm256_mul_ps(vbi, vw1r));
+            __m256 xdr = _mm256_sub_ps(_mm256_mul_ps(vdr, vw1r), _mm256_mul_ps(vdi, vw1i));
+            __m256 xdi = _mm256_add_ps(_mm256_mul_ps(vdr, vw1i), _mm256_mul_ps(vdi, vw1r));
+            __m256 s0r = _mm256_add_ps(var, xbr), s0i = _mm256_add_ps(vai, xbi);
+            __m256 s1r = _mm256_sub_ps(var, xbr), s1i = _mm256_sub_ps(vai, xbi);
+            __m256 d0r = _mm256_add_ps(vcr, xdr), d0i = _mm256_add_ps(vci, xdi);
+            __m256 d1r = _mm256_sub_ps(vcr, xdr), d1i = _mm256_sub_ps(vci, xdi);
+            __m256 t0r = _mm256_sub_ps(_mm256_mul_ps(d0r, vw2r), _mm256_mul_ps(d0i, vw2i));
+            __m256 t0i = _mm256_add_ps(_mm256_mul_ps(d0r, vw2i), _mm256_mul_ps(d0i, vw2r));
+            __m256 t1r = _mm256_sub_ps(_mm256_mul_ps(d1r, vw2r), _mm256_mul_ps(d1i, vw2i));
+            __m256 t1i = _mm256_add_ps(_mm256_mul_ps(d1r, vw2i), _mm256_mul_ps(d1i, vw2r));
+            _mm256_storeu_ps(ar + j, _mm256_add_ps(s0r, t0r));
+            _mm256_storeu_ps(ai + j, _mm256_add_ps(s0i, t0i));
+            _mm256_storeu_ps(cr + j, _mm256_sub_ps(s0r, t0r));
+            _mm256_storeu_ps(ci + j, _mm256_sub_ps(s0i, t0i));
+            _mm256_storeu_ps(br + j, _mm256_add_ps(s1r, t1i));
+            _mm256_storeu_ps(bi + j, _mm256_sub_ps(s1i, t1r));
+            _mm256_storeu_ps(dr + j, _mm256_sub_ps(s1r, t1i));
+            _mm256_storeu_ps(di + j, _mm256_add_ps(s1i, t1r));
+        }
+    }
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static void rfft_radix4_stage_neon(float *re, float *im, int n, int len, const float *tw)
+{
+    const float *w1r = tw;
+    const float *w1i = tw + len;
+    const float *w2r = tw + 2 * len;
+    const float *w2i = tw + 3 * len;
+    int b, j;
+    for (b = 0; b < n; b += 4 * len) {
+        float *ar = re + b, *ai = im + b;
+        float *br = ar + len, *bi = ai + len;
+        float *cr = br + len, *ci = bi + len;
+        float *dr = cr + len, *di = ci + len;
+        for (j = 0; j < len; j += 4) {
+            float32x4_t vw1r = vld1q_f32(w1r + j), vw1i = vld1q_f32(w1i + j);
+            float32x4_t vw2r = vld1q_f32(w2r + j), vw2i = vld1q_f32(w2i + j);
+            float32x4_t vbr = vld1q_f32(br + j), vbi = vld1q_f32(bi + j);
+            float32x4_t vdr = vld1q_f32(dr + j), vdi = vld1q_f32(di + j);
+            float32x4_t var = vld1q_f32(ar + j), vai = vld1q_f32(ai + j);
+            float32x4_t vcr = vld1q_f32(cr + j), vci = vld1q_f32(ci + j);
+            float32x4_t xbr = vsubq_f32(vmulq_f32(vbr, vw1r), vmulq_f32(vbi, vw1i));
+            float32x4_t xbi = vaddq_f32(vmulq_f32(vbr, vw1i), vmulq_f32(vbi, vw1r));
+            float32x4_t xdr = vsubq_f32(vmulq_f32(vdr, vw1r), vmulq_f32(vdi, vw1i));
+            float32x4_t xdi = vaddq_f32(vmulq_f32(vdr, vw1i), vmulq_f32(vdi, vw1r));
+            float32x4_t s0r = vaddq_f32(var, xbr), s0i = vaddq_f32(vai, xbi);
+            float32x4_t s1r = vsubq_f32(var, xbr), s1i = vsubq_f32(vai, xbi);
+            float32x4_t d0r = vaddq_f32(vcr, xdr), d0i = vaddq_f32(vci, xdi);
+            float32x4_t d1r = vsubq_f32(vcr, xdr), d1i = vsubq_f32(vci, xdi);
+            float32x4_t t0r = vsubq_f32(vmulq_f32(d0r, vw2r), vmulq_f32(d0i, vw2i));
+            float32x4_t t0i = vaddq_f32(vmulq_f32(d0r, vw2i), vmulq_f32(d0i, vw2r));
+            float32x4_t t1r = vsubq_f32(vmulq_f32(d1r, vw2r), vmulq_f32(d1i, vw2i));
+            float32x4_t t1i = vaddq_f32(vmulq_f32(d1r, vw2i), vmulq_f32(d1i, vw2r));
+            vst1q_f32(ar + j, vaddq_f32(s0r, t0r));
+            vst1q_f32(ai + j, vaddq_f32(s0i, t0i));
+            vst1q_f32(cr + j, vsubq_f32(s0r, t0r));
+            vst1q_f32(ci + j, vsubq_f32(s0i, t0i));
+            vst1q_f32(br + j, vaddq_f32(s1r, t1i));
+            vst1q_f32(bi + j, vsubq_f32(s1i, t1r));
+            vst1q_f32(dr + j, vsubq_f32(s1r, t1i));
+            vst1q_f32(di + j, vaddq_f32(s1i, t1r));
+        }
+    }
+}
+#endif
+
+/* forward complex fft of the bit-reversed work arrays, in place */
+static void rfft_complex(const RFFT_PLAN *plan, float *re, float *im)
+{
+    int n = plan->half_len;
+    const float *tw = plan->stage_tw;
+    int len = 1;
+
+    if (plan->first_radix2) {
+        rfft_radix2_first(re, im, n);
+        len = 2;
+    }
+    for (; len < n; len <<= 2) {
+#if defined(DIOS_SSP_HAVE_AVX2)
+        if (len >= 8 && DIOS_SSP_SIMD_AVX2 == plan->simd) {
+            rfft_radix4_stage_avx2(re, im, n, len, tw);
+            tw += 4 * len;
+            continue;
+        }
+#elif defined(DIOS_SSP_HAVE_NEON)
+        if (len >= 4) {
+            rfft_radix4_stage_neon(re, im, n, len, tw);
+            tw += 4 * len;
+            continue;
+        }
+#endif
+        rfft_radix4_stage_scalar(re, im, n, len, tw);
+        tw += 4 * len;
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+/* channel-interleaved transform: point p of lane l at re[p * 8 + l], the input
+   bit-reversed; runs the stages and the split step of rfft_complex and
+   dios_ssp_share_rfft_process for 8 channels at once. In place re/im[k] end as
+   X[k] for k < half and nyq as the real X[half] */
+__attribute__((target("avx2")))
+static void rfft_batch_avx2(const RFFT_PLAN *plan, float *re, float *im, float *nyq)
+{
+    int n = plan->half_len;
+    const float *tw = plan->stage_tw;
+    int len = 1;
+    int b, j, k;
+
+    if (plan->first_radix2) {
+        for (j = 0; j < n; j += 2) {
+            __m256 ar = _mm256_loadu_ps(re + j * 8), ai = _mm256_loadu_ps(im + j * 8);
+            __m256 br = _mm256_loadu_ps(re + j * 8 + 8), bi = _mm256_loadu_ps(im + j * 8 + 8);
+            _mm256_storeu_ps(re + j * 8 + 8, _mm256_sub_ps(ar, br));
+            _mm256_storeu_ps(im + j * 8 + 8, _mm256_sub_ps(ai, bi));
+            _mm256_storeu_ps(re + j * 8, _mm256_add_ps(ar, br));
+            _mm256_storeu_ps(im + j * 8, _mm256_add_ps(ai, bi));
+        }
+        len = 2;
+    }
+    for (; len < n; len <<= 2) {
+        for (b = 0; b < n; b += 4 * len) {
+            for (j = 0; j < len; j++) {
+                float *ar = re + (b + j) * 8, *ai = im + (b + j) * 8;
+                float *br = ar + len * 8, *bi = ai + len * 8;
+                float *cr = br + len * 8, *ci = bi + len * 8;
+                float *dr = cr + len * 8, *di = ci + len * 8;
+                __m256 vw1r = _mm256_set1_ps(tw[j]), vw1i = _mm256_set1_ps(tw[len + j]);
+                __m256 vw2r = _mm256_set1_ps(tw[2 * len + j]), vw2i = _mm256_set1_ps(tw[3 * len + j]);
+                __m256 vbr = _mm256_loadu_ps(br), vbi = _mm256_loadu_ps(bi);
+                __m256 vdr = _mm256_loadu_ps(dr), vdi = _mm256_loadu_ps(di);
+                __m256 var = _mm256_loadu_ps(ar), vai = _mm256_loadu_ps(ai);
+                __m256 vcr = _mm256_loadu_ps(cr), vci = _mm256_loadu_ps(ci);
+                __m256 xbr = _mm256_sub_ps(_mm256_mul_ps(vbr, vw1r), _mm256_mul_ps(vbi, vw1i));
+                __m256 xbi = _mm256_add_ps(_mm256_mul_ps(vbr, vw1i), _mm256_mul_ps(vbi, vw1r));
+                __m256 xdr = _mm256_sub_ps(_mm256_mul_ps(vdr, vw1r), _mm256_mul_ps(vdi, vw1i));
+                __m256 xdi = _mm256_add_ps(_mm256_mul_ps(vdr, vw1i), _mm256_mul_ps(vdi, vw1r));
+                __m256 s0r = _mm256_add_ps(var, xbr), s0i = _mm256_add_ps(vai, xbi);
+                __m256 s1r = _mm256_sub_ps(var, xbr), s1i = _mm256_sub_ps(vai, xbi);
+                __m256 d0r = _mm256_add_ps(vcr, xdr), d0i = _mm256_add_ps(vci, xdi);
+                __m256 d1r = _mm256_sub_ps(vcr, xdr), d1i = _mm256_sub_ps(vci, xdi);
+                __m256 t0r = _mm256_sub_ps(_mm256_mul_ps(d0r, vw2r), _mm256_mul_ps(d0i, vw2i));
+                __m256 t0i = _mm256_add_ps(_mm256_mul_ps(d0r, vw2i), _mm256_mul_ps(d0i, vw2r));
+                __m256 t1r = _mm256_sub_ps(_mm256_mul_ps(d1r, vw2r), _mm256_mul_ps(d1i, vw2i));
+                __m256 t1i = _mm256_add_ps(_mm256_mul_ps(d1r, vw2i), _mm256_mul_ps(d1i, vw2r));
+                _mm256_storeu_ps(ar, _mm256_add_ps(s0r, t0r));
+                _mm256_storeu_ps(ai, _mm256_add_ps(s0i, t0i));
+                _mm256_storeu_ps(cr, _mm256_sub_ps(s0r, t0r));
+                _mm256_storeu_ps(ci, _mm256_sub_ps(s0i, t0i));
+                _mm256_storeu_ps(br, _mm256_add_ps(s1r, t1i));
+                _mm256_storeu_ps(bi, _mm256_sub_ps(s1i, t1r));
+                _mm256_storeu_ps(dr, _mm256_sub_ps(s1r, t1i));
+                _mm256_storeu_ps(di, _mm256_add_ps(s1i, t1r));
+            }
+        }
+        tw += 4 * len;
+    }
+
+    __m256 half_c = _mm256_set1_ps(0.5f);
+    __m256 r0 = _mm256_loadu_ps(re), i0 = _mm256_loadu_ps(im);
+    _mm256_storeu_ps(re, _mm256_add_ps(r0, i0));
+    _mm256_storeu_ps(nyq, _mm256_sub_ps(r0, i0));
+    _mm256_storeu_ps(im, _mm256_setzero_ps());
+    for (k = 1; k <= n / 2; k++) {
+        float *pr = re + k * 8, *pi = im + k * 8;
+        float *qr = re + (n - k) * 8, *qi = im + (n - k) * 8;
+        __m256 zr = _mm256_loadu_ps(pr), zi = _mm256_loadu_ps(pi);
+        __m256 yr = _mm256_loadu_ps(qr), yi = _mm256_loadu_ps(qi);
+        __m256 wr = _mm256_set1_ps(plan->split_wr[k]), wi = _mm256_set1_ps(plan->split_wi[k]);
+        __m256 er = _mm256_mul_ps(half_c, _mm256_add_ps(zr, yr));
+        __m256 ei = _mm256_mul_ps(half_c, _mm256_sub_ps(zi, yi));
+        __m256 dr = _mm256_mul_ps(half_c, _mm256_sub_ps(zr, yr));
+        __m256 di = _mm256_mul_ps(half_c, _mm256_add_ps(zi, yi));
+        __m256 tr = _mm256_add_ps(_mm256_mul_ps(wr, di), _mm256_mul_ps(wi, dr));
+        __m256 ti = _mm256_sub_ps(_mm256_mul_ps(wi, di), _mm256_mul_ps(wr, dr));
+        _mm256_storeu_ps(pr, _mm256_add_ps(er, tr));
+        _mm256_storeu_ps(pi, _mm256_add_ps(ei, ti));
+        _mm256_storeu_ps(qr, _mm256_sub_ps(er, tr));
+        _mm256_storeu_ps(qi, _mm256_sub_ps(ti, ei));
+    }
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+/* 4-lane counterpart of rfft_batch_avx2 */
+static void rfft_batch_neon(const RFFT_PLAN *plan, float *re, float *im, float *nyq)
+{
+    int n = plan->half_len;
+    const float *tw = plan->stage_tw;
+    int len = 1;
+    int b, j, k;
+
+    if (plan->first_radix2) {
+        for (j = 0; j < n; j += 2) {
+            float32x4_t ar = vld1q_f32(re + j * 4), ai = vld1q_f32(im + j * 4);
+            float32x4_t br = vld1q_f32(re + j * 4 + 4), bi = vld1q_f32(im + j * 4 + 4);
+            vst1q_f32(re + j * 4 + 4, vsubq_f32(ar, br));
+            vst1q_f32(im + j * 4 + 4, vsubq_f32(ai, bi));
+            vst1q_f32(re + j * 4, vaddq_f32(ar, br));
+            vst1q_f32(im + j * 4, vaddq_f32(ai, bi));
+        }
+        len = 2;
+    }
+    for (; len < n; len <<= 2) {
+        for (b = 0; b < n; b += 4 * len) {
+            for (j = 0; j < len; j++) {
+                float *ar = re + (b + j) * 4, *ai = im + (b + j) * 4;
+                float *br = ar + len * 4, *bi = ai + len * 4;
+                float *cr = br + len * 4, *ci = bi + len * 4;
+                float *dr = cr + len * 4, *di = ci + len * 4;
+                float32x4_t vw1r = vdupq_n_f32(tw[j]), vw1i = vdupq_n_f32(tw[len + j]);
+                float32x4_t vw2r = vdupq_n_f32(tw[2 * len + j]), vw2i = vdupq_n_f32(tw[3 * len + j]);
+                float32x4_t vbr = vld1q_f32(br), vbi = vld1q_f32(bi);
+                float32x4_t vdr = vld1q_f32(dr), vdi = vld1q_f32(di);
+                float32x4_t var = vld1q_f32(ar), vai = vld1q_f32(ai);
+                float32x4_t vcr = vld1q_f32(cr), vci = vld1q_f32(ci);
+                float32x4_t xbr = vsubq_f32(vmulq_f32(vbr, vw1r), vmulq_f32(vbi, vw1i));
+                float32x4_t xbi = vaddq_f32(vmulq_f32(vbr, vw1i), vmulq_f32(vbi, vw1r));
+                float32x4_t xdr = vsubq_f32(vmulq_f32(vdr, vw1r), vmulq_f32(vdi, vw1i));
+                float32x4_t xdi = vaddq_f32(vmulq_f32(vdr, vw1i), vmulq_f32(vdi, vw1r));
+                float32x4_t s0r = vaddq_f32(var, xbr), s0i = vaddq_f32(vai, xbi);
+                float32x4_t s1r = vsubq_f32(var, xbr), s1i = vsubq_f32(vai, xbi);
+                float32x4_t d0r = vaddq_f32(vcr, xdr), d0i = vaddq_f32(vci, xdi);
+                float32x4_t d1r = vsubq_f32(vcr, xdr), d1i = vsubq_f32(vci, xdi);
+                float32x4_t t0r = vsubq_f32(vmulq_f32(d0r, vw2r), vmulq_f32(d0i, vw2i));
+                float32x4_t t0i = vaddq_f32(vmulq_f32(d0r, vw2i), vmulq_f32(d0i, vw2r));
+                float32x4_t t1r = vsubq_f32(vmulq_f32(d1r, vw2r), vmulq_f32(d1i, vw2i));
+                float32x4_t t1i = vaddq_f32(vmulq_f32(d1r, vw2i), vmulq_f32(d1i, vw2r));
+                vst1q_f32(ar, vaddq_f32(s0r, t0r));
+                vst1q_f32(ai, vaddq_f32(s0i, t0i));
+                vst1q_f32(cr, vsubq_f32(s0r, t0r));
+                vst1q_f32(ci, vsubq_f32(s0i, t0i));
+                vst1q_f32(br, vaddq_f32(s1r, t1i));
+                vst1q_f32(bi, vsubq_f32(s1i, t1r));
+                vst1q_f32(dr, vsubq_f32(s1r, t1i));
+                vst1q_f32(di, vaddq_f32(s1i, t1r));
+            }
+        }
+        tw += 4 * len;
+    }
+
+    float32x4_t half_c = vdupq_n_f32(0.5f);
+    float32x4_t r0 = vld1q_f32(re), i0 = vld1q_f32(im);
+    vst1q_f32(re, vaddq_f32(r0, i0));
+    vst1q_f32(nyq, vsubq_f32(r0, i0));
+    vst1q_f32(im, vdupq_n_f32(0.0f));
+    for (k = 1; k <= n / 2; k++) {
+        float *pr = re + k * 4, *pi = im + k * 4;
+        float *qr = re + (n - k) * 4, *qi = im + (n - k) * 4;
+        float32x4_t zr = vld1q_f32(pr), zi = vld1q_f32(pi);
+        float32x4_t yr = vld1q_f32(qr), yi = vld1q_f32(qi);
+        float32x4_t wr = vdupq_n_f32(plan->split_wr[k]), wi = vdupq_n_f32(plan->split_wi[k]);
+        float32x4_t er = vmulq_f32(half_c, vaddq_f32(zr, yr));
+        float32x4_t ei = vmulq_f32(half_c, vsubq_f32(zi, yi));
+        float32x4_t dr = vmulq_f32(half_c, vsubq_f32(zr, yr));
+        float32x4_t di = vmulq_f32(half_c, vaddq_f32(zi, yi));
+        float32x4_t tr = vaddq_f32(vmulq_f32(wr, di), vmulq_f32(wi, dr));
+        float32x4_t ti = vsubq_f32(vmulq_f32(wi, di), vmulq_f32(wr, dr));
+        vst1q_f32(pr, vaddq_f32(er, tr));
+        vst1q_f32(pi, vaddq_f32(ei, ti));
+        vst1q_f32(qr, vsubq_f32(er, tr));
+        vst1q_f32(qi, vsubq_f32(ti, ei));
+    }
+}
+#endif
+
+static void rfft_plan_free(RFFT_PLAN *plan)
+{
+    free(plan->bitrev);
+    free(plan->stage_tw);
+    free(plan->split_wr);
+    free(plan->split_wi);
+    free(plan);
+}
+
+static RFFT_PLAN *rfft_plan_create(int fft_len)
+{
+    RFFT_PLAN *plan;
+    int i, j, bits, len, half, tw_size;
+
+    plan = (RFFT_PLAN*)calloc(1, sizeof(RFFT_PLAN));
+    if (NULL == plan) {
+        return NULL;
+    }
+    plan->fft_len = fft_len;
+    half = plan->half_len = fft_len / 2;
+    for (bits = 0; (1 << bits) < half; bits++) {
+    }
+    plan->first_radix2 = bits & 1;
+    tw_size = 0;
+    for (len = plan->first_radix2 ? 2 : 1; len < half; len <<= 2) {
+        tw_size += 4 * len;
+    }
+
+    plan->bitrev = (int *)calloc(half, sizeof(int));
+    plan->stage_tw = (float *)calloc(tw_size + 1, sizeof(float));
+    plan->split_wr = (float *)calloc(fft_len / 4 + 1, sizeof(float));
+    plan->split_wi = (float *)calloc(fft_len / 4 + 1, sizeof(float));
+    if (NULL == plan->bitrev || NULL == plan->stage_tw || NULL == plan->split_wr || NULL == plan->split_wi) {
+        rfft_plan_free(plan);
+        return NULL;
+    }
+
+    for (i = 0; i < half; i++) {
+        int r = 0;
+        for (j = 0; j < bits; j++) {
+            r |= ((i >> j) & 1) << (bits - 1 - j);
+        }
+        plan->bitrev[i] = r;
+    }
+
+    float *tw = plan->stage_tw;
+    for (len = plan->first_radix2 ? 2 : 1; len < half; len <<= 2) {
+        for (j = 0; j < len; j++) {
+            tw[j] = (float)cos(-PI * j / len);
+            tw[len + j] = (float)sin(-PI * j / len);
+            tw[2 * len + j] = (float)cos(-0.5 * PI * j / len);
+            tw[3 * len + j] = (float)sin(-0.5 * PI * j / len);
+        }
+        tw += 4 * len;
+    }
+    for (i = 0; i <= fft_len / 4; i++) {
+        plan->split_wr[i] = (float)cos(-2.0 * PI * i / fft_len);
+        plan->split_wi[i] = (float)sin(-2.0 * PI * i / fft_len);
+    }
+    plan->simd = dios_ssp_share_simd_level();
+
+    return plan;
+}
+
+/* get the cached plan of fft_len, building it on first use */
+static RFFT_PLAN *rfft_plan_acquire(int fft_len)
+{
+    RFFT_PLAN *plan;
+
+    pthread_mutex_lock(&rfft_plan_lock);
+    for (plan = rfft_plan_list; NULL != plan; plan = plan->next) {
+        if (plan->fft_len == fft_len) {
+            break;
+        }
+    }
+    if (NULL == plan) {
+        plan = rfft_plan_create(fft_len);
+        if (NULL != plan) {
+            plan->next = rfft_plan_list;
+            rfft_plan_list = plan;
+        }
+    }
+    if (NULL != plan) {
+        plan->ref_count++;
+    }
+    pthread_mutex_unlock(&rfft_plan_lock);
+
+    return plan;
+}
+
+static void rfft_plan_release(const RFFT_PLAN *plan)
+{
+    RFFT_PLAN **link;
+
+    pthread_mutex_lock(&rfft_plan_lock);
+    for (link = &rfft_plan_list; NULL != *link; link = &(*link)->next) {
+        if (*link == plan) {
+            RFFT_PLAN *found = *link;
+            if (--found->ref_count == 0) {
+                *link = found->next;
+                rfft_plan_free(found);
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&rfft_plan_lock);
+}
+
 void *dios_ssp_share_rfft_init(int fft_len)
 {
-    void *rfft_handle = NULL;
-    rfft_handle = (void*)calloc(1, sizeof(RFFT_PARAM));
     RFFT_PARAM *rfft_param;
-    rfft_param = (RFFT_PARAM*)rfft_handle;
-    int i = 0;
-    int j = 0;
-    rfft_param->fft_len = fft_len;
-    for (i = 1; (j =  i << 1) <= rfft_param->fft_len; i = j) {
-        rfft_param->Mq_max = i >> 1;
-    }
-    rfft_param->wi = (float *)calloc(rfft_param->Mq_max - 1, sizeof(float));
-    rfft_param->wr = (float *)calloc(rfft_param->Mq_max - 1, sizeof(float));
-    if (NULL == rfft_param->wi || NULL == rfft_param->wr) {
+
+    if (fft_len < 4 || (fft_len & (fft_len - 1)) != 0) {
+        puts("fft length must be a power of 2, at least 4.\n");
+        return NULL;
+    }
+    rfft_param = (RFFT_PARAM*)calloc(1, sizeof(RFFT_PARAM));
+    if (NULL == rfft_param) {
+        puts("Memory allocation error.\n");
+        return NULL;
+    }
+    rfft_param->plan = rfft_plan_acquire(fft_len);
+    rfft_param->work_re = (float *)calloc(fft_len / 2, sizeof(float));
+    rfft_param->work_im = (float *)calloc(fft_len / 2, sizeof(float));
+    if (NULL == rfft_param->plan || NULL == rfft_param->work_re || NULL == rfft_param->work_im) {
+        puts("Memory allocation error.\n");
+        dios_ssp_share_rfft_uninit(rfft_param);
+        return NULL;
+    }
+#if defined(DIOS_SSP_HAVE_AVX2)
+    rfft_param->batch_lanes = DIOS_SSP_SIMD_AVX2 == rfft_param->plan->simd ? 8 : 0;
+#elif defined(DIOS_SSP_HAVE_NEON)
+    rfft_param->batch_lanes = 4;
+#endif
+
+    return(rfft_param);
+}
+
+void *dios_ssp_share_rfft_batch_init(int fft_len)
+{
+    RFFT_PARAM *rfft_param;
+    int lanes;
+
+    rfft_param = (RFFT_PARAM*)dios_ssp_share_rfft_init(fft_len);
+    if (NULL == rfft_param) {
+        return NULL;
+    }
+    lanes = rfft_param->batch_lanes > 0 ? rfft_param->batch_lanes : 1;
+    rfft_param->batch_re = (float *)calloc(rfft_param->plan->half_len * lanes, sizeof(float));
+    rfft_param->batch_im = (float *)calloc(rfft_param->plan->half_len * lanes, sizeof(float));
+    rfft_param->batch_nyq = (float *)calloc(lanes, sizeof(float));
+    rfft_param->batch_out = (float *)calloc(fft_len, sizeof(float));
+    if (NULL == rfft_param->batch_re || NULL == rfft_param->batch_im
+        || NULL == rfft_param->batch_nyq || NULL == rfft_param->batch_out) {
         puts("Memory allocation error.\n");
+        dios_ssp_share_rfft_uninit(rfft_param);
         return NULL;
     }
 
-    float theta = 0;
-    theta = (float)(-2.0f * PI / rfft_param->fft_len);
-    for (i = 1; i < rfft_param->Mq_max; i++) {
-        rfft_param->wr[i - 1] = (float)cos(theta * i);
-        rfft_param->wi[i - 1] = (float)sin(theta * i);
+    return(rfft_param);
+}
+
+int dios_ssp_share_rfft_plan_count(void)
+{
+    const RFFT_PLAN *plan;
+    int count = 0;
+
+    pthread_mutex_lock(&rfft_plan_lock);
+    for (plan = rfft_plan_list; NULL != plan; plan = plan->next) {
+        count++;
     }
-    return(rfft_handle);
+    pthread_mutex_unlock(&rfft_plan_lock);
+
+    return count;
 }
 
 int dios_ssp_share_rfft_process(void *rfft_handle, float *inbuffer, float *outbuffer)
@@ -61,63 +593,36 @@ int dios_ssp_share_rfft_process(void *rfft_handle, float *inbuffer, float *outbu
     }
     RFFT_PARAM *rfft_param;
     rfft_param = (RFFT_PARAM*)rfft_handle;
-    int m = 0;
-    int mh = 0;
-    int mq = 0;
-    int i = 0;
-    int j = 0;
-    int k = 0;
-    int jr = 0;
-    int ji = 0;
-    int kr = 0;
-    int ki = 0;
-    int fft_len = rfft_param->fft_len;
-    float xr = 0;
-    float xi = 0;
-
-    for (i = 0; i < fft_len; i++) {
-        outbuffer[i] = inbuffer[i];
-    }
-    i = 0;
-    for (j = 1; j < fft_len - 1; j++) {
-        for (k = fft_len >> 1; k > (i ^= k); k >>= 1) {
-        }
-        if (j < i) {
-            xr = outbuffer[j];
-            outbuffer[j] = outbuffer[i];
-            outbuffer[i] = xr;
-        }
-    }
-
-    for (mh = 1; (m = mh << 1) <= fft_len; mh = m) {
-        mq = mh >> 1;
-
-        /* ---- real to real butterflies (W == 1) ---- */
-        for (jr = 0; jr < fft_len; jr += m) {
-            kr = jr + mh;
-            xr = outbuffer[kr];
-            outbuffer[kr] = outbuffer[jr] - xr;
-            outbuffer[jr] += xr;
-        }
-
-        /* ---- complex to complex butterflies (W != 1) ---- */
-        for (i = 1; i < mq; i++) {
-            for (j = 0; j < fft_len; j += m) {
-                jr = j + i;
-                ji = j + mh - i;
-                kr = j + mh + i;
-                ki = j + m - i;
-                xr = rfft_param->wr[rfft_param->Mq_max / mq * i - 1] * outbuffer[kr] +
-                     rfft_param->wi[rfft_param->Mq_max / mq * i - 1] * outbuffer[ki];
-                xi = rfft_param->wr[rfft_param->Mq_max / mq * i - 1] * outbuffer[ki] -
-                     rfft_param->wi[rfft_param->Mq_max / mq * i - 1] * outbuffer[kr];
-                outbuffer[kr] = -outbuffer[ji] + xi;
-                outbuffer[ki] = outbuffer[ji] + xi;
-                outbuffer[ji] = outbuffer[jr] - xr;
-                outbuffer[jr] = outbuffer[jr] + xr;
-            }
-        }
-        /* ---- real to complex butterflies are trivial ---- */
+    const RFFT_PLAN *plan = rfft_param->plan;
+    int fft_len = plan->fft_len;
+    int half = plan->half_len;
+    float *re = rfft_param->work_re;
+    float *im = rfft_param->work_im;
+    int k;
+
+    /* z[n] = x[2n] + j * x[2n+1], loaded in bit-reversed order */
+    for (k = 0; k < half; k++) {
+        re[plan->bitrev[k]] = inbuffer[2 * k];
+        im[plan->bitrev[k]] = inbuffer[2 * k + 1];
+    }
+    rfft_complex(plan, re, im);
+
+    /* X[k] = E[k] + W^k * O[k], X[half-k] = conj(E[k] - W^k * O[k]),
+       E = (Z[k] + conj(Z[half-k])) / 2, O = -j * (Z[k] - conj(Z[half-k])) / 2;
+       out[k] = Re(X[k]), out[fft_len-k] = -Im(X[k]) */
+    outbuffer[0] = re[0] + im[0];
+    outbuffer[half] = re[0] - im[0];
+    for (k = 1; k <= half / 2; k++) {
+        float er = 0.5f * (re[k] + re[half - k]);
+        float ei = 0.5f * (im[k] - im[half - k]);
+        float dr = 0.5f * (re[k] - re[half - k]);
+        float di = 0.5f * (im[k] + im[half - k]);
+        float tr = plan->split_wr[k] * di + plan->split_wi[k] * dr;
+        float ti = plan->split_wi[k] * di - plan->split_wr[k] * dr;
+        outbuffer[k] = er + tr;
+        outbuffer[fft_len - k] = -(ei + ti);
+        outbuffer[half - k] = er - tr;
+        outbuffer[half + k] = ei - ti;
     }
     return 0;
 }
@@ -129,72 +634,108 @@ int dios_ssp_share_irfft_process(void *rfft_handle, float *inbuffer, float *outb
     }
     RFFT_PARAM *rfft_param;
     rfft_param = (RFFT_PARAM*)rfft_handle;
-    int m = 0;
-    int mh = 0;
-    int mq = 0;
-    int i = 0;
-    int j = 0;
-    int k = 0;
-    int jr = 0;
-    int ji = 0;
-    int kr = 0;
-    int ki = 0;
-    int fft_len = rfft_param->fft_len;
-    float xr = 0;
-    float xi = 0;
-
-    for (i = 0; i < fft_len; i++) {
-        outbuffer[i] = inbuffer[i];
-    }
-    outbuffer[0] *= 0.5;
-    outbuffer[fft_len / 2] *= 0.5;
-
-    for (m = fft_len; (mh = m >> 1) >= 1; m = mh) {
-        mq = mh >> 1;
-
-        /* ---- real to real butterflies (W == 1) ---- */
-        for (jr = 0; jr < fft_len; jr += m) {
-            kr = jr + mh;
-            xr = outbuffer[jr] - outbuffer[kr];
-            outbuffer[jr] += outbuffer[kr];
-            outbuffer[kr] = xr;
-        }
-
-        /* ---- complex to complex butterflies (W != 1) ---- */
-        for (i = 1; i < mq; i++) {
-            for (j = 0; j < fft_len; j += m) {
-                jr = j + i;
-                ji = j + mh - i;
-                kr = j + mh + i;
-                ki = j + m - i;
-                xr = outbuffer[jr] - outbuffer[ji];
-                xi = outbuffer[ki] + outbuffer[kr];
-                outbuffer[jr] = outbuffer[jr] + outbuffer[ji];
-                outbuffer[ji] = outbuffer[ki] - outbuffer[kr];
-                outbuffer[kr] = rfft_param->wr[rfft_param->Mq_max / mq * i - 1] * xr -
-                                rfft_param->wi[rfft_param->Mq_max / mq * i - 1] * xi;
-                outbuffer[ki] = rfft_param->wr[rfft_param->Mq_max / mq * i - 1] * xi +
-                                rfft_param->wi[rfft_param->Mq_max / mq * i - 1] * xr;
-            }
-        }
-        /* ---- complex to real butterflies are trivial ---- */
+    const RFFT_PLAN *plan = rfft_param->plan;
+    int fft_len = plan->fft_len;
+    int half = plan->half_len;
+    float *re = rfft_param->work_re;
+    float *im = rfft_param->work_im;
+    int k;
+
+    /* 2 * Z[k] = E[k] + j * O[k] with E = X[k] + conj(X[half-k]), O = W^-k * (X[k] - conj(X[half-k])),
+       the inverse runs the forward fft on conj(Z), loaded in bit-reversed order */
+    re[0] = inbuffer[0] + inbuffer[half];
+    im[0] = -(inbuffer[0] - inbuffer[half]);
+    for (k = 1; k <= half / 2; k++) {
+        float xr = inbuffer[k], xi = -inbuffer[fft_len - k];
+        float yr = inbuffer[half - k], yi = -inbuffer[half + k];
+        float er = xr + yr, ei = xi - yi;
+        float dr = xr - yr, di = xi + yi;
+        float or_ = plan->split_wr[k] * dr + plan->split_wi[k] * di;
+        float oi = plan->split_wr[k] * di - plan->split_wi[k] * dr;
+        re[plan->bitrev[k]] = er - oi;
+        im[plan->bitrev[k]] = -(ei + or_);
+        re[plan->bitrev[half - k]] = er + oi;
+        im[plan->bitrev[half - k]] = -(or_ - ei);
+    }
+    rfft_complex(plan, re, im);
+
+    /* scaled like the former transform: irfft(rfft(x)) = fft_len * x */
+    for (k = 0; k < half; k++) {
+        outbuffer[2 * k] = re[k];
+        outbuffer[2 * k + 1] = -im[k];
+    }
+    return 0;
+}
+
+int dios_ssp_share_rfft_batch_process(void *rfft_handle, float **inbuffer, int channels,
+                                      float **out_re, float **out_im, int out_step)
+{
+    if (NULL == rfft_handle || NULL == inbuffer || NULL == out_re || NULL == out_im || channels < 0) {
+        return -1;
+    }
+    RFFT_PARAM *rfft_param;
+    rfft_param = (RFFT_PARAM*)rfft_handle;
+    const RFFT_PLAN *plan = rfft_param->plan;
+    int fft_len = plan->fft_len;
+    int half = plan->half_len;
+    int lanes = rfft_param->batch_lanes;
+    int ch = 0;
+    int k, l;
+
+    if (NULL == rfft_param->batch_out) {
+        /* handle not created by dios_ssp_share_rfft_batch_init */
+        return -1;
     }
 
-    /* ---- unscrambler ---- */
-    i = 0;
-    for (j = 1; j < fft_len - 1; j++) {
-        for (k = fft_len >> 1; k > (i ^= k); k >>= 1) {
+    /* groups of lanes channels; a partial group is padded with zero lanes when it
+       fills more than a quarter of them, smaller rests go channel by channel */
+    while (lanes > 0 && 4 * (channels - ch) > lanes) {
+        float *re = rfft_param->batch_re;
+        float *im = rfft_param->batch_im;
+        int num = channels - ch < lanes ? channels - ch : lanes;
+        for (l = 0; l < num; l++) {
+            const float *x = inbuffer[ch + l];
+            for (k = 0; k < half; k++) {
+                re[plan->bitrev[k] * lanes + l] = x[2 * k];
+                im[plan->bitrev[k] * lanes + l] = x[2 * k + 1];
+            }
         }
-        if (j < i) {
-            xr = outbuffer[j];
-            outbuffer[j] = outbuffer[i];
-            outbuffer[i] = xr;
+        for (; l < lanes; l++) {
+            for (k = 0; k < half; k++) {
+                re[k * lanes + l] = 0.0f;
+                im[k * lanes + l] = 0.0f;
+            }
+        }
+#if defined(DIOS_SSP_HAVE_AVX2)
+        rfft_batch_avx2(plan, re, im, rfft_param->batch_nyq);
+#elif defined(DIOS_SSP_HAVE_NEON)
+        rfft_batch_neon(plan, re, im, rfft_param->batch_nyq);
+#endif
+        for (l = 0; l < num; l++) {
+            float *yr = out_re[ch + l];
+            float *yi = out_im[ch + l];
+            for (k = 0; k < half; k++) {
+                yr[k * out_step] = re[k * lanes + l];
+                yi[k * out_step] = im[k * lanes + l];
+            }
+            yr[half * out_step] = rfft_param->batch_nyq[l];
+            yi[half * out_step] = 0.0f;
         }
+        ch += num;
     }
 
-    for (j = 0; j <= fft_len - 1; j++) {
-        /*a[j] *= 2.0 / fft_len;*/    /* <=== Default */
-        outbuffer[j] *= 2.0;            /* <=== use for SubBand. */
+    /* without simd, or the rest of the channels */
+    for (; ch < channels; ch++) {
+        float *yr = out_re[ch];
+        float *yi = out_im[ch];
+        dios_ssp_share_rfft_process(rfft_param, inbuffer[ch], rfft_param->batch_out);
+        for (k = 0; k <= half; k++) {
+            yr[k * out_step] = rfft_param->batch_out[k];
+        }
+        yi[0] = yi[half * out_step] = 0.0f;
+        for (k = 1; k < half; k++) {
+            yi[k * out_step] = -rfft_param->batch_out[fft_len - k];
+        }
     }
     return 0;
 }
@@ -206,10 +747,16 @@ int dios_ssp_share_rfft_uninit(void *rfft_handle)
     }
     RFFT_PARAM *rfft_param;
     rfft_param = (RFFT_PARAM*)rfft_handle;
-    free(rfft_param->wi);
-    free(rfft_param->wr);
+    if (NULL != rfft_param->plan) {
+        rfft_plan_release(rfft_param->plan);
+    }
+    free(rfft_param->work_re);
+    free(rfft_param->work_im);
+    free(rfft_param->batch_re);
+    free(rfft_param->batch_im);
+    free(rfft_param->batch_nyq);
+    free(rfft_param->batch_out);
     free(rfft_param);
 
     return 0;
 }
-
@@ -0,0 +1,197 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Description: Sample fifo and overlap-add accumulator for the STFT modules.
+The fifo keeps a mirrored copy of its storage, so an analysis window can be
+read in place at any position, and the accumulator wraps around instead of
+shifting its tail after every hop.
+==============================================================================*/
+
+#include "dios_ssp_share_ringbuf.h"
+
+objRingBuf* dios_ssp_share_ringbuf_init(int size)
+{
+    if (size <= 0) {
+        return NULL;
+    }
+
+    objRingBuf *rb = (objRingBuf *)calloc(1, sizeof(objRingBuf));
+    if (NULL == rb) {
+        return NULL;
+    }
+    rb->buf = (float *)calloc(2 * size, sizeof(float));
+    if (NULL == rb->buf) {
+        free(rb);
+        return NULL;
+    }
+    rb->size = size;
+
+    return rb;
+}
+
+int dios_ssp_share_ringbuf_reset(objRingBuf *rb, int count)
+{
+    if (NULL == rb || count < 0 || count > rb->size) {
+        return -1;
+    }
+
+    memset(rb->buf, 0, 2 * rb->size * sizeof(float));
+    rb->head = 0;
+    rb->count = count;
+
+    return 0;
+}
+
+int dios_ssp_share_ringbuf_write(objRingBuf *rb, const float *x, int len)
+{
+    if (NULL == rb || len < 0 || rb->count + len > rb->size) {
+        return -1;
+    }
+
+    int pos = rb->head + rb->count;
+    if (pos >= rb->size) {
+        pos -= rb->size;
+    }
+    int first = rb->size - pos < len ? rb->size - pos : len;
+
+    memcpy(rb->buf + pos, x, first * sizeof(float));
+    memcpy(rb->buf + pos + rb->size, x, first * sizeof(float));
+    memcpy(rb->buf, x + first, (len - first) * sizeof(float));
+    memcpy(rb->buf + rb->size, x + first, (len - first) * sizeof(float));
+    rb->count += len;
+
+    return 0;
+}
+
+const float* dios_ssp_share_ringbuf_window(const objRingBuf *rb, int offset)
+{
+    return rb->buf + rb->head + offset;
+}
+
+int dios_ssp_share_ringbuf_consume(objRingBuf *rb, int len)
+{
+    if (NULL == rb || len < 0 || len > rb->count) {
+        return -1;
+    }
+
+    rb->head += len;
+    if (rb->head >= rb->size) {
+        rb->head -= rb->size;
+    }
+    rb->count -= len;
+
+    return 0;
+}
+
+int dios_ssp_share_ringbuf_uninit(objRingBuf *rb)
+{
+    if (NULL == rb) {
+        return -1;
+    }
+
+    free(rb->buf);
+    free(rb);
+
+    return 0;
+}
+
+objOlaBuf* dios_ssp_share_ola_init(int size)
+{
+    if (size <= 0) {
+        return NULL;
+    }
+
+    objOlaBuf *ola = (objOlaBuf *)calloc(1, sizeof(objOlaBuf));
+    if (NULL == ola) {
+        return NULL;
+    }
+    ola->buf = (float *)calloc(size, sizeof(float));
+    if (NULL == ola->buf) {
+        free(ola);
+        return NULL;
+    }
+    ola->size = size;
+
+    return ola;
+}
+
+int dios_ssp_share_ola_reset(objOlaBuf *ola)
+{
+    if (NULL == ola) {
+        return -1;
+    }
+
+    memset(ola->buf, 0, ola->size * sizeof(float));
+    ola->head = 0;
+
+    return 0;
+}
+
+int dios_ssp_share_ola_add(objOlaBuf *ola, int offset, const float *x, int len)
+{
+    if (NULL == ola || offset < 0 || len < 0 || offset + len > ola->size) {
+        return -1;
+    }
+
+    int i;
+    int pos = ola->head + offset;
+    if (pos >= ola->size) {
+        pos -= ola->size;
+    }
+    int first = ola->size - pos < len ? ola->size - pos : len;
+    float *dst = ola->buf + pos;
+
+    for (i = 0; i < first; i++) {
+        dst[i] += x[i];
+    }
+    dst = ola->buf - first;
+    for (i = first; i < len; i++) {
+        dst[i] += x[i];
+    }
+
+    return 0;
+}
+
+int dios_ssp_share_ola_pop(objOlaBuf *ola, float *out, int len)
+{
+    if (NULL == ola || len < 0 || len > ola->size) {
+        return -1;
+    }
+
+    int first = ola->size - ola->head < len ? ola->size - ola->head : len;
+
+    memcpy(out, ola->buf + ola->head, first * sizeof(float));
+    memset(ola->buf + ola->head, 0, first * sizeof(float));
+    memcpy(out + first, ola->buf, (len - first) * sizeof(float));
+    memset(ola->buf, 0, (len - first) * sizeof(float));
+    ola->head += len;
+    if (ola->head >= ola->size) {
+        ola->head -= ola->size;
+    }
+
+    return 0;
+}
+
+int dios_ssp_share_ola_uninit(objOlaBuf *ola)
+{
+    if (NULL == ola) {
+        return -1;
+    }
+
+    free(ola->buf);
+    free(ola);
+
+    return 0;
+}
@@ -0,0 +1,1027 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Description: Vector kernels shared by the modules. Every kernel has a scalar
+version; AVX2 versions are compiled with a function target attribute and
+picked at runtime from the cpu features, NEON versions are used whenever the
+compiler targets aarch64.
+==============================================================================*/
+
+#include "dios_ssp_share_simd.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+#include <immintrin.h>
+#include <pthread.h>
+#elif defined(DIOS_SSP_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+/* cpu features are probed once; the kernels are called from the aec worker
+   threads, so the first call may come from several threads at the same time */
+static pthread_once_t simd_level_once = PTHREAD_ONCE_INIT;
+static int simd_level = DIOS_SSP_SIMD_NONE;
+
+static void simd_level_probe(void)
+{
+    __builtin_cpu_init();
+    simd_level = __builtin_cpu_supports("avx2") ? DIOS_SSP_SIMD_AVX2 : DIOS_SSP_SIMD_NONE;
+}
+#endif
+
+int dios_ssp_share_simd_level(void)
+{
+#if defined(DIOS_SSP_HAVE_AVX2)
+    pthread_once(&simd_level_once, simd_level_probe);
+    return simd_level;
+#elif defined(DIOS_SSP_HAVE_NEON)
+    return DIOS_SSP_SIMD_NEON;
+#else
+    return DIOS_SSP_SIMD_NONE;
+#endif
+}
+
+static void vec_abs_scalar(const float *re, const float *im, float *out, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        out[i] = sqrtf(re[i] * re[i] + im[i] * im[i]);
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int vec_abs_avx2(const float *re, const float *im, float *out, int len)
+{
+    int i;
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 r = _mm256_loadu_ps(re + i);
+        __m256 m = _mm256_loadu_ps(im + i);
+        // no fma, keep the rounding of the scalar path
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(r, r), _mm256_mul_ps(m, m));
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(p));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int vec_abs_neon(const float *re, const float *im, float *out, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4_t r = vld1q_f32(re + i);
+        float32x4_t m = vld1q_f32(im + i);
+        float32x4_t p = vaddq_f32(vmulq_f32(r, r), vmulq_f32(m, m));
+        vst1q_f32(out + i, vsqrtq_f32(p));
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_vec_abs(const float *re, const float *im, float *out, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = vec_abs_avx2(re, im, out, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = vec_abs_neon(re, im, out, len);
+#endif
+    vec_abs_scalar(re, im, out, done, len);
+}
+
+static void vec_scale_power_scalar(const float *re, const float *im, const float *power,
+                                   const float *target, float *out_re, float *out_im, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        if (power[i] > 0.0f) {
+            float g = sqrtf(target[i] / power[i]);
+            out_re[i] = re[i] * g;
+            out_im[i] = im[i] * g;
+        } else {
+            out_re[i] = sqrtf(target[i]);
+            out_im[i] = 0.0f;
+        }
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int vec_scale_power_avx2(const float *re, const float *im, const float *power,
+                                const float *target, float *out_re, float *out_im, int len)
+{
+    int i;
+    const __m256 zero = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 p = _mm256_loadu_ps(power + i);
+        __m256 t = _mm256_loadu_ps(target + i);
+        __m256 live = _mm256_cmp_ps(p, zero, _CMP_GT_OQ);
+        // the zero lanes divide by zero here and are replaced below
+        __m256 g = _mm256_sqrt_ps(_mm256_div_ps(t, p));
+        __m256 r = _mm256_mul_ps(_mm256_loadu_ps(re + i), g);
+        __m256 m = _mm256_mul_ps(_mm256_loadu_ps(im + i), g);
+        _mm256_storeu_ps(out_re + i, _mm256_blendv_ps(_mm256_sqrt_ps(t), r, live));
+        _mm256_storeu_ps(out_im + i, _mm256_blendv_ps(zero, m, live));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int vec_scale_power_neon(const float *re, const float *im, const float *power,
+                                const float *target, float *out_re, float *out_im, int len)
+{
+    int i;
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4_t p = vld1q_f32(power + i);
+        float32x4_t t = vld1q_f32(target + i);
+        uint32x4_t live = vcgtq_f32(p, zero);
+        float32x4_t g = vsqrtq_f32(vdivq_f32(t, p));
+        float32x4_t r = vmulq_f32(vld1q_f32(re + i), g);
+        float32x4_t m = vmulq_f32(vld1q_f32(im + i), g);
+        vst1q_f32(out_re + i, vbslq_f32(live, r, vsqrtq_f32(t)));
+        vst1q_f32(out_im + i, vbslq_f32(live, m, zero));
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_vec_scale_power(const float *re, const float *im, const float *power,
+                                    const float *target, float *out_re, float *out_im, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = vec_scale_power_avx2(re, im, power, target, out_re, out_im, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = vec_scale_power_neon(re, im, power, target, out_re, out_im, len);
+#endif
+    vec_scale_power_scalar(re, im, power, target, out_re, out_im, done, len);
+}
+
+static void mat_vec_acc_scalar(const float *a, int cols, int lda, const float *x, float *y, int start, int rows)
+{
+    int r, c;
+    for (r = start; r < rows; r++) {
+        float acc = y[r];
+        for (c = 0; c < cols; c++) {
+            acc += a[c * lda + r] * x[c];
+        }
+        y[r] = acc;
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int mat_vec_acc_avx2(const float *a, int rows, int cols, int lda, const float *x, float *y)
+{
+    int r, c;
+    for (r = 0; r + 16 <= rows; r += 16) {
+        __m256 acc0 = _mm256_loadu_ps(y + r);
+        __m256 acc1 = _mm256_loadu_ps(y + r + 8);
+        for (c = 0; c < cols; c++) {
+            __m256 xc = _mm256_set1_ps(x[c]);
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + c * lda + r), xc));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + c * lda + r + 8), xc));
+        }
+        _mm256_storeu_ps(y + r, acc0);
+        _mm256_storeu_ps(y + r + 8, acc1);
+    }
+    for (; r + 8 <= rows; r += 8) {
+        __m256 acc = _mm256_loadu_ps(y + r);
+        for (c = 0; c < cols; c++) {
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + c * lda + r), _mm256_set1_ps(x[c])));
+        }
+        _mm256_storeu_ps(y + r, acc);
+    }
+    return r;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int mat_vec_acc_neon(const float *a, int rows, int cols, int lda, const float *x, float *y)
+{
+    int r, c;
+    for (r = 0; r + 4 <= rows; r += 4) {
+        float32x4_t acc = vld1q_f32(y + r);
+        for (c = 0; c < cols; c++) {
+            acc = vaddq_f32(acc, vmulq_n_f32(vld1q_f32(a + c * lda + r), x[c]));
+        }
+        vst1q_f32(y + r, acc);
+    }
+    return r;
+}
+#endif
+
+void dios_ssp_share_mat_vec_acc(const float *a, int rows, int cols, int lda, const float *x, float *y)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = mat_vec_acc_avx2(a, rows, cols, lda, x, y);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = mat_vec_acc_neon(a, rows, cols, lda, x, y);
+#endif
+    mat_vec_acc_scalar(a, cols, lda, x, y, done, rows);
+}
+
+float *dios_ssp_share_simd_calloc(int len)
+{
+    void *ptr = NULL;
+    size_t size = ((size_t)(len > 0 ? len : 1) * sizeof(float) + DIOS_SSP_SIMD_ALIGN - 1)
+                  & ~(size_t)(DIOS_SSP_SIMD_ALIGN - 1);
+    if (0 != posix_memalign(&ptr, DIOS_SSP_SIMD_ALIGN, size)) {
+        return NULL;
+    }
+    memset(ptr, 0, size);
+    return (float *)ptr;
+}
+
+void dios_ssp_share_simd_free(float *ptr)
+{
+    free(ptr);
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static inline float hsum_avx2(__m256 v)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+static void cvec_dot_conj_scalar(const float *hr, const float *hi, const float *xr, const float *xi,
+                                 int start, int len, float *out_re, float *out_im)
+{
+    int i;
+    float acc_r = *out_re, acc_i = *out_im;
+    for (i = start; i < len; i++) {
+        acc_r += hr[i] * xr[i] + hi[i] * xi[i];
+        acc_i += hr[i] * xi[i] - hi[i] * xr[i];
+    }
+    *out_re = acc_r;
+    *out_im = acc_i;
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int cvec_dot_conj_avx2(const float *hr, const float *hi, const float *xr, const float *xi,
+                              int len, float *out_re, float *out_im)
+{
+    int i;
+    __m256 acc_r = _mm256_setzero_ps(), acc_i = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 vhr = _mm256_loadu_ps(hr + i), vhi = _mm256_loadu_ps(hi + i);
+        __m256 vxr = _mm256_loadu_ps(xr + i), vxi = _mm256_loadu_ps(xi + i);
+        acc_r = _mm256_add_ps(acc_r, _mm256_add_ps(_mm256_mul_ps(vhr, vxr), _mm256_mul_ps(vhi, vxi)));
+        acc_i = _mm256_add_ps(acc_i, _mm256_sub_ps(_mm256_mul_ps(vhr, vxi), _mm256_mul_ps(vhi, vxr)));
+    }
+    *out_re = hsum_avx2(acc_r);
+    *out_im = hsum_avx2(acc_i);
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int cvec_dot_conj_neon(const float *hr, const float *hi, const float *xr, const float *xi,
+                              int len, float *out_re, float *out_im)
+{
+    int i;
+    float32x4_t acc_r = vdupq_n_f32(0.0f), acc_i = vdupq_n_f32(0.0f);
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4_t vhr = vld1q_f32(hr + i), vhi = vld1q_f32(hi + i);
+        float32x4_t vxr = vld1q_f32(xr + i), vxi = vld1q_f32(xi + i);
+        acc_r = vaddq_f32(acc_r, vaddq_f32(vmulq_f32(vhr, vxr), vmulq_f32(vhi, vxi)));
+        acc_i = vaddq_f32(acc_i, vsubq_f32(vmulq_f32(vhr, vxi), vmulq_f32(vhi, vxr)));
+    }
+    *out_re = vaddvq_f32(acc_r);
+    *out_im = vaddvq_f32(acc_i);
+    return i;
+}
+#endif
+
+void dios_ssp_share_cvec_dot_conj(const float *hr, const float *hi, const float *xr, const float *xi,
+                                  int len, float *out_re, float *out_im)
+{
+    int done = 0;
+    *out_re = 0.0f;
+    *out_im = 0.0f;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = cvec_dot_conj_avx2(hr, hi, xr, xi, len, out_re, out_im);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = cvec_dot_conj_neon(hr, hi, xr, xi, len, out_re, out_im);
+#endif
+    cvec_dot_conj_scalar(hr, hi, xr, xi, done, len, out_re, out_im);
+}
+
+static float cvec_power_scalar(const float *xr, const float *xi, const float *w, int start, int len)
+{
+    int i;
+    float acc = 0.0f;
+    for (i = start; i < len; i++) {
+        float p = xr[i] * xr[i] + xi[i] * xi[i];
+        acc += NULL == w ? p : p * w[i];
+    }
+    return acc;
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int cvec_power_avx2(const float *xr, const float *xi, const float *w, int len, float *out)
+{
+    int i;
+    __m256 acc = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 vxr = _mm256_loadu_ps(xr + i), vxi = _mm256_loadu_ps(xi + i);
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(vxr, vxr), _mm256_mul_ps(vxi, vxi));
+        acc = _mm256_add_ps(acc, NULL == w ? p : _mm256_mul_ps(p, _mm256_loadu_ps(w + i)));
+    }
+    *out = hsum_avx2(acc);
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int cvec_power_neon(const float *xr, const float *xi, const float *w, int len, float *out)
+{
+    int i;
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4_t vxr = vld1q_f32(xr + i), vxi = vld1q_f32(xi + i);
+        float32x4_t p = vaddq_f32(vmulq_f32(vxr, vxr), vmulq_f32(vxi, vxi));
+        acc = vaddq_f32(acc, NULL == w ? p : vmulq_f32(p, vld1q_f32(w + i)));
+    }
+    *out = vaddvq_f32(acc);
+    return i;
+}
+#endif
+
+float dios_ssp_share_cvec_power(const float *xr, const float *xi, const float *w, int len)
+{
+    int done = 0;
+    float acc = 0.0f;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = cvec_power_avx2(xr, xi, w, len, &acc);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = cvec_power_neon(xr, xi, w, len, &acc);
+#endif
+    return acc + cvec_power_scalar(xr, xi, w, done, len);
+}
+
+static void cvec_axpy_scalar(const float *w, const float *xr, const float *xi, float ar, float ai,
+                             float *yr, float *yi, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        float zr = xr[i] * ar - xi[i] * ai;
+        float zi = xr[i] * ai + xi[i] * ar;
+        yr[i] += w[i] * zr;
+        yi[i] += w[i] * zi;
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int cvec_axpy_avx2(const float *w, const float *xr, const float *xi, float ar, float ai,
+                          float *yr, float *yi, int len)
+{
+    int i;
+    __m256 var = _mm256_set1_ps(ar), vai = _mm256_set1_ps(ai);
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 vxr = _mm256_loadu_ps(xr + i), vxi = _mm256_loadu_ps(xi + i);
+        __m256 vw = _mm256_loadu_ps(w + i);
+        __m256 zr = _mm256_sub_ps(_mm256_mul_ps(vxr, var), _mm256_mul_ps(vxi, vai));
+        __m256 zi = _mm256_add_ps(_mm256_mul_ps(vxr, vai), _mm256_mul_ps(vxi, var));
+        _mm256_storeu_ps(yr + i, _mm256_add_ps(_mm256_loadu_ps(yr + i), _mm256_mul_ps(vw, zr)));
+        _mm256_storeu_ps(yi + i, _mm256_add_ps(_mm256_loadu_ps(yi + i), _mm256_mul_ps(vw, zi)));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int cvec_axpy_neon(const float *w, const float *xr, const float *xi, float ar, float ai,
+                          float *yr, float *yi, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4_t vxr = vld1q_f32(xr + i), vxi = vld1q_f32(xi + i);
+        float32x4_t vw = vld1q_f32(w + i);
+        float32x4_t zr = vsubq_f32(vmulq_n_f32(vxr, ar), vmulq_n_f32(vxi, ai));
+        float32x4_t zi = vaddq_f32(vmulq_n_f32(vxr, ai), vmulq_n_f32(vxi, ar));
+        vst1q_f32(yr + i, vaddq_f32(vld1q_f32(yr + i), vmulq_f32(vw, zr)));
+        vst1q_f32(yi + i, vaddq_f32(vld1q_f32(yi + i), vmulq_f32(vw, zi)));
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_cvec_axpy(const float *w, const float *xr, const float *xi, float ar, float ai,
+                              float *yr, float *yi, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = cvec_axpy_avx2(w, xr, xi, ar, ai, yr, yi, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = cvec_axpy_neon(w, xr, xi, ar, ai, yr, yi, len);
+#endif
+    cvec_axpy_scalar(w, xr, xi, ar, ai, yr, yi, done, len);
+}
+
+static void vec_mul_acc_scalar(const float *a, const float *b, float *y, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        y[i] += a[i] * b[i];
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int vec_mul_acc_avx2(const float *a, const float *b, float *y, int len)
+{
+    int i;
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 p = _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), p));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int vec_mul_acc_neon(const float *a, const float *b, float *y, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4_t p = vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), p));
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_vec_mul_acc(const float *a, const float *b, float *y, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = vec_mul_acc_avx2(a, b, y, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = vec_mul_acc_neon(a, b, y, len);
+#endif
+    vec_mul_acc_scalar(a, b, y, done, len);
+}
+
+static void cvec_mul_acc_scalar(const float *ar, const float *ai, const float *br, const float *bi,
+                                float sign, float *yr, float *yi, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        float si = sign * ai[i];
+        yr[i] += ar[i] * br[i] - si * bi[i];
+        yi[i] += ar[i] * bi[i] + si * br[i];
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int cvec_mul_acc_avx2(const float *ar, const float *ai, const float *br, const float *bi,
+                             float sign, float *yr, float *yi, int len)
+{
+    int i;
+    __m256 vs = _mm256_set1_ps(sign);
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 var = _mm256_loadu_ps(ar + i), vai = _mm256_mul_ps(vs, _mm256_loadu_ps(ai + i));
+        __m256 vbr = _mm256_loadu_ps(br + i), vbi = _mm256_loadu_ps(bi + i);
+        __m256 zr = _mm256_sub_ps(_mm256_mul_ps(var, vbr), _mm256_mul_ps(vai, vbi));
+        __m256 zi = _mm256_add_ps(_mm256_mul_ps(var, vbi), _mm256_mul_ps(vai, vbr));
+        _mm256_storeu_ps(yr + i, _mm256_add_ps(_mm256_loadu_ps(yr + i), zr));
+        _mm256_storeu_ps(yi + i, _mm256_add_ps(_mm256_loadu_ps(yi + i), zi));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int cvec_mul_acc_neon(const float *ar, const float *ai, const float *br, const float *bi,
+                             float sign, float *yr, float *yi, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4_t var = vld1q_f32(ar + i), vai = vmulq_n_f32(vld1q_f32(ai + i), sign);
+        float32x4_t vbr = vld1q_f32(br + i), vbi = vld1q_f32(bi + i);
+        float32x4_t zr = vsubq_f32(vmulq_f32(var, vbr), vmulq_f32(vai, vbi));
+        float32x4_t zi = vaddq_f32(vmulq_f32(var, vbi), vmulq_f32(vai, vbr));
+        vst1q_f32(yr + i, vaddq_f32(vld1q_f32(yr + i), zr));
+        vst1q_f32(yi + i, vaddq_f32(vld1q_f32(yi + i), zi));
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_cvec_mul_acc(const float *ar, const float *ai, const float *br, const float *bi,
+                                 int conj_a, float *yr, float *yi, int len)
+{
+    int done = 0;
+    float sign = conj_a ? -1.0f : 1.0f;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = cvec_mul_acc_avx2(ar, ai, br, bi, sign, yr, yi, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = cvec_mul_acc_neon(ar, ai, br, bi, sign, yr, yi, len);
+#endif
+    cvec_mul_acc_scalar(ar, ai, br, bi, sign, yr, yi, done, len);
+}
+
+static void popcount_mean_scalar(unsigned int key, const unsigned int *words, const int *shifts,
+                                 int *counts, int *mean, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        unsigned int u32 = key ^ words[i];
+        int diff;
+        u32 = (u32 & 0x55555555) + ((u32 >> 1) & 0x55555555);
+        u32 = (u32 & 0x33333333) + ((u32 >> 2) & 0x33333333);
+        u32 = (u32 & 0x0f0f0f0f) + ((u32 >> 4) & 0x0f0f0f0f);
+        u32 = (u32 & 0x00ff00ff) + ((u32 >> 8) & 0x00ff00ff);
+        u32 = (u32 & 0x0000ffff) + ((u32 >> 16) & 0x0000ffff);
+        counts[i] = (int)u32;
+        if (shifts[i] > 0) {
+            diff = 512 * counts[i] - mean[i];
+            mean[i] += diff < 0 ? -((-diff) >> shifts[i]) : diff >> shifts[i];
+        }
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int popcount_mean_avx2(unsigned int key, const unsigned int *words, const int *shifts,
+                              int *counts, int *mean, int len)
+{
+    int i;
+    // bits of every nibble value
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i one8 = _mm256_set1_epi8(1);
+    const __m256i one16 = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i vkey = _mm256_set1_epi32((int)key);
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(words + i)), vkey);
+        __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(x, nibble)),
+                                    _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+        // byte counts summed to 16 then 32 bits
+        c = _mm256_madd_epi16(_mm256_maddubs_epi16(c, one8), one16);
+        _mm256_storeu_si256((__m256i *)(counts + i), c);
+
+        __m256i s = _mm256_loadu_si256((const __m256i *)(shifts + i));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mean + i));
+        __m256i d = _mm256_sub_epi32(_mm256_slli_epi32(c, 9), m);
+        // shift the magnitude so negative steps round toward zero too
+        __m256i step = _mm256_sign_epi32(_mm256_srlv_epi32(_mm256_abs_epi32(d), s), d);
+        step = _mm256_and_si256(step, _mm256_cmpgt_epi32(s, zero));
+        _mm256_storeu_si256((__m256i *)(mean + i), _mm256_add_epi32(m, step));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int popcount_mean_neon(unsigned int key, const unsigned int *words, const int *shifts,
+                              int *counts, int *mean, int len)
+{
+    int i;
+    const uint32x4_t vkey = vdupq_n_u32(key);
+    const int32x4_t zero = vdupq_n_s32(0);
+    for (i = 0; i + 4 <= len; i += 4) {
+        uint32x4_t x = veorq_u32(vld1q_u32(words + i), vkey);
+        int32x4_t c = vreinterpretq_s32_u32(vpaddlq_u16(vpaddlq_u8(vcntq_u8(vreinterpretq_u8_u32(x)))));
+        vst1q_s32(counts + i, c);
+
+        int32x4_t s = vld1q_s32(shifts + i);
+        int32x4_t m = vld1q_s32(mean + i);
+        int32x4_t d = vsubq_s32(vshlq_n_s32(c, 9), m);
+        int32x4_t step = vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(vabsq_s32(d)), vnegq_s32(s)));
+        step = vbslq_s32(vcltq_s32(d, zero), vnegq_s32(step), step);
+        step = vandq_s32(step, vreinterpretq_s32_u32(vcgtq_s32(s, zero)));
+        vst1q_s32(mean + i, vaddq_s32(m, step));
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_popcount_mean(unsigned int key, const unsigned int *words, const int *shifts,
+                                  int *counts, int *mean, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = popcount_mean_avx2(key, words, shifts, counts, mean, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = popcount_mean_neon(key, words, shifts, counts, mean, len);
+#endif
+    popcount_mean_scalar(key, words, shifts, counts, mean, done, len);
+}
+
+static void vec_min_max_int_scalar(const int *x, int *min_val, int *min_pos, int *max_val, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        if (x[i] < *min_val) {
+            *min_val = x[i];
+            *min_pos = i;
+        }
+        if (x[i] > *max_val) {
+            *max_val = x[i];
+        }
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int vec_min_max_int_avx2(const int *x, int *min_val, int *min_pos, int *max_val, int len)
+{
+    int i;
+    int k;
+    int lane_min[8];
+    int lane_pos[8];
+    int lane_max[8];
+    if (len < 8) {
+        return 0;
+    }
+    __m256i vmin = _mm256_loadu_si256((const __m256i *)x);
+    __m256i vmax = vmin;
+    __m256i vpos = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i pos = vpos;
+    const __m256i step = _mm256_set1_epi32(8);
+    for (i = 8; i + 8 <= len; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(x + i));
+        pos = _mm256_add_epi32(pos, step);
+        // strictly smaller only, so every lane keeps its first position
+        vpos = _mm256_blendv_epi8(vpos, pos, _mm256_cmpgt_epi32(vmin, v));
+        vmin = _mm256_min_epi32(vmin, v);
+        vmax = _mm256_max_epi32(vmax, v);
+    }
+    _mm256_storeu_si256((__m256i *)lane_min, vmin);
+    _mm256_storeu_si256((__m256i *)lane_pos, vpos);
+    _mm256_storeu_si256((__m256i *)lane_max, vmax);
+    *min_val = lane_min[0];
+    *min_pos = lane_pos[0];
+    *max_val = lane_max[0];
+    for (k = 1; k < 8; k++) {
+        if (lane_min[k] < *min_val || (lane_min[k] == *min_val && lane_pos[k] < *min_pos)) {
+            *min_val = lane_min[k];
+            *min_pos = lane_pos[k];
+        }
+        if (lane_max[k] > *max_val) {
+            *max_val = lane_max[k];
+        }
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int vec_min_max_int_neon(const int *x, int *min_val, int *min_pos, int *max_val, int len)
+{
+    int i;
+    int k;
+    int lane_min[4];
+    int lane_pos[4];
+    int lane_max[4];
+    const int pos0[4] = {0, 1, 2, 3};
+    if (len < 4) {
+        return 0;
+    }
+    int32x4_t vmin = vld1q_s32(x);
+    int32x4_t vmax = vmin;
+    int32x4_t vpos = vld1q_s32(pos0);
+    int32x4_t pos = vpos;
+    const int32x4_t step = vdupq_n_s32(4);
+    for (i = 4; i + 4 <= len; i += 4) {
+        int32x4_t v = vld1q_s32(x + i);
+        pos = vaddq_s32(pos, step);
+        vpos = vbslq_s32(vcltq_s32(v, vmin), pos, vpos);
+        vmin = vminq_s32(vmin, v);
+        vmax = vmaxq_s32(vmax, v);
+    }
+    vst1q_s32(lane_min, vmin);
+    vst1q_s32(lane_pos, vpos);
+    vst1q_s32(lane_max, vmax);
+    *min_val = lane_min[0];
+    *min_pos = lane_pos[0];
+    *max_val = lane_max[0];
+    for (k = 1; k < 4; k++) {
+        if (lane_min[k] < *min_val || (lane_min[k] == *min_val && lane_pos[k] < *min_pos)) {
+            *min_val = lane_min[k];
+            *min_pos = lane_pos[k];
+        }
+        if (lane_max[k] > *max_val) {
+            *max_val = lane_max[k];
+        }
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_vec_min_max_int(const int *x, int *min_val, int *min_pos, int *max_val, int len)
+{
+    int done = 0;
+    *min_val = x[0];
+    *min_pos = 0;
+    *max_val = x[0];
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = vec_min_max_int_avx2(x, min_val, min_pos, max_val, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = vec_min_max_int_neon(x, min_val, min_pos, max_val, len);
+#endif
+    vec_min_max_int_scalar(x, min_val, min_pos, max_val, done, len);
+}
+
+/* interleaved complex kernels: the AVX2 paths hold four complex values per
+   register, the real parts in the even lanes and the imaginary parts in the odd
+   lanes, the NEON paths deinterleave four complex values with vld2q */
+static void xcvec_mul_scalar(const xcomplex *a, const xcomplex *b, int acc, xcomplex *y, int start, int len)
+{
+    int i;
+    if (acc) {
+        for (i = start; i < len; i++) {
+            y[i] = complex_add(y[i], complex_mul(a[i], b[i]));
+        }
+    } else {
+        for (i = start; i < len; i++) {
+            y[i] = complex_mul(a[i], b[i]);
+        }
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+// [ar * br - ai * bi, ai * br + ar * bi] of each complex pair
+__attribute__((target("avx2")))
+static inline __m256 xcmul_avx2(__m256 a, __m256 b)
+{
+    __m256 p = _mm256_mul_ps(a, _mm256_moveldup_ps(b));
+    __m256 q = _mm256_mul_ps(_mm256_permute_ps(a, 0xb1), _mm256_movehdup_ps(b));
+    return _mm256_addsub_ps(p, q);
+}
+
+__attribute__((target("avx2")))
+static int xcvec_mul_avx2(const xcomplex *a, const xcomplex *b, int acc, xcomplex *y, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        __m256 z = xcmul_avx2(_mm256_loadu_ps(&a[i].r), _mm256_loadu_ps(&b[i].r));
+        if (acc) {
+            z = _mm256_add_ps(_mm256_loadu_ps(&y[i].r), z);
+        }
+        _mm256_storeu_ps(&y[i].r, z);
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static inline float32x4x2_t xcmul_neon(float32x4x2_t a, float32x4x2_t b)
+{
+    float32x4x2_t z;
+    z.val[0] = vsubq_f32(vmulq_f32(a.val[0], b.val[0]), vmulq_f32(a.val[1], b.val[1]));
+    z.val[1] = vaddq_f32(vmulq_f32(a.val[1], b.val[0]), vmulq_f32(a.val[0], b.val[1]));
+    return z;
+}
+
+static int xcvec_mul_neon(const xcomplex *a, const xcomplex *b, int acc, xcomplex *y, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4x2_t z = xcmul_neon(vld2q_f32(&a[i].r), vld2q_f32(&b[i].r));
+        if (acc) {
+            float32x4x2_t v = vld2q_f32(&y[i].r);
+            z.val[0] = vaddq_f32(v.val[0], z.val[0]);
+            z.val[1] = vaddq_f32(v.val[1], z.val[1]);
+        }
+        vst2q_f32(&y[i].r, z);
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_xcvec_mul(const xcomplex *a, const xcomplex *b, int acc, xcomplex *y, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = xcvec_mul_avx2(a, b, acc, y, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = xcvec_mul_neon(a, b, acc, y, len);
+#endif
+    xcvec_mul_scalar(a, b, acc, y, done, len);
+}
+
+static void xcvec_flms_update_scalar(const xcomplex *x, const xcomplex *e, const xcomplex *mu,
+                                     xcomplex *h, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        h[i] = complex_add(h[i], complex_mul(complex_mul(complex_conjg(x[i]), e[i]), mu[i]));
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int xcvec_flms_update_avx2(const xcomplex *x, const xcomplex *e, const xcomplex *mu,
+                                  xcomplex *h, int len)
+{
+    int i;
+    const __m256 conj = _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+    for (i = 0; i + 4 <= len; i += 4) {
+        __m256 z = _mm256_xor_ps(_mm256_loadu_ps(&x[i].r), conj);
+        z = xcmul_avx2(z, _mm256_loadu_ps(&e[i].r));
+        z = xcmul_avx2(z, _mm256_loadu_ps(&mu[i].r));
+        _mm256_storeu_ps(&h[i].r, _mm256_add_ps(_mm256_loadu_ps(&h[i].r), z));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int xcvec_flms_update_neon(const xcomplex *x, const xcomplex *e, const xcomplex *mu,
+                                  xcomplex *h, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4x2_t z = vld2q_f32(&x[i].r);
+        float32x4x2_t v = vld2q_f32(&h[i].r);
+        z.val[1] = vnegq_f32(z.val[1]);
+        z = xcmul_neon(z, vld2q_f32(&e[i].r));
+        z = xcmul_neon(z, vld2q_f32(&mu[i].r));
+        v.val[0] = vaddq_f32(v.val[0], z.val[0]);
+        v.val[1] = vaddq_f32(v.val[1], z.val[1]);
+        vst2q_f32(&h[i].r, v);
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_xcvec_flms_update(const xcomplex *x, const xcomplex *e, const xcomplex *mu,
+                                      xcomplex *h, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = xcvec_flms_update_avx2(x, e, mu, h, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = xcvec_flms_update_neon(x, e, mu, h, len);
+#endif
+    xcvec_flms_update_scalar(x, e, mu, h, done, len);
+}
+
+static void xcvec_mul_sub_scalar(const xcomplex *nu, xcomplex *h, int start, int len)
+{
+    int i;
+    for (i = start; i < len; i++) {
+        h[i] = complex_sub(h[i], complex_mul(h[i], nu[i]));
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int xcvec_mul_sub_avx2(const xcomplex *nu, xcomplex *h, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        __m256 v = _mm256_loadu_ps(&h[i].r);
+        _mm256_storeu_ps(&h[i].r, _mm256_sub_ps(v, xcmul_avx2(v, _mm256_loadu_ps(&nu[i].r))));
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int xcvec_mul_sub_neon(const xcomplex *nu, xcomplex *h, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4x2_t v = vld2q_f32(&h[i].r);
+        float32x4x2_t z = xcmul_neon(v, vld2q_f32(&nu[i].r));
+        v.val[0] = vsubq_f32(v.val[0], z.val[0]);
+        v.val[1] = vsubq_f32(v.val[1], z.val[1]);
+        vst2q_f32(&h[i].r, v);
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_xcvec_mul_sub(const xcomplex *nu, xcomplex *h, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = xcvec_mul_sub_avx2(nu, h, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = xcvec_mul_sub_neon(nu, h, len);
+#endif
+    xcvec_mul_sub_scalar(nu, h, done, len);
+}
+
+static void xcvec_abs2_scalar(const xcomplex *x, int acc, float *out, int start, int len)
+{
+    int i;
+    if (acc) {
+        for (i = start; i < len; i++) {
+            out[i] += complex_abs2(x[i]);
+        }
+    } else {
+        for (i = start; i < len; i++) {
+            out[i] = complex_abs2(x[i]);
+        }
+    }
+}
+
+#if defined(DIOS_SSP_HAVE_AVX2)
+__attribute__((target("avx2")))
+static int xcvec_abs2_avx2(const xcomplex *x, int acc, float *out, int len)
+{
+    int i;
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m256 v0 = _mm256_loadu_ps(&x[i].r);
+        __m256 v1 = _mm256_loadu_ps(&x[i + 4].r);
+        // hadd pairs re^2 + im^2 as [0 1 4 5 | 2 3 6 7], the permute restores the order
+        __m256 p = _mm256_hadd_ps(_mm256_mul_ps(v0, v0), _mm256_mul_ps(v1, v1));
+        p = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(p), 0xd8));
+        if (acc) {
+            p = _mm256_add_ps(_mm256_loadu_ps(out + i), p);
+        }
+        _mm256_storeu_ps(out + i, p);
+    }
+    return i;
+}
+#endif
+
+#if defined(DIOS_SSP_HAVE_NEON)
+static int xcvec_abs2_neon(const xcomplex *x, int acc, float *out, int len)
+{
+    int i;
+    for (i = 0; i + 4 <= len; i += 4) {
+        float32x4x2_t v = vld2q_f32(&x[i].r);
+        float32x4_t p = vaddq_f32(vmulq_f32(v.val[0], v.val[0]), vmulq_f32(v.val[1], v.val[1]));
+        if (acc) {
+            p = vaddq_f32(vld1q_f32(out + i), p);
+        }
+        vst1q_f32(out + i, p);
+    }
+    return i;
+}
+#endif
+
+void dios_ssp_share_xcvec_abs2(const xcomplex *x, int acc, float *out, int len)
+{
+    int done = 0;
+#if defined(DIOS_SSP_HAVE_AVX2)
+    if (DIOS_SSP_SIMD_AVX2 == dios_ssp_share_simd_level()) {
+        done = xcvec_abs2_avx2(x, acc, out, len);
+    }
+#elif defined(DIOS_SSP_HAVE_NEON)
+    done = xcvec_abs2_neon(x, acc, out, len);
+#endif
+    xcvec_abs2_scalar(x, acc, out, done, len);
+}
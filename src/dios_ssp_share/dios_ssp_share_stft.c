@@ -0,0 +1,141 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Description: Multichannel short-time fourier analysis. One object can feed
+every spatial module of a frame (DOA, MVDR), so each microphone is windowed
+and transformed once; the channels are transformed together by the batched
+rfft.
+==============================================================================*/
+
+#include "dios_ssp_share_stft.h"
+
+objMchStft* dios_ssp_share_stft_init(int channels, int fft_size, int shift_size)
+{
+    int i;
+
+    if (channels <= 0 || shift_size <= 0 || shift_size > fft_size) {
+        return NULL;
+    }
+
+    objMchStft *stft = (objMchStft *)calloc(1, sizeof(objMchStft));
+    if (NULL == stft) {
+        return NULL;
+    }
+    stft->channels = channels;
+    stft->fft_size = fft_size;
+    stft->shift_size = shift_size;
+
+    stft->re = (float *)calloc(channels * fft_size, sizeof(float));
+    stft->im = (float *)calloc(channels * fft_size, sizeof(float));
+    stft->ana_win = (float *)calloc(fft_size, sizeof(float));
+    stft->win_data = (float *)calloc(channels * fft_size, sizeof(float));
+    stft->win_ptr = (float **)calloc(channels, sizeof(float *));
+    stft->re_ptr = (float **)calloc(channels, sizeof(float *));
+    stft->im_ptr = (float **)calloc(channels, sizeof(float *));
+    stft->rfft_param = dios_ssp_share_rfft_batch_init(fft_size);
+    stft->ring = (objRingBuf **)calloc(channels, sizeof(objRingBuf *));
+    if (NULL == stft->re || NULL == stft->im || NULL == stft->ana_win || NULL == stft->win_data
+        || NULL == stft->win_ptr || NULL == stft->re_ptr || NULL == stft->im_ptr
+        || NULL == stft->rfft_param || NULL == stft->ring) {
+        dios_ssp_share_stft_uninit(stft);
+        return NULL;
+    }
+    for (i = 0; i < channels; i++) {
+        stft->win_ptr[i] = stft->win_data + i * fft_size;
+        stft->re_ptr[i] = stft->re + i * fft_size;
+        stft->im_ptr[i] = stft->im + i * fft_size;
+        stft->ring[i] = dios_ssp_share_ringbuf_init(fft_size);
+        if (NULL == stft->ring[i]) {
+            dios_ssp_share_stft_uninit(stft);
+            return NULL;
+        }
+    }
+
+    for (i = 0; i < fft_size; i++) {
+        stft->ana_win[i] = (float)(0.54 - 0.46 * cos((2 * i) * PI / (fft_size - 1)));
+    }
+    dios_ssp_share_stft_reset(stft);
+
+    return stft;
+}
+
+int dios_ssp_share_stft_reset(objMchStft *stft)
+{
+    int i;
+
+    if (NULL == stft) {
+        return -1;
+    }
+
+    for (i = 0; i < stft->channels; i++) {
+        dios_ssp_share_ringbuf_reset(stft->ring[i], stft->fft_size - stft->shift_size);
+    }
+    memset(stft->re, 0, stft->channels * stft->fft_size * sizeof(float));
+    memset(stft->im, 0, stft->channels * stft->fft_size * sizeof(float));
+
+    return 0;
+}
+
+int dios_ssp_share_stft_process(objMchStft *stft, const float *in)
+{
+    int i, ch;
+
+    if (NULL == stft || NULL == in) {
+        return -1;
+    }
+
+    for (ch = 0; ch < stft->channels; ch++) {
+        float *win_data = stft->win_ptr[ch];
+
+        dios_ssp_share_ringbuf_write(stft->ring[ch], in + ch * stft->shift_size, stft->shift_size);
+        const float *x = dios_ssp_share_ringbuf_window(stft->ring[ch], 0);
+        for (i = 0; i < stft->fft_size; i++) {
+            win_data[i] = x[i] * stft->ana_win[i];
+        }
+        dios_ssp_share_ringbuf_consume(stft->ring[ch], stft->shift_size);
+    }
+
+    return dios_ssp_share_rfft_batch_process(stft->rfft_param, stft->win_ptr, stft->channels,
+                                             stft->re_ptr, stft->im_ptr, 1);
+}
+
+int dios_ssp_share_stft_uninit(objMchStft *stft)
+{
+    int i;
+
+    if (NULL == stft) {
+        return -1;
+    }
+
+    if (stft->ring) {
+        for (i = 0; i < stft->channels; i++) {
+            dios_ssp_share_ringbuf_uninit(stft->ring[i]);
+        }
+        free(stft->ring);
+    }
+    if (stft->rfft_param) {
+        dios_ssp_share_rfft_uninit(stft->rfft_param);
+    }
+    free(stft->re);
+    free(stft->im);
+    free(stft->ana_win);
+    free(stft->win_data);
+    free(stft->win_ptr);
+    free(stft->re_ptr);
+    free(stft->im_ptr);
+    free(stft);
+
+    return 0;
+}
@@ -20,7 +20,6 @@ Description: Using FFT for subband analysis and subband synthesis.
 
 objSubBand* dios_ssp_share_subband_init(int frm_len)
 {
-    int i;
     float subband_filter_coef[] = {
         -0.0000407034f,	-0.0000476284f,	-0.0000497470f,	-0.0000516895f,	-0.0000537149f,	-0.0000557572f,
             -0.0000577796f,	-0.0000598974f,	-0.0000620104f,	-0.0000642049f,	-0.0000664541f,	-0.0000687551f,
@@ -155,82 +154,71 @@ objSubBand* dios_ssp_share_subband_init(int frm_len)
 
     objSubBand *srv = NULL;
     srv = (objSubBand *)calloc(1, sizeof(objSubBand));
+    if (NULL == srv) {
+        return NULL;
+    }
 
     /*allocation memory to struct param.*/
     srv->frm_len = frm_len;
     srv->Ppf_tap = AEC_WIN_LEN / AEC_FFT_LEN;  /* 768 / 256 = 3 */
     srv->Ppf_decm = AEC_WIN_LEN / srv->frm_len; /* 768 / 128 = 6 */
     srv->scale = 1.0f;
+    srv->ana_pos = 0;
+    srv->comp_pos = 0;
 
-    srv->p_in = (int *)calloc(srv->Ppf_decm, sizeof(int));
-    srv->p_h0 = (int *)calloc(srv->Ppf_decm, sizeof(int));
-
-    for (i = 0; i < AEC_WIN_LEN / srv->frm_len; i++) {
-        srv->p_in[i] = i * srv->frm_len;
-        srv->p_h0[i] = i * srv->frm_len;
-    }
+    /* filter and histories are aligned blocks of frm_len samples each, the
+       polyphase sums then run over whole blocks with dios_ssp_share_vec_mul_acc */
     srv->ana_cxout = (xcomplex *)calloc(AEC_SUBBAND_NUM, sizeof(xcomplex));
-    srv->comp_in = (float *)calloc(AEC_FFT_LEN, sizeof(float));
-    srv->comp_out = (float *)calloc(AEC_WIN_LEN, sizeof(float));
-    srv->lpf_coef = (float *)calloc(AEC_WIN_LEN, sizeof(float));
-
+    srv->comp_in = dios_ssp_share_simd_calloc(AEC_FFT_LEN);
+    srv->comp_out = dios_ssp_share_simd_calloc(AEC_WIN_LEN);
+    srv->lpf_coef = dios_ssp_share_simd_calloc(AEC_WIN_LEN);
+    srv->ana_xin = dios_ssp_share_simd_calloc(AEC_WIN_LEN);
+    srv->ana_xout = dios_ssp_share_simd_calloc(AEC_FFT_LEN);
 
-    memcpy(srv->lpf_coef, subband_filter_coef, AEC_WIN_LEN * sizeof(float));
-
-    srv->ana_xin = (float *)calloc(AEC_WIN_LEN, sizeof(float));
-    srv->ana_xout = (float *)calloc(AEC_WIN_LEN, sizeof(float));
-
-    for (i = 0; i < AEC_WIN_LEN; i++) {
-        srv->comp_out[i] = 0.0;
-    }
     srv->rfft_param = dios_ssp_share_rfft_init(AEC_FFT_LEN);
 
     srv->fftout_buffer = (float*)calloc(AEC_FFT_LEN, sizeof(float));
     srv->fftin_buffer = (float*)calloc(AEC_FFT_LEN, sizeof(float));
+    if (NULL == srv->ana_cxout || NULL == srv->comp_in || NULL == srv->comp_out || NULL == srv->lpf_coef
+        || NULL == srv->ana_xin || NULL == srv->ana_xout || NULL == srv->rfft_param
+        || NULL == srv->fftout_buffer || NULL == srv->fftin_buffer) {
+        dios_ssp_share_subband_uninit(srv);
+        return NULL;
+    }
+    memcpy(srv->lpf_coef, subband_filter_coef, AEC_WIN_LEN * sizeof(float));
     return srv;
 }
 
 int dios_ssp_share_subband_reset(objSubBand* srv)
 {
-    int i;
-    for (i = 0; i < AEC_WIN_LEN; i++) {
-        srv->comp_out[i] = 0.0;
-        srv->ana_xin[i] = 0.0;
-    }
-    for (i = 0; i < AEC_WIN_LEN / srv->frm_len; i++) {
-        srv->p_in[i] = i * srv->frm_len;
-        srv->p_h0[i] = i * srv->frm_len;
-    }
+    memset(srv->comp_out, 0, AEC_WIN_LEN * sizeof(float));
+    memset(srv->ana_xin, 0, AEC_WIN_LEN * sizeof(float));
+    srv->ana_pos = 0;
+    srv->comp_pos = 0;
     return 0;
 }
 
 // subband analysis
 int dios_ssp_share_subband_analyse(objSubBand* srv, float* in_buf, xcomplex* out_buf)
 {
-    int i, j;
-    for (i = srv->frm_len - 1; i >= 0; i--) {
-        srv->ana_xin[i + srv->p_in[0]] = (in_buf[srv->frm_len - i - 1]);
-    }
-    float r0 = 0.0;
-    for (i = 0; i < AEC_FFT_LEN; i++) {
-        r0 = 0.0;
-        if (i < srv->frm_len) {
-            for (j = 0; j < srv->Ppf_tap; j++) {
-                r0 += srv->lpf_coef[srv->p_h0[2 * j] + i] * srv->ana_xin[srv->p_in[2 * j] + i];
-            }
-        } else {
-            for (j = 0; j < srv->Ppf_tap; j++) {
-                r0 += srv->lpf_coef[srv->p_h0[2 * j + 1] + i - srv->frm_len] * srv->ana_xin[srv->p_in[2 * j + 1] + i - srv->frm_len];
-            }
-        }
-        srv->ana_xout[i] = r0;
+    int i, k;
+    int frm_len = srv->frm_len;
+    float *xin = srv->ana_xin + srv->ana_pos * frm_len;
+    for (i = 0; i < frm_len; i++) {
+        xin[i] = in_buf[frm_len - i - 1];
     }
 
-    int itmp = srv->p_in[srv->Ppf_decm - 1];
-    for (i = srv->Ppf_decm - 1; i > 0; i--) {
-        srv->p_in[i] = srv->p_in[i - 1];
+    /* block k of the filter weights the frame k frames ago, even blocks sum into the
+       first half of the fft input and odd blocks into the second half */
+    memset(srv->ana_xout, 0, AEC_FFT_LEN * sizeof(float));
+    for (k = 0; k < srv->Ppf_decm; k++) {
+        int blk = (srv->ana_pos + k) % srv->Ppf_decm;
+        dios_ssp_share_vec_mul_acc(srv->lpf_coef + k * frm_len, srv->ana_xin + blk * frm_len,
+                                   srv->ana_xout + (k & 1) * frm_len, frm_len);
     }
-    srv->p_in[0] = itmp;
+
+    /* the oldest block takes the next frame, nothing is shifted */
+    srv->ana_pos = (srv->ana_pos + srv->Ppf_decm - 1) % srv->Ppf_decm;
 
     dios_ssp_share_rfft_process(srv->rfft_param, srv->ana_xout, srv->fftout_buffer);
 
@@ -247,7 +235,9 @@ int dios_ssp_share_subband_analyse(objSubBand* srv, float* in_buf, xcomplex* out
 // subband synthesis
 int dios_ssp_share_subband_compose(objSubBand* srv, xcomplex* in_buf, float* out_buf)
 {
-    int i, j;
+    int i, k;
+    int frm_len = srv->frm_len;
+    float *out;
     srv->fftin_buffer[0] = in_buf[0].r;
     srv->fftin_buffer[srv->frm_len] = in_buf[srv->frm_len].r;
     for (i = 1; i < srv->frm_len; i++) {
@@ -258,26 +248,25 @@ int dios_ssp_share_subband_compose(objSubBand* srv, xcomplex* in_buf, float* out
     dios_ssp_share_irfft_process(srv->rfft_param, srv->fftin_buffer, srv->fftout_buffer);
 
     for (i = 0; i < AEC_FFT_LEN; i++) {
-        srv->comp_in[i] = srv->fftout_buffer[i];
-    }
-    for (i = 0; i < srv->Ppf_tap; i++) {
-        for (j = 0; j < AEC_FFT_LEN; j++) {
-            int k = i * AEC_FFT_LEN + j;
-            srv->comp_out[k] += srv->lpf_coef[k] * srv->comp_in[AEC_FFT_LEN - j - 1];
-        }
+        srv->comp_in[i] = srv->fftout_buffer[AEC_FFT_LEN - i - 1];
     }
 
-    for (i = 0; i < srv->frm_len; i++) {
-        out_buf[i] = srv->comp_out[i] * srv->frm_len * srv->scale;
+    /* block k of the overlap-add output is comp_pos + k of the ring, it takes filter
+       block k times the reversed fft output repeated Ppf_tap times */
+    for (k = 0; k < srv->Ppf_decm; k++) {
+        int blk = (srv->comp_pos + k) % srv->Ppf_decm;
+        dios_ssp_share_vec_mul_acc(srv->lpf_coef + k * frm_len, srv->comp_in + (k * frm_len) % AEC_FFT_LEN,
+                                   srv->comp_out + blk * frm_len, frm_len);
     }
 
-    /* shift, add  for compostion */
-    for (i = 0; i < AEC_WIN_LEN - srv->frm_len; i++) {
-        srv->comp_out[i] = srv->comp_out[i + srv->frm_len];
-    }
-    for (i = AEC_WIN_LEN - srv->frm_len; i < AEC_WIN_LEN; i++) {
-        srv->comp_out[i] = 0.0;
+    out = srv->comp_out + srv->comp_pos * frm_len;
+    for (i = 0; i < frm_len; i++) {
+        out_buf[i] = out[i] * frm_len * srv->scale;
     }
+
+    /* the block just output is cleared and becomes the last block of the ring */
+    memset(out, 0, frm_len * sizeof(float));
+    srv->comp_pos = (srv->comp_pos + 1) % srv->Ppf_decm;
     return(0);
 }
 
@@ -287,21 +276,21 @@ int dios_ssp_share_subband_uninit(objSubBand* srv)
     if (NULL == srv) {
         return -1;
     }
-    free(srv->p_in);
-    free(srv->p_h0);
     free(srv->ana_cxout);
-    free(srv->comp_in);
-    free(srv->comp_out);
-    free(srv->lpf_coef);
-    free(srv->ana_xin);
-    free(srv->ana_xout);
+    dios_ssp_share_simd_free(srv->comp_in);
+    dios_ssp_share_simd_free(srv->comp_out);
+    dios_ssp_share_simd_free(srv->lpf_coef);
+    dios_ssp_share_simd_free(srv->ana_xin);
+    dios_ssp_share_simd_free(srv->ana_xout);
     free(srv->fftout_buffer);
     free(srv->fftin_buffer);
-    ret = dios_ssp_share_rfft_uninit(srv->rfft_param);
+    if (NULL != srv->rfft_param) {
+        ret = dios_ssp_share_rfft_uninit(srv->rfft_param);
+    }
+    free(srv);
     if (0 != ret) {
         return -1;
     }
-    free(srv);
     return 0;
 }
 
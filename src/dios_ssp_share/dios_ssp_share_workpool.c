@@ -0,0 +1,143 @@
+/* Copyright (C) 2017 Beijing Didi Infinity Technology and Development Co.,Ltd.
+All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Description: Persistent worker pool for per-channel work inside one frame.
+Tasks are handed out one index at a time under the pool lock, so a job of a
+few channels is spread over the threads without any per-frame thread
+creation. Which thread runs a task does not change its result as long as the
+tasks only write their own state.
+==============================================================================*/
+
+#include "dios_ssp_share_workpool.h"
+
+/* run tasks of the current job until none is left, called with the lock held */
+static void workpool_drain(objWorkpool *pool)
+{
+    int index;
+    while (pool->next < pool->task_num) {
+        index = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->task(pool->arg, index);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_broadcast(&pool->done_cond);
+        }
+    }
+}
+
+static void* workpool_worker(void *arg)
+{
+    objWorkpool *pool = (objWorkpool *)arg;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (!pool->quit && pool->next >= pool->task_num) {
+            pthread_cond_wait(&pool->job_cond, &pool->lock);
+        }
+        if (pool->quit) {
+            break;
+        }
+        workpool_drain(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+objWorkpool* dios_ssp_share_workpool_init(int thread_num)
+{
+    int i;
+    objWorkpool *pool = NULL;
+
+    if (thread_num < 0) {
+        return NULL;
+    }
+    pool = (objWorkpool *)calloc(1, sizeof(objWorkpool));
+    if (NULL == pool) {
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    if (thread_num > 0) {
+        pool->threads = (pthread_t *)calloc(thread_num, sizeof(pthread_t));
+        if (NULL == pool->threads) {
+            dios_ssp_share_workpool_uninit(pool);
+            return NULL;
+        }
+    }
+    for (i = 0; i < thread_num; i++) {
+        if (0 != pthread_create(&pool->threads[i], NULL, workpool_worker, pool)) {
+            dios_ssp_share_workpool_uninit(pool);
+            return NULL;
+        }
+        pool->thread_num++;
+    }
+
+    return pool;
+}
+
+int dios_ssp_share_workpool_run(objWorkpool *pool, WorkpoolTask task, void *arg, int task_num)
+{
+    int i;
+
+    if (NULL == pool || NULL == task || task_num < 0) {
+        return -1;
+    }
+    if (pool->thread_num == 0 || task_num == 1) {
+        for (i = 0; i < task_num; i++) {
+            task(arg, i);
+        }
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->task_num = task_num;
+    pool->next = 0;
+    pool->pending = task_num;
+    pthread_cond_broadcast(&pool->job_cond);
+    workpool_drain(pool);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+int dios_ssp_share_workpool_uninit(objWorkpool *pool)
+{
+    int i;
+
+    if (NULL == pool) {
+        return -1;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->job_cond);
+    pthread_mutex_unlock(&pool->lock);
+    for (i = 0; i < pool->thread_num; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->job_cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+
+    return 0;
+}